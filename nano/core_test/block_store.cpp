@@ -3,6 +3,9 @@
 #include <nano/lib/utility.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/node.hpp>
+#include <nano/secure/block_codec.hpp>
+#include <nano/secure/group_commit.hpp>
+#include <nano/secure/ledger_snapshot.hpp>
 #include <nano/secure/versioning.hpp>
 
 #if NANO_ROCKSDB
@@ -12,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <fstream>
+#include <sstream>
 
 #include <stdlib.h>
 
@@ -79,6 +83,64 @@ TEST (block_store, add_item)
 	ASSERT_EQ (nullptr, latest3);
 }
 
+TEST (block_store, blocks_get)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::keypair key;
+	nano::open_block block1 (0, 1, key.pub, key.prv, key.pub, 0);
+	nano::send_block block2 (block1.hash (), 2, 3, key.prv, key.pub, 0);
+	nano::state_block block3 (key.pub, block2.hash (), 4, 5, 6, key.prv, key.pub, 0);
+	{
+		auto transaction (store->tx_begin_write ());
+		store->block_put (transaction, block1.hash (), block1, nano::block_sideband (nano::block_type::open, key.pub, 0, 0, 1, 0, nano::epoch::epoch_0));
+		store->block_put (transaction, block2.hash (), block2, nano::block_sideband (nano::block_type::send, key.pub, 0, 0, 2, 0, nano::epoch::epoch_0));
+		store->block_put (transaction, block3.hash (), block3, nano::block_sideband (nano::block_type::state, key.pub, 0, 0, 3, 0, nano::epoch::epoch_0));
+	}
+	auto transaction (store->tx_begin_read ());
+	// Cached and uncached blocks are both returned
+	ASSERT_NE (nullptr, store->block_get (transaction, block2.hash ()));
+	std::vector<nano::block_sideband> sidebands;
+	auto blocks (store->blocks_get (transaction, { block3.hash (), 7, block1.hash (), block2.hash (), block3.hash () }, &sidebands));
+	ASSERT_EQ (5, blocks.size ());
+	ASSERT_EQ (5, sidebands.size ());
+	ASSERT_EQ (block3, *blocks[0]);
+	ASSERT_EQ (nullptr, blocks[1]);
+	ASSERT_EQ (block1, *blocks[2]);
+	ASSERT_EQ (block2, *blocks[3]);
+	ASSERT_EQ (block3, *blocks[4]);
+	ASSERT_EQ (3, sidebands[0].height);
+	ASSERT_EQ (1, sidebands[2].height);
+	ASSERT_EQ (2, sidebands[3].height);
+	ASSERT_TRUE (store->blocks_get (transaction, {}).empty ());
+}
+
+TEST (block_store, accounts_get)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::account account1 (1);
+	nano::account account2 (2);
+	{
+		auto transaction (store->tx_begin_write ());
+		store->account_put (transaction, account1, { 3, 4, 5, 6, 7, 8, nano::epoch::epoch_0 });
+		store->account_put (transaction, account2, { 9, 10, 11, 12, 13, 14, nano::epoch::epoch_0 });
+	}
+	auto transaction (store->tx_begin_read ());
+	nano::account_info info;
+	ASSERT_FALSE (store->account_get (transaction, account2, info));
+	auto infos (store->accounts_get (transaction, { account2, 15, account1 }));
+	ASSERT_EQ (3, infos.size ());
+	ASSERT_TRUE (infos[0].is_initialized ());
+	ASSERT_EQ (info, *infos[0]);
+	ASSERT_FALSE (infos[1].is_initialized ());
+	ASSERT_TRUE (infos[2].is_initialized ());
+	ASSERT_EQ (3, infos[2]->head.number ());
+	ASSERT_EQ (8, infos[2]->block_count);
+}
+
 TEST (block_store, clear_successor)
 {
 	nano::logger_mt logger;
@@ -191,6 +253,44 @@ TEST (block_store, add_pending)
 	ASSERT_TRUE (store->pending_get (transaction, key2, pending2));
 }
 
+TEST (block_store, pending_amounts)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::account account (1);
+	auto transaction (store->tx_begin_write ());
+	nano::pending_summary summary;
+	ASSERT_TRUE (store->pending_summary_get (transaction, account, summary));
+	store->pending_put (transaction, nano::pending_key (account, 1), nano::pending_info (2, 10, nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (account, 2), nano::pending_info (2, 30, nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (account, 3), nano::pending_info (2, 20, nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (2, 4), nano::pending_info (2, 40, nano::epoch::epoch_0));
+	// Replacing an entry updates its amount
+	store->pending_put (transaction, nano::pending_key (account, 1), nano::pending_info (2, 5, nano::epoch::epoch_0));
+	ASSERT_FALSE (store->pending_summary_get (transaction, account, summary));
+	ASSERT_EQ (nano::pending_summary (3, 55), summary);
+	std::vector<nano::pending_amount_key> entries;
+	for (auto i (store->pending_amounts_begin (transaction, account)), n (store->pending_amounts_end ()); i != n && nano::pending_amount_key (i->first).account == account; ++i)
+	{
+		entries.push_back (i->first);
+	}
+	ASSERT_EQ (3, entries.size ());
+	ASSERT_EQ (nano::pending_amount_key (account, 30, 2), entries[0]);
+	ASSERT_EQ (nano::pending_amount_key (account, 20, 3), entries[1]);
+	ASSERT_EQ (nano::pending_amount_key (account, 5, 1), entries[2]);
+	ASSERT_EQ (nano::amount (5), entries[2].amount ());
+	store->pending_del (transaction, nano::pending_key (account, 2));
+	ASSERT_FALSE (store->pending_summary_get (transaction, account, summary));
+	ASSERT_EQ (nano::pending_summary (2, 25), summary);
+	store->pending_del (transaction, nano::pending_key (account, 1));
+	store->pending_del (transaction, nano::pending_key (account, 3));
+	ASSERT_TRUE (store->pending_summary_get (transaction, account, summary));
+	auto remaining (store->pending_amounts_begin (transaction, account));
+	ASSERT_NE (store->pending_amounts_end (), remaining);
+	ASSERT_EQ (nano::pending_amount_key (2, 40, 4), nano::pending_amount_key (remaining->first));
+}
+
 TEST (block_store, pending_iterator)
 {
 	nano::logger_mt logger;
@@ -259,6 +359,26 @@ TEST (block_store, pending_iterator_comparison)
 	}
 }
 
+TEST (block_store, pending_account_iterator)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	auto transaction (store->tx_begin_write ());
+	store->pending_put (transaction, nano::pending_key (nano::account (2), nano::block_hash (5)), nano::pending_info (nano::account (10), nano::amount (1), nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (nano::account (3), nano::block_hash (1)), nano::pending_info (nano::account (10), nano::amount (1), nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (nano::account (3), nano::block_hash (4)), nano::pending_info (nano::account (10), nano::amount (2), nano::epoch::epoch_0));
+	store->pending_put (transaction, nano::pending_key (nano::account (4), nano::block_hash (2)), nano::pending_info (nano::account (10), nano::amount (3), nano::epoch::epoch_0));
+	std::vector<nano::block_hash> hashes;
+	for (auto i (store->pending_begin (transaction, nano::account (3))), n (store->pending_end ()); i != n && nano::pending_key (i->first).account == nano::account (3); ++i)
+	{
+		hashes.push_back (nano::pending_key (i->first).hash);
+	}
+	ASSERT_EQ ((std::vector<nano::block_hash>{ 1, 4 }), hashes);
+	auto i (store->pending_begin (transaction, nano::account (5)));
+	ASSERT_TRUE (i == store->pending_end () || nano::pending_key (i->first).account != nano::account (5));
+}
+
 TEST (block_store, genesis)
 {
 	nano::logger_mt logger;
@@ -741,6 +861,33 @@ TEST (block_store, account_count)
 	ASSERT_EQ (1, store->account_count (transaction));
 }
 
+TEST (block_store, table_counts)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	{
+		auto store = nano::make_store (logger, path);
+		ASSERT_TRUE (!store->init_error ());
+		auto transaction (store->tx_begin_write ());
+		store->online_weight_put (transaction, 1, 2);
+		store->online_weight_put (transaction, 3, 4);
+		store->online_weight_put (transaction, 3, 5);
+		store->online_weight_del (transaction, 1);
+		store->confirmation_height_put (transaction, nano::account (1), 0);
+		store->confirmation_height_put (transaction, nano::account (2), 0);
+		store->peer_put (transaction, nano::endpoint_key (boost::asio::ip::address_v6::any ().to_bytes (), 100));
+		store->peer_put (transaction, nano::endpoint_key (boost::asio::ip::address_v6::any ().to_bytes (), 101));
+		store->peer_clear (transaction);
+		store->peer_put (transaction, nano::endpoint_key (boost::asio::ip::address_v6::any ().to_bytes (), 102));
+	}
+	auto store = nano::make_store (logger, path);
+	ASSERT_TRUE (!store->init_error ());
+	auto transaction (store->tx_begin_read ());
+	ASSERT_EQ (1, store->online_weight_count (transaction));
+	ASSERT_EQ (2, store->confirmation_height_count (transaction));
+	ASSERT_EQ (1, store->peer_count (transaction));
+}
+
 TEST (block_store, cemented_count_cache)
 {
 	nano::logger_mt logger;
@@ -1760,6 +1907,35 @@ TEST (mdb_block_store, upgrade_backup)
 	ASSERT_NE (get_backup_path ().string (), dir.string ());
 }
 
+TEST (mdb_block_store, upgrade_v15_v16)
+{
+	auto path (nano::unique_path ());
+	nano::account account (1);
+	{
+		nano::logger_mt logger;
+		nano::mdb_store store (logger, path);
+		auto transaction (store.tx_begin_write ());
+		store.pending_put (transaction, nano::pending_key (account, 1), nano::pending_info (2, 10, nano::epoch::epoch_0));
+		store.pending_put (transaction, nano::pending_key (account, 2), nano::pending_info (2, 20, nano::epoch::epoch_0));
+		store.version_put (transaction, 15);
+	}
+	// The index is rebuilt from the pending entries
+	nano::logger_mt logger;
+	nano::mdb_store store (logger, path);
+	ASSERT_FALSE (store.init_error ());
+	auto transaction (store.tx_begin_read ());
+	ASSERT_EQ (16, store.version_get (transaction));
+	nano::pending_summary summary;
+	ASSERT_FALSE (store.pending_summary_get (transaction, account, summary));
+	ASSERT_EQ (nano::pending_summary (2, 30), summary);
+	auto i (store.pending_amounts_begin (transaction, account));
+	ASSERT_EQ (nano::pending_amount_key (account, 20, 2), nano::pending_amount_key (i->first));
+	++i;
+	ASSERT_EQ (nano::pending_amount_key (account, 10, 1), nano::pending_amount_key (i->first));
+	++i;
+	ASSERT_EQ (store.pending_amounts_end (), i);
+}
+
 // Test various confirmation height values as well as clearing them
 TEST (block_store, confirmation_height)
 {
@@ -1930,6 +2106,68 @@ TEST (block_store, rocksdb_force_test_env_variable)
 #endif
 }
 
+TEST (block_store, ledger_snapshot)
+{
+	nano::logger_mt logger;
+	nano::genesis genesis;
+	nano::stat stats;
+	nano::keypair key1;
+	std::stringstream snapshot;
+	auto store1 = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store1->init_error ());
+	nano::ledger ledger1 (*store1, stats);
+	nano::work_pool pool (std::numeric_limits<unsigned>::max ());
+	nano::send_block send1 (genesis.hash (), key1.pub, nano::genesis_amount - 100, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *pool.generate (genesis.hash ()));
+	nano::open_block open1 (send1.hash (), nano::test_genesis_key.pub, key1.pub, key1.prv, key1.pub, *pool.generate (key1.pub));
+	nano::state_block send2 (key1.pub, open1.hash (), nano::test_genesis_key.pub, 50, nano::test_genesis_key.pub, key1.prv, key1.pub, *pool.generate (open1.hash ()));
+	{
+		auto transaction (store1->tx_begin_write ());
+		store1->initialize (transaction, genesis, ledger1.rep_weights, ledger1.cemented_count, ledger1.block_count_cache);
+		ASSERT_EQ (nano::process_result::progress, ledger1.process (transaction, send1).code);
+		ASSERT_EQ (nano::process_result::progress, ledger1.process (transaction, open1).code);
+		ASSERT_EQ (nano::process_result::progress, ledger1.process (transaction, send2).code);
+	}
+	ASSERT_FALSE (nano::ledger_snapshot::write (*store1, snapshot));
+	auto contents (snapshot.str ());
+	auto store2 = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store2->init_error ());
+	{
+		auto transaction (store2->tx_begin_write ());
+		nano::rep_weights rep_weights;
+		std::atomic<uint64_t> cemented_count{ 0 };
+		std::atomic<uint64_t> block_count_cache{ 0 };
+		store2->initialize (transaction, genesis, rep_weights, cemented_count, block_count_cache);
+	}
+	std::string error;
+	std::stringstream stream1 (contents);
+	ASSERT_FALSE (nano::ledger_snapshot::read (*store2, stream1, error));
+	ASSERT_TRUE (error.empty ());
+	{
+		auto transaction1 (store1->tx_begin_read ());
+		auto transaction2 (store2->tx_begin_read ());
+		ASSERT_EQ (store1->block_count (transaction1).sum (), store2->block_count (transaction2).sum ());
+		ASSERT_EQ (4, store2->block_count (transaction2).sum ());
+		ASSERT_EQ (2, store2->account_count (transaction2));
+		nano::account_info info1;
+		nano::account_info info2;
+		ASSERT_FALSE (store1->account_get (transaction1, key1.pub, info1));
+		ASSERT_FALSE (store2->account_get (transaction2, key1.pub, info2));
+		ASSERT_EQ (info1, info2);
+		nano::pending_info pending;
+		ASSERT_FALSE (store2->pending_get (transaction2, nano::pending_key (nano::test_genesis_key.pub, send2.hash ()), pending));
+		ASSERT_EQ (nano::test_genesis_key.pub, store2->frontier_get (transaction2, send1.hash ()));
+	}
+	// A corrupted chunk is rejected
+	contents[contents.size () / 2] ^= 1;
+	std::stringstream stream2 (contents);
+	ASSERT_TRUE (nano::ledger_snapshot::read (*store2, stream2, error));
+	ASSERT_FALSE (error.empty ());
+	// The previously imported ledger is left untouched
+	auto transaction (store2->tx_begin_read ());
+	ASSERT_EQ (4, store2->block_count (transaction).sum ());
+	ASSERT_TRUE (store2->block_exists (transaction, send2.hash ()));
+}
+
 namespace
 {
 void write_sideband_v12 (nano::mdb_store & store_a, nano::transaction & transaction_a, nano::block & block_a, nano::block_hash const & successor_a, MDB_dbi db_a)
@@ -2001,3 +2239,417 @@ void modify_genesis_account_info_to_v5 (nano::mdb_store & store, nano::transacti
 	assert (status == 0);
 }
 }
+
+TEST (block_store, cache)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::genesis genesis;
+	nano::stat stats;
+	nano::ledger ledger (*store, stats);
+	{
+		auto transaction (store->tx_begin_write ());
+		store->initialize (transaction, genesis, ledger.rep_weights, ledger.cemented_count, ledger.block_count_cache);
+	}
+	auto read1 (store->tx_begin_read ());
+	nano::block_sideband sideband1;
+	auto block1 (store->block_get (read1, genesis.hash (), &sideband1));
+	ASSERT_NE (nullptr, block1);
+	// Second read returns the cached object
+	nano::block_sideband sideband2;
+	auto block2 (store->block_get (read1, genesis.hash (), &sideband2));
+	ASSERT_EQ (block1, block2);
+	ASSERT_EQ (sideband1.height, sideband2.height);
+	uint64_t confirmation_height (0);
+	ASSERT_FALSE (store->confirmation_height_get (read1, nano::genesis_account, confirmation_height));
+	ASSERT_EQ (1, confirmation_height);
+	// Changes are visible to new read transactions once committed
+	{
+		auto transaction (store->tx_begin_write ());
+		store->confirmation_height_put (transaction, nano::genesis_account, 2);
+		// Write transactions read the store
+		ASSERT_FALSE (store->confirmation_height_get (transaction, nano::genesis_account, confirmation_height));
+		ASSERT_EQ (2, confirmation_height);
+		// Readers still see their snapshot
+		ASSERT_FALSE (store->confirmation_height_get (read1, nano::genesis_account, confirmation_height));
+		ASSERT_EQ (1, confirmation_height);
+	}
+	// Stale snapshots do not populate the cache
+	ASSERT_FALSE (store->confirmation_height_get (read1, nano::genesis_account, confirmation_height));
+	ASSERT_EQ (1, confirmation_height);
+	auto read2 (store->tx_begin_read ());
+	ASSERT_FALSE (store->confirmation_height_get (read2, nano::genesis_account, confirmation_height));
+	ASSERT_EQ (2, confirmation_height);
+	read1.refresh ();
+	ASSERT_FALSE (store->confirmation_height_get (read1, nano::genesis_account, confirmation_height));
+	ASSERT_EQ (2, confirmation_height);
+	boost::property_tree::ptree json;
+	store->cache ().serialize_json (json);
+	ASSERT_EQ (1, json.get<uint64_t> ("blocks.hits"));
+	ASSERT_EQ (1, json.get<uint64_t> ("blocks.entries"));
+	ASSERT_EQ (1, json.get<uint64_t> ("confirmation_heights.entries"));
+}
+
+TEST (group_commit, group)
+{
+	nano::durability_config config;
+	config.mode = nano::durability_mode::group;
+	config.sync_interval = std::chrono::seconds (10);
+	std::atomic<unsigned> flushes{ 0 };
+	nano::group_commit group_commit (config, [&flushes]() {
+		std::this_thread::sleep_for (std::chrono::milliseconds (10));
+		++flushes;
+	});
+	// Committers wait for a flush instead of the sync interval
+	group_commit.committed ();
+	ASSERT_EQ (1, flushes);
+	std::vector<std::thread> threads;
+	for (auto i (0); i < 8; ++i)
+	{
+		threads.emplace_back ([&group_commit]() {
+			for (auto j (0); j < 10; ++j)
+			{
+				group_commit.committed ();
+			}
+		});
+	}
+	for (auto & thread : threads)
+	{
+		thread.join ();
+	}
+	// Concurrent commits share flushes
+	ASSERT_LT (flushes, 81);
+	ASSERT_EQ (flushes, group_commit.flushes);
+	// Deferred commits are flushed when the outermost scope ends
+	auto flushes_l (flushes.load ());
+	nano::group_commit::defer_begin ();
+	nano::group_commit::defer_begin ();
+	group_commit.committed ();
+	group_commit.committed ();
+	ASSERT_EQ (flushes_l, flushes);
+	nano::group_commit::defer_end ();
+	ASSERT_EQ (flushes_l, flushes);
+	nano::group_commit::defer_end ();
+	ASSERT_EQ (flushes_l + 1, flushes);
+}
+
+TEST (group_commit, async)
+{
+	nano::durability_config config;
+	config.mode = nano::durability_mode::async;
+	config.sync_interval = std::chrono::seconds (10);
+	std::atomic<unsigned> flushes{ 0 };
+	nano::group_commit group_commit (config, [&flushes]() {
+		++flushes;
+	});
+	group_commit.committed ();
+	group_commit.committed ();
+	ASSERT_EQ (0, flushes);
+	// Outstanding commits are flushed on shutdown
+	group_commit.stop ();
+	ASSERT_EQ (1, flushes);
+	group_commit.stop ();
+	ASSERT_EQ (1, flushes);
+}
+
+TEST (block_store, group_commit)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	nano::durability_config config;
+	config.mode = nano::durability_mode::group;
+	nano::genesis genesis;
+	{
+		auto store = nano::make_store (logger, path, false, false, nano::rocksdb_config{}, nano::txn_tracking_config{}, std::chrono::milliseconds (5000), 128, 512, false, false, config);
+		ASSERT_TRUE (!store->init_error ());
+		nano::stat stats;
+		nano::ledger ledger (*store, stats);
+		auto transaction (store->tx_begin_write ());
+		store->initialize (transaction, genesis, ledger.rep_weights, ledger.cemented_count, ledger.block_count_cache);
+		transaction.commit ();
+		transaction.renew ();
+		store->confirmation_height_put (transaction, nano::genesis_account, 2);
+	}
+	auto store = nano::make_store (logger, path);
+	ASSERT_TRUE (!store->init_error ());
+	auto transaction (store->tx_begin_read ());
+	ASSERT_TRUE (store->block_exists (transaction, genesis.hash ()));
+	uint64_t confirmation_height (0);
+	ASSERT_FALSE (store->confirmation_height_get (transaction, nano::genesis_account, confirmation_height));
+	ASSERT_EQ (2, confirmation_height);
+}
+
+TEST (block_store, read_only)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	{
+		nano::mdb_store store (logger, path, nano::txn_tracking_config{}, std::chrono::seconds (5), 128, 512, false, nano::durability_config{}, nano::compression_config{}, true);
+		// Read-only stores are not created
+		ASSERT_TRUE (store.init_error ());
+	}
+	{
+		nano::mdb_store store (logger, path);
+		ASSERT_FALSE (store.init_error ());
+		auto transaction (store.tx_begin_write ());
+		store.online_weight_put (transaction, 1, 2);
+	}
+	nano::mdb_store store (logger, path, nano::txn_tracking_config{}, std::chrono::seconds (5), 128, 512, false, nano::durability_config{}, nano::compression_config{}, true);
+	ASSERT_FALSE (store.init_error ());
+	{
+		auto transaction (store.tx_begin_read ());
+		ASSERT_EQ (1, store.online_weight_count (transaction));
+		// Commits from another process are not tracked by the cache
+		ASSERT_EQ (0, transaction.cache_generation ());
+	}
+	MDB_txn * transaction;
+	ASSERT_EQ (EACCES, mdb_txn_begin (store.env, nullptr, 0, &transaction));
+	ASSERT_TRUE (store.compact (0, []() { return false; }));
+}
+
+// The block processor and the confirmation height processor both write confirmation heights
+TEST (block_store, confirmation_height_writers)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::account account (1);
+	std::atomic<bool> cemented{ false };
+	std::thread cementer;
+	{
+		// Account opened by the block processor
+		auto transaction (store->tx_begin_write ({ nano::tables::accounts, nano::tables::confirmation_height }));
+		store->confirmation_height_put (transaction, account, 0);
+		cementer = std::thread ([&store, &account, &cemented]() {
+			auto transaction (store->tx_begin_write ({ nano::tables::confirmation_height }));
+			store->confirmation_height_put (transaction, account, 1);
+			cemented = true;
+		});
+		// Cementing waits for the block processor to commit
+		std::this_thread::sleep_for (std::chrono::milliseconds (100));
+		ASSERT_FALSE (cemented);
+	}
+	cementer.join ();
+	auto transaction (store->tx_begin_read ());
+	uint64_t confirmation_height (0);
+	ASSERT_FALSE (store->confirmation_height_get (transaction, account, confirmation_height));
+	ASSERT_EQ (1, confirmation_height);
+}
+
+// Online compaction renames the compacted file over the open ledger, which Windows does not allow
+#ifndef _WIN32
+TEST (block_store, compact)
+{
+	nano::logger_mt logger;
+	auto store = nano::make_store (logger, nano::unique_path ());
+	ASSERT_TRUE (!store->init_error ());
+	nano::genesis genesis;
+	{
+		nano::stat stats;
+		nano::ledger ledger (*store, stats);
+		auto transaction (store->tx_begin_write ());
+		store->initialize (transaction, genesis, ledger.rep_weights, ledger.cemented_count, ledger.block_count_cache);
+		for (uint64_t i (0); i < 10000; ++i)
+		{
+			store->online_weight_put (transaction, i, i);
+		}
+	}
+	{
+		auto transaction (store->tx_begin_write ());
+		for (uint64_t i (0); i < 10000; i += 2)
+		{
+			store->online_weight_del (transaction, i);
+		}
+	}
+	// Reset read transactions do not hold back the swap
+	auto reset_transaction (store->tx_begin_read ());
+	reset_transaction.reset ();
+	// Writes made while the tables are copied are carried over
+	std::thread writer ([&store]() {
+		for (uint64_t i (1); i <= 1000; ++i)
+		{
+			auto transaction (store->tx_begin_write ());
+			store->online_weight_put (transaction, 10000 + i, 10000 + i);
+			if (i % 2 == 1)
+			{
+				store->online_weight_del (transaction, i);
+			}
+		}
+	});
+	ASSERT_FALSE (store->compact (0, []() { return false; }));
+	writer.join ();
+	reset_transaction.renew ();
+	ASSERT_TRUE (store->block_exists (reset_transaction, genesis.hash ()));
+	{
+		auto transaction (store->tx_begin_write ());
+		store->online_weight_put (transaction, 20000, 20000);
+	}
+	auto transaction (store->tx_begin_read ());
+	ASSERT_TRUE (store->block_exists (transaction, genesis.hash ()));
+	ASSERT_EQ (4500 + 1000 + 1, store->online_weight_count (transaction));
+	for (auto i (store->online_weight_begin (transaction)), n (store->online_weight_end ()); i != n; ++i)
+	{
+		ASSERT_EQ (i->first, i->second.number ());
+		ASSERT_TRUE (i->first > 10000 || (i->first > 1000 && i->first % 2 == 1));
+	}
+	// Gives up when stopped
+	ASSERT_TRUE (store->compact (0, []() { return true; }));
+}
+
+// Keys recorded by a writer which has not committed yet are replayed after its commit
+TEST (block_store, compact_open_writer)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	auto store = nano::make_store (logger, path);
+	ASSERT_TRUE (!store->init_error ());
+	{
+		auto transaction (store->tx_begin_write ());
+		for (uint64_t i (0); i < 10000; ++i)
+		{
+			store->online_weight_put (transaction, i, i);
+		}
+	}
+	std::atomic<bool> compacted{ false };
+	// Throttled so that the tables are still being copied when the writer starts
+	std::thread compactor ([&store, &compacted]() {
+		compacted = !store->compact (256 * 1024, []() { return false; });
+	});
+	auto start (std::chrono::steady_clock::now ());
+	while (!boost::filesystem::exists (path.parent_path () / "compacting.ldb"))
+	{
+		ASSERT_LT (std::chrono::steady_clock::now () - start, std::chrono::seconds (10));
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+	{
+		auto transaction (store->tx_begin_write ());
+		store->online_weight_put (transaction, 20000, 20000);
+		// Held open across the first replay round
+		std::this_thread::sleep_for (std::chrono::seconds (3));
+	}
+	compactor.join ();
+	ASSERT_TRUE (compacted);
+	auto transaction (store->tx_begin_read ());
+	ASSERT_EQ (10001, store->online_weight_count (transaction));
+}
+
+// Read-only stores in other processes reopen the ledger once it is replaced by an online compaction
+TEST (block_store, compact_replica)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	nano::mdb_store store (logger, path);
+	ASSERT_FALSE (store.init_error ());
+	{
+		auto transaction (store.tx_begin_write ());
+		store.online_weight_put (transaction, 1, 1);
+	}
+	nano::mdb_store replica (logger, path, nano::txn_tracking_config{}, std::chrono::seconds (5), 128, 512, false, nano::durability_config{}, nano::compression_config{}, true);
+	ASSERT_FALSE (replica.init_error ());
+	ASSERT_FALSE (store.compact (0, []() { return false; }));
+	ASSERT_TRUE (replica.replica_refresh ());
+	{
+		auto transaction (store.tx_begin_write ());
+		store.online_weight_put (transaction, 2, 2);
+	}
+	ASSERT_TRUE (replica.replica_refresh ());
+	auto transaction (replica.tx_begin_read ());
+	ASSERT_EQ (2, replica.online_weight_count (transaction));
+}
+#endif
+
+TEST (block_codec, train)
+{
+	nano::keypair key1;
+	std::vector<std::vector<uint8_t>> samples;
+	for (uint64_t i (0); i < 64; ++i)
+	{
+		nano::state_block block (key1.pub, 0, nano::genesis_account, i, 0, key1.prv, key1.pub, 0);
+		std::vector<uint8_t> bytes;
+		{
+			nano::vectorstream stream (bytes);
+			block.serialize (stream);
+		}
+		samples.push_back (bytes);
+	}
+	auto dictionary (nano::block_codec::train (samples, 1024));
+	ASSERT_FALSE (dictionary.empty ());
+	ASSERT_LE (dictionary.size (), 1024);
+	nano::block_codec codec (dictionary);
+	std::vector<uint8_t> compressed;
+	ASSERT_FALSE (codec.compress (samples[0].data (), samples[0].size (), samples[0].size (), compressed));
+	ASSERT_LT (compressed.size (), samples[0].size ());
+	std::vector<uint8_t> decompressed;
+	ASSERT_FALSE (codec.decompress (compressed.data (), compressed.size (), decompressed));
+	ASSERT_EQ (samples[0], decompressed);
+	// Output which is not smaller than the limit is rejected
+	ASSERT_TRUE (codec.compress (samples[0].data (), samples[0].size (), compressed.size (), compressed));
+	// Back references into the dictionary cannot be decoded without it
+	ASSERT_FALSE (codec.compress (samples[1].data (), samples[1].size (), samples[1].size (), compressed));
+	nano::block_codec empty (std::vector<uint8_t>{});
+	ASSERT_TRUE (empty.decompress (compressed.data (), compressed.size (), decompressed));
+}
+
+TEST (block_store, compressed_blocks)
+{
+	nano::logger_mt logger;
+	auto path (nano::unique_path ());
+	nano::keypair key1;
+	std::vector<std::shared_ptr<nano::state_block>> blocks;
+	for (uint64_t i (0); i < 16; ++i)
+	{
+		blocks.push_back (std::make_shared<nano::state_block> (key1.pub, 0, nano::genesis_account, i, 0, key1.prv, key1.pub, 0));
+	}
+	auto put ([&blocks](nano::block_store & store_a, size_t begin_a, size_t end_a) {
+		auto transaction (store_a.tx_begin_write ());
+		for (auto i (begin_a); i < end_a; ++i)
+		{
+			nano::block_sideband sideband (nano::block_type::state, blocks[i]->account (), 0, blocks[i]->balance (), 1, nano::seconds_since_epoch (), nano::epoch::epoch_0);
+			store_a.block_put (transaction, blocks[i]->hash (), *blocks[i], sideband);
+		}
+	});
+	nano::compression_config compression_config;
+	compression_config.enable = true;
+	compression_config.dictionary_samples = 8;
+	{
+		// Not enough state blocks to train a dictionary yet
+		nano::mdb_store store (logger, path, nano::txn_tracking_config{}, std::chrono::seconds (5), 128, 512, false, nano::durability_config{}, compression_config);
+		ASSERT_FALSE (store.init_error ());
+		put (store, 0, 8);
+	}
+	{
+		nano::mdb_store store (logger, path, nano::txn_tracking_config{}, std::chrono::seconds (5), 128, 512, false, nano::durability_config{}, compression_config);
+		ASSERT_FALSE (store.init_error ());
+		put (store, 8, 16);
+		auto transaction (store.tx_begin_read ());
+		nano::mdb_val value;
+		ASSERT_EQ (0, mdb_get (store.env.tx (transaction), store.state_blocks, nano::mdb_val (blocks[0]->hash ()), value));
+		ASSERT_EQ (nano::block::size (nano::block_type::state) + nano::block_sideband::size (nano::block_type::state), value.size ());
+		ASSERT_EQ (0, mdb_get (store.env.tx (transaction), store.state_blocks, nano::mdb_val (blocks[15]->hash ()), value));
+		ASSERT_LT (value.size (), nano::block::size (nano::block_type::state));
+		ASSERT_EQ (16, store.block_count (transaction).state);
+		ASSERT_NE (nullptr, store.block_random (transaction));
+	}
+	// Compressed blocks are still read with compression disabled
+	nano::mdb_store store (logger, path);
+	ASSERT_FALSE (store.init_error ());
+	auto transaction (store.tx_begin_read ());
+	std::vector<nano::block_hash> hashes;
+	for (auto const & block : blocks)
+	{
+		nano::block_sideband sideband;
+		auto block_l (store.block_get (transaction, block->hash (), &sideband));
+		ASSERT_NE (nullptr, block_l);
+		ASSERT_EQ (*block, *block_l);
+		ASSERT_EQ (block->balance (), sideband.balance);
+		ASSERT_TRUE (store.block_exists (transaction, block->hash ()));
+		hashes.push_back (block->hash ());
+	}
+	auto blocks_l (store.blocks_get (transaction, hashes, nullptr));
+	for (size_t i (0); i < blocks.size (); ++i)
+	{
+		ASSERT_NE (nullptr, blocks_l[i]);
+		ASSERT_EQ (*blocks[i], *blocks_l[i]);
+	}
+}
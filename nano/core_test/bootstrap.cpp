@@ -167,6 +167,55 @@ TEST (bulk_pull, count_limit)
 	ASSERT_EQ (nullptr, block);
 }
 
+TEST (bulk_pull, fill_batch)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	nano::genesis genesis;
+	auto send1 (std::make_shared<nano::send_block> (genesis.hash (), nano::test_genesis_key.pub, nano::genesis_amount - 1, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	ASSERT_EQ (nano::process_result::progress, node.process (*send1).code);
+	auto state1 (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, send1->hash (), nano::test_genesis_key.pub, nano::genesis_amount, send1->hash (), nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send1->hash ())));
+	ASSERT_EQ (nano::process_result::progress, node.process (*state1).code);
+
+	// The batch holds the same bytes as serializing each block
+	std::vector<uint8_t> expected;
+	{
+		nano::vectorstream stream (expected);
+		nano::serialize_block (stream, *state1);
+		nano::serialize_block (stream, *send1);
+		nano::serialize_block (stream, *genesis.open);
+	}
+	auto connection (std::make_shared<nano::bootstrap_server> (nullptr, system.nodes[0]));
+	std::unique_ptr<nano::bulk_pull> req (new nano::bulk_pull{});
+	req->start = nano::test_genesis_key.pub;
+	req->end.clear ();
+	connection->requests.push (std::unique_ptr<nano::message>{});
+	auto request (std::make_shared<nano::bulk_pull_server> (connection, std::move (req)));
+	std::vector<uint8_t> buffer;
+	request->fill_batch (buffer);
+	ASSERT_EQ (expected, buffer);
+	ASSERT_EQ (3, request->sent_count);
+	// Exhausted
+	request->fill_batch (buffer);
+	ASSERT_EQ (expected, buffer);
+
+	// Counted request starting from a block hash
+	std::unique_ptr<nano::bulk_pull> req2 (new nano::bulk_pull{});
+	req2->start = send1->hash ();
+	req2->set_count_present (true);
+	req2->count = 1;
+	connection->requests.push (std::unique_ptr<nano::message>{});
+	auto request2 (std::make_shared<nano::bulk_pull_server> (connection, std::move (req2)));
+	std::vector<uint8_t> buffer2;
+	request2->fill_batch (buffer2);
+	std::vector<uint8_t> expected2;
+	{
+		nano::vectorstream stream (expected2);
+		nano::serialize_block (stream, *send1);
+	}
+	ASSERT_EQ (expected2, buffer2);
+}
+
 TEST (bootstrap_processor, DISABLED_process_none)
 {
 	nano::system system (24000, 1);
@@ -288,6 +337,76 @@ TEST (bootstrap_processor, process_new)
 	node1->stop ();
 }
 
+TEST (bootstrap_processor, frontier_ranges)
+{
+	nano::system system (24000, 1);
+	auto & node0 (*system.nodes[0]);
+	nano::genesis genesis;
+	// Accounts are spread over the account space and end up in different frontier ranges
+	std::vector<nano::keypair> keys (16);
+	nano::block_hash previous (genesis.hash ());
+	{
+		auto transaction (node0.store.tx_begin_write ());
+		for (size_t i (0); i < keys.size (); ++i)
+		{
+			nano::state_block send (nano::test_genesis_key.pub, previous, nano::test_genesis_key.pub, nano::genesis_amount - (i + 1) * nano::Gbcb_ratio, keys[i].pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (previous));
+			ASSERT_EQ (nano::process_result::progress, node0.ledger.process (transaction, send).code);
+			nano::state_block open (keys[i].pub, 0, keys[i].pub, nano::Gbcb_ratio, send.hash (), keys[i].prv, keys[i].pub, *system.work.generate (keys[i].pub));
+			ASSERT_EQ (nano::process_result::progress, node0.ledger.process (transaction, open).code);
+			previous = send.hash ();
+		}
+	}
+	auto node1 (std::make_shared<nano::node> (system.io_ctx, 24001, nano::unique_path (), system.alarm, system.logging, system.work));
+	ASSERT_FALSE (node1->init_error ());
+	node1->bootstrap_initiator.bootstrap (node0.network.endpoint ());
+	system.deadline_set (20s);
+	while (node1->ledger.block_count_cache < node0.ledger.block_count_cache)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	for (auto const & key : keys)
+	{
+		ASSERT_EQ (nano::Gbcb_ratio, node1->balance (key.pub));
+	}
+	ASSERT_EQ (0, node1->stats.count (nano::stat::type::error, nano::stat::detail::frontier_req, nano::stat::dir::out));
+	node1->stop ();
+}
+
+TEST (bootstrap_processor, pull_scores)
+{
+	nano::system system (24000, 1);
+	auto node (system.nodes[0]);
+	auto attempt (std::make_shared<nano::bootstrap_attempt> (node));
+	auto make_client = [&node, &attempt]() {
+		auto socket (std::make_shared<nano::socket> (node));
+		return std::make_shared<nano::bootstrap_client> (node, attempt, std::make_shared<nano::transport::channel_tcp> (*node, socket), socket);
+	};
+	auto fast (make_client ());
+	auto slow (make_client ());
+	// Not warmed up yet, no score and no segmentation
+	ASSERT_EQ (0.0, fast->score ());
+	ASSERT_EQ (0, attempt->pull_count (*fast));
+	auto start (std::chrono::steady_clock::now () - std::chrono::seconds (10));
+	fast->start_time = start;
+	fast->block_count = 10000;
+	slow->start_time = start;
+	slow->block_count = 10000;
+	slow->pulls_failed = 9;
+	ASSERT_NEAR (1000.0, fast->score (), 50.0);
+	ASSERT_NEAR (100.0, slow->score (), 5.0);
+	attempt->average_score = (fast->score () + slow->score ()) / 2;
+	ASSERT_EQ (0, attempt->pull_count (*fast));
+	ASSERT_EQ (nano::bootstrap_limits::bootstrap_slow_peer_pull_count, attempt->pull_count (*slow));
+	// Continuations go to the fastest idle client
+	nano::unique_lock<std::mutex> lock (attempt->mutex);
+	attempt->idle.push_back (slow);
+	attempt->idle.push_back (fast);
+	attempt->idle.push_back (slow);
+	ASSERT_EQ (fast, attempt->best_connection (lock));
+	ASSERT_EQ (2, attempt->idle.size ());
+	attempt->idle.clear ();
+}
+
 TEST (bootstrap_processor, pull_diamond)
 {
 	nano::system system (24000, 1);
@@ -670,6 +789,34 @@ TEST (bootstrap_processor, lazy_destinations)
 	ASSERT_TRUE (node2->ledger.block_exists (state_open->hash ()));
 }
 
+TEST (bootstrap_processor, lazy_memory_budget)
+{
+	nano::system system;
+	nano::node_flags node_flags;
+	node_flags.disable_legacy_bootstrap = true;
+	auto node1 = system.add_node (nano::node_config (24000, system.logging), node_flags);
+	auto attempt (std::make_shared<nano::bootstrap_attempt> (node1->shared (), nano::bootstrap_mode::lazy));
+	attempt->lazy_start_time = std::chrono::steady_clock::now ();
+	nano::block_hash hash1 (1);
+	nano::block_hash hash2 (2);
+	{
+		nano::lock_guard<std::mutex> lazy_lock (attempt->lazy_mutex);
+		attempt->lazy_blocks.insert (hash1);
+		attempt->lazy_balances.emplace (hash1, 10);
+		attempt->lazy_state_backlog.emplace (hash2, nano::lazy_state_backlog_item{ hash2, hash1, 10, 1 });
+		// Only caches that can be rebuilt from the ledger are dropped
+		attempt->lazy_memory_trim ();
+		ASSERT_TRUE (attempt->lazy_blocks.empty ());
+		ASSERT_TRUE (attempt->lazy_balances.empty ());
+		ASSERT_EQ (1, attempt->lazy_state_backlog.size ());
+		attempt->lazy_memory_update ();
+	}
+	ASSERT_FALSE (attempt->lazy_has_expired ());
+	// The budget applies without legacy bootstrap to hand over to
+	attempt->lazy_memory = nano::bootstrap_limits::lazy_memory_budget + 1;
+	ASSERT_TRUE (attempt->lazy_has_expired ());
+}
+
 TEST (bootstrap_processor, wallet_lazy_frontier)
 {
 	nano::system system (24000, 1);
@@ -852,6 +999,36 @@ TEST (frontier_req, time_cutoff)
 	ASSERT_TRUE (request2->frontier.is_zero ());
 }
 
+TEST (frontier_req, age_index)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	nano::genesis genesis;
+	nano::keypair key1;
+	nano::state_block send1 (nano::test_genesis_key.pub, genesis.hash (), nano::test_genesis_key.pub, nano::genesis_amount - nano::Gbcb_ratio, key1.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *node.work_generate_blocking (genesis.hash ()));
+	nano::state_block open1 (key1.pub, 0, key1.pub, nano::Gbcb_ratio, send1.hash (), key1.prv, key1.pub, *node.work_generate_blocking (key1.pub));
+	{
+		auto transaction (node.store.tx_begin_write ());
+		ASSERT_EQ (nano::process_result::progress, node.ledger.process (transaction, send1).code);
+		ASSERT_EQ (nano::process_result::progress, node.ledger.process (transaction, open1).code);
+	}
+	ASSERT_EQ (2, node.ledger.age_index.size ());
+	auto connection (std::make_shared<nano::bootstrap_server> (nullptr, system.nodes[0]));
+	std::unique_ptr<nano::frontier_req> req (new nano::frontier_req);
+	req->start = std::min (nano::test_genesis_key.pub, key1.pub);
+	req->age = 60;
+	req->count = std::numeric_limits<decltype (req->count)>::max ();
+	connection->requests.push (std::unique_ptr<nano::message>{});
+	auto request (std::make_shared<nano::frontier_req_server> (connection, std::move (req)));
+	ASSERT_TRUE (request->from_index);
+	ASSERT_EQ (std::min (nano::test_genesis_key.pub, key1.pub), request->current);
+	request->next ();
+	ASSERT_EQ (std::max (nano::test_genesis_key.pub, key1.pub), request->current);
+	ASSERT_EQ (key1.pub == request->current ? open1.hash () : send1.hash (), request->frontier);
+	request->next ();
+	ASSERT_TRUE (request->current.is_zero ());
+}
+
 TEST (bulk, genesis)
 {
 	nano::system system (24000, 1);
@@ -967,3 +1144,75 @@ TEST (bulk_pull_account, basics)
 		ASSERT_EQ (nullptr, block_data.second.get ());
 	}
 }
+
+TEST (pulls_cache, segments)
+{
+	nano::pulls_cache cache;
+	nano::keypair key;
+	nano::block_hash ledger_head (1), head1 (2), head2 (3);
+	// Completed pull of a fresh ledger head
+	cache.add_segment (nano::pull_info (key.pub, head1, ledger_head));
+	// Identical pull from another peer or a restarted attempt is skipped
+	nano::pull_info pull1 (key.pub, head1, ledger_head);
+	ASSERT_TRUE (cache.truncate_pull (pull1));
+	// Pull of a newer frontier only requests blocks above the pulled segment
+	nano::pull_info pull2 (key.pub, head2, ledger_head);
+	ASSERT_FALSE (cache.truncate_pull (pull2));
+	ASSERT_EQ (head1, pull2.end);
+	cache.add_segment (pull2);
+	ASSERT_EQ (1, cache.segments.size ());
+	nano::pull_info pull3 (key.pub, head2, ledger_head);
+	ASSERT_TRUE (cache.truncate_pull (pull3));
+	// Different ledger head, the segment may be on another chain
+	nano::pull_info pull4 (key.pub, head2, 4);
+	ASSERT_FALSE (cache.truncate_pull (pull4));
+	ASSERT_EQ (nano::block_hash (4), pull4.end);
+	// Other accounts are not affected
+	nano::pull_info pull5 (nano::genesis_account, head2, ledger_head);
+	ASSERT_FALSE (cache.truncate_pull (pull5));
+	ASSERT_EQ (ledger_head, pull5.end);
+}
+
+TEST (bulk_pull_account, fill_batch)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	nano::keypair key1;
+	nano::genesis genesis;
+	auto send1 (std::make_shared<nano::send_block> (genesis.hash (), key1.pub, nano::genesis_amount - 1, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	ASSERT_EQ (nano::process_result::progress, node.process (*send1).code);
+	auto send2 (std::make_shared<nano::send_block> (send1->hash (), key1.pub, nano::genesis_amount - 11, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send1->hash ())));
+	ASSERT_EQ (nano::process_result::progress, node.process (*send2).code);
+	auto connection (std::make_shared<nano::bootstrap_server> (nullptr, system.nodes[0]));
+
+	// Entries are packed by decreasing amount, below minimum amounts are not visited
+	std::unique_ptr<nano::bulk_pull_account> req (new nano::bulk_pull_account{});
+	req->account = key1.pub;
+	req->minimum_amount = 5;
+	req->flags = nano::bulk_pull_account_flags::pending_hash_amount_and_address;
+	auto request (std::make_shared<nano::bulk_pull_account_server> (connection, std::move (req)));
+	std::vector<uint8_t> expected;
+	{
+		nano::vectorstream stream (expected);
+		nano::write (stream, send2->hash ().bytes);
+		nano::write (stream, nano::uint128_union (10).bytes);
+		nano::write (stream, nano::genesis_account.bytes);
+	}
+	std::vector<uint8_t> buffer;
+	ASSERT_FALSE (request->fill_batch (buffer));
+	ASSERT_EQ (expected, buffer);
+	buffer.clear ();
+	ASSERT_FALSE (request->fill_batch (buffer));
+	ASSERT_TRUE (buffer.empty ());
+
+	// Duplicate sources are sent once
+	std::unique_ptr<nano::bulk_pull_account> req2 (new nano::bulk_pull_account{});
+	req2->account = key1.pub;
+	req2->minimum_amount = 0;
+	req2->flags = nano::bulk_pull_account_flags::pending_address_only;
+	auto request2 (std::make_shared<nano::bulk_pull_account_server> (connection, std::move (req2)));
+	std::vector<uint8_t> expected2 (nano::genesis_account.bytes.begin (), nano::genesis_account.bytes.end ());
+	std::vector<uint8_t> buffer2;
+	ASSERT_FALSE (request2->fill_batch (buffer2));
+	ASSERT_EQ (expected2, buffer2);
+}
@@ -0,0 +1,83 @@
+#include <nano/lib/compact_hash_map.hpp>
+
+#include <gtest/gtest.h>
+
+TEST (compact_hash_map, emplace_erase)
+{
+	nano::compact_hash_map<nano::uint128_t> map;
+	nano::block_hash hash1 (1);
+	nano::block_hash hash2 (2);
+	ASSERT_TRUE (map.empty ());
+	ASSERT_EQ (nullptr, map.find (hash1));
+	ASSERT_TRUE (map.emplace (hash1, 10));
+	// Existing values are left unchanged
+	ASSERT_FALSE (map.emplace (hash1, 20));
+	ASSERT_NE (nullptr, map.find (hash1));
+	ASSERT_EQ (10, *map.find (hash1));
+	ASSERT_EQ (nullptr, map.find (hash2));
+	ASSERT_TRUE (map.emplace (hash2, 30));
+	ASSERT_EQ (2, map.size ());
+	*map.find (hash2) = 40;
+	ASSERT_TRUE (map.erase (hash1));
+	ASSERT_FALSE (map.erase (hash1));
+	ASSERT_EQ (nullptr, map.find (hash1));
+	ASSERT_EQ (40, *map.find (hash2));
+	ASSERT_EQ (1, map.size ());
+	map.clear ();
+	ASSERT_TRUE (map.empty ());
+	ASSERT_EQ (nullptr, map.find (hash2));
+}
+
+TEST (compact_hash_map, many)
+{
+	nano::compact_hash_map<uint64_t> map (16);
+	std::vector<nano::block_hash> hashes;
+	for (uint64_t i (0); i < 10000; ++i)
+	{
+		nano::block_hash hash;
+		// Spread values over the stored 64 bits as block hashes would be
+		hash.qwords[0] = i * 0x9e3779b97f4a7c15ULL;
+		hash.qwords[1] = i;
+		hashes.push_back (hash);
+		ASSERT_TRUE (map.emplace (hash, i));
+	}
+	ASSERT_EQ (hashes.size (), map.size ());
+	// Erasing while iterating over the arena, the last value moves into the erased position
+	for (size_t i (0); i < map.size ();)
+	{
+		if (map.value (i) % 2 == 0)
+		{
+			map.erase_index (i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+	ASSERT_EQ (hashes.size () / 2, map.size ());
+	for (uint64_t i (0); i < hashes.size (); ++i)
+	{
+		auto value (map.find (hashes[i]));
+		if (i % 2 == 1)
+		{
+			ASSERT_NE (nullptr, value);
+			ASSERT_EQ (i, *value);
+		}
+		else
+		{
+			ASSERT_EQ (nullptr, value);
+		}
+	}
+	auto memory (map.memory ());
+	// Reinserting reuses erased slots and arena capacity
+	for (uint64_t i (0); i < hashes.size (); i += 2)
+	{
+		ASSERT_TRUE (map.emplace (hashes[i], i));
+	}
+	ASSERT_EQ (hashes.size (), map.size ());
+	ASSERT_EQ (memory, map.memory ());
+	for (uint64_t i (0); i < hashes.size (); ++i)
+	{
+		ASSERT_EQ (i, *map.find (hashes[i]));
+	}
+}
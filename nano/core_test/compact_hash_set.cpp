@@ -0,0 +1,62 @@
+#include <nano/lib/compact_hash_set.hpp>
+
+#include <gtest/gtest.h>
+
+TEST (compact_hash_set, insert_erase)
+{
+	nano::compact_hash_set set;
+	nano::block_hash hash1 (1);
+	nano::block_hash hash2 (2);
+	ASSERT_TRUE (set.empty ());
+	ASSERT_FALSE (set.exists (hash1));
+	ASSERT_TRUE (set.insert (hash1));
+	ASSERT_FALSE (set.insert (hash1));
+	ASSERT_TRUE (set.exists (hash1));
+	ASSERT_FALSE (set.exists (hash2));
+	ASSERT_TRUE (set.insert (hash2));
+	ASSERT_EQ (2, set.size ());
+	ASSERT_TRUE (set.erase (hash1));
+	ASSERT_FALSE (set.erase (hash1));
+	ASSERT_FALSE (set.exists (hash1));
+	ASSERT_TRUE (set.exists (hash2));
+	ASSERT_EQ (1, set.size ());
+	set.clear ();
+	ASSERT_TRUE (set.empty ());
+	ASSERT_FALSE (set.exists (hash2));
+}
+
+TEST (compact_hash_set, many)
+{
+	nano::compact_hash_set set (16);
+	std::vector<nano::block_hash> hashes;
+	for (uint64_t i (0); i < 10000; ++i)
+	{
+		nano::block_hash hash;
+		// Spread values over the stored 64 bits as block hashes would be
+		hash.qwords[0] = i * 0x9e3779b97f4a7c15ULL;
+		hash.qwords[1] = i;
+		hashes.push_back (hash);
+		ASSERT_TRUE (set.insert (hash));
+	}
+	ASSERT_EQ (hashes.size (), set.size ());
+	// At least half of the slots are kept free
+	ASSERT_GE (set.memory (), 2 * hashes.size () * sizeof (uint64_t));
+	for (size_t i (0); i < hashes.size (); i += 2)
+	{
+		ASSERT_TRUE (set.erase (hashes[i]));
+	}
+	for (size_t i (0); i < hashes.size (); ++i)
+	{
+		ASSERT_EQ (i % 2 == 1, set.exists (hashes[i]));
+	}
+	ASSERT_EQ (hashes.size () / 2, set.erased ());
+	auto memory (set.memory ());
+	// Reinserting reuses erased slots, the former slot of each hash lies in its probe sequence
+	for (size_t i (0); i < hashes.size (); i += 2)
+	{
+		ASSERT_TRUE (set.insert (hashes[i]));
+	}
+	ASSERT_EQ (hashes.size (), set.size ());
+	ASSERT_EQ (0, set.erased ());
+	ASSERT_EQ (memory, set.memory ());
+}
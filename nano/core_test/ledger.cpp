@@ -2866,3 +2866,33 @@ TEST (ledger, zero_rep)
 	ASSERT_EQ (nano::genesis_amount, system.nodes[0]->ledger.rep_weights.representation_get (nano::test_genesis_key.pub));
 	ASSERT_EQ (0, system.nodes[0]->ledger.rep_weights.representation_get (0));
 }
+
+TEST (ledger, age_index)
+{
+	auto now (nano::seconds_since_epoch ());
+	nano::account_age_index index (100);
+	nano::account account1 (1);
+	nano::account account2 (2);
+	nano::account account3 (3);
+	index.update (account3, now);
+	index.update (account1, now - 10);
+	// Outside of the window
+	index.update (account2, now - 200);
+	ASSERT_EQ (2, index.size ());
+	// Not populated from the store, only changes since construction are known
+	ASSERT_FALSE (index.recent (now - 50, 0, std::numeric_limits<size_t>::max ()).is_initialized ());
+	index.complete (now - 100);
+	auto recent1 (index.recent (now - 50, 0, std::numeric_limits<size_t>::max ()));
+	ASSERT_TRUE (recent1.is_initialized ());
+	ASSERT_EQ ((std::vector<nano::account>{ account1, account3 }), *recent1);
+	auto recent2 (index.recent (now - 5, 0, std::numeric_limits<size_t>::max ()));
+	ASSERT_EQ ((std::vector<nano::account>{ account3 }), *recent2);
+	auto recent3 (index.recent (now - 50, account2, 1));
+	ASSERT_EQ ((std::vector<nano::account>{ account3 }), *recent3);
+	// Beyond the window entries may have been pruned
+	ASSERT_FALSE (index.recent (now - 150, 0, std::numeric_limits<size_t>::max ()).is_initialized ());
+	// Rollback to an old state removes the entry
+	index.update (account3, now - 200);
+	index.erase (account1);
+	ASSERT_EQ (0, index.size ());
+}
@@ -61,7 +61,8 @@ TEST (message_parser, exact_confirm_ack_size)
 	test_visitor visitor;
 	nano::block_uniquer block_uniquer;
 	nano::vote_uniquer vote_uniquer (block_uniquer);
-	nano::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<nano::send_block> (1, 1, 2, nano::keypair ().prv, 4, *system.work.generate (nano::root (1))));
 	auto vote (std::make_shared<nano::vote> (0, nano::keypair ().prv, 0, std::move (block)));
 	nano::confirm_ack message (vote);
@@ -94,7 +95,8 @@ TEST (message_parser, exact_confirm_req_size)
 	test_visitor visitor;
 	nano::block_uniquer block_uniquer;
 	nano::vote_uniquer vote_uniquer (block_uniquer);
-	nano::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<nano::send_block> (1, 1, 2, nano::keypair ().prv, 4, *system.work.generate (nano::root (1))));
 	nano::confirm_req message (std::move (block));
 	std::vector<uint8_t> bytes;
@@ -126,7 +128,8 @@ TEST (message_parser, exact_confirm_req_hash_size)
 	test_visitor visitor;
 	nano::block_uniquer block_uniquer;
 	nano::vote_uniquer vote_uniquer (block_uniquer);
-	nano::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	nano::send_block block (1, 1, 2, nano::keypair ().prv, 4, *system.work.generate (nano::root (1)));
 	nano::confirm_req message (block.hash (), block.root ());
 	std::vector<uint8_t> bytes;
@@ -158,7 +161,8 @@ TEST (message_parser, exact_publish_size)
 	test_visitor visitor;
 	nano::block_uniquer block_uniquer;
 	nano::vote_uniquer vote_uniquer (block_uniquer);
-	nano::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	auto block (std::make_shared<nano::send_block> (1, 1, 2, nano::keypair ().prv, 4, *system.work.generate (nano::root (1))));
 	nano::publish message (std::move (block));
 	std::vector<uint8_t> bytes;
@@ -190,7 +194,8 @@ TEST (message_parser, exact_keepalive_size)
 	test_visitor visitor;
 	nano::block_uniquer block_uniquer;
 	nano::vote_uniquer vote_uniquer (block_uniquer);
-	nano::message_parser parser (block_uniquer, vote_uniquer, visitor, system.work);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
 	nano::keepalive message;
 	std::vector<uint8_t> bytes;
 	{
@@ -214,3 +219,31 @@ TEST (message_parser, exact_keepalive_size)
 	ASSERT_EQ (1, visitor.keepalive_count);
 	ASSERT_NE (parser.status, nano::message_parser::parse_status::success);
 }
+
+TEST (message_parser, duplicate_publish)
+{
+	nano::system system (24000, 1);
+	test_visitor visitor;
+	nano::block_uniquer block_uniquer;
+	nano::vote_uniquer vote_uniquer (block_uniquer);
+	nano::network_filter filter (1);
+	nano::message_parser parser (filter, block_uniquer, vote_uniquer, visitor, system.work);
+	auto block (std::make_shared<nano::send_block> (1, 1, 2, nano::keypair ().prv, 4, *system.work.generate (nano::root (1))));
+	nano::publish message (std::move (block));
+	auto bytes (message.to_bytes ());
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (1, visitor.publish_count);
+	ASSERT_EQ (parser.status, nano::message_parser::parse_status::success);
+	parser.deserialize_buffer (bytes->data (), bytes->size ());
+	ASSERT_EQ (1, visitor.publish_count);
+	ASSERT_EQ (parser.status, nano::message_parser::parse_status::duplicate_publish_message);
+	// Insufficient work is not remembered by the filter
+	auto block2 (std::make_shared<nano::send_block> (1, 1, 3, nano::keypair ().prv, 4, 0));
+	nano::publish message2 (std::move (block2));
+	auto bytes2 (message2.to_bytes ());
+	parser.deserialize_buffer (bytes2->data (), bytes2->size ());
+	ASSERT_EQ (parser.status, nano::message_parser::parse_status::insufficient_work);
+	parser.deserialize_buffer (bytes2->data (), bytes2->size ());
+	ASSERT_EQ (parser.status, nano::message_parser::parse_status::insufficient_work);
+	ASSERT_EQ (1, visitor.publish_count);
+}
@@ -869,53 +869,102 @@ TEST (network, replace_port)
 TEST (bandwidth_limiter, validate)
 {
 	size_t const full_confirm_ack (488 + 8);
+	auto const zero (std::chrono::steady_clock::duration::zero ());
+	nano::bandwidth_limiter limiter_0 (0);
+	for (auto i (0); i < 1000; ++i)
 	{
-		nano::bandwidth_limiter limiter_0 (0);
-		nano::bandwidth_limiter limiter_1 (1024);
-		nano::bandwidth_limiter limiter_256 (1024 * 256);
-		nano::bandwidth_limiter limiter_1024 (1024 * 1024);
-		nano::bandwidth_limiter limiter_1536 (1024 * 1536);
+		ASSERT_EQ (zero, limiter_0.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::vote)); // will never limit
+	}
+	nano::bandwidth_limiter limiter_1 (1024);
+	ASSERT_EQ (std::chrono::steady_clock::duration::max (), limiter_1.consume (2048, nano::bandwidth_limiter::traffic_class::vote)); // more than the buckets can ever hold
+	ASSERT_TRUE (limiter_1.exceeds_capacity (2048, nano::bandwidth_limiter::traffic_class::vote));
+	ASSERT_FALSE (limiter_1.exceeds_capacity (1024, nano::bandwidth_limiter::traffic_class::vote));
+	ASSERT_FALSE (limiter_0.exceeds_capacity (2048, nano::bandwidth_limiter::traffic_class::vote));
+	nano::bandwidth_limiter limiter_4 (1024 * 4);
+	// The publish share holds 2 messages, the remaining root tokens allow borrowing for 6 more
+	auto count (0);
+	while (limiter_4.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::publish) == zero)
+	{
+		++count;
+	}
+	ASSERT_EQ (8, count);
+	// Votes are not starved by publishes, their share holds 3 messages
+	for (auto i (0); i < 3; ++i)
+	{
+		ASSERT_EQ (zero, limiter_4.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::vote));
+	}
+	auto wait (limiter_4.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::vote));
+	ASSERT_NE (zero, wait);
+	ASSERT_LE (wait, nano::bandwidth_limiter::max_deferral);
+	std::this_thread::sleep_for (wait);
+	ASSERT_EQ (zero, limiter_4.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::vote));
+	// Forced messages are always accounted for
+	limiter_4.consume_force (1024 * 4, nano::bandwidth_limiter::traffic_class::other);
+	ASSERT_GT (limiter_4.consume (full_confirm_ack, nano::bandwidth_limiter::traffic_class::other), nano::bandwidth_limiter::max_deferral);
+}
 
-		auto now (std::chrono::steady_clock::now ());
+TEST (bandwidth_limiter, classify)
+{
+	ASSERT_EQ (nano::bandwidth_limiter::traffic_class::vote, nano::bandwidth_limiter::classify (nano::stat::detail::confirm_ack));
+	ASSERT_EQ (nano::bandwidth_limiter::traffic_class::confirm_req, nano::bandwidth_limiter::classify (nano::stat::detail::confirm_req));
+	ASSERT_EQ (nano::bandwidth_limiter::traffic_class::publish, nano::bandwidth_limiter::classify (nano::stat::detail::publish));
+	ASSERT_EQ (nano::bandwidth_limiter::traffic_class::bootstrap, nano::bandwidth_limiter::classify (nano::stat::detail::bulk_pull));
+	ASSERT_EQ (nano::bandwidth_limiter::traffic_class::other, nano::bandwidth_limiter::classify (nano::stat::detail::keepalive));
+}
 
-		while (now + 1s >= std::chrono::steady_clock::now ())
-		{
-			ASSERT_FALSE (limiter_0.should_drop (full_confirm_ack)); // will never drop
-			ASSERT_TRUE (limiter_1.should_drop (full_confirm_ack)); // always drop as message > limit / rate_buffer.size ()
-			limiter_256.should_drop (full_confirm_ack);
-			limiter_1024.should_drop (full_confirm_ack);
-			limiter_1536.should_drop (full_confirm_ack);
-			std::this_thread::sleep_for (10ms);
-		}
-		ASSERT_FALSE (limiter_0.should_drop (full_confirm_ack)); // will never drop
-		ASSERT_TRUE (limiter_1.should_drop (full_confirm_ack)); // always drop as message > limit / rate_buffer.size ()
-		ASSERT_FALSE (limiter_256.should_drop (full_confirm_ack)); // as a second has passed counter is started and nothing is dropped
-		ASSERT_FALSE (limiter_1024.should_drop (full_confirm_ack)); // as a second has passed counter is started and nothing is dropped
-		ASSERT_FALSE (limiter_1536.should_drop (full_confirm_ack)); // as a second has passed counter is started and nothing is dropped
+TEST (network, fanout_selector)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	ASSERT_TRUE (node.network.fanout.sample (4).empty ());
+	std::vector<nano::endpoint> endpoints;
+	for (uint16_t port (24010); port < 24020; ++port)
+	{
+		endpoints.emplace_back (boost::asio::ip::address_v6::loopback (), port);
+		node.network.udp_channels.insert (endpoints.back (), node.network_params.protocol.protocol_version);
 	}
-
+	// Rebuilt in the background once channels change
+	system.deadline_set (5s);
+	while (node.network.fanout.size () != 10)
 	{
-		nano::bandwidth_limiter limiter_0 (0);
-		nano::bandwidth_limiter limiter_1 (1024);
-		nano::bandwidth_limiter limiter_256 (1024 * 256);
-		nano::bandwidth_limiter limiter_1024 (1024 * 1024);
-		nano::bandwidth_limiter limiter_1536 (1024 * 1536);
-
-		auto now (std::chrono::steady_clock::now ());
-		//trend rate for 5 sec
-		while (now + 5s >= std::chrono::steady_clock::now ())
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (4, node.network.fanout.size_sqrt ());
+	// Without representatives every peer is reached by walking the shuffled snapshot
+	std::unordered_set<nano::endpoint> reached;
+	for (auto i (0); i < 5; ++i)
+	{
+		auto sample (node.network.fanout.sample (2));
+		ASSERT_EQ (2, sample.size ());
+		ASSERT_NE (sample[0], sample[1]);
+		for (auto & channel : sample)
 		{
-			ASSERT_FALSE (limiter_0.should_drop (full_confirm_ack)); // will never drop
-			ASSERT_TRUE (limiter_1.should_drop (full_confirm_ack)); // always drop as message > limit / rate_buffer.size ()
-			limiter_256.should_drop (full_confirm_ack);
-			limiter_1024.should_drop (full_confirm_ack);
-			limiter_1536.should_drop (full_confirm_ack);
-			std::this_thread::sleep_for (50ms);
+			reached.insert (channel->get_endpoint ());
 		}
-		ASSERT_EQ (limiter_0.get_rate (), 0); //should be 0 as rate is not gathered if not needed
-		ASSERT_EQ (limiter_1.get_rate (), 0); //should be 0 since nothing is small enough to pass through is tracked
-		ASSERT_EQ (limiter_256.get_rate (), full_confirm_ack); //should be 0 since nothing is small enough to pass through is tracked
-		ASSERT_EQ (limiter_1024.get_rate (), full_confirm_ack); //should be 0 since nothing is small enough to pass through is tracked
-		ASSERT_EQ (limiter_1536.get_rate (), full_confirm_ack); //should be 0 since nothing is small enough to pass through is tracked
+	}
+	ASSERT_EQ (10, reached.size ());
+	// A representative always fills one of the slots
+	auto channel0 (node.network.udp_channels.channel (endpoints[0]));
+	ASSERT_NE (nullptr, channel0);
+	nano::keypair keypair1;
+	node.rep_crawler.response (channel0, keypair1.pub, nano::amount (100));
+	node.network.fanout.refresh ();
+	ASSERT_EQ (10, node.network.fanout.size ());
+	for (auto i (0); i < 10; ++i)
+	{
+		auto sample (node.network.fanout.sample (2));
+		ASSERT_EQ (2, sample.size ());
+		ASSERT_EQ (1, std::count (sample.begin (), sample.end (), channel0));
+	}
+	// Asking for more than the snapshot holds returns each channel once
+	auto all (node.network.fanout.sample (20));
+	ASSERT_EQ (10, all.size ());
+	ASSERT_EQ (10, std::unordered_set<std::shared_ptr<nano::transport::channel>> (all.begin (), all.end ()).size ());
+	// Erased channels are dropped by the next rebuild
+	node.network.udp_channels.erase (endpoints[1]);
+	system.deadline_set (5s);
+	while (node.network.fanout.size () != 9)
+	{
+		ASSERT_NO_ERROR (system.poll ());
 	}
 }
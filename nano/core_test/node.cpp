@@ -1139,6 +1139,64 @@ TEST (node_flags, disable_udp)
 	node2->stop ();
 }
 
+TEST (node_flags, read_replica)
+{
+	nano::system system;
+	auto path (nano::unique_path ());
+	{
+		// Initializes the ledger
+		auto node (std::make_shared<nano::node> (system.io_ctx, 24000, path, system.alarm, system.logging, system.work));
+		node->stop ();
+	}
+	// Read-only RocksDB instances never observe commits from the writer
+	auto use_rocksdb_str = std::getenv ("TEST_USE_ROCKSDB");
+	if (use_rocksdb_str && boost::lexical_cast<int> (use_rocksdb_str) == 1)
+	{
+		nano::node_flags node_flags;
+		node_flags.read_replica = true;
+		node_flags.read_only = true;
+		auto node (std::make_shared<nano::node> (system.io_ctx, path, system.alarm, nano::node_config (24000, system.logging), system.work, node_flags));
+		ASSERT_TRUE (node->init_error ());
+		ASSERT_FALSE (node->replica_supported ());
+		return;
+	}
+	// Stands for the node writing the ledger in another process
+	nano::logger_mt logger;
+	nano::mdb_store store (logger, path / "data.ldb");
+	ASSERT_FALSE (store.init_error ());
+	nano::node_flags node_flags;
+	node_flags.read_replica = true;
+	node_flags.read_only = true;
+	auto node (std::make_shared<nano::node> (system.io_ctx, path, system.alarm, nano::node_config (24000, system.logging), system.work, node_flags));
+	ASSERT_FALSE (node->init_error ());
+	ASSERT_NE (24000, node->network.endpoint ().port ());
+	std::vector<uint64_t> notified;
+	node->observers.replica_refresh.add ([&notified](uint64_t block_count_a) {
+		notified.push_back (block_count_a);
+	});
+	ASSERT_FALSE (node->replica_refresh ());
+	nano::genesis genesis;
+	nano::keypair key;
+	nano::send_block send (genesis.hash (), key.pub, nano::genesis_amount - 100, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (genesis.hash ()));
+	{
+		nano::stat stats;
+		nano::ledger ledger (store, stats);
+		auto transaction (store.tx_begin_write ());
+		ASSERT_EQ (nano::process_result::progress, ledger.process (transaction, send).code);
+		store.confirmation_height_put (transaction, nano::test_genesis_key.pub, 2);
+	}
+	node->ledger.block_count_cache = 1;
+	node->replica_reloaded = std::chrono::steady_clock::now () - node->network_params.node.replica_reload_interval;
+	ASSERT_TRUE (node->replica_refresh ());
+	ASSERT_EQ (2, node->ledger.block_count_cache);
+	ASSERT_EQ (2, node->ledger.cemented_count);
+	ASSERT_EQ (std::vector<uint64_t>{ 2 }, notified);
+	ASSERT_EQ (1, node->stats.count (nano::stat::type::ledger, nano::stat::detail::replica_reload));
+	ASSERT_FALSE (node->replica_refresh ());
+	ASSERT_EQ (1, notified.size ());
+	node->stop ();
+}
+
 TEST (node, fork_publish)
 {
 	std::weak_ptr<nano::node> node0;
@@ -2896,6 +2954,102 @@ TEST (node, block_processor_half_full)
 	ASSERT_FALSE (node.block_processor.full ());
 }
 
+// Blocks held by legacy pulls hold back the bootstrap like queued blocks
+TEST (node, block_processor_chains_buffered)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	ASSERT_FALSE (node.block_processor.half_full ());
+	node.block_processor.chains_buffered = node.flags.block_processor_full_size / 2 + 1;
+	ASSERT_TRUE (node.block_processor.half_full ());
+	node.block_processor.chains_buffered = 0;
+	ASSERT_EQ (0, node.block_processor.size ());
+}
+
+TEST (node, block_processor_unchecked_staging)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	// Without peers the attempt keeps waiting for a connection and stays in progress
+	node.bootstrap_initiator.bootstrap ();
+	ASSERT_TRUE (node.bootstrap_initiator.in_progress ());
+	nano::genesis genesis;
+	nano::keypair key;
+	auto send1 (std::make_shared<nano::send_block> (genesis.hash (), key.pub, nano::genesis_amount - 100, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	auto send2 (std::make_shared<nano::send_block> (send1->hash (), key.pub, nano::genesis_amount - 200, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send1->hash ())));
+	node.process_active (send2);
+	node.block_processor.flush ();
+	ASSERT_FALSE (node.ledger.block_exists (send2->hash ()));
+	// The gap block is held in memory instead of the unchecked table
+	ASSERT_EQ (1, node.unchecked_staging.size ());
+	{
+		auto transaction (node.store.tx_begin_read ());
+		ASSERT_EQ (0, node.store.unchecked_count (transaction));
+	}
+	node.process_active (send1);
+	node.block_processor.flush ();
+	ASSERT_TRUE (node.ledger.block_exists (send1->hash ()));
+	ASSERT_TRUE (node.ledger.block_exists (send2->hash ()));
+	ASSERT_EQ (0, node.unchecked_staging.size ());
+	auto transaction (node.store.tx_begin_read ());
+	ASSERT_EQ (0, node.store.unchecked_count (transaction));
+}
+
+TEST (node, block_processor_chain)
+{
+	nano::system system (24000, 1);
+	auto & node (*system.nodes[0]);
+	nano::genesis genesis;
+	auto send1 (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, genesis.hash (), nano::test_genesis_key.pub, nano::genesis_amount - nano::Gbcb_ratio, nano::test_genesis_key.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (genesis.hash ())));
+	auto send2 (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, send1->hash (), nano::test_genesis_key.pub, nano::genesis_amount - 2 * nano::Gbcb_ratio, nano::test_genesis_key.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send1->hash ())));
+	// Invalid signature
+	auto send3 (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, send2->hash (), nano::test_genesis_key.pub, nano::genesis_amount - 3 * nano::Gbcb_ratio, nano::test_genesis_key.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send2->hash ())));
+	send3->signature.bytes[0] ^= 1;
+	auto send4 (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, send3->hash (), nano::test_genesis_key.pub, nano::genesis_amount - 4 * nano::Gbcb_ratio, nano::test_genesis_key.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (send3->hash ())));
+	std::deque<nano::unchecked_info> chain;
+	for (auto const & block : { send1, send2, send3, send4 })
+	{
+		chain.emplace_back (block, nano::test_genesis_key.pub, 0, nano::signature_verification::unknown);
+	}
+	node.block_processor.add_chain (std::move (chain));
+	node.block_processor.flush ();
+	ASSERT_TRUE (node.ledger.block_exists (send1->hash ()));
+	ASSERT_TRUE (node.ledger.block_exists (send2->hash ()));
+	ASSERT_FALSE (node.ledger.block_exists (send3->hash ()));
+	ASSERT_FALSE (node.ledger.block_exists (send4->hash ()));
+	ASSERT_EQ (0, node.block_processor.size ());
+	// Historical blocks do not start elections
+	ASSERT_TRUE (node.active.empty ());
+	auto transaction (node.store.tx_begin_read ());
+	ASSERT_EQ (1, node.store.unchecked_count (transaction));
+}
+
+TEST (node, block_processor_chain_deadline)
+{
+	nano::system system;
+	nano::node_config node_config (24000, system.logging);
+	node_config.block_processor_batch_max_time = std::chrono::milliseconds (0);
+	nano::node_flags node_flags;
+	node_flags.block_processor_batch_size = 1;
+	auto & node (*system.add_node (node_config, node_flags));
+	nano::genesis genesis;
+	std::deque<nano::unchecked_info> chain;
+	auto previous (genesis.hash ());
+	for (auto i (1); i <= 4; ++i)
+	{
+		auto send (std::make_shared<nano::state_block> (nano::test_genesis_key.pub, previous, nano::test_genesis_key.pub, nano::genesis_amount - i * nano::Gbcb_ratio, nano::test_genesis_key.pub, nano::test_genesis_key.prv, nano::test_genesis_key.pub, *system.work.generate (previous)));
+		chain.emplace_back (send, nano::test_genesis_key.pub, 0, nano::signature_verification::unknown);
+		previous = send->hash ();
+	}
+	// Each batch runs out of time after one block, the rest of the chain is requeued in order
+	node.block_processor.add_chain (std::move (chain));
+	node.block_processor.flush ();
+	ASSERT_TRUE (node.ledger.block_exists (previous));
+	ASSERT_EQ (0, node.block_processor.size ());
+	auto transaction (node.store.tx_begin_read ());
+	ASSERT_EQ (0, node.store.unchecked_count (transaction));
+}
+
 TEST (node, confirm_back)
 {
 	nano::system system (24000, 1);
@@ -121,6 +121,8 @@ TEST (toml, daemon_config_deserialize_defaults)
 	[node.statistics.sampling]
 	[node.websocket]
 	[node.rocksdb]
+	[node.durability]
+	[node.compression]
 	[opencl]
 	[rpc]
 	[rpc.child_process]
@@ -249,6 +251,18 @@ TEST (toml, daemon_config_deserialize_defaults)
 	ASSERT_EQ (conf.node.rocksdb_config.memtable_size, defaults.node.rocksdb_config.memtable_size);
 	ASSERT_EQ (conf.node.rocksdb_config.num_memtables, defaults.node.rocksdb_config.num_memtables);
 	ASSERT_EQ (conf.node.rocksdb_config.total_memtable_size, defaults.node.rocksdb_config.total_memtable_size);
+	ASSERT_EQ (conf.node.rocksdb_config.point_lookup_bloom_filter_bits, defaults.node.rocksdb_config.point_lookup_bloom_filter_bits);
+	ASSERT_EQ (conf.node.rocksdb_config.pending_prefix_extractor, defaults.node.rocksdb_config.pending_prefix_extractor);
+	ASSERT_EQ (conf.node.rocksdb_config.unchecked_fifo_size, defaults.node.rocksdb_config.unchecked_fifo_size);
+	ASSERT_EQ (conf.node.rocksdb_config.confirmation_height_memtable_size, defaults.node.rocksdb_config.confirmation_height_memtable_size);
+
+	ASSERT_EQ (conf.node.durability_config.mode, defaults.node.durability_config.mode);
+	ASSERT_EQ (conf.node.durability_config.sync_interval, defaults.node.durability_config.sync_interval);
+
+	ASSERT_EQ (conf.node.compression_config.enable, defaults.node.compression_config.enable);
+	ASSERT_EQ (conf.node.compression_config.tables, defaults.node.compression_config.tables);
+	ASSERT_EQ (conf.node.compression_config.dictionary_size, defaults.node.compression_config.dictionary_size);
+	ASSERT_EQ (conf.node.compression_config.dictionary_samples, defaults.node.compression_config.dictionary_samples);
 }
 
 TEST (toml, optional_child)
@@ -492,6 +506,20 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	memtable_size = 128
 	num_memtables = 3
 	total_memtable_size = 0
+	point_lookup_bloom_filter_bits = 12
+	pending_prefix_extractor = false
+	unchecked_fifo_size = 999
+	confirmation_height_memtable_size = 16
+
+	[node.durability]
+	mode = "group"
+	sync_interval = 999
+
+	[node.compression]
+	enable = true
+	tables = ["send", "state"]
+	dictionary_size = 8
+	dictionary_samples = 999
 
 	[node.experimental]
 	secondary_work_peers = ["test.org:998"]
@@ -635,6 +663,18 @@ TEST (toml, daemon_config_deserialize_no_defaults)
 	ASSERT_NE (conf.node.rocksdb_config.memtable_size, defaults.node.rocksdb_config.memtable_size);
 	ASSERT_NE (conf.node.rocksdb_config.num_memtables, defaults.node.rocksdb_config.num_memtables);
 	ASSERT_NE (conf.node.rocksdb_config.total_memtable_size, defaults.node.rocksdb_config.total_memtable_size);
+	ASSERT_NE (conf.node.rocksdb_config.point_lookup_bloom_filter_bits, defaults.node.rocksdb_config.point_lookup_bloom_filter_bits);
+	ASSERT_NE (conf.node.rocksdb_config.pending_prefix_extractor, defaults.node.rocksdb_config.pending_prefix_extractor);
+	ASSERT_NE (conf.node.rocksdb_config.unchecked_fifo_size, defaults.node.rocksdb_config.unchecked_fifo_size);
+	ASSERT_NE (conf.node.rocksdb_config.confirmation_height_memtable_size, defaults.node.rocksdb_config.confirmation_height_memtable_size);
+
+	ASSERT_NE (conf.node.durability_config.mode, defaults.node.durability_config.mode);
+	ASSERT_NE (conf.node.durability_config.sync_interval, defaults.node.durability_config.sync_interval);
+
+	ASSERT_NE (conf.node.compression_config.enable, defaults.node.compression_config.enable);
+	ASSERT_NE (conf.node.compression_config.tables, defaults.node.compression_config.tables);
+	ASSERT_NE (conf.node.compression_config.dictionary_size, defaults.node.compression_config.dictionary_size);
+	ASSERT_NE (conf.node.compression_config.dictionary_samples, defaults.node.compression_config.dictionary_samples);
 }
 
 /** There should be no required values **/
@@ -654,6 +694,8 @@ TEST (toml, daemon_config_no_required)
 	[node.statistics.sampling]
 	[node.websocket]
 	[node.rocksdb]
+	[node.durability]
+	[node.compression]
 	[opencl]
 	[rpc]
 	[rpc.child_process]
@@ -757,4 +799,30 @@ TEST (toml, daemon_config_deserialize_errors)
 
 	ASSERT_EQ (toml2.get_error ().get_message (), "frontiers_confirmation value is invalid (available: always, auto, disabled)");
 	ASSERT_EQ (conf2.node.frontiers_confirmation, nano::frontiers_confirmation_mode::invalid);
+
+	std::stringstream ss_durability;
+	ss_durability << R"toml(
+	[node.durability]
+	mode = "randomstring"
+	)toml";
+
+	nano::tomlconfig toml3;
+	toml3.read (ss_durability);
+	nano::daemon_config conf3;
+	conf3.deserialize_toml (toml3);
+
+	ASSERT_EQ (toml3.get_error ().get_message (), "mode value is invalid (available: sync, group, async)");
+
+	std::stringstream ss_compression;
+	ss_compression << R"toml(
+	[node.compression]
+	tables = ["state", "randomstring"]
+	)toml";
+
+	nano::tomlconfig toml4;
+	toml4.read (ss_compression);
+	nano::daemon_config conf4;
+	conf4.deserialize_toml (toml4);
+
+	ASSERT_EQ (toml4.get_error ().get_message (), "tables contains an invalid value (available: send, receive, open, change, state)");
 }
@@ -0,0 +1,61 @@
+#include <nano/node/unchecked_staging.hpp>
+
+#include <gtest/gtest.h>
+
+TEST (unchecked_staging, put_take)
+{
+	nano::unchecked_staging staging (1024 * 1024);
+	nano::keypair key;
+	auto block1 (std::make_shared<nano::send_block> (1, 2, 3, key.prv, key.pub, 5));
+	auto block2 (std::make_shared<nano::send_block> (1, 2, 4, key.prv, key.pub, 5));
+	auto block3 (std::make_shared<nano::send_block> (6, 2, 4, key.prv, key.pub, 5));
+	ASSERT_TRUE (staging.put (nano::unchecked_key (block1->previous (), block1->hash ()), nano::unchecked_info (block1, key.pub, 10)));
+	ASSERT_TRUE (staging.put (nano::unchecked_key (block2->previous (), block2->hash ()), nano::unchecked_info (block2, key.pub, 10)));
+	ASSERT_TRUE (staging.put (nano::unchecked_key (block3->previous (), block3->hash ()), nano::unchecked_info (block3, key.pub, 10)));
+	// Duplicates replace the existing entry
+	ASSERT_TRUE (staging.put (nano::unchecked_key (block1->previous (), block1->hash ()), nano::unchecked_info (block1, key.pub, 20)));
+	ASSERT_EQ (3, staging.size ());
+	// The budget accounts for the in-memory objects, not only the serialized blocks
+	ASSERT_GT (staging.bytes (), 3 * (sizeof (nano::send_block) + nano::block::size (nano::block_type::send)));
+	ASSERT_EQ (2, staging.get (1).size ());
+	nano::unchecked_info info;
+	ASSERT_FALSE (staging.find (block1->hash (), info));
+	ASSERT_EQ (20, info.modified);
+	ASSERT_TRUE (staging.find (5, info));
+	auto taken (staging.take (1));
+	ASSERT_EQ (2, taken.size ());
+	ASSERT_EQ (1, staging.size ());
+	ASSERT_TRUE (staging.take (1).empty ());
+	ASSERT_EQ (1, staging.take (6).size ());
+	ASSERT_EQ (0, staging.size ());
+	ASSERT_EQ (0, staging.bytes ());
+}
+
+TEST (unchecked_staging, spill)
+{
+	nano::keypair key;
+	std::vector<std::shared_ptr<nano::block>> blocks;
+	for (auto i (0); i < 16; ++i)
+	{
+		blocks.push_back (std::make_shared<nano::send_block> (i + 1, 2, 3, key.prv, key.pub, 5));
+	}
+	nano::unchecked_staging disabled (0);
+	ASSERT_FALSE (disabled.put (nano::unchecked_key (blocks[0]->previous (), blocks[0]->hash ()), nano::unchecked_info (blocks[0], key.pub, 0)));
+	ASSERT_EQ (0, disabled.size ());
+	nano::unchecked_staging staging (4096);
+	for (auto i (0); i < 16; ++i)
+	{
+		ASSERT_TRUE (staging.put (nano::unchecked_key (blocks[i]->previous (), blocks[i]->hash ()), nano::unchecked_info (blocks[i], key.pub, i)));
+	}
+	ASSERT_GT (staging.bytes (), staging.max_bytes);
+	auto spilled (staging.spill ());
+	ASSERT_FALSE (spilled.empty ());
+	ASSERT_LE (staging.bytes (), staging.max_bytes);
+	// Oldest entries are spilled first
+	ASSERT_EQ (blocks[0]->hash (), spilled.front ().first.hash);
+	ASSERT_EQ (16, spilled.size () + staging.size ());
+	ASSERT_TRUE (staging.spill ().empty ());
+	ASSERT_EQ (1, staging.erase_older_than (spilled.size () + 1));
+	ASSERT_EQ (16 - spilled.size () - 1, staging.spill_all ().size ());
+	ASSERT_EQ (0, staging.size ());
+}
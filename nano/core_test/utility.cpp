@@ -1,3 +1,4 @@
+#include <nano/lib/stats.hpp>
 #include <nano/lib/timer.hpp>
 #include <nano/lib/utility.hpp>
 #include <nano/secure/utility.hpp>
@@ -82,3 +83,51 @@ TEST (filesystem, move_all_files)
 	ASSERT_FALSE (boost::filesystem::exists (dummy_file1));
 	ASSERT_FALSE (boost::filesystem::exists (dummy_file2));
 }
+
+TEST (histogram, buckets)
+{
+	// Small values have a bucket each
+	for (uint64_t i (0); i < nano::histogram::sub_bucket_count; ++i)
+	{
+		ASSERT_EQ (i, nano::histogram::index (i));
+		ASSERT_EQ (i, nano::histogram::upper_bound (i));
+	}
+	// Every value falls within the bounds of its bucket, which are within 12.5% of each other
+	for (uint64_t value : { 8ULL, 15ULL, 16ULL, 17ULL, 100ULL, 1000ULL, 123456ULL, 4294967295ULL })
+	{
+		auto index (nano::histogram::index (value));
+		ASSERT_LT (index, nano::histogram::bucket_count);
+		ASSERT_LE (value, nano::histogram::upper_bound (index));
+		ASSERT_GT (value, nano::histogram::upper_bound (index - 1));
+		ASSERT_LE (nano::histogram::upper_bound (index) - nano::histogram::upper_bound (index - 1), value / 8 + 1);
+	}
+	ASSERT_EQ (nano::histogram::bucket_count - 1, nano::histogram::index (std::numeric_limits<uint64_t>::max ()));
+}
+
+TEST (histogram, percentile)
+{
+	nano::histogram histogram;
+	ASSERT_EQ (0, histogram.percentile (50));
+	for (uint64_t i (1); i <= 100; ++i)
+	{
+		histogram.add (i * 10);
+	}
+	ASSERT_EQ (100, histogram.count ());
+	ASSERT_EQ (1000, histogram.max ());
+	ASSERT_EQ (50500, histogram.sum ());
+	auto p50 (histogram.percentile (50));
+	ASSERT_LE (500, p50);
+	ASSERT_GE (500 + 500 / 8, p50);
+	auto p99 (histogram.percentile (99));
+	ASSERT_LE (990, p99);
+	ASSERT_GE (1000, p99);
+	ASSERT_EQ (1000, histogram.percentile (100));
+	nano::histogram other;
+	other.add (5000);
+	histogram.merge (other);
+	ASSERT_EQ (101, histogram.count ());
+	ASSERT_EQ (5000, histogram.percentile (100));
+	histogram.clear ();
+	ASSERT_EQ (0, histogram.count ());
+	ASSERT_EQ (0, histogram.max ());
+}
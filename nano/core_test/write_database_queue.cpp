@@ -0,0 +1,19 @@
+#include <nano/node/write_database_queue.hpp>
+
+#include <gtest/gtest.h>
+
+TEST (write_database_queue, select)
+{
+	nano::write_database_queue write_database_queue;
+	{
+		auto write_guard (write_database_queue.wait (nano::writer::process_batch));
+		ASSERT_FALSE (write_database_queue.process (nano::writer::confirmation_height));
+		ASSERT_TRUE (write_database_queue.contains (nano::writer::confirmation_height));
+	}
+	ASSERT_TRUE (write_database_queue.process (nano::writer::confirmation_height));
+	{
+		auto write_guard (write_database_queue.pop ());
+	}
+	ASSERT_FALSE (write_database_queue.contains (nano::writer::confirmation_height));
+	ASSERT_FALSE (write_database_queue.contains (nano::writer::process_batch));
+}
@@ -74,6 +74,30 @@ size_t nano::block::size (nano::block_type type_a)
 	return result;
 }
 
+nano::block_hash nano::block::serialized_previous (nano::block_type type_a, uint8_t const * data_a)
+{
+	nano::block_hash result (0);
+	switch (type_a)
+	{
+		case nano::block_type::invalid:
+		case nano::block_type::not_a_block:
+			assert (false);
+			break;
+		case nano::block_type::send:
+		case nano::block_type::receive:
+		case nano::block_type::change:
+			// The previous field comes first
+			std::copy (data_a, data_a + sizeof (result.bytes), result.bytes.begin ());
+			break;
+		case nano::block_type::open:
+			break;
+		case nano::block_type::state:
+			std::copy (data_a + sizeof (nano::account), data_a + sizeof (nano::account) + sizeof (result.bytes), result.bytes.begin ());
+			break;
+	}
+	return result;
+}
+
 nano::block_hash nano::block::hash () const
 {
 	nano::block_hash result;
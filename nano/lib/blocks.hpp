@@ -88,6 +88,8 @@ public:
 	virtual ~block () = default;
 	virtual bool valid_predecessor (nano::block const &) const = 0;
 	static size_t size (nano::block_type);
+	// Reads the previous field of a serialized block without deserializing it, zero for open blocks
+	static nano::block_hash serialized_previous (nano::block_type, uint8_t const *);
 };
 class send_hashables
 {
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Memory efficient map from 256-bit hashes to values, the counterpart of nano::compact_hash_set for bookkeeping that needs a value per hash.
+ * Values are kept contiguously in an arena next to the first 64 bits of their hash, an open addressing table of 32-bit arena indices
+ * with linear probing finds them. This avoids the separate allocation, pointers and cached hash of each std::unordered_map node.
+ * Erasing moves the last value of the arena into the freed position, so arena indices are only stable until the next erase.
+ * Truncation makes false positives possible with a probability of about n / 2^64, as with nano::compact_hash_set.
+ * Not thread-safe
+ */
+template <typename T>
+class compact_hash_map final
+{
+public:
+	explicit compact_hash_map (size_t capacity_a = 1024)
+	{
+		// Capacity is kept a power of two so the slot index is a mask of the digest
+		size_t capacity (16);
+		while (capacity < capacity_a)
+		{
+			capacity *= 2;
+		}
+		slots.resize (capacity, empty_slot);
+	}
+	/** Returns true if the value was inserted, false if the hash was already present, in which case the stored value is left unchanged */
+	bool emplace (nano::uint256_union const & hash_a, T const & value_a)
+	{
+		auto digest_l (digest (hash_a));
+		auto mask (slots.size () - 1);
+		auto index (static_cast<size_t> (digest_l) & mask);
+		// First erased slot of the probe sequence, reused so that erase and insert cycles do not fill the table
+		auto reuse (slots.size ());
+		while (slots[index] != empty_slot)
+		{
+			if (slots[index] == tombstone)
+			{
+				if (reuse == slots.size ())
+				{
+					reuse = index;
+				}
+			}
+			else if (arena[slots[index] - 1].digest == digest_l)
+			{
+				return false;
+			}
+			index = (index + 1) & mask;
+		}
+		assert (arena.size () < tombstone - 1);
+		if (reuse != slots.size ())
+		{
+			index = reuse;
+			--tombstones;
+		}
+		// Keep at least half of the slots empty so probe sequences stay short
+		else if ((arena.size () + tombstones + 1) * 2 > slots.size ())
+		{
+			rehash ((arena.size () + 1) * 4 > slots.size () ? slots.size () * 2 : slots.size ());
+			index = find_empty (digest_l);
+		}
+		arena.push_back (entry{ digest_l, value_a });
+		slots[index] = static_cast<uint32_t> (arena.size ());
+		return true;
+	}
+	/** Returns the value stored for the hash or nullptr, valid until the next change of the map */
+	T * find (nano::uint256_union const & hash_a)
+	{
+		auto slot (find_slot (digest (hash_a)));
+		return slot != slots.size () ? &arena[slots[slot] - 1].value : nullptr;
+	}
+	/** Returns true if the hash was present */
+	bool erase (nano::uint256_union const & hash_a)
+	{
+		auto slot (find_slot (digest (hash_a)));
+		bool result (slot != slots.size ());
+		if (result)
+		{
+			erase_index (slots[slot] - 1);
+		}
+		return result;
+	}
+	/** Value at position \p index_a of the arena, for iteration over [0, size ()) */
+	T & value (size_t index_a)
+	{
+		assert (index_a < arena.size ());
+		return arena[index_a].value;
+	}
+	/** Erases the value at position \p index_a of the arena, the last value takes its position */
+	void erase_index (size_t index_a)
+	{
+		assert (index_a < arena.size ());
+		// Probe sequences of other elements may pass through this slot
+		slots[slot_of (index_a)] = tombstone;
+		++tombstones;
+		auto last (arena.size () - 1);
+		if (index_a != last)
+		{
+			slots[slot_of (last)] = static_cast<uint32_t> (index_a + 1);
+			arena[index_a] = std::move (arena[last]);
+		}
+		arena.pop_back ();
+	}
+	void clear ()
+	{
+		std::vector<uint32_t> empty (16, empty_slot);
+		slots.swap (empty);
+		std::vector<entry> arena_l;
+		arena.swap (arena_l);
+		tombstones = 0;
+	}
+	size_t size () const
+	{
+		return arena.size ();
+	}
+	bool empty () const
+	{
+		return arena.empty ();
+	}
+	/** Bytes used by the table and the arena */
+	size_t memory () const
+	{
+		return slots.capacity () * sizeof (uint32_t) + arena.capacity () * sizeof (entry);
+	}
+
+private:
+	class entry final
+	{
+	public:
+		uint64_t digest;
+		T value;
+	};
+	static uint64_t digest (nano::uint256_union const & hash_a)
+	{
+		return hash_a.qwords[0];
+	}
+	/** Index of the slot referring to a value with \p digest_a, or slots.size () if there is none */
+	size_t find_slot (uint64_t digest_a) const
+	{
+		auto mask (slots.size () - 1);
+		auto index (static_cast<size_t> (digest_a) & mask);
+		while (slots[index] != empty_slot)
+		{
+			if (slots[index] != tombstone && arena[slots[index] - 1].digest == digest_a)
+			{
+				return index;
+			}
+			index = (index + 1) & mask;
+		}
+		return slots.size ();
+	}
+	/** Index of the slot referring to the arena position \p index_a, which must be present */
+	size_t slot_of (size_t index_a) const
+	{
+		auto mask (slots.size () - 1);
+		auto index (static_cast<size_t> (arena[index_a].digest) & mask);
+		while (slots[index] != index_a + 1)
+		{
+			assert (slots[index] != empty_slot);
+			index = (index + 1) & mask;
+		}
+		return index;
+	}
+	size_t find_empty (uint64_t digest_a) const
+	{
+		auto mask (slots.size () - 1);
+		auto index (static_cast<size_t> (digest_a) & mask);
+		while (slots[index] != empty_slot)
+		{
+			index = (index + 1) & mask;
+		}
+		return index;
+	}
+	void rehash (size_t capacity_a)
+	{
+		assert ((capacity_a & (capacity_a - 1)) == 0);
+		std::vector<uint32_t> slots_l (capacity_a, empty_slot);
+		slots.swap (slots_l);
+		tombstones = 0;
+		for (size_t i (0), n (arena.size ()); i < n; ++i)
+		{
+			slots[find_empty (arena[i].digest)] = static_cast<uint32_t> (i + 1);
+		}
+	}
+	/** Arena positions plus one, zero marks an empty slot */
+	std::vector<uint32_t> slots;
+	std::vector<entry> arena;
+	size_t tombstones{ 0 };
+	static uint32_t constexpr empty_slot = 0;
+	static uint32_t constexpr tombstone = std::numeric_limits<uint32_t>::max ();
+};
+
+template <typename T>
+uint32_t constexpr compact_hash_map<T>::empty_slot;
+template <typename T>
+uint32_t constexpr compact_hash_map<T>::tombstone;
+}
@@ -0,0 +1,141 @@
+#include <nano/lib/compact_hash_set.hpp>
+
+#include <cassert>
+
+constexpr uint64_t nano::compact_hash_set::empty_slot;
+constexpr uint64_t nano::compact_hash_set::tombstone;
+
+nano::compact_hash_set::compact_hash_set (size_t capacity_a)
+{
+	// Capacity is kept a power of two so the slot index is a mask of the digest
+	size_t capacity (16);
+	while (capacity < capacity_a)
+	{
+		capacity *= 2;
+	}
+	slots.resize (capacity, empty_slot);
+}
+
+uint64_t nano::compact_hash_set::digest (nano::uint256_union const & hash_a)
+{
+	auto result (hash_a.qwords[0]);
+	// Reserved values for empty and erased slots
+	if (result == empty_slot || result == tombstone)
+	{
+		result += 2;
+	}
+	return result;
+}
+
+size_t nano::compact_hash_set::find (uint64_t digest_a) const
+{
+	auto mask (slots.size () - 1);
+	auto index (static_cast<size_t> (digest_a) & mask);
+	while (slots[index] != empty_slot && slots[index] != digest_a)
+	{
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+bool nano::compact_hash_set::insert (nano::uint256_union const & hash_a)
+{
+	auto digest_l (digest (hash_a));
+	auto mask (slots.size () - 1);
+	auto index (static_cast<size_t> (digest_l) & mask);
+	// First erased slot of the probe sequence, reused so that erase and insert cycles do not fill the table
+	auto reuse (slots.size ());
+	while (slots[index] != empty_slot && slots[index] != digest_l)
+	{
+		if (slots[index] == tombstone && reuse == slots.size ())
+		{
+			reuse = index;
+		}
+		index = (index + 1) & mask;
+	}
+	bool result (slots[index] == empty_slot);
+	if (result)
+	{
+		if (reuse != slots.size ())
+		{
+			slots[reuse] = digest_l;
+			--tombstones;
+		}
+		else
+		{
+			// Keep at least half of the slots empty so probe sequences stay short
+			if ((count + tombstones + 1) * 2 > slots.size ())
+			{
+				rehash ((count + 1) * 4 > slots.size () ? slots.size () * 2 : slots.size ());
+				index = find (digest_l);
+			}
+			slots[index] = digest_l;
+		}
+		++count;
+	}
+	return result;
+}
+
+bool nano::compact_hash_set::exists (nano::uint256_union const & hash_a) const
+{
+	auto digest_l (digest (hash_a));
+	return slots[find (digest_l)] == digest_l;
+}
+
+bool nano::compact_hash_set::erase (nano::uint256_union const & hash_a)
+{
+	auto digest_l (digest (hash_a));
+	auto index (find (digest_l));
+	bool result (slots[index] == digest_l);
+	if (result)
+	{
+		// Probe sequences of other elements may pass through this slot
+		slots[index] = tombstone;
+		--count;
+		++tombstones;
+	}
+	return result;
+}
+
+void nano::compact_hash_set::clear ()
+{
+	std::vector<uint64_t> empty (16, empty_slot);
+	slots.swap (empty);
+	count = 0;
+	tombstones = 0;
+}
+
+size_t nano::compact_hash_set::size () const
+{
+	return count;
+}
+
+bool nano::compact_hash_set::empty () const
+{
+	return count == 0;
+}
+
+size_t nano::compact_hash_set::erased () const
+{
+	return tombstones;
+}
+
+size_t nano::compact_hash_set::memory () const
+{
+	return slots.capacity () * sizeof (uint64_t);
+}
+
+void nano::compact_hash_set::rehash (size_t capacity_a)
+{
+	assert ((capacity_a & (capacity_a - 1)) == 0);
+	std::vector<uint64_t> old (capacity_a, empty_slot);
+	old.swap (slots);
+	tombstones = 0;
+	for (auto digest_l : old)
+	{
+		if (digest_l != empty_slot && digest_l != tombstone)
+		{
+			slots[find (digest_l)] = digest_l;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+
+#include <vector>
+
+namespace nano
+{
+/**
+ * Memory efficient set of 256-bit hashes for bookkeeping of very large numbers of blocks.
+ * Only the first 64 bits of each hash are stored, in an open addressing table with linear probing, using about
+ * 16 bytes per element instead of the ~80 bytes of a std::unordered_set node. Truncation makes false positives possible,
+ * which is acceptable for block hashes as long as a positive is treated as a hint, with a probability of about n / 2^64.
+ * Not thread-safe
+ */
+class compact_hash_set final
+{
+public:
+	explicit compact_hash_set (size_t capacity_a = 1024);
+	/** Returns true if the hash was inserted, false if it was already present */
+	bool insert (nano::uint256_union const &);
+	bool exists (nano::uint256_union const &) const;
+	/** Returns true if the hash was present */
+	bool erase (nano::uint256_union const &);
+	void clear ();
+	size_t size () const;
+	bool empty () const;
+	/** Erased slots, reused by later inserts or dropped by the next rehash */
+	size_t erased () const;
+	/** Bytes used by the table */
+	size_t memory () const;
+
+private:
+	static uint64_t digest (nano::uint256_union const &);
+	/** Index of the slot holding \p digest_a, or of the first empty slot in its probe sequence */
+	size_t find (uint64_t digest_a) const;
+	void rehash (size_t capacity_a);
+	std::vector<uint64_t> slots;
+	size_t count{ 0 };
+	size_t tombstones{ 0 };
+	static uint64_t constexpr empty_slot = 0;
+	static uint64_t constexpr tombstone = 1;
+};
+}
@@ -0,0 +1,70 @@
+#include <nano/lib/blocks.hpp>
+#include <nano/lib/compressionconfig.hpp>
+#include <nano/lib/tomlconfig.hpp>
+
+#include <algorithm>
+#include <array>
+
+unsigned constexpr nano::compression_config::max_dictionary_size;
+
+namespace
+{
+std::array<std::pair<char const *, nano::block_type>, 5> const table_names{ { { "send", nano::block_type::send }, { "receive", nano::block_type::receive }, { "open", nano::block_type::open }, { "change", nano::block_type::change }, { "state", nano::block_type::state } } };
+}
+
+nano::error nano::compression_config::serialize_toml (nano::tomlconfig & toml) const
+{
+	toml.put ("enable", enable, "Whether blocks written to the ledger are compressed with a dictionary trained on sampled state blocks. Compressed blocks stay readable when this is disabled again. The dictionary is trained when the node starts with at least dictionary_samples state blocks in the ledger. LMDB ledgers compress each block, RocksDB ledgers compress the files of the block column families.\ntype:bool");
+	auto tables_l (toml.create_array ("tables", "Block types whose tables are compressed.\ntype:string,{send,receive,open,change,state}"));
+	for (auto const & table : tables)
+	{
+		tables_l->push_back (table);
+	}
+	toml.put ("dictionary_size", dictionary_size, "Maximum size (KB) of the compression dictionary, at most 32.\ntype:uint32");
+	toml.put ("dictionary_samples", dictionary_samples, "Number of state blocks sampled to train the compression dictionary.\ntype:uint32");
+	return toml.get_error ();
+}
+
+nano::error nano::compression_config::deserialize_toml (nano::tomlconfig & toml)
+{
+	toml.get_optional<bool> ("enable", enable);
+	if (toml.has_key ("tables"))
+	{
+		tables.clear ();
+		toml.array_entries_required<std::string> ("tables", [this](std::string const & entry_a) {
+			tables.push_back (entry_a);
+		});
+	}
+	toml.get_optional<unsigned> ("dictionary_size", dictionary_size);
+	toml.get_optional<unsigned> ("dictionary_samples", dictionary_samples);
+
+	for (auto const & table : tables)
+	{
+		if (std::none_of (table_names.begin (), table_names.end (), [&table](auto const & name_a) { return table == name_a.first; }))
+		{
+			toml.get_error ().set ("tables contains an invalid value (available: send, receive, open, change, state)");
+		}
+	}
+	if (dictionary_size == 0 || dictionary_size > max_dictionary_size)
+	{
+		toml.get_error ().set ("dictionary_size must be between 1 and 32");
+	}
+	if (dictionary_samples == 0)
+	{
+		toml.get_error ().set ("dictionary_samples must be non-zero");
+	}
+	return toml.get_error ();
+}
+
+std::vector<nano::block_type> nano::compression_config::block_types () const
+{
+	std::vector<nano::block_type> result;
+	for (auto const & name : table_names)
+	{
+		if (std::find (tables.begin (), tables.end (), name.first) != tables.end ())
+		{
+			result.push_back (name.second);
+		}
+	}
+	return result;
+}
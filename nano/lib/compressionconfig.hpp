@@ -0,0 +1,30 @@
+#pragma once
+
+#include <nano/lib/errors.hpp>
+
+#include <string>
+#include <vector>
+
+namespace nano
+{
+class tomlconfig;
+enum class block_type : uint8_t;
+
+/** Configuration of the compression of stored blocks */
+class compression_config final
+{
+public:
+	nano::error serialize_toml (nano::tomlconfig & toml_a) const;
+	nano::error deserialize_toml (nano::tomlconfig & toml_a);
+	/** Block types of the compressed tables */
+	std::vector<nano::block_type> block_types () const;
+
+	bool enable{ false };
+	/** Block types whose tables are compressed: send, receive, open, change or state */
+	std::vector<std::string> tables{ "state" };
+	unsigned dictionary_size{ 16 }; // KB
+	unsigned dictionary_samples{ 16384 };
+	/** Deflate uses a 32KB window, larger dictionaries are never referenced */
+	static unsigned constexpr max_dictionary_size{ 32 };
+};
+}
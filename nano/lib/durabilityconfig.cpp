@@ -0,0 +1,63 @@
+#include <nano/lib/durabilityconfig.hpp>
+#include <nano/lib/tomlconfig.hpp>
+
+nano::error nano::durability_config::serialize_toml (nano::tomlconfig & toml) const
+{
+	toml.put ("mode", serialize_mode (mode), "Controls when ledger commits are flushed to disk. sync flushes as the database backend does by default. group opens the ledger without syncing on commit, commits wait for a background flush which is shared with every commit made in the meantime. async does not wait, commits made in the last sync_interval may be lost or, on file systems which reorder writes, leave the LMDB ledger corrupted after a system crash.\ntype:string,{sync,group,async}");
+	toml.put ("sync_interval", sync_interval.count (), "Maximum time between background flushes in group and async modes.\ntype:milliseconds");
+	return toml.get_error ();
+}
+
+nano::error nano::durability_config::deserialize_toml (nano::tomlconfig & toml)
+{
+	if (toml.has_key ("mode"))
+	{
+		mode = deserialize_mode (toml.get<std::string> ("mode"));
+	}
+	auto sync_interval_l (sync_interval.count ());
+	toml.get_optional ("sync_interval", sync_interval_l);
+	sync_interval = std::chrono::milliseconds (sync_interval_l);
+
+	if (mode == nano::durability_mode::invalid)
+	{
+		toml.get_error ().set ("mode value is invalid (available: sync, group, async)");
+	}
+	if (sync_interval.count () <= 0)
+	{
+		toml.get_error ().set ("sync_interval must be non-zero");
+	}
+	return toml.get_error ();
+}
+
+std::string nano::durability_config::serialize_mode (nano::durability_mode mode_a)
+{
+	switch (mode_a)
+	{
+		case nano::durability_mode::group:
+			return "group";
+		case nano::durability_mode::async:
+			return "async";
+		default:
+			return "sync";
+	}
+}
+
+nano::durability_mode nano::durability_config::deserialize_mode (std::string const & string_a)
+{
+	if (string_a == "sync")
+	{
+		return nano::durability_mode::sync;
+	}
+	else if (string_a == "group")
+	{
+		return nano::durability_mode::group;
+	}
+	else if (string_a == "async")
+	{
+		return nano::durability_mode::async;
+	}
+	else
+	{
+		return nano::durability_mode::invalid;
+	}
+}
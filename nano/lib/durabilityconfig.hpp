@@ -0,0 +1,32 @@
+#pragma once
+
+#include <nano/lib/errors.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace nano
+{
+class tomlconfig;
+
+enum class durability_mode : uint8_t
+{
+	sync, // Commits are flushed the way the database backend does by default
+	group, // Commits wait for a background flush which is shared with concurrent commits
+	async, // Commits are flushed in the background every sync_interval without waiting
+	invalid
+};
+
+/** Configuration of when ledger commits are flushed to disk */
+class durability_config final
+{
+public:
+	nano::error serialize_toml (nano::tomlconfig & toml_a) const;
+	nano::error deserialize_toml (nano::tomlconfig & toml_a);
+	static std::string serialize_mode (nano::durability_mode);
+	static nano::durability_mode deserialize_mode (std::string const &);
+
+	nano::durability_mode mode{ nano::durability_mode::sync };
+	std::chrono::milliseconds sync_interval{ 100 };
+};
+}
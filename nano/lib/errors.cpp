@@ -156,6 +156,8 @@ std::string nano::error_rpc_messages::message (int ev) const
 			return "Representative account and previous hash required";
 		case nano::error_rpc::block_create_requirements_send:
 			return "Destination account, previous hash, current balance and amount required";
+		case nano::error_rpc::compaction_running:
+			return "Database compaction is already running or the database is read-only";
 		case nano::error_rpc::confirmation_height_not_processing:
 			return "There are no blocks currently being processed for adding confirmation height";
 		case nano::error_rpc::confirmation_not_found:
@@ -166,6 +168,8 @@ std::string nano::error_rpc_messages::message (int ev) const
 			return "Lazy bootstrap is disabled";
 		case nano::error_rpc::disabled_bootstrap_legacy:
 			return "Legacy bootstrap is disabled";
+		case nano::error_rpc::disabled_read_replica:
+			return "Action is not available on a read replica";
 		case nano::error_rpc::invalid_balance:
 			return "Invalid balance number";
 		case nano::error_rpc::invalid_destinations:
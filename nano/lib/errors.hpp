@@ -91,11 +91,13 @@ enum class error_rpc
 	block_create_requirements_receive,
 	block_create_requirements_change,
 	block_create_requirements_send,
+	compaction_running,
 	confirmation_height_not_processing,
 	confirmation_not_found,
 	difficulty_limit,
 	disabled_bootstrap_lazy,
 	disabled_bootstrap_legacy,
+	disabled_read_replica,
 	invalid_balance,
 	invalid_destinations,
 	invalid_epoch,
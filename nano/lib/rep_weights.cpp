@@ -27,6 +27,12 @@ std::unordered_map<nano::account, nano::uint128_t> nano::rep_weights::get_rep_am
 	return rep_amounts;
 }
 
+void nano::rep_weights::replace (std::unordered_map<nano::account, nano::uint128_t> rep_amounts_a)
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	rep_amounts.swap (rep_amounts_a);
+}
+
 void nano::rep_weights::put (nano::account const & account_a, nano::uint128_union const & representation_a)
 {
 	auto it = rep_amounts.find (account_a);
@@ -19,6 +19,8 @@ public:
 	nano::uint128_t representation_get (nano::account const & account_a);
 	void representation_put (nano::account const & account_a, nano::uint128_union const & representation_a);
 	std::unordered_map<nano::account, nano::uint128_t> get_rep_amounts ();
+	/** Replaces every weight, used when the weights are recomputed from the store */
+	void replace (std::unordered_map<nano::account, nano::uint128_t> rep_amounts_a);
 
 private:
 	std::mutex mutex;
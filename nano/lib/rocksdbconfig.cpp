@@ -13,6 +13,10 @@ nano::error nano::rocksdb_config::serialize_toml (nano::tomlconfig & toml) const
 	toml.put ("num_memtables", num_memtables, "Number of memtables to keep in memory per column family. 2 is the minimum, 3 is recommended.\ntype:uint32");
 	toml.put ("memtable_size", memtable_size, "Amount of memory (MB) to build up before flushing to disk for an individual column family. Large values increase performance. 64 or 128 is recommended.\ntype:uint32");
 	toml.put ("total_memtable_size", total_memtable_size, "Total memory (MB) which can be used across all memtables, set to 0 for unconstrained.\ntype:uint32");
+	toml.put ("point_lookup_bloom_filter_bits", point_lookup_bloom_filter_bits, "Number of bloom filter bits for the block, account, pending and confirmation height column families, which are mostly read by key. 0 disables the bloom filter.\ntype:uint32");
+	toml.put ("pending_prefix_extractor", pending_prefix_extractor, "Whether pending entries are filtered by destination account, speeding up lookups of accounts without pending entries.\ntype:bool");
+	toml.put ("unchecked_fifo_size", unchecked_fifo_size, "Size (MB) above which the oldest unchecked blocks are dropped using FIFO compaction, unchecked blocks older than a day are dropped as well. The unchecked count becomes an estimate. 0 uses level compaction.\ntype:uint64");
+	toml.put ("confirmation_height_memtable_size", confirmation_height_memtable_size, "Amount of memory (MB) to build up before flushing confirmation heights to disk, their index and filter blocks are always pinned in the block cache.\ntype:uint32");
 	return toml.get_error ();
 }
 
@@ -28,12 +32,20 @@ nano::error nano::rocksdb_config::deserialize_toml (nano::tomlconfig & toml)
 	toml.get_optional<unsigned> ("num_memtables", num_memtables);
 	toml.get_optional<unsigned> ("memtable_size", memtable_size);
 	toml.get_optional<unsigned> ("total_memtable_size", total_memtable_size);
+	toml.get_optional<unsigned> ("point_lookup_bloom_filter_bits", point_lookup_bloom_filter_bits);
+	toml.get_optional<bool> ("pending_prefix_extractor", pending_prefix_extractor);
+	toml.get_optional<uint64_t> ("unchecked_fifo_size", unchecked_fifo_size);
+	toml.get_optional<unsigned> ("confirmation_height_memtable_size", confirmation_height_memtable_size);
 
 	// Validate ranges
 	if (bloom_filter_bits > 100)
 	{
 		toml.get_error ().set ("bloom_filter_bits is too high");
 	}
+	if (point_lookup_bloom_filter_bits > 100)
+	{
+		toml.get_error ().set ("point_lookup_bloom_filter_bits is too high");
+	}
 	if (num_memtables < 2)
 	{
 		toml.get_error ().set ("num_memtables must be at least 2");
@@ -54,6 +66,10 @@ nano::error nano::rocksdb_config::deserialize_toml (nano::tomlconfig & toml)
 	{
 		toml.get_error ().set ("block_size must be non-zero");
 	}
+	if (confirmation_height_memtable_size == 0)
+	{
+		toml.get_error ().set ("confirmation_height_memtable_size must be non-zero");
+	}
 
 	return toml.get_error ();
 }
@@ -25,5 +25,9 @@ public:
 	unsigned memtable_size{ 32 }; // MB
 	unsigned num_memtables{ 2 }; // Need a minimum of 2
 	unsigned total_memtable_size{ 512 }; // MB
+	unsigned point_lookup_bloom_filter_bits{ 10 };
+	bool pending_prefix_extractor{ true };
+	uint64_t unchecked_fifo_size{ 0 }; // MB
+	unsigned confirmation_height_memtable_size{ 8 }; // MB
 };
 }
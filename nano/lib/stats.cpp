@@ -5,6 +5,7 @@
 #include <boost/format.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include <cmath>
 #include <ctime>
 #include <fstream>
 #include <iostream>
@@ -192,6 +193,129 @@ public:
 	}
 };
 
+nano::histogram::histogram ()
+{
+	clear ();
+}
+
+void nano::histogram::add (uint64_t value_a)
+{
+	buckets[index (value_a)].fetch_add (1, std::memory_order_relaxed);
+	total.fetch_add (1, std::memory_order_relaxed);
+	total_sum.fetch_add (value_a, std::memory_order_relaxed);
+	auto current (maximum.load (std::memory_order_relaxed));
+	while (value_a > current && !maximum.compare_exchange_weak (current, value_a, std::memory_order_relaxed))
+	{
+	}
+}
+
+void nano::histogram::merge (nano::histogram const & other_a)
+{
+	for (size_t i (0); i < bucket_count; ++i)
+	{
+		buckets[i].fetch_add (other_a.buckets[i].load (std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	total.fetch_add (other_a.count (), std::memory_order_relaxed);
+	total_sum.fetch_add (other_a.sum (), std::memory_order_relaxed);
+	auto other_max (other_a.max ());
+	auto current (maximum.load (std::memory_order_relaxed));
+	while (other_max > current && !maximum.compare_exchange_weak (current, other_max, std::memory_order_relaxed))
+	{
+	}
+}
+
+void nano::histogram::clear ()
+{
+	for (auto & bucket : buckets)
+	{
+		bucket.store (0, std::memory_order_relaxed);
+	}
+	total.store (0, std::memory_order_relaxed);
+	total_sum.store (0, std::memory_order_relaxed);
+	maximum.store (0, std::memory_order_relaxed);
+}
+
+uint64_t nano::histogram::count () const
+{
+	return total.load (std::memory_order_relaxed);
+}
+
+uint64_t nano::histogram::sum () const
+{
+	return total_sum.load (std::memory_order_relaxed);
+}
+
+uint64_t nano::histogram::max () const
+{
+	return maximum.load (std::memory_order_relaxed);
+}
+
+uint64_t nano::histogram::percentile (double percentile_a) const
+{
+	uint64_t result (0);
+	auto count_l (count ());
+	if (count_l > 0)
+	{
+		auto target (std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (count_l * std::min (std::max (percentile_a, 0.0), 100.0) / 100.0))));
+		auto max_l (max ());
+		// Buckets may be updated concurrently, fall back to the maximum if they add up to less than the target
+		result = max_l;
+		uint64_t running (0);
+		for (size_t i (0); i < bucket_count; ++i)
+		{
+			running += buckets[i].load (std::memory_order_relaxed);
+			if (running >= target)
+			{
+				result = std::min (upper_bound (i), max_l);
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+void nano::histogram::serialize (boost::property_tree::ptree & tree_a) const
+{
+	auto count_l (count ());
+	tree_a.put ("count", count_l);
+	tree_a.put ("mean", count_l > 0 ? sum () / count_l : 0);
+	tree_a.put ("max", max ());
+	tree_a.put ("p50", percentile (50));
+	tree_a.put ("p90", percentile (90));
+	tree_a.put ("p99", percentile (99));
+}
+
+size_t nano::histogram::index (uint64_t value_a)
+{
+	auto value (std::min (value_a, (uint64_t (1) << max_magnitude) - 1));
+	size_t result (value);
+	if (value >= sub_bucket_count)
+	{
+		unsigned magnitude (sub_bucket_bits);
+		while (value >> (magnitude + 1))
+		{
+			++magnitude;
+		}
+		// The top sub_bucket_bits + 1 bits select the bucket within the magnitude
+		auto shift (magnitude - sub_bucket_bits);
+		result = (magnitude - sub_bucket_bits + 1) * sub_bucket_count + (value >> shift) - sub_bucket_count;
+	}
+	return result;
+}
+
+uint64_t nano::histogram::upper_bound (size_t index_a)
+{
+	uint64_t result (index_a);
+	if (index_a >= sub_bucket_count)
+	{
+		auto magnitude (index_a / sub_bucket_count + sub_bucket_bits - 1);
+		uint64_t sub_bucket (index_a % sub_bucket_count + sub_bucket_count);
+		auto shift (magnitude - sub_bucket_bits);
+		result = ((sub_bucket + 1) << shift) - 1;
+	}
+	return result;
+}
+
 nano::stat::stat (nano::stat_config config) :
 config (config)
 {
@@ -438,6 +562,18 @@ std::string nano::stat::type_to_string (uint32_t key)
 			break;
 		case nano::stat::type::drop:
 			res = "drop";
+			break;
+		case nano::stat::type::filter:
+			res = "filter";
+			break;
+		case nano::stat::type::defer:
+			res = "defer";
+			break;
+		case nano::stat::type::requests:
+			res = "requests";
+			break;
+		case nano::stat::type::aggregator:
+			res = "aggregator";
 	}
 	return res;
 }
@@ -475,6 +611,9 @@ std::string nano::stat::detail_to_string (uint32_t key)
 		case nano::stat::detail::bulk_pull_request_failure:
 			res = "bulk_pull_request_failure";
 			break;
+		case nano::stat::detail::bulk_pull_skipped:
+			res = "bulk_pull_skipped";
+			break;
 		case nano::stat::detail::bulk_push:
 			res = "bulk_push";
 			break;
@@ -636,6 +775,36 @@ std::string nano::stat::detail_to_string (uint32_t key)
 			break;
 		case nano::stat::detail::blocks_confirmed:
 			res = "blocks_confirmed";
+			break;
+		case nano::stat::detail::duplicate_publish:
+			res = "duplicate_publish";
+			break;
+		case nano::stat::detail::requests_cached_hashes:
+			res = "requests_cached_hashes";
+			break;
+		case nano::stat::detail::requests_generated_hashes:
+			res = "requests_generated_hashes";
+			break;
+		case nano::stat::detail::requests_cached_votes:
+			res = "requests_cached_votes";
+			break;
+		case nano::stat::detail::requests_generated_votes:
+			res = "requests_generated_votes";
+			break;
+		case nano::stat::detail::requests_unknown:
+			res = "requests_unknown";
+			break;
+		case nano::stat::detail::aggregator_accepted:
+			res = "aggregator_accepted";
+			break;
+		case nano::stat::detail::aggregator_dropped:
+			res = "aggregator_dropped";
+			break;
+		case nano::stat::detail::replica_refresh:
+			res = "replica_refresh";
+			break;
+		case nano::stat::detail::replica_reload:
+			res = "replica_reload";
 	}
 	return res;
 }
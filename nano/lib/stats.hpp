@@ -7,6 +7,7 @@
 #include <boost/circular_buffer.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <map>
@@ -149,6 +150,42 @@ public:
 	nano::observer_set<uint64_t, uint64_t> count_observers;
 };
 
+/**
+ * Lock-free log-linear histogram in the style of HdrHistogram, used for latencies in microseconds.
+ * Values are grouped by their power of two magnitude and every magnitude is split into 8 linear sub-buckets,
+ * which bounds the error of reported percentiles to 12.5% of the value. Values of 2^32 and above are clamped.
+ */
+class histogram final
+{
+public:
+	histogram ();
+	void add (uint64_t value_a);
+	/** Adds the contents of \p other_a to this histogram */
+	void merge (nano::histogram const & other_a);
+	void clear ();
+	uint64_t count () const;
+	uint64_t sum () const;
+	uint64_t max () const;
+	/** Returns the upper bound of the bucket holding the value at \p percentile_a (0 to 100), or zero if empty */
+	uint64_t percentile (double percentile_a) const;
+	/** Writes count, mean, max and the 50th, 90th and 99th percentiles */
+	void serialize (boost::property_tree::ptree & tree_a) const;
+
+	static unsigned constexpr sub_bucket_bits = 3;
+	static unsigned constexpr sub_bucket_count = 1U << sub_bucket_bits;
+	static unsigned constexpr max_magnitude = 32;
+	static size_t constexpr bucket_count = (max_magnitude - sub_bucket_bits + 1) * sub_bucket_count;
+	static size_t index (uint64_t value_a);
+	/** Largest value which is counted in bucket \p index_a */
+	static uint64_t upper_bound (size_t index_a);
+
+private:
+	std::array<std::atomic<uint64_t>, bucket_count> buckets;
+	std::atomic<uint64_t> total{ 0 };
+	std::atomic<uint64_t> total_sum{ 0 };
+	std::atomic<uint64_t> maximum{ 0 };
+};
+
 /** Log sink interface */
 class stat_log_sink
 {
@@ -237,7 +274,11 @@ public:
 		udp,
 		observer,
 		confirmation_height,
-		drop
+		drop,
+		filter,
+		defer,
+		requests,
+		aggregator
 	};
 
 	/** Optional detail type */
@@ -286,6 +327,7 @@ public:
 		bulk_pull_failed_account,
 		bulk_pull_receive_block_failure,
 		bulk_pull_request_failure,
+		bulk_pull_skipped,
 		bulk_push,
 		frontier_req,
 		frontier_confirmation_failed,
@@ -331,7 +373,25 @@ public:
 
 		// confirmation height
 		blocks_confirmed,
-		invalid_block
+		invalid_block,
+
+		// filter
+		duplicate_publish,
+
+		// requests
+		requests_cached_hashes,
+		requests_generated_hashes,
+		requests_cached_votes,
+		requests_generated_votes,
+		requests_unknown,
+
+		// aggregator
+		aggregator_accepted,
+		aggregator_dropped,
+
+		// ledger replica
+		replica_refresh,
+		replica_reload
 	};
 
 	/** Direction of the stat. If the direction is irrelevant, use in */
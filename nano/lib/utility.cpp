@@ -150,6 +150,15 @@ namespace thread_role
 			case nano::thread_role::name::worker:
 				thread_role_name_string = "Worker";
 				break;
+			case nano::thread_role::name::request_aggregator:
+				thread_role_name_string = "Req aggregator";
+				break;
+			case nano::thread_role::name::store_flush:
+				thread_role_name_string = "Store flush";
+				break;
+			case nano::thread_role::name::store_compaction:
+				thread_role_name_string = "Store compaction";
+				break;
 		}
 
 		/*
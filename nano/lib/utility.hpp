@@ -117,7 +117,10 @@ namespace thread_role
 		rpc_process_container,
 		work_watcher,
 		confirmation_height_processing,
-		worker
+		worker,
+		request_aggregator,
+		store_flush,
+		store_compaction
 	};
 	/*
 	 * Get/Set the identifier for the current thread
@@ -968,6 +968,8 @@ int main (int argc, char * const * argv)
 					nano::account const & account (i->first);
 					nano::account_info const & info (i->second);
 					auto hash (info.head);
+					// Chains are pulled from the head and handed to the block processor oldest first, as bulk pull clients do
+					std::deque<nano::unchecked_info> chain;
 					while (!hash.is_zero ())
 					{
 						// Retrieving block data
@@ -979,12 +981,18 @@ int main (int argc, char * const * argv)
 							{
 								std::cout << boost::str (boost::format ("%1% blocks retrieved") % count) << std::endl;
 							}
-							nano::unchecked_info unchecked_info (block, account, 0, nano::signature_verification::unknown);
-							node2.node->block_processor.add (unchecked_info);
+							chain.emplace_front (block, account, 0, nano::signature_verification::unknown);
 							// Retrieving previous block hash
 							hash = block->previous ();
 						}
 					}
+					while (!chain.empty ())
+					{
+						auto segment_size (std::min (chain.size (), nano::bootstrap_limits::bootstrap_chain_max));
+						std::deque<nano::unchecked_info> segment (chain.begin (), chain.begin () + segment_size);
+						chain.erase (chain.begin (), chain.begin () + segment_size);
+						node2.node->block_processor.add_chain (std::move (segment));
+					}
 				}
 			}
 			count = 0;
@@ -6,6 +6,7 @@
 #include <cassert>
 
 std::chrono::milliseconds constexpr nano::block_processor::confirmation_request_delay;
+size_t constexpr nano::block_processor::chains_batch_max;
 
 nano::block_processor::block_processor (nano::node & node_a, nano::write_database_queue & write_database_queue_a) :
 generator (node_a),
@@ -46,7 +47,7 @@ void nano::block_processor::flush ()
 size_t nano::block_processor::size ()
 {
 	nano::unique_lock<std::mutex> lock (mutex);
-	return (blocks.size () + state_blocks.size () + forced.size ());
+	return (blocks.size () + state_blocks.size () + forced.size () + chains_blocks + chains_buffered);
 }
 
 bool nano::block_processor::full ()
@@ -95,6 +96,19 @@ void nano::block_processor::add (nano::unchecked_info const & info_a)
 	}
 }
 
+void nano::block_processor::add_chain (std::deque<nano::unchecked_info> chain_a)
+{
+	if (!chain_a.empty ())
+	{
+		{
+			nano::lock_guard<std::mutex> lock (mutex);
+			chains_blocks += chain_a.size ();
+			chains.push_back (std::move (chain_a));
+		}
+		condition.notify_all ();
+	}
+}
+
 void nano::block_processor::force (std::shared_ptr<nano::block> block_a)
 {
 	{
@@ -146,7 +160,7 @@ bool nano::block_processor::should_log (bool first_time)
 bool nano::block_processor::have_blocks ()
 {
 	assert (!mutex.try_lock ());
-	return !blocks.empty () || !forced.empty () || !state_blocks.empty ();
+	return !blocks.empty () || !forced.empty () || !state_blocks.empty () || !chains.empty ();
 }
 
 void nano::block_processor::verify_state_blocks (nano::unique_lock<std::mutex> & lock_a, size_t max_count)
@@ -159,44 +173,8 @@ void nano::block_processor::verify_state_blocks (nano::unique_lock<std::mutex> &
 	if (!items.empty ())
 	{
 		auto size (items.size ());
-		std::vector<nano::block_hash> hashes;
-		hashes.reserve (size);
-		std::vector<unsigned char const *> messages;
-		messages.reserve (size);
-		std::vector<size_t> lengths;
-		lengths.reserve (size);
-		std::vector<nano::account> accounts;
-		accounts.reserve (size);
-		std::vector<unsigned char const *> pub_keys;
-		pub_keys.reserve (size);
-		std::vector<nano::signature> blocks_signatures;
-		blocks_signatures.reserve (size);
-		std::vector<unsigned char const *> signatures;
-		signatures.reserve (size);
 		std::vector<int> verifications;
-		verifications.resize (size, 0);
-		for (auto i (0); i < size; ++i)
-		{
-			auto & item (items[i]);
-			hashes.push_back (item.block->hash ());
-			messages.push_back (hashes.back ().bytes.data ());
-			lengths.push_back (sizeof (decltype (hashes)::value_type));
-			nano::account account (item.block->account ());
-			if (!item.block->link ().is_zero () && node.ledger.is_epoch_link (item.block->link ()))
-			{
-				account = node.ledger.epoch_signer (item.block->link ());
-			}
-			else if (!item.account.is_zero ())
-			{
-				account = item.account;
-			}
-			accounts.push_back (account);
-			pub_keys.push_back (accounts.back ().bytes.data ());
-			blocks_signatures.push_back (item.block->block_signature ());
-			signatures.push_back (blocks_signatures.back ().bytes.data ());
-		}
-		nano::signature_check_set check = { size, messages.data (), lengths.data (), pub_keys.data (), signatures.data (), verifications.data () };
-		node.checker.verify (check);
+		verify_signatures (items, verifications);
 		lock_a.lock ();
 		for (auto i (0); i < size; ++i)
 		{
@@ -225,8 +203,9 @@ void nano::block_processor::verify_state_blocks (nano::unique_lock<std::mutex> &
 			}
 			else
 			{
-				blocks_filter.erase (filter_item (hashes[i], blocks_signatures[i]));
-				requeue_invalid (hashes[i], item);
+				auto hash (item.block->hash ());
+				blocks_filter.erase (filter_item (hash, item.block->block_signature ()));
+				requeue_invalid (hash, item);
 			}
 			items.pop_front ();
 		}
@@ -241,6 +220,119 @@ void nano::block_processor::verify_state_blocks (nano::unique_lock<std::mutex> &
 	}
 }
 
+void nano::block_processor::verify_signatures (std::deque<nano::unchecked_info> const & items_a, std::vector<int> & verifications_a)
+{
+	auto size (items_a.size ());
+	std::vector<nano::block_hash> hashes;
+	hashes.reserve (size);
+	std::vector<unsigned char const *> messages;
+	messages.reserve (size);
+	std::vector<size_t> lengths;
+	lengths.reserve (size);
+	std::vector<nano::account> accounts;
+	accounts.reserve (size);
+	std::vector<unsigned char const *> pub_keys;
+	pub_keys.reserve (size);
+	std::vector<nano::signature> blocks_signatures;
+	blocks_signatures.reserve (size);
+	std::vector<unsigned char const *> signatures;
+	signatures.reserve (size);
+	verifications_a.assign (size, 0);
+	for (auto i (0); i < size; ++i)
+	{
+		auto & item (items_a[i]);
+		hashes.push_back (item.block->hash ());
+		messages.push_back (hashes.back ().bytes.data ());
+		lengths.push_back (sizeof (decltype (hashes)::value_type));
+		nano::account account (item.block->account ());
+		if (!item.block->link ().is_zero () && node.ledger.is_epoch_link (item.block->link ()))
+		{
+			account = node.ledger.epoch_signer (item.block->link ());
+		}
+		else if (!item.account.is_zero ())
+		{
+			account = item.account;
+		}
+		accounts.push_back (account);
+		pub_keys.push_back (accounts.back ().bytes.data ());
+		blocks_signatures.push_back (item.block->block_signature ());
+		signatures.push_back (blocks_signatures.back ().bytes.data ());
+	}
+	nano::signature_check_set check = { size, messages.data (), lengths.data (), pub_keys.data (), signatures.data (), verifications_a.data () };
+	node.checker.verify (check);
+}
+
+void nano::block_processor::verify_chains (std::deque<nano::unchecked_info> & items_a)
+{
+	nano::timer<std::chrono::milliseconds> timer_l (nano::timer_state::started);
+	std::vector<int> verifications;
+	verify_signatures (items_a, verifications);
+	for (auto i (0); i < items_a.size (); ++i)
+	{
+		assert (verifications[i] == 1 || verifications[i] == 0);
+		auto & item (items_a[i]);
+		// Legacy blocks of an unknown account cannot be checked in advance, the ledger verifies them
+		if (item.verified == nano::signature_verification::unknown && (item.block->type () == nano::block_type::state || item.block->type () == nano::block_type::open || !item.account.is_zero ()))
+		{
+			if (!item.block->link ().is_zero () && node.ledger.is_epoch_link (item.block->link ()))
+			{
+				// Possible regular state blocks with epoch link (send subtype) are left unknown
+				if (verifications[i] == 1)
+				{
+					item.verified = nano::signature_verification::valid_epoch;
+				}
+			}
+			else if (verifications[i] == 1)
+			{
+				item.verified = nano::signature_verification::valid;
+			}
+			else
+			{
+				item.verified = nano::signature_verification::invalid;
+			}
+		}
+	}
+	if (node.config.logging.timing_logging ())
+	{
+		node.logger.try_log (boost::str (boost::format ("Batch verified %1% bootstrap blocks in %2% %3%") % items_a.size () % timer_l.stop ().count () % timer_l.unit ()));
+	}
+}
+
+void nano::block_processor::process_chains (nano::write_transaction const & transaction_a, std::deque<nano::unchecked_info> & items_a)
+{
+	nano::timer<std::chrono::milliseconds> timer_l (nano::timer_state::started);
+	size_t count (0);
+	while (!items_a.empty () && (timer_l.before_deadline (node.config.block_processor_batch_max_time) || count < node.flags.block_processor_batch_size))
+	{
+		auto & item (items_a.front ());
+		if (item.verified != nano::signature_verification::invalid)
+		{
+			// Historical blocks do not reach process_live as they are neither recent nor in block_arrival
+			process_one (transaction_a, item);
+		}
+		else
+		{
+			requeue_invalid (item.block->hash (), item);
+		}
+		items_a.pop_front ();
+		++count;
+	}
+	if (!items_a.empty ())
+	{
+		// Out of time, the verified remainder goes back to the front so the chain resumes in order
+		{
+			nano::lock_guard<std::mutex> lock (mutex);
+			chains_blocks += items_a.size ();
+			chains.push_front (std::move (items_a));
+		}
+		items_a.clear ();
+	}
+	if (node.config.logging.timing_logging ())
+	{
+		node.logger.always_log (boost::str (boost::format ("Processed %1% bootstrap blocks in %2% %3%") % count % timer_l.stop ().count () % timer_l.unit ()));
+	}
+}
+
 void nano::block_processor::process_batch (nano::unique_lock<std::mutex> & lock_a)
 {
 	nano::timer<std::chrono::milliseconds> timer_l;
@@ -258,10 +350,28 @@ void nano::block_processor::process_batch (nano::unique_lock<std::mutex> & lock_
 			}
 		}
 	}
+	// Take whole bootstrap chains, their signatures are checked before the write transaction is opened
+	std::deque<nano::unchecked_info> chain_items;
+	while (!chains.empty () && (chain_items.empty () || chain_items.size () + chains.front ().size () <= chains_batch_max))
+	{
+		auto & chain (chains.front ());
+		chains_blocks -= chain.size ();
+		std::move (chain.begin (), chain.end (), std::back_inserter (chain_items));
+		chains.pop_front ();
+	}
 	lock_a.unlock ();
+	if (!chain_items.empty ())
+	{
+		verify_chains (chain_items);
+	}
 	auto scoped_write_guard = write_database_queue.wait (nano::writer::process_batch);
-	auto transaction (node.store.tx_begin_write ({ nano::tables::accounts, nano::tables::cached_counts, nano::tables::change_blocks, nano::tables::frontiers, nano::tables::open_blocks, nano::tables::pending, nano::tables::receive_blocks, nano::tables::representation, nano::tables::send_blocks, nano::tables::state_blocks, nano::tables::unchecked }, { nano::tables::confirmation_height }));
+	auto transaction (node.store.tx_begin_write ({ nano::tables::accounts, nano::tables::cached_counts, nano::tables::change_blocks, nano::tables::confirmation_height, nano::tables::frontiers, nano::tables::open_blocks, nano::tables::pending, nano::tables::pending_amounts, nano::tables::pending_summary, nano::tables::receive_blocks, nano::tables::representation, nano::tables::send_blocks, nano::tables::state_blocks, nano::tables::unchecked }));
+	// Chains and blocks share the time limit of the write transaction
 	timer_l.restart ();
+	if (!chain_items.empty ())
+	{
+		process_chains (transaction, chain_items);
+	}
 	lock_a.lock ();
 	// Processing blocks
 	auto first_time (true);
@@ -418,7 +528,7 @@ nano::process_return nano::block_processor::process_one (nano::write_transaction
 			{
 				info_a.modified = nano::seconds_since_epoch ();
 			}
-			node.store.unchecked_put (transaction_a, nano::unchecked_key (info_a.block->previous (), hash), info_a);
+			unchecked_put (transaction_a, nano::unchecked_key (info_a.block->previous (), hash), info_a);
 			node.gap_cache.add (hash);
 			break;
 		}
@@ -433,7 +543,7 @@ nano::process_return nano::block_processor::process_one (nano::write_transaction
 			{
 				info_a.modified = nano::seconds_since_epoch ();
 			}
-			node.store.unchecked_put (transaction_a, nano::unchecked_key (node.ledger.block_source (transaction_a, *(info_a.block)), hash), info_a);
+			unchecked_put (transaction_a, nano::unchecked_key (node.ledger.block_source (transaction_a, *(info_a.block)), hash), info_a);
 			node.gap_cache.add (hash);
 			break;
 		}
@@ -536,9 +646,29 @@ void nano::block_processor::queue_unchecked (nano::write_transaction const & tra
 		}
 		add (info);
 	}
+	for (auto & info : node.unchecked_staging.take (hash_a))
+	{
+		add (info);
+	}
 	node.gap_cache.erase (hash_a);
 }
 
+void nano::block_processor::unchecked_put (nano::write_transaction const & transaction_a, nano::unchecked_key const & key_a, nano::unchecked_info const & info_a)
+{
+	// Gaps are mostly resolved within the same bootstrap attempt, live gap blocks are persisted straight away
+	if (node.bootstrap_initiator.in_progress () && node.unchecked_staging.put (key_a, info_a))
+	{
+		for (auto const & entry : node.unchecked_staging.spill ())
+		{
+			node.store.unchecked_put (transaction_a, entry.first, entry.second);
+		}
+	}
+	else
+	{
+		node.store.unchecked_put (transaction_a, key_a, info_a);
+	}
+}
+
 nano::block_hash nano::block_processor::filter_item (nano::block_hash const & hash_a, nano::signature const & signature_a)
 {
 	static nano::random_constants constants;
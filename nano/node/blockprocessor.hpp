@@ -10,6 +10,7 @@
 #include <boost/multi_index/random_access_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <unordered_set>
@@ -43,6 +44,13 @@ public:
 	bool half_full ();
 	void add (nano::unchecked_info const &);
 	void add (std::shared_ptr<nano::block>, uint64_t = 0);
+	/**
+	 * Queues a chain segment pulled during bootstrap, ordered from its oldest block.
+	 * Chains bypass the duplicate filter, are signature checked in one batch and processed in order inside a single write transaction
+	 */
+	void add_chain (std::deque<nano::unchecked_info>);
+	/** Blocks of legacy pulls buffered by bulk pull clients before add_chain, counted by size */
+	std::atomic<size_t> chains_buffered{ 0 };
 	void force (std::shared_ptr<nano::block>);
 	void wait_write ();
 	bool should_log (bool);
@@ -56,7 +64,11 @@ public:
 
 private:
 	void queue_unchecked (nano::write_transaction const &, nano::block_hash const &);
+	void unchecked_put (nano::write_transaction const &, nano::unchecked_key const &, nano::unchecked_info const &);
 	void verify_state_blocks (nano::unique_lock<std::mutex> &, size_t = std::numeric_limits<size_t>::max ());
+	void verify_signatures (std::deque<nano::unchecked_info> const &, std::vector<int> &);
+	void verify_chains (std::deque<nano::unchecked_info> &);
+	void process_chains (nano::write_transaction const &, std::deque<nano::unchecked_info> &);
 	void process_batch (nano::unique_lock<std::mutex> &);
 	void process_live (nano::block_hash const &, std::shared_ptr<nano::block>, const bool = false);
 	void requeue_invalid (nano::block_hash const &, nano::unchecked_info const &);
@@ -67,6 +79,9 @@ private:
 	std::deque<nano::unchecked_info> state_blocks;
 	std::deque<nano::unchecked_info> blocks;
 	std::deque<std::shared_ptr<nano::block>> forced;
+	std::deque<std::deque<nano::unchecked_info>> chains;
+	size_t chains_blocks{ 0 };
+	static size_t constexpr chains_batch_max{ 8192 };
 	nano::block_hash filter_item (nano::block_hash const &, nano::signature const &);
 	std::unordered_set<nano::block_hash> blocks_filter;
 	boost::multi_index_container<
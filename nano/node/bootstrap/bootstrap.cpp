@@ -16,6 +16,8 @@ constexpr double nano::bootstrap_limits::bootstrap_connection_scale_target_block
 constexpr double nano::bootstrap_limits::bootstrap_minimum_blocks_per_sec;
 constexpr double nano::bootstrap_limits::bootstrap_minimum_termination_time_sec;
 constexpr unsigned nano::bootstrap_limits::bootstrap_max_new_connections;
+constexpr double nano::bootstrap_limits::bootstrap_slow_peer_score_ratio;
+constexpr nano::bulk_pull::count_t nano::bootstrap_limits::bootstrap_slow_peer_pull_count;
 constexpr size_t nano::bootstrap_limits::bootstrap_max_confirm_frontiers;
 constexpr double nano::bootstrap_limits::required_frontier_confirmation_ratio;
 constexpr unsigned nano::bootstrap_limits::frontier_confirmation_blocks_limit;
@@ -26,6 +28,10 @@ constexpr unsigned nano::bootstrap_limits::lazy_destinations_request_limit;
 constexpr uint64_t nano::bootstrap_limits::lazy_batch_pull_count_resize_blocks_limit;
 constexpr double nano::bootstrap_limits::lazy_batch_pull_count_resize_ratio;
 constexpr size_t nano::bootstrap_limits::lazy_blocks_restart_limit;
+constexpr size_t nano::bootstrap_limits::lazy_memory_budget;
+constexpr size_t nano::bootstrap_limits::bootstrap_chain_max;
+constexpr size_t nano::bootstrap_limits::bootstrap_chain_buffer_max;
+constexpr std::chrono::minutes nano::pulls_cache::segment_cutoff;
 constexpr std::chrono::hours nano::bootstrap_excluded_peers::exclude_time_hours;
 constexpr std::chrono::hours nano::bootstrap_excluded_peers::exclude_remove_hours;
 
@@ -60,6 +66,23 @@ double nano::bootstrap_client::elapsed_seconds () const
 	return std::chrono::duration_cast<std::chrono::duration<double>> (std::chrono::steady_clock::now () - start_time).count ();
 }
 
+bool nano::bootstrap_client::warmed_up () const
+{
+	return block_count > 0 && elapsed_seconds () > nano::bootstrap_limits::bootstrap_connection_warmup_time_sec;
+}
+
+double nano::bootstrap_client::score () const
+{
+	double result (0.0);
+	if (warmed_up ())
+	{
+		auto completed (static_cast<double> (pulls_completed.load ()));
+		auto failed (static_cast<double> (pulls_failed.load ()));
+		result = block_rate () * (completed + 1.0) / (completed + failed + 1.0);
+	}
+	return result;
+}
+
 void nano::bootstrap_client::stop (bool force)
 {
 	pending_stop = true;
@@ -102,50 +125,61 @@ bool nano::bootstrap_attempt::should_log ()
 	return result;
 }
 
-bool nano::bootstrap_attempt::request_frontier (nano::unique_lock<std::mutex> & lock_a, bool first_attempt)
+void nano::bootstrap_attempt::request_frontier (nano::unique_lock<std::mutex> & lock_a)
 {
-	auto result (true);
-	auto connection_l (connection (lock_a, first_attempt));
-	connection_frontier_request = connection_l;
+	// The first range goes to the front connection, which is the peer requested explicitly if there is one
+	auto connection_l (connection (lock_a, !frontier_requested));
 	if (connection_l)
 	{
-		endpoint_frontier_request = connection_l->channel->get_tcp_endpoint ();
-		std::future<bool> future;
+		assert (!frontier_ranges.empty ());
+		auto range (frontier_ranges.front ());
+		frontier_ranges.pop_front ();
+		if (!frontier_requested)
 		{
-			auto client (std::make_shared<nano::frontier_req_client> (connection_l));
-			client->run ();
-			frontiers = client;
-			future = client->promise.get_future ();
+			frontier_requested = true;
+			endpoint_frontier_request = connection_l->channel->get_tcp_endpoint ();
 		}
-		lock_a.unlock ();
-		result = consume_future (future); // This is out of scope of `client' so when the last reference via boost::asio::io_context is lost and the client is destroyed, the future throws an exception.
-		lock_a.lock ();
-		if (result)
-		{
-			pulls.clear ();
-		}
-		if (node->config.logging.network_logging ())
+		++frontier_requests;
+		// A failed request requeues its range under the attempt mutex, dispatch in an external thread in case it fails right away
+		node->background ([connection_l, range]() {
+			auto client (std::make_shared<nano::frontier_req_client> (connection_l, range.first, range.second));
+			client->run ();
+		});
+	}
+}
+
+void nano::bootstrap_attempt::frontier_range_finished (nano::account const & resume_a, nano::account const & end_a, bool error_a)
+{
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		assert (frontier_requests > 0);
+		--frontier_requests;
+		if (error_a)
 		{
-			if (!result)
-			{
-				node->logger.try_log (boost::str (boost::format ("Completed frontier request, %1% out of sync accounts according to %2%") % pulls.size () % connection_l->channel->to_string ()));
-			}
-			else
+			node->stats.inc (nano::stat::type::error, nano::stat::detail::frontier_req, nano::stat::dir::out);
+			if (!stopped)
 			{
-				node->stats.inc (nano::stat::type::error, nano::stat::detail::frontier_req, nano::stat::dir::out);
+				frontier_ranges.emplace_back (resume_a, end_a);
 			}
 		}
+		if (frontier_ranges.empty () && frontier_requests == 0)
+		{
+			frontiers_received = true;
+		}
 	}
-	return result;
+	condition.notify_all ();
 }
 
 void nano::bootstrap_attempt::request_pull (nano::unique_lock<std::mutex> & lock_a)
 {
-	auto connection_l (connection (lock_a));
-	if (connection_l)
+	// Partially processed pulls are the tails of long chains, they go to the fastest idle peer
+	bool continuation (mode == nano::bootstrap_mode::legacy && !pulls.empty () && pulls.front ().processed > 0);
+	auto connection_l (continuation ? best_connection (lock_a) : connection (lock_a));
+	if (connection_l && !pulls.empty ())
 	{
 		auto pull (pulls.front ());
 		pulls.pop_front ();
+		bool skip (false);
 		if (mode != nano::bootstrap_mode::legacy)
 		{
 			// Check if pull is obsolete (head was processed)
@@ -155,36 +189,76 @@ void nano::bootstrap_attempt::request_pull (nano::unique_lock<std::mutex> & lock
 				pulls.pop_front ();
 			}
 		}
-		recent_pulls_head.push_back (pull.head);
-		if (recent_pulls_head.size () > nano::bootstrap_limits::bootstrap_max_confirm_frontiers)
+		else
 		{
-			recent_pulls_head.pop_front ();
+			// Shorten new pulls overlapping chain ranges already pulled by a previous request
+			skip = pull.processed == 0 && pull.head == pull.head_original && node->bootstrap_initiator.cache.truncate_pull (pull);
+			if (skip)
+			{
+				node->stats.inc (nano::stat::type::bootstrap, nano::stat::detail::bulk_pull_skipped, nano::stat::dir::out);
+			}
+			else if (pull.count == 0)
+			{
+				pull.count = pull_count (*connection_l);
+			}
+		}
+		if (!skip)
+		{
+			recent_pulls_head.push_back (pull.head);
+			if (recent_pulls_head.size () > nano::bootstrap_limits::bootstrap_max_confirm_frontiers)
+			{
+				recent_pulls_head.pop_front ();
+			}
+			++pulling;
+			// The bulk_pull_client destructor attempt to requeue_pull which can cause a deadlock if this is the last reference
+			// Dispatch request in an external thread in case it needs to be destroyed
+			node->background ([connection_l, pull]() {
+				auto client (std::make_shared<nano::bulk_pull_client> (connection_l, pull));
+				client->request ();
+			});
+		}
+		else
+		{
+			idle.push_back (connection_l);
 		}
-		++pulling;
-		// The bulk_pull_client destructor attempt to requeue_pull which can cause a deadlock if this is the last reference
-		// Dispatch request in an external thread in case it needs to be destroyed
-		node->background ([connection_l, pull]() {
-			auto client (std::make_shared<nano::bulk_pull_client> (connection_l, pull));
-			client->request ();
-		});
+	}
+	else if (connection_l)
+	{
+		idle.push_back (connection_l);
 	}
 }
 
+nano::bulk_pull::count_t nano::bootstrap_attempt::pull_count (nano::bootstrap_client const & client_a) const
+{
+	nano::bulk_pull::count_t result (0);
+	if (client_a.warmed_up () && client_a.score () < average_score * nano::bootstrap_limits::bootstrap_slow_peer_score_ratio)
+	{
+		result = nano::bootstrap_limits::bootstrap_slow_peer_pull_count;
+	}
+	return result;
+}
+
 void nano::bootstrap_attempt::request_push (nano::unique_lock<std::mutex> & lock_a)
 {
 	bool error (false);
-	if (auto connection_shared = connection_frontier_request.lock ())
+	// Each peer is pushed the chains missing from the frontiers it sent
+	while (!bulk_push_targets.empty () && !stopped)
 	{
-		std::future<bool> future;
+		auto targets (std::move (bulk_push_targets.front ()));
+		bulk_push_targets.pop_front ();
+		if (auto connection_shared = targets.first.lock ())
 		{
-			auto client (std::make_shared<nano::bulk_push_client> (connection_shared));
-			client->start ();
-			push = client;
-			future = client->promise.get_future ();
+			std::future<bool> future;
+			{
+				auto client (std::make_shared<nano::bulk_push_client> (connection_shared, targets.second));
+				client->start ();
+				push = client;
+				future = client->promise.get_future ();
+			}
+			lock_a.unlock ();
+			error |= consume_future (future); // This is out of scope of `client' so when the last reference via boost::asio::io_context is lost and the client is destroyed, the future throws an exception.
+			lock_a.lock ();
 		}
-		lock_a.unlock ();
-		error = consume_future (future); // This is out of scope of `client' so when the last reference via boost::asio::io_context is lost and the client is destroyed, the future throws an exception.
-		lock_a.lock ();
 	}
 	if (node->config.logging.network_logging ())
 	{
@@ -202,7 +276,8 @@ bool nano::bootstrap_attempt::still_pulling ()
 	auto running (!stopped);
 	auto more_pulls (!pulls.empty ());
 	auto still_pulling (pulling > 0);
-	return running && (more_pulls || still_pulling);
+	auto more_frontiers (!frontier_ranges.empty () || frontier_requests > 0);
+	return running && (more_pulls || still_pulling || more_frontiers);
 }
 
 void nano::bootstrap_attempt::run_start (nano::unique_lock<std::mutex> & lock_a)
@@ -213,23 +288,16 @@ void nano::bootstrap_attempt::run_start (nano::unique_lock<std::mutex> & lock_a)
 	requeued_pulls = 0;
 	pulls.clear ();
 	recent_pulls_head.clear ();
-	auto frontier_failure (true);
-	uint64_t frontier_attempts (0);
-	while (!stopped && frontier_failure)
+	// Split the account space into ranges requested from several peers at once, pulls start as soon as frontiers arrive
+	frontier_ranges.clear ();
+	frontier_requested = false;
+	auto const ranges (nano::bootstrap_limits::bootstrap_frontier_ranges);
+	nano::uint256_t const step (std::numeric_limits<nano::uint256_t>::max () / ranges);
+	for (auto i (0u); i < ranges; ++i)
 	{
-		++frontier_attempts;
-		frontier_failure = request_frontier (lock_a, frontier_attempts == 1);
-	}
-	frontiers_received = true;
-	// Shuffle pulls.
-	release_assert (std::numeric_limits<CryptoPP::word32>::max () > pulls.size ());
-	if (!pulls.empty ())
-	{
-		for (auto i = static_cast<CryptoPP::word32> (pulls.size () - 1); i > 0; --i)
-		{
-			auto k = nano::random_pool::generate_word32 (0, i);
-			std::swap (pulls[i], pulls[k]);
-		}
+		nano::account start (step * i);
+		nano::account end (i + 1 < ranges ? step * (i + 1) : 0);
+		frontier_ranges.emplace_back (start, end);
 	}
 }
 
@@ -243,7 +311,11 @@ void nano::bootstrap_attempt::run ()
 	{
 		while (still_pulling ())
 		{
-			if (!pulls.empty ())
+			if (!frontier_ranges.empty ())
+			{
+				request_frontier (lock);
+			}
+			else if (!pulls.empty ())
 			{
 				request_pull (lock);
 			}
@@ -318,6 +390,23 @@ std::shared_ptr<nano::bootstrap_client> nano::bootstrap_attempt::connection (nan
 	return result;
 }
 
+std::shared_ptr<nano::bootstrap_client> nano::bootstrap_attempt::best_connection (nano::unique_lock<std::mutex> & lock_a)
+{
+	// clang-format off
+	condition.wait (lock_a, [& stopped = stopped, &idle = idle] { return stopped || !idle.empty (); });
+	// clang-format on
+	std::shared_ptr<nano::bootstrap_client> result;
+	if (!idle.empty ())
+	{
+		auto best (std::max_element (idle.begin (), idle.end (), [](std::shared_ptr<nano::bootstrap_client> const & a, std::shared_ptr<nano::bootstrap_client> const & b) {
+			return a->score () < b->score ();
+		}));
+		result = *best;
+		idle.erase (best);
+	}
+	return result;
+}
+
 bool nano::bootstrap_attempt::consume_future (std::future<bool> & future_a)
 {
 	bool result;
@@ -358,6 +447,7 @@ unsigned nano::bootstrap_attempt::target_connections (size_t pulls_remaining)
 void nano::bootstrap_attempt::populate_connections ()
 {
 	double rate_sum = 0.0;
+	double score_sum = 0.0;
 	size_t num_pulls = 0;
 	std::priority_queue<std::shared_ptr<nano::bootstrap_client>, std::vector<std::shared_ptr<nano::bootstrap_client>>, block_rate_cmp> sorted_connections;
 	std::unordered_set<nano::tcp_endpoint> endpoints;
@@ -376,9 +466,10 @@ void nano::bootstrap_attempt::populate_connections ()
 					double elapsed_sec = client->elapsed_seconds ();
 					auto blocks_per_sec = client->block_rate ();
 					rate_sum += blocks_per_sec;
-					if (client->elapsed_seconds () > nano::bootstrap_limits::bootstrap_connection_warmup_time_sec && client->block_count > 0)
+					if (client->warmed_up ())
 					{
 						sorted_connections.push (client);
+						score_sum += client->score ();
 					}
 					// Force-stop the slowest peers, since they can take the whole bootstrap hostage by dribbling out blocks on the last remaining pull.
 					// This is ~1.5kilobits/sec.
@@ -399,6 +490,7 @@ void nano::bootstrap_attempt::populate_connections ()
 		clients.swap (new_clients);
 	}
 
+	average_score = sorted_connections.empty () ? 0.0 : score_sum / sorted_connections.size ();
 	auto target = target_connections (num_pulls);
 
 	// We only want to drop slow peers when more than 2/3 are active. 2/3 because 1/2 is too aggressive, and 100% rarely happens.
@@ -546,7 +638,7 @@ void nano::bootstrap_attempt::stop ()
 			client->socket->close ();
 		}
 	}
-	if (auto i = frontiers.lock ())
+	if (auto i = push.lock ())
 	{
 		try
 		{
@@ -556,16 +648,21 @@ void nano::bootstrap_attempt::stop ()
 		{
 		}
 	}
-	if (auto i = push.lock ())
+}
+
+void nano::bootstrap_attempt::add_pulls (std::vector<nano::pull_info> & pulls_a)
+{
+	for (auto & pull : pulls_a)
 	{
-		try
-		{
-			i->promise.set_value (true);
-		}
-		catch (std::future_error &)
-		{
-		}
+		node->bootstrap_initiator.cache.update_pull (pull);
 	}
+	// Spreads the accounts of a frontier range over the peers, instead of pulling neighbouring accounts from the same ones
+	nano::random_pool::shuffle (pulls_a.begin (), pulls_a.end ());
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		pulls.insert (pulls.end (), pulls_a.begin (), pulls_a.end ());
+	}
+	condition.notify_all ();
 }
 
 void nano::bootstrap_attempt::add_pull (nano::pull_info const & pull_a)
@@ -622,10 +719,26 @@ void nano::bootstrap_attempt::requeue_pull (nano::pull_info const & pull_a, bool
 	}
 }
 
-void nano::bootstrap_attempt::add_bulk_push_target (nano::block_hash const & head, nano::block_hash const & end)
+void nano::bootstrap_attempt::continue_pull (nano::pull_info const & pull_a)
+{
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		pulls.push_front (pull_a);
+	}
+	condition.notify_all ();
+}
+
+void nano::bootstrap_attempt::add_bulk_push_target (std::shared_ptr<nano::bootstrap_client> const & connection_a, nano::block_hash const & head, nano::block_hash const & end)
 {
 	nano::lock_guard<std::mutex> lock (mutex);
-	bulk_push_targets.emplace_back (head, end);
+	auto existing (std::find_if (bulk_push_targets.begin (), bulk_push_targets.end (), [&connection_a](auto const & targets_a) {
+		return targets_a.first.lock () == connection_a;
+	}));
+	if (existing == bulk_push_targets.end ())
+	{
+		existing = bulk_push_targets.emplace (bulk_push_targets.end (), connection_a, std::vector<std::pair<nano::block_hash, nano::block_hash>> ());
+	}
+	existing->second.emplace_back (head, end);
 }
 
 void nano::bootstrap_attempt::attempt_restart_check (nano::unique_lock<std::mutex> & lock_a)
@@ -798,9 +911,9 @@ void nano::bootstrap_attempt::lazy_start (nano::hash_or_account const & hash_or_
 	nano::lock_guard<std::mutex> lazy_lock (lazy_mutex);
 	// Add start blocks, limit 1024 (4k with disabled legacy bootstrap)
 	size_t max_keys (node->flags.disable_legacy_bootstrap ? 4 * 1024 : 1024);
-	if (lazy_keys.size () < max_keys && lazy_keys.find (hash_or_account_a) == lazy_keys.end () && lazy_blocks.find (hash_or_account_a) == lazy_blocks.end ())
+	if (lazy_keys.size () < max_keys && std::find (lazy_keys.begin (), lazy_keys.end (), hash_or_account_a.hash) == lazy_keys.end () && !lazy_blocks.exists (hash_or_account_a))
 	{
-		lazy_keys.insert (hash_or_account_a);
+		lazy_keys.push_back (hash_or_account_a.hash);
 		lazy_pulls.emplace_back (hash_or_account_a, confirmed ? std::numeric_limits<unsigned>::max () : node->network_params.bootstrap.lazy_retry_limit);
 	}
 }
@@ -809,7 +922,7 @@ void nano::bootstrap_attempt::lazy_add (nano::hash_or_account const & hash_or_ac
 {
 	// Add only unknown blocks
 	assert (!lazy_mutex.try_lock ());
-	if (lazy_blocks.find (hash_or_account_a) == lazy_blocks.end ())
+	if (!lazy_blocks.exists (hash_or_account_a))
 	{
 		lazy_pulls.emplace_back (hash_or_account_a, retry_limit);
 	}
@@ -819,10 +932,8 @@ void nano::bootstrap_attempt::lazy_requeue (nano::block_hash const & hash_a, nan
 {
 	nano::unique_lock<std::mutex> lazy_lock (lazy_mutex);
 	// Add only known blocks
-	auto existing (lazy_blocks.find (hash_a));
-	if (existing != lazy_blocks.end ())
+	if (lazy_blocks.erase (hash_a))
 	{
-		lazy_blocks.erase (existing);
 		lazy_lock.unlock ();
 		requeue_pull (nano::pull_info (hash_a, hash_a, previous_a, static_cast<nano::pull_info::count_t> (1), confirmed_a ? std::numeric_limits<unsigned>::max () : node->network_params.bootstrap.lazy_destinations_retry_limit));
 	}
@@ -853,20 +964,55 @@ void nano::bootstrap_attempt::lazy_pull_flush ()
 		}
 		size_t count (0);
 		auto transaction (node->store.tx_begin_read ());
+		// The same dependency is often queued several times before it is pulled. Duplicates within a batch are merged
+		// before the store lookup, keeping the highest retry limit
+		std::unordered_map<nano::block_hash, size_t> batch;
 		while (!lazy_pulls.empty () && count < max_pulls)
 		{
 			auto const & pull_start (lazy_pulls.front ());
+			auto existing (batch.find (pull_start.first));
+			if (existing != batch.end ())
+			{
+				auto & pull (pulls[existing->second]);
+				pull.retry_limit = std::max (pull.retry_limit, pull_start.second);
+			}
 			// Recheck if block was already processed
-			if (lazy_blocks.find (pull_start.first) == lazy_blocks.end () && !node->store.block_exists (transaction, pull_start.first))
+			else if (!lazy_blocks.exists (pull_start.first) && !node->store.block_exists (transaction, pull_start.first))
 			{
+				batch.emplace (pull_start.first, pulls.size ());
 				pulls.emplace_back (pull_start.first, pull_start.first, nano::block_hash (0), batch_count, pull_start.second);
 				++count;
 			}
 			lazy_pulls.pop_front ();
 		}
+		lazy_memory_update ();
+		if (lazy_memory > nano::bootstrap_limits::lazy_memory_budget && node->flags.disable_legacy_bootstrap)
+		{
+			lazy_memory_trim ();
+			lazy_memory_update ();
+		}
 	}
 }
 
+void nano::bootstrap_attempt::lazy_memory_update ()
+{
+	assert (!lazy_mutex.try_lock ());
+	auto memory (lazy_blocks.memory () + lazy_undefined_links.memory () + lazy_balances.memory () + lazy_state_backlog.memory ());
+	memory += lazy_keys.capacity () * sizeof (decltype (lazy_keys)::value_type);
+	memory += lazy_pulls.size () * sizeof (decltype (lazy_pulls)::value_type);
+	lazy_memory = memory;
+}
+
+void nano::bootstrap_attempt::lazy_memory_trim ()
+{
+	assert (!lazy_mutex.try_lock ());
+	// Without legacy bootstrap to hand over to, the caches that can be rebuilt from the ledger are dropped.
+	// Processed blocks are found in the store once written, state blocks missing a cached balance wait in the backlog until their previous block is
+	lazy_blocks.clear ();
+	lazy_undefined_links.clear ();
+	lazy_balances.clear ();
+}
+
 bool nano::bootstrap_attempt::lazy_finished ()
 {
 	if (stopped)
@@ -876,19 +1022,13 @@ bool nano::bootstrap_attempt::lazy_finished ()
 	bool result (true);
 	auto transaction (node->store.tx_begin_read ());
 	nano::lock_guard<std::mutex> lazy_lock (lazy_mutex);
-	for (auto it (lazy_keys.begin ()), end (lazy_keys.end ()); it != end && !stopped;)
+	auto it (lazy_keys.begin ());
+	while (it != lazy_keys.end () && !stopped && node->store.block_exists (transaction, *it))
 	{
-		if (node->store.block_exists (transaction, *it))
-		{
-			it = lazy_keys.erase (it);
-		}
-		else
-		{
-			result = false;
-			break;
-			// No need to increment `it` as we break above.
-		}
+		++it;
 	}
+	result = it == lazy_keys.end ();
+	lazy_keys.erase (lazy_keys.begin (), it);
 	// Finish lazy bootstrap without lazy pulls (in combination with still_pulling ())
 	if (!result && lazy_pulls.empty () && lazy_state_backlog.empty ())
 	{
@@ -911,8 +1051,9 @@ bool nano::bootstrap_attempt::lazy_has_expired () const
 	{
 		result = true;
 	}
-	else if (!node->flags.disable_legacy_bootstrap && lazy_blocks_count > nano::bootstrap_limits::lazy_blocks_restart_limit)
+	else if (lazy_memory > nano::bootstrap_limits::lazy_memory_budget || (!node->flags.disable_legacy_bootstrap && lazy_blocks_count > nano::bootstrap_limits::lazy_blocks_restart_limit))
 	{
+		// Legacy bootstrap continues without the lazy bookkeeping. Without it the attempt ends once trimming could not bring memory back under the budget
 		result = true;
 	}
 	return result;
@@ -923,6 +1064,7 @@ void nano::bootstrap_attempt::lazy_clear ()
 	assert (!lazy_mutex.try_lock ());
 	lazy_blocks.clear ();
 	lazy_blocks_count = 0;
+	lazy_memory = 0;
 	lazy_keys.clear ();
 	lazy_pulls.clear ();
 	lazy_state_backlog.clear ();
@@ -1038,7 +1180,7 @@ bool nano::bootstrap_attempt::process_block_lazy (std::shared_ptr<nano::block> b
 	auto hash (block_a->hash ());
 	nano::unique_lock<std::mutex> lazy_lock (lazy_mutex);
 	// Processing new blocks
-	if (lazy_blocks.find (hash) == lazy_blocks.end ())
+	if (!lazy_blocks.exists (hash))
 	{
 		// Search for new dependencies
 		if (!block_a->source ().is_zero () && !node->ledger.block_exists (block_a->source ()) && block_a->source () != node->network_params.ledger.genesis_account)
@@ -1065,7 +1207,7 @@ bool nano::bootstrap_attempt::process_block_lazy (std::shared_ptr<nano::block> b
 			lazy_balances.emplace (hash, block_a->balance ().number ());
 		}
 		// Clearing lazy balances for previous block
-		if (!block_a->previous ().is_zero () && lazy_balances.find (block_a->previous ()) != lazy_balances.end ())
+		if (!block_a->previous ().is_zero ())
 		{
 			lazy_balances.erase (block_a->previous ());
 		}
@@ -1091,7 +1233,7 @@ void nano::bootstrap_attempt::lazy_block_state (std::shared_ptr<nano::block> blo
 		nano::uint128_t balance (block_l->hashables.balance.number ());
 		auto const & link (block_l->hashables.link);
 		// If link is not epoch link or 0. And if block from link is unknown
-		if (!link.is_zero () && !node->ledger.is_epoch_link (link) && lazy_blocks.find (link) == lazy_blocks.end () && !node->store.block_exists (transaction, link))
+		if (!link.is_zero () && !node->ledger.is_epoch_link (link) && !lazy_blocks.exists (link) && !node->store.block_exists (transaction, link))
 		{
 			auto const & previous (block_l->hashables.previous);
 			// If state block previous is 0 then source block required
@@ -1112,12 +1254,12 @@ void nano::bootstrap_attempt::lazy_block_state (std::shared_ptr<nano::block> blo
 				}
 			}
 			// Search balance of already processed previous blocks
-			else if (lazy_blocks.find (previous) != lazy_blocks.end ())
+			else if (lazy_blocks.exists (previous))
 			{
 				auto previous_balance (lazy_balances.find (previous));
-				if (previous_balance != lazy_balances.end ())
+				if (previous_balance != nullptr)
 				{
-					if (previous_balance->second <= balance)
+					if (*previous_balance <= balance)
 					{
 						lazy_add (link, retry_limit);
 					}
@@ -1125,13 +1267,13 @@ void nano::bootstrap_attempt::lazy_block_state (std::shared_ptr<nano::block> blo
 					{
 						lazy_destinations_increment (link);
 					}
-					lazy_balances.erase (previous_balance);
+					lazy_balances.erase (previous);
 				}
 			}
 			// Insert in backlog state blocks if previous wasn't already processed
 			else
 			{
-				lazy_state_backlog.emplace (previous, nano::lazy_state_backlog_item{ link, balance, retry_limit });
+				lazy_state_backlog.emplace (previous, nano::lazy_state_backlog_item{ previous, link, balance, retry_limit });
 			}
 		}
 	}
@@ -1141,9 +1283,9 @@ void nano::bootstrap_attempt::lazy_block_state_backlog_check (std::shared_ptr<na
 {
 	// Search unknown state blocks balances
 	auto find_state (lazy_state_backlog.find (hash_a));
-	if (find_state != lazy_state_backlog.end ())
+	if (find_state != nullptr)
 	{
-		auto next_block (find_state->second);
+		auto next_block (*find_state);
 		// Retrieve balance for previous state & send blocks
 		if (block_a->type () == nano::block_type::state || block_a->type () == nano::block_type::send)
 		{
@@ -1157,12 +1299,11 @@ void nano::bootstrap_attempt::lazy_block_state_backlog_check (std::shared_ptr<na
 			}
 		}
 		// Assumption for other legacy block types
-		else if (lazy_undefined_links.find (next_block.link) == lazy_undefined_links.end ())
+		else if (lazy_undefined_links.insert (next_block.link))
 		{
 			lazy_add (next_block.link, node->network_params.bootstrap.lazy_retry_limit); // Head is not confirmed. It can be account or hash or non-existing
-			lazy_undefined_links.insert (next_block.link);
 		}
-		lazy_state_backlog.erase (find_state);
+		lazy_state_backlog.erase (hash_a);
 	}
 }
 
@@ -1170,12 +1311,12 @@ void nano::bootstrap_attempt::lazy_backlog_cleanup ()
 {
 	auto transaction (node->store.tx_begin_read ());
 	nano::lock_guard<std::mutex> lazy_lock (lazy_mutex);
-	for (auto it (lazy_state_backlog.begin ()), end (lazy_state_backlog.end ()); it != end && !stopped;)
+	for (size_t i (0); i < lazy_state_backlog.size () && !stopped;)
 	{
-		if (node->store.block_exists (transaction, it->first))
+		auto next_block (lazy_state_backlog.value (i));
+		if (node->store.block_exists (transaction, next_block.previous))
 		{
-			auto next_block (it->second);
-			if (node->ledger.balance (transaction, it->first) <= next_block.balance) // balance
+			if (node->ledger.balance (transaction, next_block.previous) <= next_block.balance) // balance
 			{
 				lazy_add (next_block.link, next_block.retry_limit); // link
 			}
@@ -1183,12 +1324,13 @@ void nano::bootstrap_attempt::lazy_backlog_cleanup ()
 			{
 				lazy_destinations_increment (next_block.link);
 			}
-			it = lazy_state_backlog.erase (it);
+			// The last entry takes this position and is checked next
+			lazy_state_backlog.erase_index (i);
 		}
 		else
 		{
-			lazy_add (it->first, it->second.retry_limit);
-			++it;
+			lazy_add (next_block.previous, next_block.retry_limit);
+			++i;
 		}
 	}
 }
@@ -1230,7 +1372,7 @@ bool nano::bootstrap_attempt::lazy_processed_or_exists (nano::block_hash const &
 {
 	bool result (false);
 	nano::unique_lock<std::mutex> lazy_lock (lazy_mutex);
-	if (lazy_blocks.find (hash_a) != lazy_blocks.end ())
+	if (lazy_blocks.exists (hash_a))
 	{
 		result = true;
 	}
@@ -1505,6 +1647,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (bootstrap_initiato
 {
 	size_t count = 0;
 	size_t cache_count = 0;
+	size_t segments_count = 0;
 	size_t excluded_peers_count = 0;
 	{
 		nano::lock_guard<std::mutex> guard (bootstrap_initiator.observers_mutex);
@@ -1513,6 +1656,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (bootstrap_initiato
 	{
 		nano::lock_guard<std::mutex> guard (bootstrap_initiator.cache.pulls_cache_mutex);
 		cache_count = bootstrap_initiator.cache.cache.size ();
+		segments_count = bootstrap_initiator.cache.segments.size ();
 	}
 	{
 		nano::lock_guard<std::mutex> guard (bootstrap_initiator.excluded_peers.excluded_peers_mutex);
@@ -1521,10 +1665,12 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (bootstrap_initiato
 
 	auto sizeof_element = sizeof (decltype (bootstrap_initiator.observers)::value_type);
 	auto sizeof_cache_element = sizeof (decltype (bootstrap_initiator.cache.cache)::value_type);
+	auto sizeof_segments_element = sizeof (decltype (bootstrap_initiator.cache.segments)::value_type);
 	auto sizeof_excluded_peers_element = sizeof (decltype (bootstrap_initiator.excluded_peers.peers)::value_type);
 	auto composite = std::make_unique<seq_con_info_composite> (name);
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "observers", count, sizeof_element }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "pulls_cache", cache_count, sizeof_cache_element }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "pulled_segments", segments_count, sizeof_segments_element }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "excluded_peers", excluded_peers_count, sizeof_excluded_peers_element }));
 	return composite;
 }
@@ -1579,6 +1725,57 @@ void nano::pulls_cache::remove (nano::pull_info const & pull_a)
 	cache.get<account_head_tag> ().erase (head_512);
 }
 
+void nano::pulls_cache::add_segment (nano::pull_info const & pull_a)
+{
+	nano::lock_guard<std::mutex> guard (pulls_cache_mutex);
+	// Clean old segment
+	if (segments.size () > cache_size_max)
+	{
+		segments.erase (segments.begin ());
+	}
+	auto now (std::chrono::steady_clock::now ());
+	auto & segments_by_account (segments.get<account_tag> ());
+	auto existing (segments_by_account.find (pull_a.account_or_head));
+	if (existing == segments_by_account.end ())
+	{
+		segments.insert (nano::pulled_segment{ now, pull_a.account_or_head, pull_a.head_original, pull_a.end });
+	}
+	else
+	{
+		segments_by_account.modify (existing, [&pull_a, now](nano::pulled_segment & segment_a) {
+			// Keep the ledger head of a truncated pull
+			if (segment_a.head != pull_a.end)
+			{
+				segment_a.end = pull_a.end;
+			}
+			segment_a.time = now;
+			segment_a.head = pull_a.head_original;
+		});
+	}
+}
+
+bool nano::pulls_cache::truncate_pull (nano::pull_info & pull_a)
+{
+	bool result (false);
+	nano::lock_guard<std::mutex> guard (pulls_cache_mutex);
+	auto & segments_by_account (segments.get<account_tag> ());
+	auto existing (segments_by_account.find (pull_a.account_or_head));
+	if (existing != segments_by_account.end ())
+	{
+		if (existing->time + segment_cutoff < std::chrono::steady_clock::now ())
+		{
+			segments_by_account.erase (existing);
+		}
+		// Only ranges above the same ledger head are known to be on the requested chain
+		else if (existing->end == pull_a.end)
+		{
+			result = existing->head == pull_a.head;
+			pull_a.end = existing->head;
+		}
+	}
+	return result;
+}
+
 uint64_t nano::bootstrap_excluded_peers::add (nano::tcp_endpoint const & endpoint_a, size_t network_peers_count)
 {
 	uint64_t result (0);
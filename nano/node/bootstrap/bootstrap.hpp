@@ -1,5 +1,7 @@
 #pragma once
 
+#include <nano/lib/compact_hash_map.hpp>
+#include <nano/lib/compact_hash_set.hpp>
 #include <nano/node/bootstrap/bootstrap_bulk_pull.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/socket.hpp>
@@ -44,6 +46,8 @@ enum class bootstrap_mode
 class lazy_state_backlog_item final
 {
 public:
+	/** Key of the entry, kept in full to check the ledger for it */
+	nano::block_hash previous{ 0 };
 	nano::link link{ 0 };
 	nano::uint128_t balance{ 0 };
 	unsigned retry_limit{ 0 };
@@ -63,10 +67,16 @@ public:
 	~bootstrap_attempt ();
 	void run ();
 	std::shared_ptr<nano::bootstrap_client> connection (nano::unique_lock<std::mutex> &, bool = false);
+	/** Like connection (), but takes the idle client with the highest score */
+	std::shared_ptr<nano::bootstrap_client> best_connection (nano::unique_lock<std::mutex> &);
+	/** Block count limit for a legacy pull sent to \p client_a. Slow peers pull long chains in segments, 0 means no limit */
+	nano::bulk_pull::count_t pull_count (nano::bootstrap_client const & client_a) const;
 	bool consume_future (std::future<bool> &);
 	void populate_connections ();
 	void start_populate_connections ();
-	bool request_frontier (nano::unique_lock<std::mutex> &, bool = false);
+	void request_frontier (nano::unique_lock<std::mutex> &);
+	/** Called once per frontier range request. On error the range is requeued starting from \p resume_a */
+	void frontier_range_finished (nano::account const & resume_a, nano::account const & end_a, bool error_a);
 	void request_pull (nano::unique_lock<std::mutex> &);
 	void request_push (nano::unique_lock<std::mutex> &);
 	void add_connection (nano::endpoint const &);
@@ -74,12 +84,17 @@ public:
 	void pool_connection (std::shared_ptr<nano::bootstrap_client>);
 	void stop ();
 	void requeue_pull (nano::pull_info const &, bool = false);
+	/** Queues the remainder of a segmented pull in front, without counting it as a retry */
+	void continue_pull (nano::pull_info const &);
 	void add_pull (nano::pull_info const &);
 	bool still_pulling ();
 	void run_start (nano::unique_lock<std::mutex> &);
 	unsigned target_connections (size_t pulls_remaining);
 	bool should_log ();
-	void add_bulk_push_target (nano::block_hash const &, nano::block_hash const &);
+	/** Records a chain missing from the peer of \p connection_a, which it is pushed to once pulling is done */
+	void add_bulk_push_target (std::shared_ptr<nano::bootstrap_client> const & connection_a, nano::block_hash const &, nano::block_hash const &);
+	/** Queues pulls found by a frontier request in random order */
+	void add_pulls (std::vector<nano::pull_info> &);
 	void attempt_restart_check (nano::unique_lock<std::mutex> &);
 	bool confirm_frontiers (nano::unique_lock<std::mutex> &);
 	bool process_block (std::shared_ptr<nano::block>, nano::account const &, uint64_t, nano::bulk_pull::count_t, bool, unsigned);
@@ -91,6 +106,8 @@ public:
 	bool lazy_finished ();
 	bool lazy_has_expired () const;
 	void lazy_pull_flush ();
+	void lazy_memory_update ();
+	void lazy_memory_trim ();
 	void lazy_clear ();
 	bool process_block_lazy (std::shared_ptr<nano::block>, nano::account const &, uint64_t, nano::bulk_pull::count_t, unsigned);
 	void lazy_block_state (std::shared_ptr<nano::block>, unsigned);
@@ -110,9 +127,11 @@ public:
 	std::mutex next_log_mutex;
 	std::chrono::steady_clock::time_point next_log;
 	std::deque<std::weak_ptr<nano::bootstrap_client>> clients;
-	std::weak_ptr<nano::bootstrap_client> connection_frontier_request;
 	nano::tcp_endpoint endpoint_frontier_request;
-	std::weak_ptr<nano::frontier_req_client> frontiers;
+	/** Account ranges [first, second) waiting for a frontier request, a zero second means the end of the account space */
+	std::deque<std::pair<nano::account, nano::account>> frontier_ranges;
+	std::atomic<unsigned> frontier_requests{ 0 };
+	bool frontier_requested{ false };
 	std::weak_ptr<nano::bulk_push_client> push;
 	std::deque<nano::pull_info> pulls;
 	std::deque<nano::block_hash> recent_pulls_head;
@@ -124,7 +143,10 @@ public:
 	std::atomic<uint64_t> total_blocks{ 0 };
 	std::atomic<unsigned> runs_count{ 0 };
 	std::atomic<unsigned> requeued_pulls{ 0 };
-	std::vector<std::pair<nano::block_hash, nano::block_hash>> bulk_push_targets;
+	/** Average score of the warmed up clients, refreshed by populate_connections */
+	std::atomic<double> average_score{ 0.0 };
+	/** Chains missing from peers, grouped by the connection their frontiers were received from */
+	std::deque<std::pair<std::weak_ptr<nano::bootstrap_client>, std::vector<std::pair<nano::block_hash, nano::block_hash>>>> bulk_push_targets;
 	std::atomic<bool> frontiers_received{ false };
 	std::atomic<bool> frontiers_confirmed{ false };
 	std::atomic<bool> populate_connections_started{ false };
@@ -134,11 +156,15 @@ public:
 	std::mutex mutex;
 	nano::condition_variable condition;
 	// Lazy bootstrap
-	std::unordered_set<nano::block_hash> lazy_blocks;
-	std::unordered_map<nano::block_hash, nano::lazy_state_backlog_item> lazy_state_backlog;
-	std::unordered_set<nano::block_hash> lazy_undefined_links;
-	std::unordered_map<nano::block_hash, nano::uint128_t> lazy_balances;
-	std::unordered_set<nano::block_hash> lazy_keys;
+	/** Blocks processed by lazy bootstrap, by truncated hash */
+	nano::compact_hash_set lazy_blocks;
+	/** State blocks waiting for the balance of their previous block, by truncated previous hash */
+	nano::compact_hash_map<nano::lazy_state_backlog_item> lazy_state_backlog;
+	nano::compact_hash_set lazy_undefined_links;
+	/** Balances of the first blocks of pulls, by truncated hash */
+	nano::compact_hash_map<nano::uint128_t> lazy_balances;
+	/** Start keys, bounded by lazy_start */
+	std::vector<nano::block_hash> lazy_keys;
 	std::deque<std::pair<nano::hash_or_account, unsigned>> lazy_pulls;
 	std::chrono::steady_clock::time_point lazy_start_time;
 	std::chrono::steady_clock::time_point last_lazy_flush{ std::chrono::steady_clock::now () };
@@ -155,6 +181,8 @@ public:
 	boost::multi_index::hashed_unique<boost::multi_index::tag<account_tag>, boost::multi_index::member<lazy_destinations_item, nano::account, &lazy_destinations_item::account>>>>
 	lazy_destinations;
 	std::atomic<size_t> lazy_blocks_count{ 0 };
+	/** Estimated memory used by the lazy bootstrap containers, refreshed with every lazy_pull_flush */
+	std::atomic<size_t> lazy_memory{ 0 };
 	std::atomic<bool> lazy_destinations_flushed{ false };
 	std::mutex lazy_mutex;
 	// Wallet lazy bootstrap
@@ -169,6 +197,9 @@ public:
 	void stop (bool force);
 	double block_rate () const;
 	double elapsed_seconds () const;
+	/** Block rate weighted by the share of pulls that completed. Zero until the client is warmed up */
+	double score () const;
+	bool warmed_up () const;
 	std::shared_ptr<nano::node> node;
 	std::shared_ptr<nano::bootstrap_attempt> attempt;
 	std::shared_ptr<nano::transport::channel_tcp> channel;
@@ -176,6 +207,8 @@ public:
 	std::shared_ptr<std::vector<uint8_t>> receive_buffer;
 	std::chrono::steady_clock::time_point start_time;
 	std::atomic<uint64_t> block_count;
+	std::atomic<uint64_t> pulls_completed{ 0 };
+	std::atomic<uint64_t> pulls_failed{ 0 };
 	std::atomic<bool> pending_stop;
 	std::atomic<bool> hard_stop;
 };
@@ -186,23 +219,51 @@ public:
 	nano::uint512_union account_head;
 	nano::block_hash new_head;
 };
+/** Chain range of an account pulled completely, from \p head down to \p end which was the ledger head when the pull was requested */
+class pulled_segment final
+{
+public:
+	std::chrono::steady_clock::time_point time;
+	nano::account account;
+	nano::block_hash head;
+	nano::block_hash end;
+};
 class pulls_cache final
 {
 public:
 	void add (nano::pull_info const &);
 	void update_pull (nano::pull_info &);
 	void remove (nano::pull_info const &);
+	/** Records a completed legacy pull, a segment starting at the head of the existing one extends it */
+	void add_segment (nano::pull_info const &);
+	/**
+	 * Lowers the amount of blocks requested by a new legacy pull using the segments already pulled for its account.
+	 * A pull from the same ledger head is truncated to end at the pulled segment head.
+	 * Returns true if the whole pull is already held and the request can be skipped
+	 */
+	bool truncate_pull (nano::pull_info &);
 	std::mutex pulls_cache_mutex;
 	class account_head_tag
 	{
 	};
+	class account_tag
+	{
+	};
 	boost::multi_index_container<
 	nano::cached_pulls,
 	boost::multi_index::indexed_by<
 	boost::multi_index::ordered_non_unique<boost::multi_index::member<nano::cached_pulls, std::chrono::steady_clock::time_point, &nano::cached_pulls::time>>,
 	boost::multi_index::hashed_unique<boost::multi_index::tag<account_head_tag>, boost::multi_index::member<nano::cached_pulls, nano::uint512_union, &nano::cached_pulls::account_head>>>>
 	cache;
+	boost::multi_index_container<
+	nano::pulled_segment,
+	boost::multi_index::indexed_by<
+	boost::multi_index::ordered_non_unique<boost::multi_index::member<nano::pulled_segment, std::chrono::steady_clock::time_point, &nano::pulled_segment::time>>,
+	boost::multi_index::hashed_unique<boost::multi_index::tag<account_tag>, boost::multi_index::member<nano::pulled_segment, nano::account, &nano::pulled_segment::account>>>>
+	segments;
 	constexpr static size_t cache_size_max = 10000;
+	/** Blocks of older segments are expected to be in the ledger or to have failed processing, they are not trusted anymore */
+	constexpr static std::chrono::minutes segment_cutoff{ 10 };
 };
 class excluded_peers_item final
 {
@@ -283,10 +344,18 @@ public:
 	static constexpr unsigned requeued_pulls_limit = 256;
 	static constexpr unsigned requeued_pulls_limit_test = 2;
 	static constexpr unsigned bulk_push_cost_limit = 200;
+	static constexpr unsigned bootstrap_frontier_ranges = 8;
+	static constexpr double bootstrap_slow_peer_score_ratio = 0.5;
+	static constexpr nano::bulk_pull::count_t bootstrap_slow_peer_pull_count = 1024;
+	static constexpr uint32_t bootstrap_frontier_page_size = 16 * 1024;
+	static constexpr size_t bootstrap_chain_max = 8 * 1024;
+	/** Blocks a legacy pull buffers to hand its chain over oldest first, older blocks wait for the rest of the pull in unchecked beyond it */
+	static constexpr size_t bootstrap_chain_buffer_max = 8 * bootstrap_chain_max;
 	static constexpr std::chrono::seconds lazy_flush_delay_sec = std::chrono::seconds (5);
 	static constexpr unsigned lazy_destinations_request_limit = 256 * 1024;
 	static constexpr uint64_t lazy_batch_pull_count_resize_blocks_limit = 4 * 1024 * 1024;
 	static constexpr double lazy_batch_pull_count_resize_ratio = 2.0;
 	static constexpr size_t lazy_blocks_restart_limit = 1024 * 1024;
+	static constexpr size_t lazy_memory_budget = 256 * 1024 * 1024;
 };
 }
@@ -25,8 +25,27 @@ unexpected_count (0)
 
 nano::bulk_pull_client::~bulk_pull_client ()
 {
+	flush_chain ();
+	// Legacy pulls only carry a count when segmented for a slow peer
+	bool segment_complete (connection->attempt->mode == nano::bootstrap_mode::legacy && pull.count != 0 && pull_blocks >= pull.count && unexpected_count == 0);
+	if (expected == pull.end || segment_complete)
+	{
+		++connection->pulls_completed;
+	}
+	else
+	{
+		++connection->pulls_failed;
+	}
+	if (expected != pull.end && segment_complete)
+	{
+		// Continue with the rest of the chain, preferably on a faster peer
+		pull.head = expected;
+		pull.count = 0;
+		pull.processed += pull_blocks;
+		connection->attempt->continue_pull (pull);
+	}
 	// If received end block is not expected end block
-	if (expected != pull.end)
+	else if (expected != pull.end)
 	{
 		pull.head = expected;
 		if (connection->attempt->mode != nano::bootstrap_mode::legacy)
@@ -43,6 +62,10 @@ nano::bulk_pull_client::~bulk_pull_client ()
 	else
 	{
 		connection->node->bootstrap_initiator.cache.remove (pull);
+		if (connection->attempt->mode == nano::bootstrap_mode::legacy)
+		{
+			connection->node->bootstrap_initiator.cache.add_segment (pull);
+		}
 	}
 	{
 		nano::lock_guard<std::mutex> mutex (connection->attempt->mutex);
@@ -108,6 +131,8 @@ void nano::bulk_pull_client::throttled_receive_block ()
 	}
 	else
 	{
+		// Buffered blocks count towards the limit, they are handed over so that the block processor can drain them
+		flush_chain ();
 		auto this_l (shared_from_this ());
 		connection->node->alarm.add (std::chrono::steady_clock::now () + std::chrono::seconds (1), [this_l]() {
 			if (!this_l->connection->pending_stop && !this_l->connection->attempt->stopped)
@@ -243,7 +268,26 @@ void nano::bulk_pull_client::received_block (boost::system::error_code const & e
 				connection->start_time = std::chrono::steady_clock::now ();
 			}
 			connection->attempt->total_blocks++;
-			bool stop_pull (connection->attempt->process_block (block, known_account, pull_blocks, pull.count, block_expected, pull.retry_limit));
+			bool stop_pull (false);
+			if (connection->attempt->mode == nano::bootstrap_mode::legacy && block_expected)
+			{
+				chain.emplace_front (block, known_account, 0, nano::signature_verification::unknown);
+				++connection->node->block_processor.chains_buffered;
+				if (chain.size () >= nano::bootstrap_limits::bootstrap_chain_max)
+				{
+					// Older blocks are still to come, hold the full segment so the chain is queued oldest first
+					segments.push_front (std::move (chain));
+					chain.clear ();
+					if (segments.size () * nano::bootstrap_limits::bootstrap_chain_max >= nano::bootstrap_limits::bootstrap_chain_buffer_max)
+					{
+						flush_chain ();
+					}
+				}
+			}
+			else
+			{
+				stop_pull = connection->attempt->process_block (block, known_account, pull_blocks, pull.count, block_expected, pull.retry_limit);
+			}
 			pull_blocks++;
 			if (!stop_pull && !connection->hard_stop.load ())
 			{
@@ -280,6 +324,23 @@ void nano::bulk_pull_client::received_block (boost::system::error_code const & e
 	}
 }
 
+void nano::bulk_pull_client::flush_chain ()
+{
+	if (!chain.empty ())
+	{
+		segments.push_front (std::move (chain));
+		chain.clear ();
+	}
+	size_t count (0);
+	for (auto & segment : segments)
+	{
+		count += segment.size ();
+		connection->node->block_processor.add_chain (std::move (segment));
+	}
+	segments.clear ();
+	connection->node->block_processor.chains_buffered -= count;
+}
+
 nano::bulk_pull_account_client::bulk_pull_account_client (std::shared_ptr<nano::bootstrap_client> connection_a, nano::account const & account_a) :
 connection (connection_a),
 account (account_a),
@@ -486,33 +547,51 @@ void nano::bulk_pull_server::set_current_end ()
 
 void nano::bulk_pull_server::send_next ()
 {
-	auto block (get_next ());
-	if (block != nullptr)
+	fill_and_write ();
+}
+
+void nano::bulk_pull_server::fill_and_write ()
+{
+	while (true)
 	{
-		std::vector<uint8_t> send_buffer;
+		std::vector<uint8_t> buffer;
+		fill_batch (buffer);
 		{
-			nano::vectorstream stream (send_buffer);
-			nano::serialize_block (stream, *block);
+			nano::lock_guard<std::mutex> lock (mutex);
+			if (!write_idle)
+			{
+				// Sent by sent_action once the write in flight completes
+				prepared = std::move (buffer);
+				prepared_ready = true;
+				break;
+			}
+			write_idle = false;
 		}
-		auto this_l (shared_from_this ());
-		if (connection->node->config.logging.bulk_pull_logging ())
+		if (buffer.empty ())
 		{
-			connection->node->logger.try_log (boost::str (boost::format ("Sending block: %1%") % block->hash ().to_string ()));
+			send_finished ();
+			break;
 		}
-		connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l](boost::system::error_code const & ec, size_t size_a) {
-			this_l->sent_action (ec, size_a);
-		});
+		write (std::move (buffer));
 	}
-	else
+}
+
+void nano::bulk_pull_server::write (std::vector<uint8_t> && buffer_a)
+{
+	if (connection->node->config.logging.bulk_pull_logging ())
 	{
-		send_finished ();
+		connection->node->logger.try_log (boost::str (boost::format ("Sending %1% bytes of blocks, %2% blocks sent in total") % buffer_a.size () % sent_count));
 	}
+	auto this_l (shared_from_this ());
+	connection->socket->async_write (nano::shared_const_buffer (std::move (buffer_a)), [this_l](boost::system::error_code const & ec, size_t size_a) {
+		this_l->sent_action (ec, size_a);
+	});
 }
 
-std::shared_ptr<nano::block> nano::bulk_pull_server::get_next ()
+bool nano::bulk_pull_server::cursor_valid (bool & last_a) const
 {
-	std::shared_ptr<nano::block> result;
-	bool send_current = false, set_current_to_end = false;
+	bool result (false);
+	last_a = false;
 
 	/*
 	 * Determine if we should reply with a block
@@ -525,17 +604,17 @@ std::shared_ptr<nano::block> nano::bulk_pull_server::get_next ()
 	 */
 	if (current != request->end)
 	{
-		send_current = true;
+		result = true;
 	}
 	else if (current == request->end && include_start == true)
 	{
-		send_current = true;
+		result = true;
 
 		/*
 		 * We also need to ensure that the next time
 		 * are invoked that we return a null result
 		 */
-		set_current_to_end = true;
+		last_a = true;
 	}
 
 	/*
@@ -545,47 +624,95 @@ std::shared_ptr<nano::block> nano::bulk_pull_server::get_next ()
 	 */
 	if (max_count != 0 && sent_count >= max_count)
 	{
-		send_current = false;
+		result = false;
 	}
+	return result;
+}
 
-	if (send_current)
+void nano::bulk_pull_server::cursor_advance (nano::block_hash const & previous_a, bool last_a)
+{
+	if (!previous_a.is_zero () && !last_a)
 	{
-		auto transaction (connection->node->store.tx_begin_read ());
-		result = connection->node->store.block_get (transaction, current);
-		if (result != nullptr && set_current_to_end == false)
-		{
-			auto previous (result->previous ());
-			if (!previous.is_zero ())
-			{
-				current = previous;
-			}
-			else
-			{
-				current = request->end;
-			}
-		}
-		else
-		{
-			current = request->end;
-		}
-
-		sent_count++;
+		current = previous_a;
+	}
+	else
+	{
+		current = request->end;
 	}
+	sent_count++;
 
 	/*
-	 * Once we have processed "get_next()" once our cursor is no longer on
+	 * Once a block was processed our cursor is no longer on
 	 * the "start" member, so this flag is not relevant is always false.
 	 */
 	include_start = false;
+}
 
+std::shared_ptr<nano::block> nano::bulk_pull_server::get_next ()
+{
+	std::shared_ptr<nano::block> result;
+	bool last (false);
+	if (cursor_valid (last))
+	{
+		auto transaction (connection->node->store.tx_begin_read ());
+		result = connection->node->store.block_get (transaction, current);
+		cursor_advance (result != nullptr ? result->previous () : nano::block_hash (0), last);
+	}
+	include_start = false;
 	return result;
 }
 
+void nano::bulk_pull_server::fill_batch (std::vector<uint8_t> & buffer_a)
+{
+	bool last (false);
+	if (cursor_valid (last))
+	{
+		auto transaction (connection->node->store.tx_begin_read ());
+		size_t count (0);
+		do
+		{
+			nano::block_hash previous (0);
+			auto error (connection->node->store.block_serialized_append (transaction, current, buffer_a, previous));
+			// A missing block ends the response, as there is nothing to follow it with
+			cursor_advance (!error ? previous : nano::block_hash (0), last);
+		} while (++count < batch_size && cursor_valid (last));
+	}
+	include_start = false;
+}
+
 void nano::bulk_pull_server::sent_action (boost::system::error_code const & ec, size_t size_a)
 {
 	if (!ec)
 	{
-		send_next ();
+		std::vector<uint8_t> buffer;
+		bool ready (false);
+		{
+			nano::lock_guard<std::mutex> lock (mutex);
+			ready = prepared_ready;
+			if (ready)
+			{
+				buffer = std::move (prepared);
+				prepared.clear ();
+				prepared_ready = false;
+			}
+			else
+			{
+				// The next batch is still being filled, fill_and_write will send it
+				write_idle = true;
+			}
+		}
+		if (ready)
+		{
+			if (buffer.empty ())
+			{
+				send_finished ();
+			}
+			else
+			{
+				write (std::move (buffer));
+				fill_and_write ();
+			}
+		}
 	}
 	else
 	{
@@ -678,6 +805,7 @@ void nano::bulk_pull_account_server::set_params ()
 	 */
 	current_key.account = request->account;
 	current_key.hash = 0;
+	current_amount_key = nano::pending_amount_key (request->account, std::numeric_limits<nano::uint128_t>::max (), 0);
 }
 
 void nano::bulk_pull_account_server::send_frontier ()
@@ -715,68 +843,162 @@ void nano::bulk_pull_account_server::send_frontier ()
 void nano::bulk_pull_account_server::send_next_block ()
 {
 	/*
-	 * Get the next item from the queue, it is a tuple with the key (which
-	 * contains the account and hash) and data (which contains the amount)
+	 * Fill the next batch of entries, skipping over batches in which
+	 * every scanned entry was filtered out
 	 */
-	auto block_data (get_next ());
-	auto block_info_key (block_data.first.get ());
-	auto block_info (block_data.second.get ());
+	std::vector<uint8_t> send_buffer;
+	auto more (true);
+	while (send_buffer.empty () && more)
+	{
+		more = fill_batch (send_buffer);
+	}
 
-	if (block_info_key != nullptr)
+	if (!send_buffer.empty ())
 	{
 		/*
-		 * If we have a new item, emit it to the socket
+		 * If we have new items, emit them to the socket
 		 */
+		if (connection->node->config.logging.bulk_pull_logging ())
+		{
+			connection->node->logger.try_log (boost::str (boost::format ("Sending %1% bytes of pending entries") % send_buffer.size ()));
+		}
 
-		std::vector<uint8_t> send_buffer;
-		if (pending_address_only)
+		auto this_l (shared_from_this ());
+		connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l](boost::system::error_code const & ec, size_t size_a) {
+			this_l->sent_action (ec, size_a);
+		});
+	}
+	else
+	{
+		/*
+		 * Otherwise, finalize the connection
+		 */
+		if (connection->node->config.logging.bulk_pull_logging ())
 		{
-			nano::vectorstream output_stream (send_buffer);
+			connection->node->logger.try_log (boost::str (boost::format ("Done sending blocks")));
+		}
 
-			if (connection->node->config.logging.bulk_pull_logging ())
+		send_finished ();
+	}
+}
+
+bool nano::bulk_pull_account_server::fill_batch (std::vector<uint8_t> & buffer_a)
+{
+	auto more (true);
+	size_t count (0);
+	size_t scanned (0);
+	auto transaction (connection->node->store.tx_begin_read ());
+	nano::vectorstream output_stream (buffer_a);
+	if (request->minimum_amount.is_zero ())
+	{
+		for (auto i (connection->node->store.pending_begin (transaction, current_key)), n (connection->node->store.pending_end ()); count < batch_size && scanned < batch_scan_max; ++i, ++scanned)
+		{
+			/*
+			 * Finish up at the end of the table or if the entry is for a different account
+			 */
+			if (i == n || i->first.account != request->account)
 			{
-				connection->node->logger.try_log (boost::str (boost::format ("Sending address: %1%") % block_info->source.to_string ()));
+				more = false;
+				break;
 			}
 
-			write (output_stream, block_info->source.bytes);
+			nano::pending_key key (i->first);
+			nano::pending_info info (i->second);
+
+			/*
+			 * Get the key for the next value, to use in the next batch
+			 */
+			current_key.account = key.account;
+			current_key.hash = key.hash.number () + 1;
+
+			if (entry_valid (info))
+			{
+				serialize_entry (output_stream, key, info);
+				++count;
+			}
 		}
-		else
+	}
+	else
+	{
+		for (auto i (connection->node->store.pending_amounts_begin (transaction, current_amount_key)), n (connection->node->store.pending_amounts_end ()); count < batch_size && scanned < batch_scan_max; ++i, ++scanned)
 		{
-			nano::vectorstream output_stream (send_buffer);
+			/*
+			 * Entries are ordered by decreasing amount, finish up at the first one below the minimum
+			 */
+			if (i == n || i->first.account != request->account || i->first.amount () < request->minimum_amount)
+			{
+				more = false;
+				break;
+			}
 
-			if (connection->node->config.logging.bulk_pull_logging ())
+			nano::pending_amount_key key (i->first);
+			current_amount_key = key;
+			current_amount_key.hash = key.hash.number () + 1;
+
+			nano::pending_info info;
+			if (!connection->node->store.pending_get (transaction, key.pending (), info) && entry_valid (info))
 			{
-				connection->node->logger.try_log (boost::str (boost::format ("Sending block: %1%") % block_info_key->hash.to_string ()));
+				serialize_entry (output_stream, key.pending (), info);
+				++count;
 			}
+		}
+	}
+	return more;
+}
 
-			write (output_stream, block_info_key->hash.bytes);
-			write (output_stream, block_info->amount.bytes);
+bool nano::bulk_pull_account_server::entry_valid (nano::pending_info const & info_a)
+{
+	/*
+	 * Skip entries where the amount is less than the requested
+	 * minimum
+	 */
+	auto result (!(info_a.amount < request->minimum_amount));
 
-			if (pending_include_address)
+	/*
+	 * If the pending_address_only flag is set, de-duplicate the
+	 * responses.  The responses are the address of the sender,
+	 * so they are are part of the pending table's information
+	 * and not key, so we have to de-duplicate them manually.
+	 */
+	if (result && pending_address_only)
+	{
+		if (!deduplication.insert (info_a.source).second)
+		{
+			/*
+			 * If the deduplication map gets too
+			 * large, clear it out.  This may
+			 * result in some duplicates getting
+			 * sent to the client, but we do not
+			 * want to commit too much memory
+			 */
+			if (deduplication.size () > 4096)
 			{
-				/**
-				 ** Write the source address as well, if requested
-				 **/
-				write (output_stream, block_info->source.bytes);
+				deduplication.clear ();
 			}
+			result = false;
 		}
+	}
+	return result;
+}
 
-		auto this_l (shared_from_this ());
-		connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l](boost::system::error_code const & ec, size_t size_a) {
-			this_l->sent_action (ec, size_a);
-		});
+void nano::bulk_pull_account_server::serialize_entry (nano::stream & stream_a, nano::pending_key const & key_a, nano::pending_info const & info_a) const
+{
+	if (pending_address_only)
+	{
+		write (stream_a, info_a.source.bytes);
 	}
 	else
 	{
-		/*
-		 * Otherwise, finalize the connection
-		 */
-		if (connection->node->config.logging.bulk_pull_logging ())
+		write (stream_a, key_a.hash.bytes);
+		write (stream_a, info_a.amount.bytes);
+
+		if (pending_include_address)
 		{
-			connection->node->logger.try_log (boost::str (boost::format ("Done sending blocks")));
+			/**
+			 ** Write the source address as well, if requested
+			 **/
+			write (stream_a, info_a.source.bytes);
 		}
-
-		send_finished ();
 	}
 }
 
@@ -816,40 +1038,11 @@ std::pair<std::unique_ptr<nano::pending_key>, std::unique_ptr<nano::pending_info
 			break;
 		}
 
-		/*
-		 * Skip entries where the amount is less than the requested
-		 * minimum
-		 */
-		if (info.amount < request->minimum_amount)
+		if (!entry_valid (info))
 		{
 			continue;
 		}
 
-		/*
-		 * If the pending_address_only flag is set, de-duplicate the
-		 * responses.  The responses are the address of the sender,
-		 * so they are are part of the pending table's information
-		 * and not key, so we have to de-duplicate them manually.
-		 */
-		if (pending_address_only)
-		{
-			if (!deduplication.insert (info.source).second)
-			{
-				/*
-				 * If the deduplication map gets too
-				 * large, clear it out.  This may
-				 * result in some duplicates getting
-				 * sent to the client, but we do not
-				 * want to commit too much memory
-				 */
-				if (deduplication.size () > 4096)
-				{
-					deduplication.clear ();
-				}
-				continue;
-			}
-		}
-
 		result.first = std::unique_ptr<nano::pending_key> (new nano::pending_key (key));
 		result.second = std::unique_ptr<nano::pending_info> (new nano::pending_info (info));
 
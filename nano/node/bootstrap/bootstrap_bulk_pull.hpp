@@ -2,7 +2,9 @@
 
 #include <nano/node/common.hpp>
 #include <nano/node/socket.hpp>
+#include <nano/secure/common.hpp>
 
+#include <deque>
 #include <unordered_set>
 
 namespace nano
@@ -33,6 +35,8 @@ public:
 	void throttled_receive_block ();
 	void received_type ();
 	void received_block (boost::system::error_code const &, size_t, nano::block_type);
+	/** Hands the buffered chain segments over to the block processor, oldest first */
+	void flush_chain ();
 	nano::block_hash first ();
 	std::shared_ptr<nano::bootstrap_client> connection;
 	nano::block_hash expected;
@@ -41,6 +45,10 @@ public:
 	uint64_t pull_blocks;
 	uint64_t unexpected_count;
 	bool network_error{ false };
+	/** Expected blocks of a legacy pull, oldest first. Blocks arrive from the head so the segment is only processed once complete */
+	std::deque<nano::unchecked_info> chain;
+	/** Full segments of the pull that exceeded bootstrap_chain_max, oldest first, up to bootstrap_chain_buffer_max blocks */
+	std::deque<std::deque<nano::unchecked_info>> segments;
 };
 class bulk_pull_account_client final : public std::enable_shared_from_this<nano::bulk_pull_account_client>
 {
@@ -55,12 +63,19 @@ public:
 };
 class bootstrap_server;
 class bulk_pull;
+/**
+ * Serves a bulk_pull request by streaming the chain in batches.
+ * Each batch is read under a single read transaction and holds the stored block bytes, copied without deserializing them.
+ * While one batch is being written to the socket the next one is filled, so at most one write is in flight.
+ */
 class bulk_pull_server final : public std::enable_shared_from_this<nano::bulk_pull_server>
 {
 public:
 	bulk_pull_server (std::shared_ptr<nano::bootstrap_server> const &, std::unique_ptr<nano::bulk_pull>);
 	void set_current_end ();
 	std::shared_ptr<nano::block> get_next ();
+	/** Appends up to batch_size serialized blocks to \p buffer_a, leaving it unchanged once the request is exhausted */
+	void fill_batch (std::vector<uint8_t> & buffer_a);
 	void send_next ();
 	void sent_action (boost::system::error_code const &, size_t);
 	void send_finished ();
@@ -71,14 +86,37 @@ public:
 	bool include_start;
 	nano::bulk_pull::count_t max_count;
 	nano::bulk_pull::count_t sent_count;
+	static size_t constexpr batch_size = 256;
+
+private:
+	/** Returns true if the block at the cursor should be sent, setting \p last_a if it must be the final one */
+	bool cursor_valid (bool & last_a) const;
+	/** Moves the cursor to \p previous_a, or to the end of the request */
+	void cursor_advance (nano::block_hash const & previous_a, bool last_a);
+	/** Fills batches and writes them whenever the socket is free, until a batch is waiting for the write in flight */
+	void fill_and_write ();
+	void write (std::vector<uint8_t> &&);
+	std::mutex mutex;
+	std::vector<uint8_t> prepared;
+	bool prepared_ready{ false };
+	bool write_idle{ true };
 };
 class bulk_pull_account;
+/**
+ * Serves a bulk_pull_account request by streaming the pending entries of the account.
+ * Entries are read in batches under a single read transaction with one store iterator, and each batch is sent with a single socket write.
+ */
 class bulk_pull_account_server final : public std::enable_shared_from_this<nano::bulk_pull_account_server>
 {
 public:
 	bulk_pull_account_server (std::shared_ptr<nano::bootstrap_server> const &, std::unique_ptr<nano::bulk_pull_account>);
 	void set_params ();
 	std::pair<std::unique_ptr<nano::pending_key>, std::unique_ptr<nano::pending_info>> get_next ();
+	/**
+	 * Appends up to batch_size serialized pending entries to \p buffer_a, scanning at most batch_scan_max entries.
+	 * Returns false once the pending entries of the account are exhausted
+	 */
+	bool fill_batch (std::vector<uint8_t> & buffer_a);
 	void send_frontier ();
 	void send_next_block ();
 	void sent_action (boost::system::error_code const &, size_t);
@@ -88,8 +126,17 @@ public:
 	std::unique_ptr<nano::bulk_pull_account> request;
 	std::unordered_set<nano::uint256_union> deduplication;
 	nano::pending_key current_key;
+	/** Position in the pending amounts index, used when a minimum amount is requested */
+	nano::pending_amount_key current_amount_key;
 	bool pending_address_only;
 	bool pending_include_address;
 	bool invalid_request;
+	static size_t constexpr batch_size = 256;
+	static size_t constexpr batch_scan_max = 4096;
+
+private:
+	/** Returns true if the entry passes the minimum amount and, for address only responses, is not a duplicate source */
+	bool entry_valid (nano::pending_info const &);
+	void serialize_entry (nano::stream &, nano::pending_key const &, nano::pending_info const &) const;
 };
 }
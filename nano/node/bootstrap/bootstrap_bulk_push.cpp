@@ -3,8 +3,9 @@
 #include <nano/node/node.hpp>
 #include <nano/node/transport/tcp.hpp>
 
-nano::bulk_push_client::bulk_push_client (std::shared_ptr<nano::bootstrap_client> const & connection_a) :
-connection (connection_a)
+nano::bulk_push_client::bulk_push_client (std::shared_ptr<nano::bootstrap_client> const & connection_a, std::vector<std::pair<nano::block_hash, nano::block_hash>> const & targets_a) :
+connection (connection_a),
+targets (targets_a)
 {
 }
 
@@ -42,11 +43,10 @@ void nano::bulk_push_client::push (nano::transaction const & transaction_a)
 	{
 		if (current_target.first.is_zero () || current_target.first == current_target.second)
 		{
-			nano::lock_guard<std::mutex> guard (connection->attempt->mutex);
-			if (!connection->attempt->bulk_push_targets.empty ())
+			if (!targets.empty ())
 			{
-				current_target = connection->attempt->bulk_push_targets.back ();
-				connection->attempt->bulk_push_targets.pop_back ();
+				current_target = targets.back ();
+				targets.pop_back ();
 			}
 			else
 			{
@@ -10,7 +10,7 @@ class bootstrap_client;
 class bulk_push_client final : public std::enable_shared_from_this<nano::bulk_push_client>
 {
 public:
-	explicit bulk_push_client (std::shared_ptr<nano::bootstrap_client> const &);
+	bulk_push_client (std::shared_ptr<nano::bootstrap_client> const &, std::vector<std::pair<nano::block_hash, nano::block_hash>> const &);
 	~bulk_push_client ();
 	void start ();
 	void push (nano::transaction const &);
@@ -19,6 +19,8 @@ public:
 	std::shared_ptr<nano::bootstrap_client> connection;
 	std::promise<bool> promise;
 	std::pair<nano::block_hash, nano::block_hash> current_target;
+	/** Chains the peer is missing, as pairs of head and end blocks, pushed from the back */
+	std::vector<std::pair<nano::block_hash, nano::block_hash>> targets;
 };
 class bootstrap_server;
 class bulk_push_server final : public std::enable_shared_from_this<nano::bulk_push_server>
@@ -7,15 +7,68 @@ constexpr double nano::bootstrap_limits::bootstrap_connection_warmup_time_sec;
 constexpr double nano::bootstrap_limits::bootstrap_minimum_elapsed_seconds_blockrate;
 constexpr double nano::bootstrap_limits::bootstrap_minimum_frontier_blocks_per_sec;
 constexpr unsigned nano::bootstrap_limits::bulk_push_cost_limit;
+constexpr unsigned nano::bootstrap_limits::bootstrap_frontier_ranges;
+constexpr uint32_t nano::bootstrap_limits::bootstrap_frontier_page_size;
 
 constexpr size_t nano::frontier_req_client::size_frontier;
+constexpr size_t nano::frontier_req_client::pulls_batch_size;
+constexpr size_t nano::frontier_req_server::batch_size;
 
 void nano::frontier_req_client::run ()
+{
+	request_page (start);
+}
+
+nano::frontier_req_client::frontier_req_client (std::shared_ptr<nano::bootstrap_client> connection_a, nano::account const & start_a, nano::account const & end_a) :
+connection (connection_a),
+start (start_a),
+end (end_a),
+current (start_a.is_zero () ? nano::account (0) : nano::account (start_a.number () - 1)),
+count (0),
+bulk_push_cost (0),
+page_size (end_a.is_zero () ? std::numeric_limits<uint32_t>::max () : nano::bootstrap_limits::bootstrap_frontier_page_size)
+{
+	auto transaction (connection->node->store.tx_begin_read ());
+	next (transaction);
+}
+
+void nano::frontier_req_client::add_pull (nano::pull_info const & pull_a)
+{
+	pulls.push_back (pull_a);
+	if (pulls.size () >= pulls_batch_size)
+	{
+		flush_pulls ();
+	}
+}
+
+void nano::frontier_req_client::flush_pulls ()
+{
+	if (!pulls.empty ())
+	{
+		connection->attempt->add_pulls (pulls);
+		pulls.clear ();
+	}
+}
+
+void nano::frontier_req_client::fail ()
+{
+	if (!finished)
+	{
+		finished = true;
+		flush_pulls ();
+		// Another connection resumes the range right after the last frontier processed
+		auto resume (last_account.is_zero () ? start : nano::account (last_account.number () + 1));
+		connection->attempt->frontier_range_finished (resume, end, !range_complete);
+	}
+}
+
+void nano::frontier_req_client::request_page (nano::account const & start_a)
 {
 	nano::frontier_req request;
-	request.start.clear ();
+	request.start = start_a;
 	request.age = std::numeric_limits<decltype (request.age)>::max ();
-	request.count = std::numeric_limits<decltype (request.count)>::max ();
+	request.count = page_size;
+	page_count = 0;
 	auto this_l (shared_from_this ());
 	connection->channel->send (
 	request, [this_l](boost::system::error_code const & ec, size_t size_a) {
@@ -29,25 +82,12 @@ void nano::frontier_req_client::run ()
 			{
 				this_l->connection->node->logger.try_log (boost::str (boost::format ("Error while sending bootstrap request %1%") % ec.message ()));
 			}
+			this_l->fail ();
 		}
 	},
 	false); // is bootstrap traffic is_droppable false
 }
 
-nano::frontier_req_client::frontier_req_client (std::shared_ptr<nano::bootstrap_client> connection_a) :
-connection (connection_a),
-current (0),
-count (0),
-bulk_push_cost (0)
-{
-	auto transaction (connection->node->store.tx_begin_read ());
-	next (transaction);
-}
-
-nano::frontier_req_client::~frontier_req_client ()
-{
-}
-
 void nano::frontier_req_client::receive_frontier ()
 {
 	auto this_l (shared_from_this ());
@@ -66,16 +106,21 @@ void nano::frontier_req_client::receive_frontier ()
 				{
 					this_l->connection->node->logger.try_log (boost::str (boost::format ("Invalid size: expected %1%, got %2%") % nano::frontier_req_client::size_frontier % size_a));
 				}
+				this_l->fail ();
 			}
 		});
 	}
+	else
+	{
+		fail ();
+	}
 }
 
 void nano::frontier_req_client::unsynced (nano::block_hash const & head, nano::block_hash const & end)
 {
 	if (bulk_push_cost < nano::bootstrap_limits::bulk_push_cost_limit)
 	{
-		connection->attempt->add_bulk_push_target (head, end);
+		connection->attempt->add_bulk_push_target (connection, head, end);
 		if (end.is_zero ())
 		{
 			bulk_push_cost += 2;
@@ -87,6 +132,22 @@ void nano::frontier_req_client::unsynced (nano::block_hash const & head, nano::b
 	}
 }
 
+bool nano::frontier_req_client::in_range (nano::account const & account_a) const
+{
+	return end.is_zero () || account_a < end;
+}
+
+void nano::frontier_req_client::range_finish (nano::transaction const & transaction_a)
+{
+	while (!current.is_zero () && in_range (current))
+	{
+		// We know about an account they don't.
+		unsynced (frontier, 0);
+		next (transaction_a);
+	}
+	range_complete = true;
+}
+
 void nano::frontier_req_client::received_frontier (boost::system::error_code const & ec, size_t size_a)
 {
 	if (!ec)
@@ -114,7 +175,7 @@ void nano::frontier_req_client::received_frontier (boost::system::error_code con
 		if (elapsed_sec > nano::bootstrap_limits::bootstrap_connection_warmup_time_sec && blocks_per_sec < nano::bootstrap_limits::bootstrap_minimum_frontier_blocks_per_sec)
 		{
 			connection->node->logger.try_log (boost::str (boost::format ("Aborting frontier req because it was too slow")));
-			promise.set_value (true);
+			fail ();
 			return;
 		}
 		if (connection->attempt->should_log ())
@@ -124,71 +185,86 @@ void nano::frontier_req_client::received_frontier (boost::system::error_code con
 		auto transaction (connection->node->store.tx_begin_read ());
 		if (!account.is_zero ())
 		{
-			while (!current.is_zero () && current < account)
+			++page_count;
+			if (range_complete)
 			{
-				// We know about an account they don't.
-				unsynced (frontier, 0);
-				next (transaction);
+				// Remainder of a page extending past the end of the range, already covered by another request
 			}
-			if (!current.is_zero ())
+			else if (!in_range (account))
+			{
+				range_finish (transaction);
+			}
+			else
 			{
-				if (account == current)
+				while (!current.is_zero () && current < account)
 				{
-					if (latest == frontier)
-					{
-						// In sync
-					}
-					else
+					// We know about an account they don't.
+					unsynced (frontier, 0);
+					next (transaction);
+				}
+				if (!current.is_zero ())
+				{
+					if (account == current)
 					{
-						if (connection->node->store.block_exists (transaction, latest))
+						if (latest == frontier)
 						{
-							// We know about a block they don't.
-							unsynced (frontier, latest);
+							// In sync
 						}
 						else
 						{
-							connection->attempt->add_pull (nano::pull_info (account, latest, frontier, 0, connection->node->network_params.bootstrap.frontier_retry_limit));
-							// Either we're behind or there's a fork we differ on
-							// Either way, bulk pushing will probably not be effective
-							bulk_push_cost += 5;
+							if (connection->node->store.block_exists (transaction, latest))
+							{
+								// We know about a block they don't.
+								unsynced (frontier, latest);
+							}
+							else
+							{
+								add_pull (nano::pull_info (account, latest, frontier, 0, connection->node->network_params.bootstrap.frontier_retry_limit));
+								// Either we're behind or there's a fork we differ on
+								// Either way, bulk pushing will probably not be effective
+								bulk_push_cost += 5;
+							}
 						}
+						next (transaction);
+					}
+					else
+					{
+						assert (account < current);
+						add_pull (nano::pull_info (account, latest, nano::block_hash (0), 0, connection->node->network_params.bootstrap.frontier_retry_limit));
 					}
-					next (transaction);
 				}
 				else
 				{
-					assert (account < current);
-					connection->attempt->add_pull (nano::pull_info (account, latest, nano::block_hash (0), 0, connection->node->network_params.bootstrap.frontier_retry_limit));
+					add_pull (nano::pull_info (account, latest, nano::block_hash (0), 0, connection->node->network_params.bootstrap.frontier_retry_limit));
 				}
-			}
-			else
-			{
-				connection->attempt->add_pull (nano::pull_info (account, latest, nano::block_hash (0), 0, connection->node->network_params.bootstrap.frontier_retry_limit));
+				last_account = account;
 			}
 			receive_frontier ();
 		}
+		else if (!range_complete && page_count == page_size)
+		{
+			// The page was cut short by its count, continue on the same connection after the last frontier
+			flush_pulls ();
+			request_page (last_account.number () + 1);
+		}
 		else
 		{
-			while (!current.is_zero ())
+			if (!range_complete)
 			{
-				// We know about an account they don't.
-				unsynced (frontier, 0);
-				next (transaction);
+				range_finish (transaction);
 			}
 			if (connection->node->config.logging.bulk_pull_logging ())
 			{
 				connection->node->logger.try_log ("Bulk push cost: ", bulk_push_cost);
 			}
+			if (connection->node->config.logging.network_logging ())
 			{
-				try
-				{
-					promise.set_value (false);
-				}
-				catch (std::future_error &)
-				{
-				}
-				connection->attempt->pool_connection (connection);
+				connection->node->logger.try_log (boost::str (boost::format ("Completed frontier request for accounts %1% to %2% from %3%") % start.to_account () % end.to_account () % connection->channel->to_string ()));
 			}
+			finished = true;
+			flush_pulls ();
+			connection->attempt->frontier_range_finished (start, end, false);
+			connection->attempt->pool_connection (connection);
 		}
 	}
 	else
@@ -197,6 +273,7 @@ void nano::frontier_req_client::received_frontier (boost::system::error_code con
 		{
 			connection->node->logger.try_log (boost::str (boost::format ("Error while receiving frontier %1%") % ec.message ()));
 		}
+		fail ();
 	}
 }
 
@@ -233,51 +310,62 @@ frontier (0),
 request (std::move (request_a)),
 count (0)
 {
-	next ();
-}
-
-void nano::frontier_req_server::send_next ()
-{
-	if (!current.is_zero () && count < request->count)
+	if (request->age != std::numeric_limits<decltype (request->age)>::max ())
 	{
-		std::vector<uint8_t> send_buffer;
-		{
-			nano::vectorstream stream (send_buffer);
-			write (stream, current.bytes);
-			write (stream, frontier.bytes);
-		}
-		auto this_l (shared_from_this ());
-		if (connection->node->config.logging.bulk_pull_logging ())
+		auto now (nano::seconds_since_epoch ());
+		auto cutoff (now - std::min<uint64_t> (now, request->age));
+		auto recent_l (connection->node->ledger.age_index.recent (cutoff, request->start, request->count));
+		if (recent_l)
 		{
-			connection->node->logger.try_log (boost::str (boost::format ("Sending frontier for %1% %2%") % current.to_account () % frontier.to_string ()));
+			from_index = true;
+			recent.assign (recent_l->begin (), recent_l->end ());
 		}
-		next ();
-		connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l](boost::system::error_code const & ec, size_t size_a) {
-			this_l->sent_action (ec, size_a);
-		});
-	}
-	else
-	{
-		send_finished ();
 	}
+	next ();
 }
 
-void nano::frontier_req_server::send_finished ()
+void nano::frontier_req_server::send_next ()
 {
 	std::vector<uint8_t> send_buffer;
+	bool finished (false);
 	{
 		nano::vectorstream stream (send_buffer);
-		nano::uint256_union zero (0);
-		write (stream, zero.bytes);
-		write (stream, zero.bytes);
+		for (size_t i (0); i < batch_size && !finished; ++i)
+		{
+			if (!current.is_zero () && count < request->count)
+			{
+				write (stream, current.bytes);
+				write (stream, frontier.bytes);
+				if (connection->node->config.logging.bulk_pull_logging ())
+				{
+					connection->node->logger.try_log (boost::str (boost::format ("Sending frontier for %1% %2%") % current.to_account () % frontier.to_string ()));
+				}
+				++count;
+				next ();
+			}
+			else
+			{
+				nano::uint256_union zero (0);
+				write (stream, zero.bytes);
+				write (stream, zero.bytes);
+				finished = true;
+			}
+		}
 	}
 	auto this_l (shared_from_this ());
-	if (connection->node->config.logging.network_logging ())
+	if (finished && connection->node->config.logging.network_logging ())
 	{
 		connection->node->logger.try_log ("Frontier sending finished");
 	}
-	connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l](boost::system::error_code const & ec, size_t size_a) {
-		this_l->no_block_sent (ec, size_a);
+	connection->socket->async_write (nano::shared_const_buffer (std::move (send_buffer)), [this_l, finished](boost::system::error_code const & ec, size_t size_a) {
+		if (finished)
+		{
+			this_l->no_block_sent (ec, size_a);
+		}
+		else
+		{
+			this_l->sent_action (ec, size_a);
+		}
 	});
 }
 
@@ -300,7 +388,6 @@ void nano::frontier_req_server::sent_action (boost::system::error_code const & e
 {
 	if (!ec)
 	{
-		count++;
 		send_next ();
 	}
 	else
@@ -321,16 +408,31 @@ void nano::frontier_req_server::next ()
 		bool skip_old (request->age != std::numeric_limits<decltype (request->age)>::max ());
 		size_t max_size (128);
 		auto transaction (connection->node->store.tx_begin_read ());
-		for (auto i (connection->node->store.latest_begin (transaction, current.number () + 1)), n (connection->node->store.latest_end ()); i != n && accounts.size () != max_size; ++i)
+		if (from_index)
 		{
-			nano::account_info const & info (i->second);
-			if (!skip_old || (now - info.modified) <= request->age)
+			// Index entries can be stale, the store has the final say
+			for (; !recent.empty () && accounts.size () != max_size; recent.pop_front ())
 			{
-				nano::account const & account (i->first);
-				accounts.emplace_back (account, info.head);
+				nano::account_info info;
+				if (!connection->node->store.account_get (transaction, recent.front (), info) && (now - info.modified) <= request->age)
+				{
+					accounts.emplace_back (recent.front (), info.head);
+				}
 			}
 		}
-		/* If loop breaks before max_size, then latest_end () is reached
+		else
+		{
+			for (auto i (connection->node->store.latest_begin (transaction, current.number () + 1)), n (connection->node->store.latest_end ()); i != n && accounts.size () != max_size; ++i)
+			{
+				nano::account_info const & info (i->second);
+				if (!skip_old || (now - info.modified) <= request->age)
+				{
+					nano::account const & account (i->first);
+					accounts.emplace_back (account, info.head);
+				}
+			}
+		}
+		/* If loop breaks before max_size, then latest_end () or the end of the index candidates is reached
 		Add empty record to finish frontier_req_server */
 		if (accounts.size () != max_size)
 		{
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <nano/node/bootstrap/bootstrap_bulk_pull.hpp>
 #include <nano/node/common.hpp>
 #include <nano/node/socket.hpp>
 
@@ -7,28 +8,51 @@ namespace nano
 {
 class transaction;
 class bootstrap_client;
+/**
+ * Downloads the frontiers of the accounts in [start, end) from a single peer and queues pulls for the ones that differ.
+ * A zero end means the range extends to the last account. Bounded ranges are requested in pages of page_size
+ * frontiers so the connection can be reused once the range is covered; the remainder of a page past the end is skipped.
+ */
 class frontier_req_client final : public std::enable_shared_from_this<nano::frontier_req_client>
 {
 public:
-	explicit frontier_req_client (std::shared_ptr<nano::bootstrap_client>);
-	~frontier_req_client ();
+	frontier_req_client (std::shared_ptr<nano::bootstrap_client>, nano::account const & start_a = nano::account (0), nano::account const & end_a = nano::account (0));
 	void run ();
+	void request_page (nano::account const &);
 	void receive_frontier ();
 	void received_frontier (boost::system::error_code const &, size_t);
 	void unsynced (nano::block_hash const &, nano::block_hash const &);
 	void next (nano::transaction const &);
+	bool in_range (nano::account const &) const;
+	/** Reports the local accounts left in the range as unsynced */
+	void range_finish (nano::transaction const &);
+	void add_pull (nano::pull_info const &);
+	/** Queues the pulls found so far */
+	void flush_pulls ();
+	/** Queues the pulls found so far and requeues the rest of the range after the last frontier processed */
+	void fail ();
 	std::shared_ptr<nano::bootstrap_client> connection;
+	nano::account const start;
+	nano::account const end;
 	nano::account current;
 	nano::block_hash frontier;
 	unsigned count;
 	nano::account landing;
 	nano::account faucet;
 	std::chrono::steady_clock::time_point start_time;
-	std::promise<bool> promise;
 	/** A very rough estimate of the cost of `bulk_push`ing missing blocks */
 	uint64_t bulk_push_cost;
 	std::deque<std::pair<nano::account, nano::block_hash>> accounts;
+	std::vector<nano::pull_info> pulls;
+	uint32_t const page_size;
+	uint32_t page_count{ 0 };
+	/** Last frontier received within the range, requests resume after it */
+	nano::account last_account{ 0 };
+	bool range_complete{ false };
+	bool finished{ false };
 	static size_t constexpr size_frontier = sizeof (nano::account) + sizeof (nano::block_hash);
+	/** Pulls are queued in batches of this size, shuffled so that neighbouring accounts are pulled from different peers */
+	static size_t constexpr pulls_batch_size = 1024;
 };
 class bootstrap_server;
 class frontier_req;
@@ -36,9 +60,9 @@ class frontier_req_server final : public std::enable_shared_from_this<nano::fron
 {
 public:
 	frontier_req_server (std::shared_ptr<nano::bootstrap_server> const &, std::unique_ptr<nano::frontier_req>);
+	/** Writes up to batch_size frontiers in a single buffer, followed by the terminating zero pair once the request is exhausted */
 	void send_next ();
 	void sent_action (boost::system::error_code const &, size_t);
-	void send_finished ();
 	void no_block_sent (boost::system::error_code const &, size_t);
 	void next ();
 	std::shared_ptr<nano::bootstrap_server> connection;
@@ -47,5 +71,9 @@ public:
 	std::unique_ptr<nano::frontier_req> request;
 	size_t count;
 	std::deque<std::pair<nano::account, nano::block_hash>> accounts;
+	/** Candidates from the ledger age index, used instead of scanning every account when the request sets an age */
+	std::deque<nano::account> recent;
+	bool from_index{ false };
+	static size_t constexpr batch_size = 1024;
 };
 }
@@ -347,15 +347,29 @@ void nano::bootstrap_server::receive_publish_action (boost::system::error_code c
 {
 	if (!ec)
 	{
-		auto error (false);
-		nano::bufferstream stream (receive_buffer->data (), size_a);
-		std::unique_ptr<nano::publish> request (new nano::publish (error, stream, header_a));
-		if (!error)
+		nano::uint128_t digest;
+		if (!node->network.publish_filter.apply (receive_buffer->data (), size_a, &digest))
 		{
-			if (is_realtime_connection ())
+			auto error (false);
+			nano::bufferstream stream (receive_buffer->data (), size_a);
+			std::unique_ptr<nano::publish> request (new nano::publish (error, stream, header_a));
+			if (!error)
 			{
-				add_request (std::unique_ptr<nano::message> (request.release ()));
+				request->digest = digest;
+				if (is_realtime_connection ())
+				{
+					add_request (std::unique_ptr<nano::message> (request.release ()));
+				}
+				receive ();
 			}
+			else
+			{
+				node->network.publish_filter.clear (digest);
+			}
+		}
+		else
+		{
+			node->stats.inc (nano::stat::type::filter, nano::stat::detail::duplicate_publish);
 			receive ();
 		}
 	}
@@ -4,6 +4,7 @@
 #include <nano/node/common.hpp>
 #include <nano/node/daemonconfig.hpp>
 #include <nano/node/node.hpp>
+#include <nano/secure/ledger_snapshot.hpp>
 
 namespace
 {
@@ -43,6 +44,8 @@ void nano::add_node_options (boost::program_options::options_description & descr
 	("account_key", "Get the public key for <account>")
 	("vacuum", "Compact database. If data_path is missing, the database in data directory is compacted.")
 	("snapshot", "Compact database and create snapshot, functions similar to vacuum but does not replace the existing database")
+	("ledger_export", "Write a checksummed image of the ledger tables to <file>, which can be loaded by ledger_import")
+	("ledger_import", "Replace the ledger of an initialized database in data_path with the image in <file>. The node must not be running")
 	("data_path", boost::program_options::value<std::string> (), "Use the supplied path as the data directory")
 	("network", boost::program_options::value<std::string> (), "Use the supplied network (live, beta or test)")
 	("clear_send_ids", "Remove all send IDs from the database (dangerous: not intended for production use)")
@@ -90,6 +93,7 @@ void nano::add_node_flag_options (boost::program_options::options_description &
 		("disable_unchecked_cleanup", "Disables periodic cleanup of old records from unchecked table")
 		("disable_unchecked_drop", "Disables drop of unchecked table at startup")
 		("fast_bootstrap", "Increase bootstrap speed for high end nodes with higher limits")
+		("read_replica", "Open the ledger of a node running in another process read-only and only serve RPC and IPC queries. Ports used by the other node must be changed with --config")
 		("batch_size", boost::program_options::value<std::size_t>(), "Increase sideband batch size, default 512")
 		("block_processor_batch_size", boost::program_options::value<std::size_t>(), "Increase block processor transaction batch write size, default 0 (limited by config block_processor_batch_max_time), 256k for fast_bootstrap")
 		("block_processor_full_size", boost::program_options::value<std::size_t>(), "Increase block processor allowed blocks queue size before dropping live network packets and holding bootstrap download, default 65536, 1 million for fast_bootstrap")
@@ -119,6 +123,11 @@ std::error_code nano::update_flags (nano::node_flags & flags_a, boost::program_o
 	flags_a.disable_unchecked_cleanup = (vm.count ("disable_unchecked_cleanup") > 0);
 	flags_a.disable_unchecked_drop = (vm.count ("disable_unchecked_drop") > 0);
 	flags_a.fast_bootstrap = (vm.count ("fast_bootstrap") > 0);
+	flags_a.read_replica = (vm.count ("read_replica") > 0);
+	if (flags_a.read_replica)
+	{
+		flags_a.read_only = true;
+	}
 	if (flags_a.fast_bootstrap)
 	{
 		flags_a.block_processor_batch_size = 256 * 1024;
@@ -393,6 +402,71 @@ std::error_code nano::handle_node_options (boost::program_options::variables_map
 			std::cerr << "Snapshot failed (unknown reason)" << std::endl;
 		}
 	}
+	else if (vm.count ("ledger_export"))
+	{
+		if (vm.count ("file") == 1)
+		{
+			boost::filesystem::path data_path = vm.count ("data_path") ? boost::filesystem::path (vm["data_path"].as<std::string> ()) : nano::working_path ();
+			nano::inactive_node node (data_path, 24000);
+			if (!node.node->init_error ())
+			{
+				std::ofstream stream (vm["file"].as<std::string> (), std::ios::binary);
+				std::cout << "Exporting ledger, this may take a while..." << std::endl;
+				if (stream.is_open () && !nano::ledger_snapshot::write (node.node->store, stream))
+				{
+					std::cout << "Ledger exported to " << vm["file"].as<std::string> () << std::endl;
+				}
+				else
+				{
+					std::cerr << "Unable to write ledger snapshot" << std::endl;
+					ec = nano::error_cli::generic;
+				}
+			}
+			else
+			{
+				ec = nano::error_cli::generic;
+			}
+		}
+		else
+		{
+			std::cerr << "ledger_export requires one <file> option" << std::endl;
+			ec = nano::error_cli::invalid_arguments;
+		}
+	}
+	else if (vm.count ("ledger_import"))
+	{
+		if (vm.count ("file") == 1)
+		{
+			boost::filesystem::path data_path = vm.count ("data_path") ? boost::filesystem::path (vm["data_path"].as<std::string> ()) : nano::working_path ();
+			auto node_flags = nano::inactive_node_flag_defaults ();
+			node_flags.read_only = false;
+			nano::inactive_node node (data_path, 24000, node_flags);
+			if (!node.node->init_error ())
+			{
+				std::ifstream stream (vm["file"].as<std::string> (), std::ios::binary);
+				std::string error;
+				std::cout << "Importing ledger, this may take a while..." << std::endl;
+				if (stream.is_open () && !nano::ledger_snapshot::read (node.node->store, stream, error))
+				{
+					std::cout << "Ledger imported" << std::endl;
+				}
+				else
+				{
+					std::cerr << "Ledger import failed: " << (error.empty () ? "unable to read file" : error) << std::endl;
+					ec = nano::error_cli::generic;
+				}
+			}
+			else
+			{
+				database_write_lock_error (ec);
+			}
+		}
+		else
+		{
+			std::cerr << "ledger_import requires one <file> option" << std::endl;
+			ec = nano::error_cli::invalid_arguments;
+		}
+	}
 	else if (vm.count ("unchecked_clear"))
 	{
 		boost::filesystem::path data_path = vm.count ("data_path") ? boost::filesystem::path (vm["data_path"].as<std::string> ()) : nano::working_path ();
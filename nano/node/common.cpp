@@ -4,12 +4,14 @@
 #include <nano/node/common.hpp>
 #include <nano/node/election.hpp>
 #include <nano/node/wallet.hpp>
+#include <nano/secure/network_filter.hpp>
 
 #include <boost/endian/conversion.hpp>
 #include <boost/pool/pool_alloc.hpp>
 
 std::bitset<16> constexpr nano::message_header::block_type_mask;
 std::bitset<16> constexpr nano::message_header::count_mask;
+size_t constexpr nano::message_header::size;
 namespace
 {
 nano::protocol_constants const & get_protocol_constants ()
@@ -257,6 +259,10 @@ std::string nano::message_parser::status_string ()
 		{
 			return "invalid_network";
 		}
+		case nano::message_parser::parse_status::duplicate_publish_message:
+		{
+			return "duplicate_publish_message";
+		}
 	}
 
 	assert (false);
@@ -264,7 +270,8 @@ std::string nano::message_parser::status_string ()
 	return "[unknown parse_status]";
 }
 
-nano::message_parser::message_parser (nano::block_uniquer & block_uniquer_a, nano::vote_uniquer & vote_uniquer_a, nano::message_visitor & visitor_a, nano::work_pool & pool_a) :
+nano::message_parser::message_parser (nano::network_filter & publish_filter_a, nano::block_uniquer & block_uniquer_a, nano::vote_uniquer & vote_uniquer_a, nano::message_visitor & visitor_a, nano::work_pool & pool_a) :
+publish_filter (publish_filter_a),
 block_uniquer (block_uniquer_a),
 vote_uniquer (vote_uniquer_a),
 visitor (visitor_a),
@@ -300,7 +307,16 @@ void nano::message_parser::deserialize_buffer (uint8_t const * buffer_a, size_t
 					}
 					case nano::message_type::publish:
 					{
-						deserialize_publish (stream, header);
+						// Early filtering to not waste time deserializing and validating work of duplicate blocks
+						nano::uint128_t digest;
+						if (!publish_filter.apply (buffer_a + nano::message_header::size, size_a - nano::message_header::size, &digest))
+						{
+							deserialize_publish (stream, header, digest);
+						}
+						else
+						{
+							status = parse_status::duplicate_publish_message;
+						}
 						break;
 					}
 					case nano::message_type::confirm_req:
@@ -347,7 +363,7 @@ void nano::message_parser::deserialize_keepalive (nano::stream & stream_a, nano:
 	}
 }
 
-void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::message_header const & header_a)
+void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::message_header const & header_a, nano::uint128_t const & digest_a)
 {
 	auto error (false);
 	nano::publish incoming (error, stream_a, header_a, &block_uniquer);
@@ -355,6 +371,7 @@ void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::m
 	{
 		if (!nano::work_validate (*incoming.block))
 		{
+			incoming.digest = digest_a;
 			visitor.publish (incoming);
 		}
 		else
@@ -366,6 +383,11 @@ void nano::message_parser::deserialize_publish (nano::stream & stream_a, nano::m
 	{
 		status = parse_status::invalid_publish_message;
 	}
+	if (status != parse_status::success)
+	{
+		// Allow a well formed retransmission to be processed
+		publish_filter.clear (digest_a);
+	}
 }
 
 void nano::message_parser::deserialize_confirm_req (nano::stream & stream_a, nano::message_header const & header_a)
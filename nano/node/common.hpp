@@ -223,6 +223,9 @@ public:
 	/** Size of the payload in bytes. For some messages, the payload size is based on header flags. */
 	size_t payload_length_bytes () const;
 
+	/** Size of the serialized header in bytes */
+	static size_t constexpr size = sizeof (std::array<uint8_t, 2>) + sizeof (uint8_t) * 3 + sizeof (nano::message_type) + sizeof (uint16_t);
+
 	static std::bitset<16> constexpr block_type_mask = std::bitset<16> (0x0f00);
 	static std::bitset<16> constexpr count_mask = std::bitset<16> (0xf000);
 };
@@ -247,6 +250,7 @@ public:
 	}
 	nano::message_header header;
 };
+class network_filter;
 class work_pool;
 class message_parser final
 {
@@ -264,16 +268,18 @@ public:
 		invalid_node_id_handshake_message,
 		outdated_version,
 		invalid_magic,
-		invalid_network
+		invalid_network,
+		duplicate_publish_message
 	};
-	message_parser (nano::block_uniquer &, nano::vote_uniquer &, nano::message_visitor &, nano::work_pool &);
+	message_parser (nano::network_filter &, nano::block_uniquer &, nano::vote_uniquer &, nano::message_visitor &, nano::work_pool &);
 	void deserialize_buffer (uint8_t const *, size_t);
 	void deserialize_keepalive (nano::stream &, nano::message_header const &);
-	void deserialize_publish (nano::stream &, nano::message_header const &);
+	void deserialize_publish (nano::stream &, nano::message_header const &, nano::uint128_t const & = 0);
 	void deserialize_confirm_req (nano::stream &, nano::message_header const &);
 	void deserialize_confirm_ack (nano::stream &, nano::message_header const &);
 	void deserialize_node_id_handshake (nano::stream &, nano::message_header const &);
 	bool at_end (nano::stream &);
+	nano::network_filter & publish_filter;
 	nano::block_uniquer & block_uniquer;
 	nano::vote_uniquer & vote_uniquer;
 	nano::message_visitor & visitor;
@@ -304,6 +310,8 @@ public:
 	bool deserialize (nano::stream &, nano::block_uniquer * = nullptr);
 	bool operator== (nano::publish const &) const;
 	std::shared_ptr<nano::block> block;
+	// Digest of the serialized block as inserted in the network publish filter, zero if not filtered
+	nano::uint128_t digest{ 0 };
 };
 class confirm_req final : public message
 {
@@ -14,6 +14,7 @@
 
 #include <cassert>
 #include <numeric>
+#include <unordered_map>
 
 nano::confirmation_height_processor::confirmation_height_processor (nano::pending_confirmation_height & pending_confirmation_height_a, nano::ledger & ledger_a, nano::active_transactions & active_a, nano::write_database_queue & write_database_queue_a, std::chrono::milliseconds batch_separate_pending_min_time_a, nano::logger_mt & logger_a) :
 pending_confirmations (pending_confirmation_height_a),
@@ -297,39 +298,19 @@ bool nano::confirmation_height_processor::write_pending (std::deque<conf_height_
 	});
 
 	// Write in batches
-	while (total_pending_write_block_count > 0)
+	auto error (false);
+	while (total_pending_write_block_count > 0 && !error)
 	{
-		uint64_t num_accounts_processed = 0;
-		auto transaction (ledger.store.tx_begin_write ({}, { nano::tables::confirmation_height }));
-		while (!all_pending_a.empty ())
+		// Commit changes periodically to reduce time holding write locks for long chains
+		std::vector<uint64_t> confirmation_heights;
+		// Locked as the block processor also writes confirmation heights when accounts are opened or rolled back
+		auto transaction (ledger.store.tx_begin_write ({ nano::tables::confirmation_height }));
+		error = write_batch (transaction, all_pending_a, confirmation_heights);
+		for (auto confirmation_height : confirmation_heights)
 		{
-			const auto & pending = all_pending_a.front ();
-			uint64_t confirmation_height;
-			auto error = ledger.store.confirmation_height_get (transaction, pending.account, confirmation_height);
-			release_assert (!error);
+			auto const & pending = all_pending_a.front ();
 			if (pending.height > confirmation_height)
 			{
-#ifndef NDEBUG
-				// Do more thorough checking in Debug mode, indicates programming error.
-				nano::block_sideband sideband;
-				auto block = ledger.store.block_get (transaction, pending.hash, &sideband);
-				static nano::network_constants network_constants;
-				assert (network_constants.is_test_network () || block != nullptr);
-				assert (network_constants.is_test_network () || sideband.height == pending.height);
-#else
-				auto block = ledger.store.block_get (transaction, pending.hash);
-#endif
-				// Check that the block still exists as there may have been changes outside this processor.
-				if (!block)
-				{
-					logger.always_log ("Failed to write confirmation height for: ", pending.hash.to_string ());
-					ledger.stats.inc (nano::stat::type::confirmation_height, nano::stat::detail::invalid_block);
-					receive_source_pairs.clear ();
-					receive_source_pairs_size = 0;
-					all_pending_a.clear ();
-					return true;
-				}
-
 				for (auto & callback_data : pending.block_callbacks_required)
 				{
 					active.post_confirmation_height_set (transaction, callback_data.block, callback_data.sideband, callback_data.election_status_type);
@@ -337,23 +318,107 @@ bool nano::confirmation_height_processor::write_pending (std::deque<conf_height_
 
 				ledger.stats.add (nano::stat::type::confirmation_height, nano::stat::detail::blocks_confirmed, nano::stat::dir::in, pending.height - confirmation_height);
 				assert (pending.num_blocks_confirmed == pending.height - confirmation_height);
-				confirmation_height = pending.height;
 				ledger.cemented_count += pending.num_blocks_confirmed;
-				ledger.store.confirmation_height_put (transaction, pending.account, confirmation_height);
 			}
 			total_pending_write_block_count -= pending.num_blocks_confirmed;
-			++num_accounts_processed;
-			all_pending_a.erase (all_pending_a.begin ());
+			all_pending_a.pop_front ();
+		}
+	}
+	if (error)
+	{
+		ledger.stats.inc (nano::stat::type::confirmation_height, nano::stat::detail::invalid_block);
+		receive_source_pairs.clear ();
+		receive_source_pairs_size = 0;
+		all_pending_a.clear ();
+	}
+	assert (all_pending_a.empty ());
+	return error;
+}
 
-			if (num_accounts_processed >= batch_write_size)
+/*
+ * Writes the confirmation heights of up to batch_write_size pending accounts and collects their previous confirmation heights.
+ * Returns true if one of the blocks no longer exists, the accounts before it are still written
+ */
+bool nano::confirmation_height_processor::write_batch (nano::write_transaction const & transaction_a, std::deque<conf_height_details> const & all_pending_a, std::vector<uint64_t> & confirmation_heights_a)
+{
+	auto error (false);
+	confirmation_heights_a.clear ();
+	// Blocks of the accounts which need writing are looked up together
+	auto batch_size (std::min<size_t> (all_pending_a.size (), batch_write_size));
+	auto not_fetched (std::numeric_limits<size_t>::max ());
+	std::vector<size_t> fetched (batch_size, not_fetched);
+	std::vector<nano::block_hash> hashes;
+	// Confirmation heights read here are kept up to date with the writes below, an account may be pending more than once
+	std::unordered_map<nano::account, uint64_t> confirmation_heights;
+	for (size_t i (0); i < batch_size; ++i)
+	{
+		auto existing (confirmation_heights.find (all_pending_a[i].account));
+		if (existing == confirmation_heights.end ())
+		{
+			uint64_t confirmation_height;
+			auto error_l = ledger.store.confirmation_height_get (transaction_a, all_pending_a[i].account, confirmation_height);
+			release_assert (!error_l);
+			existing = confirmation_heights.emplace (all_pending_a[i].account, confirmation_height).first;
+		}
+		if (all_pending_a[i].height > existing->second)
+		{
+			fetched[i] = hashes.size ();
+			hashes.push_back (all_pending_a[i].hash);
+		}
+	}
+	std::vector<nano::block_sideband> sidebands;
+	auto blocks (ledger.store.blocks_get (transaction_a, hashes, &sidebands));
+	for (size_t i (0); i < all_pending_a.size () && !error && confirmation_heights_a.size () < batch_write_size; ++i)
+	{
+		auto const & pending (all_pending_a[i]);
+		uint64_t confirmation_height;
+		auto existing (confirmation_heights.find (pending.account));
+		if (existing != confirmation_heights.end ())
+		{
+			confirmation_height = existing->second;
+		}
+		else
+		{
+			auto error_l = ledger.store.confirmation_height_get (transaction_a, pending.account, confirmation_height);
+			release_assert (!error_l);
+		}
+		if (pending.height > confirmation_height)
+		{
+			nano::block_sideband sideband;
+			std::shared_ptr<nano::block> block;
+			if (i < batch_size && fetched[i] != not_fetched)
+			{
+				block = blocks[fetched[i]];
+				sideband = sidebands[fetched[i]];
+			}
+			else
 			{
-				// Commit changes periodically to reduce time holding write locks for long chains
-				break;
+				block = ledger.store.block_get (transaction_a, pending.hash, &sideband);
+			}
+#ifndef NDEBUG
+			// Do more thorough checking in Debug mode, indicates programming error.
+			static nano::network_constants network_constants;
+			assert (network_constants.is_test_network () || block != nullptr);
+			assert (network_constants.is_test_network () || sideband.height == pending.height);
+#endif
+			// Check that the block still exists as there may have been changes outside this processor.
+			error = block == nullptr;
+			if (!error)
+			{
+				ledger.store.confirmation_height_put (transaction_a, pending.account, pending.height);
+				confirmation_heights[pending.account] = pending.height;
+			}
+			else
+			{
+				logger.always_log ("Failed to write confirmation height for: ", pending.hash.to_string ());
 			}
 		}
+		if (!error)
+		{
+			confirmation_heights_a.push_back (confirmation_height);
+		}
 	}
-	assert (all_pending_a.empty ());
-	return false;
+	return error;
 }
 
 void nano::confirmation_height_processor::collect_unconfirmed_receive_and_sources_for_account (uint64_t block_height_a, uint64_t confirmation_height_a, nano::block_hash const & hash_a, nano::account const & account_a, nano::read_transaction const & transaction_a, std::vector<callback_data> & block_callbacks_required)
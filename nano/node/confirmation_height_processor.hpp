@@ -116,6 +116,7 @@ private:
 	void add_confirmation_height (nano::block_hash const &);
 	void collect_unconfirmed_receive_and_sources_for_account (uint64_t, uint64_t, nano::block_hash const &, nano::account const &, nano::read_transaction const &, std::vector<callback_data> &);
 	bool write_pending (std::deque<conf_height_details> &);
+	bool write_batch (nano::write_transaction const &, std::deque<conf_height_details> const &, std::vector<uint64_t> &);
 
 	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (confirmation_height_processor &, const std::string &);
 	friend class confirmation_height_pending_observer_callbacks_Test;
@@ -23,6 +23,7 @@
 #include <future>
 #include <iostream>
 #include <thread>
+#include <unordered_set>
 
 namespace
 {
@@ -30,6 +31,8 @@ void construct_json (nano::seq_con_info_component * component, boost::property_t
 using ipc_json_handler_no_arg_func_map = std::unordered_map<std::string, std::function<void(nano::json_handler *)>>;
 ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ();
 auto ipc_json_handler_no_arg_funcs = create_ipc_json_handler_no_arg_func_map ();
+/** Actions which do not write the ledger, the wallets or the node configuration, a read replica leaves writes and the network to the node it follows */
+std::unordered_set<std::string> const read_replica_actions{ "account_balance", "account_block_count", "account_count", "account_get", "account_history", "account_info", "account_key", "account_list", "account_representative", "account_weight", "accounts_balances", "accounts_frontiers", "accounts_pending", "active_difficulty", "available_supply", "block", "block_account", "block_count", "block_count_type", "block_create", "block_hash", "block_info", "blocks", "blocks_info", "bootstrap_status", "chain", "confirmation_active", "confirmation_height_currently_processing", "confirmation_history", "confirmation_info", "confirmation_quorum", "database_txn_tracker", "delegators", "delegators_count", "deterministic_key", "frontier_count", "frontiers", "history", "key_create", "key_expand", "krai_from_raw", "krai_to_raw", "ledger", "mrai_from_raw", "mrai_to_raw", "node_id", "password_valid", "peers", "peers_stats", "pending", "pending_exists", "rai_from_raw", "rai_to_raw", "receive_minimum", "representatives", "representatives_online", "sign", "stats", "stats_clear", "stop", "successors", "unchecked", "unchecked_get", "unchecked_keys", "unopened", "uptime", "validate_account_number", "version", "wallet_balance_total", "wallet_balances", "wallet_contains", "wallet_export", "wallet_frontiers", "wallet_history", "wallet_info", "wallet_key_valid", "wallet_ledger", "wallet_locked", "wallet_pending", "wallet_representative", "wallet_seed", "wallet_work_get", "work_cancel", "work_generate", "work_get", "work_peers", "work_validate" };
 bool block_confirmed (nano::node & node, nano::transaction & transaction, nano::block_hash const & hash, bool include_active, bool include_only_confirmed);
 const char * epoch_as_string (nano::epoch);
 }
@@ -51,7 +54,12 @@ void nano::json_handler::process_request (bool unsafe_a)
 		boost::property_tree::read_json (istream, request);
 		action = request.get<std::string> ("action");
 		auto no_arg_func_iter = ipc_json_handler_no_arg_funcs.find (action);
-		if (no_arg_func_iter != ipc_json_handler_no_arg_funcs.cend ())
+		if (node.flags.read_replica && read_replica_actions.count (action) == 0)
+		{
+			ec = nano::error_rpc::disabled_read_replica;
+			response_errors ();
+		}
+		else if (no_arg_func_iter != ipc_json_handler_no_arg_funcs.cend ())
 		{
 			// First try the map of options with no arguments
 			no_arg_func_iter->second (this);
@@ -228,6 +236,20 @@ nano::account nano::json_handler::account_impl (std::string account_text, std::e
 	return result;
 }
 
+std::vector<nano::account> nano::json_handler::accounts_impl ()
+{
+	std::vector<nano::account> result;
+	for (auto & accounts : request.get_child ("accounts"))
+	{
+		auto account (account_impl (accounts.second.data ()));
+		if (!ec)
+		{
+			result.push_back (account);
+		}
+	}
+	return result;
+}
+
 nano::account_info nano::json_handler::account_info_impl (nano::transaction const & transaction_a, nano::account const & account_a)
 {
 	nano::account_info result;
@@ -766,16 +788,18 @@ void nano::json_handler::account_weight ()
 void nano::json_handler::accounts_balances ()
 {
 	boost::property_tree::ptree balances;
-	for (auto & accounts : request.get_child ("accounts"))
+	auto accounts_l (accounts_impl ());
+	if (!ec)
 	{
-		auto account (account_impl (accounts.second.data ()));
-		if (!ec)
+		auto transaction (node.store.tx_begin_read ());
+		auto infos (node.store.accounts_get (transaction, accounts_l));
+		for (size_t i (0); i < accounts_l.size (); ++i)
 		{
 			boost::property_tree::ptree entry;
-			auto balance (node.balance_pending (account));
-			entry.put ("balance", balance.first.convert_to<std::string> ());
-			entry.put ("pending", balance.second.convert_to<std::string> ());
-			balances.push_back (std::make_pair (account.to_account (), entry));
+			nano::uint128_t balance (infos[i] ? infos[i]->balance.number () : 0);
+			entry.put ("balance", balance.convert_to<std::string> ());
+			entry.put ("pending", node.ledger.account_pending (transaction, accounts_l[i]).convert_to<std::string> ());
+			balances.push_back (std::make_pair (accounts_l[i].to_account (), entry));
 		}
 	}
 	response_l.add_child ("balances", balances);
@@ -811,16 +835,16 @@ void nano::json_handler::accounts_create ()
 void nano::json_handler::accounts_frontiers ()
 {
 	boost::property_tree::ptree frontiers;
-	auto transaction (node.store.tx_begin_read ());
-	for (auto & accounts : request.get_child ("accounts"))
+	auto accounts_l (accounts_impl ());
+	if (!ec)
 	{
-		auto account (account_impl (accounts.second.data ()));
-		if (!ec)
+		auto transaction (node.store.tx_begin_read ());
+		auto infos (node.store.accounts_get (transaction, accounts_l));
+		for (size_t i (0); i < accounts_l.size (); ++i)
 		{
-			auto latest (node.ledger.latest (transaction, account));
-			if (!latest.is_zero ())
+			if (infos[i])
 			{
-				frontiers.put (account.to_account (), latest.to_string ());
+				frontiers.put (accounts_l[i].to_account (), infos[i]->head.to_string ());
 			}
 		}
 	}
@@ -845,50 +869,41 @@ void nano::json_handler::accounts_pending ()
 		if (!ec)
 		{
 			boost::property_tree::ptree peers_l;
-			for (auto i (node.store.pending_begin (transaction, nano::pending_key (account, 0))); nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
+			if (simple)
 			{
-				nano::pending_key const & key (i->first);
-				if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
+				for (auto i (node.store.pending_begin (transaction, account)), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
 				{
-					if (simple)
+					nano::pending_key const & key (i->first);
+					if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
 					{
 						boost::property_tree::ptree entry;
 						entry.put ("", key.hash.to_string ());
 						peers_l.push_back (std::make_pair ("", entry));
 					}
-					else
-					{
-						nano::pending_info const & info (i->second);
-						if (info.amount.number () >= threshold.number ())
-						{
-							if (source)
-							{
-								boost::property_tree::ptree pending_tree;
-								pending_tree.put ("amount", info.amount.number ().convert_to<std::string> ());
-								pending_tree.put ("source", info.source.to_account ());
-								peers_l.add_child (key.hash.to_string (), pending_tree);
-							}
-							else
-							{
-								peers_l.put (key.hash.to_string (), info.amount.number ().convert_to<std::string> ());
-							}
-						}
-					}
 				}
 			}
-			if (sorting && !simple)
+			else
 			{
-				if (source)
-				{
-					peers_l.sort ([](const auto & child1, const auto & child2) -> bool {
-						return child1.second.template get<nano::uint128_t> ("amount") > child2.second.template get<nano::uint128_t> ("amount");
-					});
-				}
-				else
+				// Entries are sorted by decreasing amount, the scan stops at the first one below the threshold
+				for (auto i (node.store.pending_amounts_begin (transaction, account)), n (node.store.pending_amounts_end ()); i != n && nano::pending_amount_key (i->first).account == account && nano::pending_amount_key (i->first).amount ().number () >= threshold.number () && peers_l.size () < count; ++i)
 				{
-					peers_l.sort ([](const auto & child1, const auto & child2) -> bool {
-						return child1.second.template get<nano::uint128_t> ("") > child2.second.template get<nano::uint128_t> ("");
-					});
+					nano::pending_amount_key const & key (i->first);
+					if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
+					{
+						if (source)
+						{
+							nano::pending_info info;
+							node.store.pending_get (transaction, key.pending (), info);
+							boost::property_tree::ptree pending_tree;
+							pending_tree.put ("amount", key.amount ().number ().convert_to<std::string> ());
+							pending_tree.put ("source", info.source.to_account ());
+							peers_l.add_child (key.hash.to_string (), pending_tree);
+						}
+						else
+						{
+							peers_l.put (key.hash.to_string (), key.amount ().number ().convert_to<std::string> ());
+						}
+					}
 				}
 			}
 			pending.add_child (account.to_account (), peers_l);
@@ -1104,88 +1119,98 @@ void nano::json_handler::blocks_info ()
 
 	boost::property_tree::ptree blocks;
 	boost::property_tree::ptree blocks_not_found;
-	auto transaction (node.store.tx_begin_read ());
-	for (boost::property_tree::ptree::value_type & hashes : request.get_child ("hashes"))
+	std::vector<std::string> hashes_text;
+	std::vector<nano::block_hash> hashes;
+	for (boost::property_tree::ptree::value_type & hashes_l : request.get_child ("hashes"))
 	{
 		if (!ec)
 		{
-			std::string hash_text = hashes.second.data ();
-			nano::block_hash hash;
-			if (!hash.decode_hex (hash_text))
+			hashes_text.push_back (hashes_l.second.data ());
+			hashes.emplace_back ();
+			if (hashes.back ().decode_hex (hashes_text.back ()))
 			{
-				nano::block_sideband sideband;
-				auto block (node.store.block_get (transaction, hash, &sideband));
-				if (block != nullptr)
-				{
-					boost::property_tree::ptree entry;
-					nano::account account (block->account ().is_zero () ? sideband.account : block->account ());
-					entry.put ("block_account", account.to_account ());
-					auto amount (node.ledger.amount (transaction, hash));
-					entry.put ("amount", amount.convert_to<std::string> ());
-					auto balance (node.ledger.balance (transaction, hash));
-					entry.put ("balance", balance.convert_to<std::string> ());
-					entry.put ("height", std::to_string (sideband.height));
-					entry.put ("local_timestamp", std::to_string (sideband.timestamp));
-					auto confirmed (node.ledger.block_confirmed (transaction, hash));
-					entry.put ("confirmed", confirmed);
+				ec = nano::error_blocks::bad_hash_number;
+			}
+		}
+	}
+	auto transaction (node.store.tx_begin_read ());
+	std::vector<std::shared_ptr<nano::block>> blocks_l;
+	std::vector<nano::block_sideband> sidebands;
+	if (!ec)
+	{
+		blocks_l = node.store.blocks_get (transaction, hashes, &sidebands);
+	}
+	for (size_t i (0); i < blocks_l.size () && !ec; ++i)
+	{
+		auto const & hash_text (hashes_text[i]);
+		auto const & hash (hashes[i]);
+		auto const & block (blocks_l[i]);
+		auto const & sideband (sidebands[i]);
+		if (block != nullptr)
+		{
+			boost::property_tree::ptree entry;
+			nano::account account (block->account ().is_zero () ? sideband.account : block->account ());
+			entry.put ("block_account", account.to_account ());
+			auto amount (node.ledger.amount (transaction, hash));
+			entry.put ("amount", amount.convert_to<std::string> ());
+			auto balance (node.ledger.balance (transaction, hash));
+			entry.put ("balance", balance.convert_to<std::string> ());
+			entry.put ("height", std::to_string (sideband.height));
+			entry.put ("local_timestamp", std::to_string (sideband.timestamp));
+			auto confirmed (node.ledger.block_confirmed (transaction, hash));
+			entry.put ("confirmed", confirmed);
 
-					if (json_block_l)
-					{
-						boost::property_tree::ptree block_node_l;
-						block->serialize_json (block_node_l);
-						entry.add_child ("contents", block_node_l);
-					}
-					else
-					{
-						std::string contents;
-						block->serialize_json (contents);
-						entry.put ("contents", contents);
-					}
-					if (block->type () == nano::block_type::state)
-					{
-						state_subtype (transaction, node, block, balance, entry);
-					}
-					if (pending)
-					{
-						bool exists (false);
-						auto destination (node.ledger.block_destination (transaction, *block));
-						if (!destination.is_zero ())
-						{
-							exists = node.store.pending_exists (transaction, nano::pending_key (destination, hash));
-						}
-						entry.put ("pending", exists ? "1" : "0");
-					}
-					if (source)
-					{
-						nano::block_hash source_hash (node.ledger.block_source (transaction, *block));
-						auto block_a (node.store.block_get (transaction, source_hash));
-						if (block_a != nullptr)
-						{
-							auto source_account (node.ledger.account (transaction, source_hash));
-							entry.put ("source_account", source_account.to_account ());
-						}
-						else
-						{
-							entry.put ("source_account", "0");
-						}
-					}
-					blocks.push_back (std::make_pair (hash_text, entry));
+			if (json_block_l)
+			{
+				boost::property_tree::ptree block_node_l;
+				block->serialize_json (block_node_l);
+				entry.add_child ("contents", block_node_l);
+			}
+			else
+			{
+				std::string contents;
+				block->serialize_json (contents);
+				entry.put ("contents", contents);
+			}
+			if (block->type () == nano::block_type::state)
+			{
+				state_subtype (transaction, node, block, balance, entry);
+			}
+			if (pending)
+			{
+				bool exists (false);
+				auto destination (node.ledger.block_destination (transaction, *block));
+				if (!destination.is_zero ())
+				{
+					exists = node.store.pending_exists (transaction, nano::pending_key (destination, hash));
 				}
-				else if (include_not_found)
+				entry.put ("pending", exists ? "1" : "0");
+			}
+			if (source)
+			{
+				nano::block_hash source_hash (node.ledger.block_source (transaction, *block));
+				auto block_a (node.store.block_get (transaction, source_hash));
+				if (block_a != nullptr)
 				{
-					boost::property_tree::ptree entry;
-					entry.put ("", hash_text);
-					blocks_not_found.push_back (std::make_pair ("", entry));
+					auto source_account (node.ledger.account (transaction, source_hash));
+					entry.put ("source_account", source_account.to_account ());
 				}
 				else
 				{
-					ec = nano::error_blocks::not_found;
+					entry.put ("source_account", "0");
 				}
 			}
-			else
-			{
-				ec = nano::error_blocks::bad_hash_number;
-			}
+			blocks.push_back (std::make_pair (hash_text, entry));
+		}
+		else if (include_not_found)
+		{
+			boost::property_tree::ptree entry;
+			entry.put ("", hash_text);
+			blocks_not_found.push_back (std::make_pair ("", entry));
+		}
+		else
+		{
+			ec = nano::error_blocks::not_found;
 		}
 	}
 	if (!ec)
@@ -1222,7 +1247,7 @@ void nano::json_handler::block_count ()
 {
 	auto transaction (node.store.tx_begin_read ());
 	response_l.put ("count", std::to_string (node.store.block_count (transaction).sum ()));
-	response_l.put ("unchecked", std::to_string (node.store.unchecked_count (transaction)));
+	response_l.put ("unchecked", std::to_string (node.store.unchecked_count (transaction) + node.unchecked_staging.size ()));
 	response_l.put ("cemented", std::to_string (node.ledger.cemented_count));
 	response_errors ();
 }
@@ -1683,6 +1708,22 @@ void nano::json_handler::bootstrap_status ()
 		response_l.put ("requeued_pulls", std::to_string (attempt->requeued_pulls));
 		response_l.put ("frontiers_received", static_cast<bool> (attempt->frontiers_received));
 		response_l.put ("frontiers_confirmed", static_cast<bool> (attempt->frontiers_confirmed));
+		response_l.put ("average_score", attempt->average_score.load ());
+		boost::property_tree::ptree scores;
+		for (auto const & client_w : attempt->clients)
+		{
+			if (auto client = client_w.lock ())
+			{
+				boost::property_tree::ptree entry;
+				entry.put ("endpoint", client->channel->to_string ());
+				entry.put ("blocks_per_sec", client->block_rate ());
+				entry.put ("pulls_completed", client->pulls_completed.load ());
+				entry.put ("pulls_failed", client->pulls_failed.load ());
+				entry.put ("score", client->score ());
+				scores.push_back (std::make_pair ("", entry));
+			}
+		}
+		response_l.add_child ("scores", scores);
 		std::string mode_text;
 		if (attempt->mode == nano::bootstrap_mode::legacy)
 		{
@@ -1698,6 +1739,7 @@ void nano::json_handler::bootstrap_status ()
 		}
 		response_l.put ("mode", mode_text);
 		response_l.put ("lazy_blocks", std::to_string (attempt->lazy_blocks.size ()));
+		response_l.put ("lazy_memory", std::to_string (attempt->lazy_memory));
 		response_l.put ("lazy_state_backlog", std::to_string (attempt->lazy_state_backlog.size ()));
 		response_l.put ("lazy_balances", std::to_string (attempt->lazy_balances.size ()));
 		response_l.put ("lazy_destinations", std::to_string (attempt->lazy_destinations.size ()));
@@ -1932,6 +1974,32 @@ void nano::json_handler::confirmation_quorum ()
 	response_errors ();
 }
 
+void nano::json_handler::database_compact ()
+{
+	uint64_t max_bytes_per_second (0);
+	boost::optional<std::string> max_bytes_per_second_text (request.get_optional<std::string> ("max_bytes_per_second"));
+	if (max_bytes_per_second_text.is_initialized ())
+	{
+		auto success = boost::conversion::try_lexical_convert<uint64_t> (*max_bytes_per_second_text, max_bytes_per_second);
+		if (!success)
+		{
+			ec = nano::error_common::invalid_amount;
+		}
+	}
+	if (!ec)
+	{
+		if (!node.compact_store (max_bytes_per_second))
+		{
+			response_l.put ("started", "1");
+		}
+		else
+		{
+			ec = nano::error_rpc::compaction_running;
+		}
+	}
+	response_errors ();
+}
+
 void nano::json_handler::database_txn_tracker ()
 {
 	boost::property_tree::ptree json;
@@ -2911,6 +2979,27 @@ void nano::json_handler::peers ()
 	response_errors ();
 }
 
+void nano::json_handler::peers_stats ()
+{
+	boost::property_tree::ptree peers_l;
+	auto peers_list (node.network.list (std::numeric_limits<size_t>::max ()));
+	std::sort (peers_list.begin (), peers_list.end (), [](const auto & lhs, const auto & rhs) {
+		return lhs->get_endpoint () < rhs->get_endpoint ();
+	});
+	for (auto const & channel : peers_list)
+	{
+		boost::property_tree::ptree entry;
+		entry.put ("type", channel->get_type () == nano::transport::transport_type::tcp ? "tcp" : "udp");
+		auto node_id_l (channel->get_node_id_optional ());
+		entry.put ("node_id", node_id_l.is_initialized () ? node_id_l.get ().to_node_id () : "");
+		entry.put ("deferred", channel->deferred_size ());
+		channel->stats->serialize (entry);
+		peers_l.push_back (boost::property_tree::ptree::value_type (channel->to_string (), entry));
+	}
+	response_l.add_child ("peers", peers_l);
+	response_errors ();
+}
+
 void nano::json_handler::pending ()
 {
 	auto account (account_impl ());
@@ -2926,59 +3015,50 @@ void nano::json_handler::pending ()
 	{
 		boost::property_tree::ptree peers_l;
 		auto transaction (node.store.tx_begin_read ());
-		for (auto i (node.store.pending_begin (transaction, nano::pending_key (account, 0))); nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
+		if (simple)
 		{
-			nano::pending_key const & key (i->first);
-			if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
+			for (auto i (node.store.pending_begin (transaction, account)), n (node.store.pending_end ()); i != n && nano::pending_key (i->first).account == account && peers_l.size () < count; ++i)
 			{
-				if (simple)
+				nano::pending_key const & key (i->first);
+				if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
 				{
 					boost::property_tree::ptree entry;
 					entry.put ("", key.hash.to_string ());
 					peers_l.push_back (std::make_pair ("", entry));
 				}
-				else
+			}
+		}
+		else
+		{
+			// Entries are sorted by decreasing amount, the scan stops at the first one below the threshold
+			for (auto i (node.store.pending_amounts_begin (transaction, account)), n (node.store.pending_amounts_end ()); i != n && nano::pending_amount_key (i->first).account == account && nano::pending_amount_key (i->first).amount ().number () >= threshold.number () && peers_l.size () < count; ++i)
+			{
+				nano::pending_amount_key const & key (i->first);
+				if (block_confirmed (node, transaction, key.hash, include_active, include_only_confirmed))
 				{
-					nano::pending_info const & info (i->second);
-					if (info.amount.number () >= threshold.number ())
+					if (source || min_version)
 					{
-						if (source || min_version)
+						nano::pending_info info;
+						node.store.pending_get (transaction, key.pending (), info);
+						boost::property_tree::ptree pending_tree;
+						pending_tree.put ("amount", key.amount ().number ().convert_to<std::string> ());
+						if (source)
 						{
-							boost::property_tree::ptree pending_tree;
-							pending_tree.put ("amount", info.amount.number ().convert_to<std::string> ());
-							if (source)
-							{
-								pending_tree.put ("source", info.source.to_account ());
-							}
-							if (min_version)
-							{
-								pending_tree.put ("min_version", epoch_as_string (info.epoch));
-							}
-							peers_l.add_child (key.hash.to_string (), pending_tree);
+							pending_tree.put ("source", info.source.to_account ());
 						}
-						else
+						if (min_version)
 						{
-							peers_l.put (key.hash.to_string (), info.amount.number ().convert_to<std::string> ());
+							pending_tree.put ("min_version", epoch_as_string (info.epoch));
 						}
+						peers_l.add_child (key.hash.to_string (), pending_tree);
+					}
+					else
+					{
+						peers_l.put (key.hash.to_string (), key.amount ().number ().convert_to<std::string> ());
 					}
 				}
 			}
 		}
-		if (sorting && !simple)
-		{
-			if (source || min_version)
-			{
-				peers_l.sort ([](const auto & child1, const auto & child2) -> bool {
-					return child1.second.template get<nano::uint128_t> ("amount") > child2.second.template get<nano::uint128_t> ("amount");
-				});
-			}
-			else
-			{
-				peers_l.sort ([](const auto & child1, const auto & child2) -> bool {
-					return child1.second.template get<nano::uint128_t> ("") > child2.second.template get<nano::uint128_t> ("");
-				});
-			}
-		}
 		response_l.add_child ("blocks", peers_l);
 	}
 	response_errors ();
@@ -3869,6 +3949,48 @@ void nano::json_handler::stats ()
 		node.stats.log_samples (*sink);
 		use_sink = true;
 	}
+	else if (type == "peers")
+	{
+		// Totals over all current channels, see peers_stats for the per-channel values
+		uint64_t messages_out (0);
+		uint64_t bytes_out (0);
+		uint64_t messages_in (0);
+		uint64_t send_errors (0);
+		uint64_t drops (0);
+		uint64_t queue_depth (0);
+		nano::histogram send_latency;
+		nano::histogram rtt;
+		auto peers_list (node.network.list (std::numeric_limits<size_t>::max ()));
+		for (auto const & channel : peers_list)
+		{
+			auto const & stats_l (*channel->stats);
+			messages_out += stats_l.messages_out;
+			bytes_out += stats_l.bytes_out;
+			messages_in += stats_l.messages_in;
+			send_errors += stats_l.send_errors;
+			drops += stats_l.drops;
+			queue_depth += stats_l.queue_depth;
+			send_latency.merge (stats_l.send_latency);
+			rtt.merge (stats_l.rtt);
+		}
+		response_l.put ("peers", peers_list.size ());
+		response_l.put ("messages_out", messages_out);
+		response_l.put ("bytes_out", bytes_out);
+		response_l.put ("messages_in", messages_in);
+		response_l.put ("send_errors", send_errors);
+		response_l.put ("drops", drops);
+		response_l.put ("queue_depth", queue_depth);
+		boost::property_tree::ptree send_latency_l;
+		send_latency.serialize (send_latency_l);
+		response_l.add_child ("send_latency_us", send_latency_l);
+		boost::property_tree::ptree rtt_l;
+		rtt.serialize (rtt_l);
+		response_l.add_child ("rtt_us", rtt_l);
+	}
+	else if (type == "store_cache")
+	{
+		node.store.cache ().serialize_json (response_l);
+	}
 	else
 	{
 		ec = nano::error_rpc::invalid_missing_type;
@@ -3915,9 +4037,7 @@ void nano::json_handler::unchecked ()
 	{
 		boost::property_tree::ptree unchecked;
 		auto transaction (node.store.tx_begin_read ());
-		for (auto i (node.store.unchecked_begin (transaction)), n (node.store.unchecked_end ()); i != n && unchecked.size () < count; ++i)
-		{
-			nano::unchecked_info const & info (i->second);
+		auto add_block = [&unchecked, json_block_l](nano::unchecked_info const & info) {
 			if (json_block_l)
 			{
 				boost::property_tree::ptree block_node_l;
@@ -3930,6 +4050,18 @@ void nano::json_handler::unchecked ()
 				info.block->serialize_json (contents);
 				unchecked.put (info.block->hash ().to_string (), contents);
 			}
+		};
+		for (auto i (node.store.unchecked_begin (transaction)), n (node.store.unchecked_end ()); i != n && unchecked.size () < count; ++i)
+		{
+			add_block (i->second);
+		}
+		// Blocks staged in memory during bootstrap
+		if (unchecked.size () < count)
+		{
+			for (auto const & entry : node.unchecked_staging.list (count - unchecked.size ()))
+			{
+				add_block (entry.second);
+			}
 		}
 		response_l.add_child ("blocks", unchecked);
 	}
@@ -3942,6 +4074,7 @@ void nano::json_handler::unchecked_clear ()
 	node.worker.push_task ([rpc_l]() {
 		auto transaction (rpc_l->node.store.tx_begin_write ());
 		rpc_l->node.store.unchecked_clear (transaction);
+		rpc_l->node.unchecked_staging.clear ();
 		rpc_l->response_l.put ("success", "");
 		rpc_l->response_errors ();
 	});
@@ -3953,28 +4086,38 @@ void nano::json_handler::unchecked_get ()
 	auto hash (hash_impl ());
 	if (!ec)
 	{
-		auto transaction (node.store.tx_begin_read ());
-		for (auto i (node.store.unchecked_begin (transaction)), n (node.store.unchecked_end ()); i != n; ++i)
+		auto put_block = [this, json_block_l](nano::unchecked_info const & info) {
+			response_l.put ("modified_timestamp", std::to_string (info.modified));
+
+			if (json_block_l)
+			{
+				boost::property_tree::ptree block_node_l;
+				info.block->serialize_json (block_node_l);
+				response_l.add_child ("contents", block_node_l);
+			}
+			else
+			{
+				std::string contents;
+				info.block->serialize_json (contents);
+				response_l.put ("contents", contents);
+			}
+		};
+		nano::unchecked_info staged;
+		if (!node.unchecked_staging.find (hash, staged))
 		{
-			nano::unchecked_key const & key (i->first);
-			if (key.hash == hash)
+			put_block (staged);
+		}
+		else
+		{
+			auto transaction (node.store.tx_begin_read ());
+			for (auto i (node.store.unchecked_begin (transaction)), n (node.store.unchecked_end ()); i != n; ++i)
 			{
-				nano::unchecked_info const & info (i->second);
-				response_l.put ("modified_timestamp", std::to_string (info.modified));
-
-				if (json_block_l)
-				{
-					boost::property_tree::ptree block_node_l;
-					info.block->serialize_json (block_node_l);
-					response_l.add_child ("contents", block_node_l);
-				}
-				else
+				nano::unchecked_key const & key (i->first);
+				if (key.hash == hash)
 				{
-					std::string contents;
-					info.block->serialize_json (contents);
-					response_l.put ("contents", contents);
+					put_block (i->second);
+					break;
 				}
-				break;
 			}
 		}
 		if (response_l.empty ())
@@ -4001,8 +4144,20 @@ void nano::json_handler::unchecked_keys ()
 	if (!ec)
 	{
 		boost::property_tree::ptree unchecked;
-		auto transaction (node.store.tx_begin_read ());
-		for (auto i (node.store.unchecked_begin (transaction, nano::unchecked_key (key, 0))), n (node.store.unchecked_end ()); i != n && unchecked.size () < count; ++i)
+		// Blocks staged in memory during bootstrap are merged with the stored ones in key order
+		auto blocks (node.unchecked_staging.list (key, count));
+		auto staged (blocks.size ());
+		{
+			auto transaction (node.store.tx_begin_read ());
+			for (auto i (node.store.unchecked_begin (transaction, nano::unchecked_key (key, 0))), n (node.store.unchecked_end ()); i != n && blocks.size () - staged < count; ++i)
+			{
+				blocks.emplace_back (i->first, i->second);
+			}
+		}
+		std::sort (blocks.begin (), blocks.end (), [](auto const & lhs, auto const & rhs) {
+			return lhs.first.previous < rhs.first.previous || (lhs.first.previous == rhs.first.previous && lhs.first.hash < rhs.first.hash);
+		});
+		for (auto i (blocks.begin ()), n (blocks.end ()); i != n && unchecked.size () < count; ++i)
 		{
 			boost::property_tree::ptree entry;
 			nano::unchecked_info const & info (i->second);
@@ -4559,40 +4714,46 @@ void nano::json_handler::wallet_pending ()
 		{
 			nano::account const & account (i->first);
 			boost::property_tree::ptree peers_l;
-			for (auto ii (node.store.pending_begin (block_transaction, nano::pending_key (account, 0))); nano::pending_key (ii->first).account == account && peers_l.size () < count; ++ii)
+			if (threshold.is_zero () && !source)
 			{
-				nano::pending_key key (ii->first);
-				if (block_confirmed (node, block_transaction, key.hash, include_active, include_only_confirmed))
+				for (auto ii (node.store.pending_begin (block_transaction, account)), nn (node.store.pending_end ()); ii != nn && nano::pending_key (ii->first).account == account && peers_l.size () < count; ++ii)
 				{
-					if (threshold.is_zero () && !source)
+					nano::pending_key key (ii->first);
+					if (block_confirmed (node, block_transaction, key.hash, include_active, include_only_confirmed))
 					{
 						boost::property_tree::ptree entry;
 						entry.put ("", key.hash.to_string ());
 						peers_l.push_back (std::make_pair ("", entry));
 					}
-					else
+				}
+			}
+			else
+			{
+				// Entries are sorted by decreasing amount, the scan stops at the first one below the threshold
+				for (auto ii (node.store.pending_amounts_begin (block_transaction, account)), nn (node.store.pending_amounts_end ()); ii != nn && nano::pending_amount_key (ii->first).account == account && nano::pending_amount_key (ii->first).amount ().number () >= threshold.number () && peers_l.size () < count; ++ii)
+				{
+					nano::pending_amount_key key (ii->first);
+					if (block_confirmed (node, block_transaction, key.hash, include_active, include_only_confirmed))
 					{
-						nano::pending_info info (ii->second);
-						if (info.amount.number () >= threshold.number ())
+						if (source || min_version)
 						{
-							if (source || min_version)
+							nano::pending_info info;
+							node.store.pending_get (block_transaction, key.pending (), info);
+							boost::property_tree::ptree pending_tree;
+							pending_tree.put ("amount", key.amount ().number ().convert_to<std::string> ());
+							if (source)
 							{
-								boost::property_tree::ptree pending_tree;
-								pending_tree.put ("amount", info.amount.number ().convert_to<std::string> ());
-								if (source)
-								{
-									pending_tree.put ("source", info.source.to_account ());
-								}
-								if (min_version)
-								{
-									pending_tree.put ("min_version", epoch_as_string (info.epoch));
-								}
-								peers_l.add_child (key.hash.to_string (), pending_tree);
+								pending_tree.put ("source", info.source.to_account ());
 							}
-							else
+							if (min_version)
 							{
-								peers_l.put (key.hash.to_string (), info.amount.number ().convert_to<std::string> ());
+								pending_tree.put ("min_version", epoch_as_string (info.epoch));
 							}
+							peers_l.add_child (key.hash.to_string (), pending_tree);
+						}
+						else
+						{
+							peers_l.put (key.hash.to_string (), key.amount ().number ().convert_to<std::string> ());
 						}
 					}
 				}
@@ -5009,6 +5170,7 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ()
 	no_arg_funcs.emplace ("confirmation_history", &nano::json_handler::confirmation_history);
 	no_arg_funcs.emplace ("confirmation_info", &nano::json_handler::confirmation_info);
 	no_arg_funcs.emplace ("confirmation_quorum", &nano::json_handler::confirmation_quorum);
+	no_arg_funcs.emplace ("database_compact", &nano::json_handler::database_compact);
 	no_arg_funcs.emplace ("database_txn_tracker", &nano::json_handler::database_txn_tracker);
 	no_arg_funcs.emplace ("delegators", &nano::json_handler::delegators);
 	no_arg_funcs.emplace ("delegators_count", &nano::json_handler::delegators_count);
@@ -5030,6 +5192,7 @@ ipc_json_handler_no_arg_func_map create_ipc_json_handler_no_arg_func_map ()
 	no_arg_funcs.emplace ("payment_end", &nano::json_handler::payment_end);
 	no_arg_funcs.emplace ("payment_wait", &nano::json_handler::payment_wait);
 	no_arg_funcs.emplace ("peers", &nano::json_handler::peers);
+	no_arg_funcs.emplace ("peers_stats", &nano::json_handler::peers_stats);
 	no_arg_funcs.emplace ("pending", &nano::json_handler::pending);
 	no_arg_funcs.emplace ("pending_exists", &nano::json_handler::pending_exists);
 	no_arg_funcs.emplace ("process", &nano::json_handler::process);
@@ -59,6 +59,7 @@ public:
 	void confirmation_info ();
 	void confirmation_quorum ();
 	void confirmation_height_currently_processing ();
+	void database_compact ();
 	void database_txn_tracker ();
 	void delegators ();
 	void delegators_count ();
@@ -81,6 +82,7 @@ public:
 	void payment_end ();
 	void payment_wait ();
 	void peers ();
+	void peers_stats ();
 	void pending ();
 	void pending_exists ();
 	void process ();
@@ -145,6 +147,8 @@ public:
 	bool wallet_locked_impl (nano::transaction const &, std::shared_ptr<nano::wallet>);
 	bool wallet_account_impl (nano::transaction const &, std::shared_ptr<nano::wallet>, nano::account const &);
 	nano::account account_impl (std::string = "", std::error_code = nano::error_common::bad_account_number);
+	/** Decodes the "accounts" array of the request */
+	std::vector<nano::account> accounts_impl ();
 	nano::account_info account_info_impl (nano::transaction const &, nano::account const &);
 	nano::amount amount_impl ();
 	std::shared_ptr<nano::block> block_impl (bool = true);
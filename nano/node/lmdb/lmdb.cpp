@@ -9,6 +9,8 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/polymorphic_cast.hpp>
 
+#include <cstring>
+#include <numeric>
 #include <queue>
 
 namespace nano
@@ -38,11 +40,86 @@ void mdb_val::convert_buffer_to_value ()
 }
 }
 
-nano::mdb_store::mdb_store (nano::logger_mt & logger_a, boost::filesystem::path const & path_a, nano::txn_tracking_config const & txn_tracking_config_a, std::chrono::milliseconds block_processor_batch_max_time_a, int lmdb_max_dbs, size_t const batch_size, bool backup_before_upgrade) :
+namespace
+{
+/** Bytes copied per write transaction of an online compaction */
+size_t constexpr compaction_batch_bytes{ 4 * 1024 * 1024 };
+/** Recorded writes above which an online compaction gives up, as it cannot keep up with the node */
+size_t constexpr compaction_max_changes{ 1024 * 1024 };
+/** Recorded writes left to replay before new transactions are held back to swap the environment */
+size_t constexpr compaction_swap_changes{ 4 * 1024 };
+unsigned constexpr compaction_max_rounds{ 64 };
+/** How long transactions are held back while waiting for the running ones to finish */
+std::chrono::milliseconds constexpr compaction_drain_timeout{ 500 };
+/** Meta key of the block compression dictionary, stored after its format version */
+nano::uint256_union const compression_key (2);
+/** Set in a ledger file once an online compaction has replaced it */
+nano::uint256_union const compaction_replaced_key (3);
+
+/** Copies \p source_dbi_a to the empty \p target_dbi_a in key order, each batch is read from a new snapshot. Returns true on error */
+bool compaction_copy (MDB_env * source_a, MDB_env * target_a, MDB_dbi source_dbi_a, MDB_dbi target_dbi_a, std::function<void(size_t)> const & throttle_a, std::function<bool()> const & stopped_a)
+{
+	auto error (false);
+	auto done (false);
+	auto started (false);
+	std::vector<uint8_t> last;
+	while (!error && !done)
+	{
+		error = stopped_a ();
+		MDB_txn * read;
+		auto status (mdb_txn_begin (source_a, nullptr, MDB_RDONLY, &read));
+		release_assert (status == MDB_SUCCESS);
+		MDB_txn * write;
+		status = mdb_txn_begin (target_a, nullptr, 0, &write);
+		release_assert (status == MDB_SUCCESS);
+		MDB_cursor * cursor;
+		status = mdb_cursor_open (read, source_dbi_a, &cursor);
+		release_assert (status == MDB_SUCCESS);
+		MDB_val key;
+		MDB_val value;
+		if (!started)
+		{
+			status = mdb_cursor_get (cursor, &key, &value, MDB_FIRST);
+		}
+		else
+		{
+			// Resume after the last copied key
+			key = { last.size (), last.data () };
+			status = mdb_cursor_get (cursor, &key, &value, MDB_SET_RANGE);
+			if (status == MDB_SUCCESS && key.mv_size == last.size () && std::memcmp (key.mv_data, last.data (), last.size ()) == 0)
+			{
+				status = mdb_cursor_get (cursor, &key, &value, MDB_NEXT);
+			}
+		}
+		size_t bytes (0);
+		while (!error && status == MDB_SUCCESS && bytes < compaction_batch_bytes)
+		{
+			// Keys arrive in order, appending fills pages sequentially
+			error = mdb_put (write, target_dbi_a, &key, &value, MDB_APPEND) != MDB_SUCCESS;
+			bytes += key.mv_size + value.mv_size;
+			last.assign (static_cast<uint8_t const *> (key.mv_data), static_cast<uint8_t const *> (key.mv_data) + key.mv_size);
+			started = true;
+			status = mdb_cursor_get (cursor, &key, &value, MDB_NEXT);
+		}
+		done = status == MDB_NOTFOUND;
+		error = error || (status != MDB_SUCCESS && status != MDB_NOTFOUND);
+		mdb_cursor_close (cursor);
+		mdb_txn_abort (read);
+		error = mdb_txn_commit (write) != MDB_SUCCESS || error;
+		throttle_a (bytes);
+	}
+	return error;
+}
+}
+
+nano::mdb_store::mdb_store (nano::logger_mt & logger_a, boost::filesystem::path const & path_a, nano::txn_tracking_config const & txn_tracking_config_a, std::chrono::milliseconds block_processor_batch_max_time_a, int lmdb_max_dbs, size_t const batch_size, bool backup_before_upgrade, nano::durability_config const & durability_config_a, nano::compression_config const & compression_config_a, bool read_only_a) :
 logger (logger_a),
-env (error, path_a, lmdb_max_dbs, true),
+env (error, path_a, lmdb_max_dbs, true, read_only_a),
 mdb_txn_tracker (logger_a, txn_tracking_config_a, block_processor_batch_max_time_a),
-txn_tracking_enabled (txn_tracking_config_a.enable)
+txn_tracking_enabled (txn_tracking_config_a.enable),
+path (path_a),
+max_dbs (lmdb_max_dbs),
+read_only (read_only_a)
 {
 	if (!error)
 	{
@@ -60,7 +137,12 @@ txn_tracking_enabled (txn_tracking_config_a.enable)
 		// Only open a write lock when upgrades are needed. This is because CLI commands
 		// open inactive nodes which can otherwise be locked here if there is a long write
 		// (can be a few minutes with the --fast_bootstrap flag for instance)
-		if (!is_fully_upgraded)
+		if (!is_fully_upgraded && read_only)
+		{
+			logger.always_log ("The ledger must be upgraded by a node with write access before it can be opened read-only");
+			error = true;
+		}
+		else if (!is_fully_upgraded)
 		{
 			if (backup_before_upgrade)
 			{
@@ -88,6 +170,25 @@ txn_tracking_enabled (txn_tracking_config_a.enable)
 			open_databases (error, transaction, 0);
 		}
 	}
+	if (!error)
+	{
+		error = compression_open (compression_config_a);
+	}
+	if (!error)
+	{
+		replica_refresh ();
+	}
+	if (!error && !read_only && durability_config_a.mode != nano::durability_mode::sync)
+	{
+		// Set after a possible vacuum, which reopens the environment
+		auto status (mdb_env_set_flags (env, MDB_NOSYNC, 1));
+		release_assert (status == MDB_SUCCESS);
+		group_commit = std::make_unique<nano::group_commit> (durability_config_a, [this]() {
+			nano::lock_guard<std::mutex> lock (env_mutex);
+			auto status (mdb_env_sync (env, 1));
+			release_assert (status == MDB_SUCCESS);
+		});
+	}
 }
 
 bool nano::mdb_store::vacuum_after_upgrade (boost::filesystem::path const & path_a, int lmdb_max_dbs)
@@ -128,12 +229,27 @@ void nano::mdb_store::serialize_mdb_tracker (boost::property_tree::ptree & json,
 
 nano::write_transaction nano::mdb_store::tx_begin_write (std::vector<nano::tables> const &, std::vector<nano::tables> const &)
 {
-	return env.tx_begin_write (create_txn_callbacks ());
+	gate_enter ();
+	auto result (env.tx_begin_write (create_txn_callbacks ()));
+	result.track_cache (cache_m);
+	if (group_commit != nullptr)
+	{
+		result.track_group_commit (*group_commit);
+	}
+	return result;
 }
 
 nano::read_transaction nano::mdb_store::tx_begin_read ()
 {
-	return env.tx_begin_read (create_txn_callbacks ());
+	gate_enter ();
+	auto generation (cache_m.generation.load ());
+	auto result (env.tx_begin_read (create_txn_callbacks ()));
+	// Commits from the writer process are only noticed by replica_refresh, a newer snapshot could otherwise read stale cached objects
+	if (!read_only)
+	{
+		result.track_cache (cache_m, generation);
+	}
+	return result;
 }
 
 nano::mdb_txn_callbacks nano::mdb_store::create_txn_callbacks ()
@@ -150,9 +266,40 @@ nano::mdb_txn_callbacks nano::mdb_store::create_txn_callbacks ()
 		});
 		// clang-format on
 	}
+	mdb_txn_callbacks.txn_release = [this](const nano::transaction_impl *) {
+		gate_exit ();
+	};
+	// Reset read transactions do not hold back an online compaction
+	mdb_txn_callbacks.txn_acquire = [this](const nano::transaction_impl *) {
+		gate_enter ();
+	};
 	return mdb_txn_callbacks;
 }
 
+void nano::mdb_store::gate_enter ()
+{
+	++gate_active;
+	while (gate_closed)
+	{
+		// Held back until the environment is replaced, or the compaction gives up waiting for running transactions
+		gate_exit ();
+		{
+			nano::unique_lock<std::mutex> lock (gate_mutex);
+			gate_condition.wait (lock, [this]() { return !gate_closed; });
+		}
+		++gate_active;
+	}
+}
+
+void nano::mdb_store::gate_exit ()
+{
+	if (--gate_active == 0 && gate_closed)
+	{
+		nano::lock_guard<std::mutex> lock (gate_mutex);
+		gate_condition.notify_all ();
+	}
+}
+
 void nano::mdb_store::open_databases (bool & error_a, nano::transaction const & transaction_a, unsigned flags)
 {
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "frontiers", flags, &frontiers) != 0;
@@ -166,6 +313,8 @@ void nano::mdb_store::open_databases (bool & error_a, nano::transaction const &
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "meta", flags, &meta) != 0;
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "peers", flags, &peers) != 0;
 	error_a |= mdb_dbi_open (env.tx (transaction_a), "confirmation_height", flags, &confirmation_height) != 0;
+	error_a |= mdb_dbi_open (env.tx (transaction_a), "pending_amounts", flags, &pending_amounts) != 0;
+	error_a |= mdb_dbi_open (env.tx (transaction_a), "pending_summary", flags, &pending_summary) != 0;
 	if (!full_sideband (transaction_a))
 	{
 		error_a |= mdb_dbi_open (env.tx (transaction_a), "blocks_info", flags, &blocks_info) != 0;
@@ -225,6 +374,8 @@ bool nano::mdb_store::do_upgrades (nano::write_transaction & transaction_a, bool
 			upgrade_v14_to_v15 (transaction_a);
 			needs_vacuuming = true;
 		case 15:
+			upgrade_v15_to_v16 (transaction_a);
+		case 16:
 			break;
 		default:
 			logger.always_log (boost::str (boost::format ("The version of the ledger (%1%) is too high for this node") % version_l));
@@ -665,6 +816,14 @@ void nano::mdb_store::upgrade_v14_to_v15 (nano::write_transaction & transaction_
 	logger.always_log ("Finished epoch merge upgrade. Preparing vacuum...");
 }
 
+void nano::mdb_store::upgrade_v15_to_v16 (nano::write_transaction const & transaction_a)
+{
+	logger.always_log ("Preparing v15 to v16 upgrade...");
+	pending_index_rebuild (transaction_a);
+	version_put (transaction_a, 16);
+	logger.always_log ("Finished building the pending amounts index");
+}
+
 /** Takes a filepath, appends '_backup_<timestamp>' to the end (but before any extension) and saves that file in the same directory */
 void nano::mdb_store::create_backup_file (nano::mdb_env & env_a, boost::filesystem::path const & filepath_a, nano::logger_mt & logger_a)
 {
@@ -750,13 +909,36 @@ int nano::mdb_store::get (nano::transaction const & transaction_a, tables table_
 	return mdb_get (env.tx (transaction_a), table_to_dbi (table_a), key_a, value_a);
 }
 
+void nano::mdb_store::get_many (nano::transaction const & transaction_a, tables table_a, std::vector<nano::mdb_val> const & keys_a, std::vector<nano::mdb_val> & values_a, std::vector<int> & statuses_a) const
+{
+	values_a.resize (keys_a.size ());
+	statuses_a.resize (keys_a.size ());
+	// Looking keys up in key order descends through neighbouring pages, which are still cached from the previous lookup
+	std::vector<size_t> order (keys_a.size ());
+	std::iota (order.begin (), order.end (), 0);
+	std::sort (order.begin (), order.end (), [&keys_a](size_t lhs_a, size_t rhs_a) {
+		auto const & lhs (keys_a[lhs_a]);
+		auto const & rhs (keys_a[rhs_a]);
+		auto compare (std::memcmp (lhs.data (), rhs.data (), std::min (lhs.size (), rhs.size ())));
+		return compare < 0 || (compare == 0 && lhs.size () < rhs.size ());
+	});
+	auto tx (env.tx (transaction_a));
+	auto dbi (table_to_dbi (table_a));
+	for (auto index : order)
+	{
+		statuses_a[index] = mdb_get (tx, dbi, keys_a[index], values_a[index]);
+	}
+}
+
 int nano::mdb_store::put (nano::write_transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a, const nano::mdb_val & value_a) const
 {
+	compaction_record (table_to_dbi (table_a), key_a);
 	return (mdb_put (env.tx (transaction_a), table_to_dbi (table_a), key_a, value_a, 0));
 }
 
 int nano::mdb_store::del (nano::write_transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a) const
 {
+	compaction_record (table_to_dbi (table_a), key_a);
 	return (mdb_del (env.tx (transaction_a), table_to_dbi (table_a), key_a, nullptr));
 }
 
@@ -767,6 +949,17 @@ int nano::mdb_store::drop (nano::write_transaction const & transaction_a, tables
 
 int nano::mdb_store::clear (nano::write_transaction const & transaction_a, MDB_dbi handle_a)
 {
+	if (compacting)
+	{
+		nano::lock_guard<std::mutex> lock (compaction_mutex);
+		if (compaction != nullptr)
+		{
+			// The whole table is copied again
+			compaction->dropped.insert (handle_a);
+			compaction->size -= compaction->keys[handle_a].size ();
+			compaction->keys.erase (handle_a);
+		}
+	}
 	return mdb_drop (env.tx (transaction_a), handle_a, 0);
 }
 
@@ -803,6 +996,10 @@ MDB_dbi nano::mdb_store::table_to_dbi (tables table_a) const
 			return state_blocks;
 		case tables::pending:
 			return pending;
+		case tables::pending_amounts:
+			return pending_amounts;
+		case tables::pending_summary:
+			return pending_summary;
 		case tables::blocks_info:
 			return blocks_info;
 		case tables::unchecked:
@@ -838,11 +1035,458 @@ int nano::mdb_store::status_code_not_found () const
 	return MDB_NOTFOUND;
 }
 
+bool nano::mdb_store::replica_refresh ()
+{
+	// The last committed transaction id is kept in the shared lock file, it is visible to every process using the environment
+	MDB_envinfo info;
+	auto status (mdb_env_info (env, &info));
+	release_assert (status == MDB_SUCCESS);
+	auto result (replica_txnid.exchange (info.me_last_txnid) != info.me_last_txnid);
+	if (result)
+	{
+		auto replaced (false);
+		{
+			auto transaction (tx_begin_read ());
+			nano::mdb_val value;
+			replaced = mdb_get (env.tx (transaction), meta, nano::mdb_val (compaction_replaced_key), value) == MDB_SUCCESS;
+		}
+		if (replaced)
+		{
+			replica_reopen ();
+		}
+		if (codec == nullptr)
+		{
+			// The dictionary may have been trained by the writer since the last refresh
+			auto transaction (tx_begin_read ());
+			compression_load (transaction);
+		}
+	}
+	return result;
+}
+
+void nano::mdb_store::replica_reopen ()
+{
+	auto drained (false);
+	{
+		nano::unique_lock<std::mutex> lock (gate_mutex);
+		gate_closed = true;
+		drained = gate_condition.wait_for (lock, compaction_drain_timeout, [this]() { return gate_active == 0; });
+	}
+	if (drained)
+	{
+		nano::lock_guard<std::mutex> lock (env_mutex);
+		mdb_env_close (env.environment);
+		env.environment = nullptr;
+		auto error (false);
+		env.init (error, path, max_dbs, true, read_only);
+		release_assert (!error);
+		{
+			auto transaction (env.tx_begin_read ());
+			open_databases (error, transaction, 0);
+		}
+		release_assert (!error);
+		MDB_envinfo info;
+		auto status (mdb_env_info (env, &info));
+		release_assert (status == MDB_SUCCESS);
+		replica_txnid = info.me_last_txnid;
+	}
+	else
+	{
+		// Retried by the next refresh
+		replica_txnid = 0;
+	}
+	{
+		nano::lock_guard<std::mutex> lock (gate_mutex);
+		gate_closed = false;
+	}
+	gate_condition.notify_all ();
+}
+
+bool nano::mdb_store::compression_open (nano::compression_config const & config_a)
+{
+	auto error (false);
+	{
+		auto transaction (tx_begin_read ());
+		error = compression_load (transaction);
+	}
+	if (error)
+	{
+		logger.always_log ("Unsupported block compression format, the ledger was written by a newer node version");
+	}
+	else if (config_a.enable && !read_only)
+	{
+		for (auto type : config_a.block_types ())
+		{
+			compressed_tables.insert (block_database (type));
+		}
+		if (codec == nullptr)
+		{
+			compression_train (config_a);
+		}
+	}
+	return error;
+}
+
+bool nano::mdb_store::compression_load (nano::transaction const & transaction_a)
+{
+	nano::mdb_val value;
+	auto status (mdb_get (env.tx (transaction_a), meta, nano::mdb_val (compression_key), value));
+	auto error (status == MDB_SUCCESS && (value.size () == 0 || *static_cast<uint8_t const *> (value.data ()) != nano::block_codec::format_version));
+	if (status == MDB_SUCCESS && !error)
+	{
+		auto data (static_cast<uint8_t const *> (value.data ()));
+		codec_set (std::vector<uint8_t> (data + 1, data + value.size ()));
+	}
+	return error;
+}
+
+void nano::mdb_store::compression_train (nano::compression_config const & config_a)
+{
+	std::vector<std::vector<uint8_t>> samples;
+	{
+		auto transaction (tx_begin_read ());
+		if (count (transaction, tables::state_blocks) >= config_a.dictionary_samples)
+		{
+			// Sampling starts at a random hash so that consecutive nodes do not train the same dictionary from the lowest hashes
+			nano::block_hash start;
+			nano::random_pool::generate_block (start.bytes.data (), start.bytes.size ());
+			MDB_cursor * cursor;
+			auto status (mdb_cursor_open (env.tx (transaction), state_blocks, &cursor));
+			release_assert (status == MDB_SUCCESS);
+			MDB_val key{ start.bytes.size (), start.bytes.data () };
+			MDB_val value;
+			auto status2 (mdb_cursor_get (cursor, &key, &value, MDB_SET_RANGE));
+			while (samples.size () < config_a.dictionary_samples)
+			{
+				if (status2 != MDB_SUCCESS)
+				{
+					status2 = mdb_cursor_get (cursor, &key, &value, MDB_FIRST);
+					release_assert (status2 == MDB_SUCCESS);
+				}
+				// Values are raw as there is no dictionary yet
+				auto data (static_cast<uint8_t const *> (value.mv_data));
+				samples.emplace_back (data, data + value.mv_size);
+				status2 = mdb_cursor_get (cursor, &key, &value, MDB_NEXT);
+			}
+			mdb_cursor_close (cursor);
+		}
+	}
+	if (!samples.empty ())
+	{
+		auto dictionary (nano::block_codec::train (samples, config_a.dictionary_size * 1024));
+		std::vector<uint8_t> value (1, nano::block_codec::format_version);
+		value.insert (value.end (), dictionary.begin (), dictionary.end ());
+		{
+			auto transaction (tx_begin_write ({ tables::meta }));
+			auto status (mdb_put (env.tx (transaction), meta, nano::mdb_val (compression_key), nano::mdb_val (value.size (), value.data ()), 0));
+			release_assert (status == MDB_SUCCESS);
+		}
+		codec_set (dictionary);
+		logger.always_log (boost::str (boost::format ("Trained a %1% byte block compression dictionary from %2% state blocks") % dictionary.size () % samples.size ()));
+	}
+}
+
+bool nano::mdb_store::compact (uint64_t max_bytes_per_second_a, std::function<bool()> const & stopped_a)
+{
+	auto error (false);
+#ifdef _WIN32
+	// A file which is mapped by the running environment cannot be renamed over
+	error = true;
+	logger.always_log ("Online compaction is not supported on this platform");
+#endif
+	{
+		nano::lock_guard<std::mutex> lock (compaction_mutex);
+		error = error || read_only || compaction != nullptr;
+		if (!error)
+		{
+			compaction = std::make_unique<compaction_changes> ();
+			compacting = true;
+		}
+	}
+	if (!error)
+	{
+		logger.always_log ("Online compaction started");
+		// Writers which did not record their changes must commit before the tables are read
+		compaction_barrier ();
+		auto compact_path (path.parent_path () / "compacting.ldb");
+		boost::filesystem::remove (compact_path);
+		boost::filesystem::remove (compact_path.string () + "-lock");
+		nano::mdb_env target (error, compact_path, max_dbs, true);
+		auto databases (compaction_databases ());
+		std::map<MDB_dbi, MDB_dbi> dbis;
+		if (!error)
+		{
+			MDB_txn * transaction;
+			auto status (mdb_txn_begin (target, nullptr, 0, &transaction));
+			release_assert (status == MDB_SUCCESS);
+			for (auto const & database : databases)
+			{
+				MDB_dbi dbi;
+				error |= mdb_dbi_open (transaction, database.first, MDB_CREATE, &dbi) != MDB_SUCCESS;
+				dbis[database.second] = dbi;
+			}
+			error |= mdb_txn_commit (transaction) != MDB_SUCCESS;
+		}
+		auto start (std::chrono::steady_clock::now ());
+		uint64_t written (0);
+		auto throttle ([max_bytes_per_second_a, start, &written](size_t bytes_a) {
+			written += bytes_a;
+			if (max_bytes_per_second_a != 0)
+			{
+				std::this_thread::sleep_until (start + std::chrono::microseconds (written * 1000000 / max_bytes_per_second_a));
+			}
+		});
+		auto stopped ([this, &stopped_a]() {
+			return stopped_a () || compaction_size () > compaction_max_changes;
+		});
+		for (auto i (databases.begin ()), n (databases.end ()); i != n && !error; ++i)
+		{
+			error = compaction_copy (env, target, i->second, dbis[i->second], throttle, stopped);
+		}
+		auto swapped (false);
+		for (unsigned round (0); !error && !swapped && round < compaction_max_rounds; ++round)
+		{
+			auto changes (compaction_take ());
+			// Keys are recorded before their writer commits, replaying them earlier would copy the previous values
+			compaction_barrier ();
+			error = compaction_replay (target, dbis, *changes, throttle, stopped) || stopped ();
+			if (!error && compaction_size () <= compaction_swap_changes)
+			{
+				error = compaction_swap (target, dbis, compact_path, swapped);
+			}
+		}
+		{
+			nano::lock_guard<std::mutex> lock (compaction_mutex);
+			compacting = false;
+			compaction.reset ();
+		}
+		if (!swapped)
+		{
+			error = true;
+			if (target.environment != nullptr)
+			{
+				mdb_env_close (target.environment);
+				target.environment = nullptr;
+			}
+			boost::filesystem::remove (compact_path);
+			boost::filesystem::remove (compact_path.string () + "-lock");
+		}
+		logger.always_log (error ? "Online compaction failed or could not keep up with writes" : "Online compaction finished");
+	}
+	return error;
+}
+
+std::vector<std::pair<char const *, MDB_dbi>> nano::mdb_store::compaction_databases () const
+{
+	// Tables of the current version, leftovers of older versions are not copied
+	return { { "frontiers", frontiers }, { "send", send_blocks }, { "receive", receive_blocks }, { "open", open_blocks }, { "change", change_blocks }, { "unchecked", unchecked }, { "vote", vote }, { "online_weight", online_weight }, { "meta", meta }, { "peers", peers }, { "confirmation_height", confirmation_height }, { "pending_amounts", pending_amounts }, { "pending_summary", pending_summary }, { "accounts", accounts }, { "pending", pending }, { "state_blocks", state_blocks } };
+}
+
+void nano::mdb_store::compaction_record (MDB_dbi dbi_a, MDB_val const & key_a) const
+{
+	if (compacting)
+	{
+		auto data (static_cast<uint8_t const *> (key_a.mv_data));
+		nano::lock_guard<std::mutex> lock (compaction_mutex);
+		if (compaction != nullptr && compaction->keys[dbi_a].emplace (data, data + key_a.mv_size).second)
+		{
+			++compaction->size;
+		}
+	}
+}
+
+void nano::mdb_store::compaction_barrier ()
+{
+	MDB_txn * transaction;
+	auto status (mdb_txn_begin (env, nullptr, 0, &transaction));
+	release_assert (status == MDB_SUCCESS);
+	mdb_txn_abort (transaction);
+}
+
+std::unique_ptr<nano::mdb_store::compaction_changes> nano::mdb_store::compaction_take ()
+{
+	auto result (std::make_unique<compaction_changes> ());
+	nano::lock_guard<std::mutex> lock (compaction_mutex);
+	compaction.swap (result);
+	return result;
+}
+
+size_t nano::mdb_store::compaction_size ()
+{
+	nano::lock_guard<std::mutex> lock (compaction_mutex);
+	return compaction->size + compaction->dropped.size ();
+}
+
+bool nano::mdb_store::compaction_replay (MDB_env * target_a, std::map<MDB_dbi, MDB_dbi> const & dbis_a, compaction_changes const & changes_a, std::function<void(size_t)> const & throttle_a, std::function<bool()> const & stopped_a)
+{
+	auto error (false);
+	for (auto i (changes_a.dropped.begin ()), n (changes_a.dropped.end ()); i != n && !error; ++i)
+	{
+		MDB_txn * transaction;
+		auto status (mdb_txn_begin (target_a, nullptr, 0, &transaction));
+		release_assert (status == MDB_SUCCESS);
+		error = mdb_drop (transaction, dbis_a.at (*i), 0) != MDB_SUCCESS;
+		error = mdb_txn_commit (transaction) != MDB_SUCCESS || error;
+		error = error || compaction_copy (env, target_a, *i, dbis_a.at (*i), throttle_a, stopped_a);
+	}
+	for (auto i (changes_a.keys.begin ()), n (changes_a.keys.end ()); i != n && !error; ++i)
+	{
+		// Dropped tables were copied again above
+		if (changes_a.dropped.count (i->first) == 0)
+		{
+			MDB_txn * read;
+			auto status (mdb_txn_begin (env, nullptr, MDB_RDONLY, &read));
+			release_assert (status == MDB_SUCCESS);
+			MDB_txn * write;
+			status = mdb_txn_begin (target_a, nullptr, 0, &write);
+			release_assert (status == MDB_SUCCESS);
+			size_t bytes (0);
+			for (auto j (i->second.begin ()), m (i->second.end ()); j != m && !error; ++j)
+			{
+				// Keys are replayed with the value they have now
+				MDB_val key{ j->size (), const_cast<uint8_t *> (j->data ()) };
+				MDB_val value;
+				auto status (mdb_get (read, i->first, &key, &value));
+				if (status == MDB_SUCCESS)
+				{
+					error = mdb_put (write, dbis_a.at (i->first), &key, &value, 0) != MDB_SUCCESS;
+					bytes += key.mv_size + value.mv_size;
+				}
+				else
+				{
+					auto status2 (mdb_del (write, dbis_a.at (i->first), &key, nullptr));
+					error = status != MDB_NOTFOUND || (status2 != MDB_SUCCESS && status2 != MDB_NOTFOUND);
+				}
+			}
+			mdb_txn_abort (read);
+			error = mdb_txn_commit (write) != MDB_SUCCESS || error;
+			throttle_a (bytes);
+		}
+	}
+	return error;
+}
+
+bool nano::mdb_store::compaction_swap (nano::mdb_env & target_a, std::map<MDB_dbi, MDB_dbi> const & dbis_a, boost::filesystem::path const & compact_path_a, bool & swapped_a)
+{
+	auto error (false);
+	auto drained (false);
+	{
+		nano::unique_lock<std::mutex> lock (gate_mutex);
+		gate_closed = true;
+		drained = gate_condition.wait_for (lock, compaction_drain_timeout, [this]() { return gate_active == 0; });
+	}
+	auto ready (drained);
+	if (ready)
+	{
+		// Nothing is written while transactions are held back, tables dropped since the last round are copied again with the gate open
+		nano::lock_guard<std::mutex> lock (compaction_mutex);
+		ready = compaction->size <= compaction_swap_changes && compaction->dropped.empty ();
+	}
+	if (ready)
+	{
+		auto changes (compaction_take ());
+		error = compaction_replay (target_a, dbis_a, *changes, [](size_t) {}, []() { return false; });
+		if (!error)
+		{
+			nano::lock_guard<std::mutex> lock (env_mutex);
+			error = mdb_env_sync (target_a, 1) != MDB_SUCCESS;
+			if (!error)
+			{
+				mdb_env_close (target_a.environment);
+				target_a.environment = nullptr;
+				// Replicas in other processes keep the previous file and lock file mapped, the new file gets a lock file of its own
+				auto previous (env.environment);
+				auto previous_meta (meta);
+				env.environment = nullptr;
+				boost::system::error_code ec;
+				boost::filesystem::rename (compact_path_a, path, ec);
+				if (ec)
+				{
+					// The ledger is kept, the compacted file is removed when the compaction gives up
+					env.environment = previous;
+					error = true;
+					logger.always_log (boost::str (boost::format ("Online compaction could not replace the ledger file: %1%") % ec.message ()));
+				}
+				else
+				{
+					boost::filesystem::remove (compact_path_a.string () + "-lock", ec);
+					boost::filesystem::remove (path.string () + "-lock", ec);
+					env.init (error, path, max_dbs, true);
+					release_assert (!error);
+					{
+						auto transaction (env.tx_begin_read ());
+						open_databases (error, transaction, 0);
+					}
+					release_assert (!error);
+					// Marks the previous file as replaced once the new one is ready, replicas reopen the ledger when they see it
+					MDB_txn * transaction;
+					auto status (mdb_txn_begin (previous, nullptr, 0, &transaction));
+					release_assert (status == MDB_SUCCESS);
+					status = mdb_put (transaction, previous_meta, nano::mdb_val (compaction_replaced_key), nano::mdb_val (uint64_t{ 1 }), 0);
+					release_assert (status == MDB_SUCCESS);
+					status = mdb_txn_commit (transaction);
+					release_assert (status == MDB_SUCCESS);
+					mdb_env_close (previous);
+					if (group_commit != nullptr)
+					{
+						auto status (mdb_env_set_flags (env, MDB_NOSYNC, 1));
+						release_assert (status == MDB_SUCCESS);
+					}
+					MDB_envinfo info;
+					status = mdb_env_info (env, &info);
+					release_assert (status == MDB_SUCCESS);
+					replica_txnid = info.me_last_txnid;
+					swapped_a = true;
+				}
+			}
+		}
+	}
+	{
+		nano::lock_guard<std::mutex> lock (gate_mutex);
+		gate_closed = false;
+	}
+	gate_condition.notify_all ();
+	return error;
+}
+
 bool nano::mdb_store::copy_db (boost::filesystem::path const & destination_file)
 {
 	return !mdb_env_copy2 (env.environment, destination_file.string ().c_str (), MDB_CP_COMPACT);
 }
 
+void nano::mdb_store::raw_for_each (nano::transaction const & transaction_a, nano::tables table_a, std::function<void(uint8_t const *, size_t, uint8_t const *, size_t)> const & action_a) const
+{
+	MDB_cursor * cursor;
+	auto status (mdb_cursor_open (env.tx (transaction_a), table_to_dbi (table_a), &cursor));
+	release_assert (status == 0);
+	MDB_val key;
+	MDB_val value;
+	for (auto status2 (mdb_cursor_get (cursor, &key, &value, MDB_FIRST)); status2 == 0; status2 = mdb_cursor_get (cursor, &key, &value, MDB_NEXT))
+	{
+		// Entries are passed uncompressed so that they can be loaded into any store
+		nano::mdb_val value_l (value.mv_size, value.mv_data);
+		block_value_decode (table_a, value_l);
+		action_a (static_cast<uint8_t const *> (key.mv_data), key.mv_size, static_cast<uint8_t const *> (value_l.data ()), value_l.size ());
+	}
+	mdb_cursor_close (cursor);
+}
+
+bool nano::mdb_store::raw_put (nano::write_transaction const & transaction_a, nano::tables table_a, uint8_t const * key_a, size_t key_size_a, uint8_t const * value_a, size_t value_size_a, bool append_a)
+{
+	nano::mdb_val key (key_size_a, const_cast<uint8_t *> (key_a));
+	nano::mdb_val value (value_size_a, const_cast<uint8_t *> (value_a));
+	std::vector<uint8_t> compressed;
+	if (!block_value_encode (table_a, value_a, value_size_a, compressed))
+	{
+		value = nano::mdb_val (compressed.size (), compressed.data ());
+	}
+	cache_m.all_modified (transaction_a);
+	compaction_record (table_to_dbi (table_a), key);
+	// Appending fills pages sequentially instead of searching the tree for every key
+	auto status (mdb_put (env.tx (transaction_a), table_to_dbi (table_a), key, value, append_a ? MDB_APPEND : 0));
+	return status != 0;
+}
+
 bool nano::mdb_store::init_error () const
 {
 	return error;
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <nano/lib/compressionconfig.hpp>
 #include <nano/lib/config.hpp>
 #include <nano/lib/diagnosticsconfig.hpp>
+#include <nano/lib/locks.hpp>
 #include <nano/lib/logger_mt.hpp>
 #include <nano/lib/numbers.hpp>
 #include <nano/node/lmdb/lmdb_env.hpp>
@@ -9,11 +11,14 @@
 #include <nano/node/lmdb/lmdb_txn.hpp>
 #include <nano/secure/blockstore_partial.hpp>
 #include <nano/secure/common.hpp>
+#include <nano/secure/group_commit.hpp>
 #include <nano/secure/versioning.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 
+#include <map>
+#include <set>
 #include <thread>
 
 #include <lmdb/libraries/liblmdb/lmdb.h>
@@ -32,7 +37,7 @@ public:
 	using block_store_partial::block_exists;
 	using block_store_partial::unchecked_put;
 
-	mdb_store (nano::logger_mt &, boost::filesystem::path const &, nano::txn_tracking_config const & txn_tracking_config_a = nano::txn_tracking_config{}, std::chrono::milliseconds block_processor_batch_max_time_a = std::chrono::milliseconds (5000), int lmdb_max_dbs = 128, size_t batch_size = 512, bool backup_before_upgrade = false);
+	mdb_store (nano::logger_mt &, boost::filesystem::path const &, nano::txn_tracking_config const & txn_tracking_config_a = nano::txn_tracking_config{}, std::chrono::milliseconds block_processor_batch_max_time_a = std::chrono::milliseconds (5000), int lmdb_max_dbs = 128, size_t batch_size = 512, bool backup_before_upgrade = false, nano::durability_config const & durability_config_a = nano::durability_config{}, nano::compression_config const & compression_config_a = nano::compression_config{}, bool read_only_a = false);
 	nano::write_transaction tx_begin_write (std::vector<nano::tables> const & tables_requiring_lock = {}, std::vector<nano::tables> const & tables_no_lock = {}) override;
 	nano::read_transaction tx_begin_read () override;
 
@@ -135,6 +140,18 @@ public:
 	 */
 	MDB_dbi pending{ 0 };
 
+	/**
+	 * Pending entries ordered by destination account and decreasing amount.
+	 * nano::account, ~nano::amount, nano::block_hash -> no_value
+	 */
+	MDB_dbi pending_amounts{ 0 };
+
+	/**
+	 * Number and total amount of the pending entries of an account, only present for accounts with pending entries.
+	 * nano::account -> uint64_t, nano::amount
+	 */
+	MDB_dbi pending_summary{ 0 };
+
 	/**
 	 * Maps block hash to account and balance. (Removed)
 	 * block_hash -> nano::account, nano::amount
@@ -186,10 +203,20 @@ public:
 	bool exists (nano::transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a) const;
 
 	int get (nano::transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a, nano::mdb_val & value_a) const;
+	void get_many (nano::transaction const & transaction_a, tables table_a, std::vector<nano::mdb_val> const & keys_a, std::vector<nano::mdb_val> & values_a, std::vector<int> & statuses_a) const;
 	int put (nano::write_transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a, const nano::mdb_val & value_a) const;
 	int del (nano::write_transaction const & transaction_a, tables table_a, nano::mdb_val const & key_a) const;
 
 	bool copy_db (boost::filesystem::path const & destination_file) override;
+	bool replica_refresh () override;
+	/**
+	 * Tables are copied in batches to a new environment next to the current one, writes made meanwhile are recorded and
+	 * replayed until few are left. New transactions are then held back until the running ones finish, the last writes are
+	 * replayed and the new file replaces the current one
+	 */
+	bool compact (uint64_t max_bytes_per_second_a, std::function<bool()> const & stopped_a) override;
+	void raw_for_each (nano::transaction const &, nano::tables, std::function<void(uint8_t const *, size_t, uint8_t const *, size_t)> const &) const override;
+	bool raw_put (nano::write_transaction const &, nano::tables, uint8_t const *, size_t, uint8_t const *, size_t, bool) override;
 
 	template <typename Key, typename Value>
 	nano::store_iterator<Key, Value> make_iterator (nano::transaction const & transaction_a, tables table_a) const
@@ -203,6 +230,13 @@ public:
 		return nano::store_iterator<Key, Value> (std::make_unique<nano::mdb_iterator<Key, Value>> (transaction_a, table_to_dbi (table_a), key));
 	}
 
+	/** There are no prefix filters, the iteration continues past the prefix of \p key */
+	template <typename Key, typename Value>
+	nano::store_iterator<Key, Value> make_prefix_iterator (nano::transaction const & transaction_a, tables table_a, nano::mdb_val const & key) const
+	{
+		return make_iterator<Key, Value> (transaction_a, table_a, key);
+	}
+
 	bool init_error () const override;
 
 	size_t count (nano::transaction const &, MDB_dbi) const;
@@ -233,11 +267,38 @@ private:
 	void upgrade_v12_to_v13 (nano::write_transaction &, size_t);
 	void upgrade_v13_to_v14 (nano::write_transaction const &);
 	void upgrade_v14_to_v15 (nano::write_transaction &);
+	void upgrade_v15_to_v16 (nano::write_transaction const &);
 	void open_databases (bool &, nano::transaction const &, unsigned);
 
 	int drop (nano::write_transaction const & transaction_a, tables table_a) override;
 	int clear (nano::write_transaction const & transaction_a, MDB_dbi handle_a);
 
+	/** Writes made while an online compaction copies the tables */
+	class compaction_changes final
+	{
+	public:
+		std::map<MDB_dbi, std::set<std::vector<uint8_t>>> keys;
+		std::set<MDB_dbi> dropped;
+		size_t size{ 0 };
+	};
+	/** Loads the block compression dictionary, trains it if compression is enabled and there is none yet. Returns true on error */
+	bool compression_open (nano::compression_config const &);
+	bool compression_load (nano::transaction const &);
+	void compression_train (nano::compression_config const &);
+	void compaction_record (MDB_dbi, MDB_val const &) const;
+	std::unique_ptr<compaction_changes> compaction_take ();
+	/** Waits for the running write transaction to finish by taking the write lock */
+	void compaction_barrier ();
+	size_t compaction_size ();
+	bool compaction_replay (MDB_env *, std::map<MDB_dbi, MDB_dbi> const &, compaction_changes const &, std::function<void(size_t)> const &, std::function<bool()> const &);
+	bool compaction_swap (nano::mdb_env &, std::map<MDB_dbi, MDB_dbi> const &, boost::filesystem::path const &, bool &);
+	std::vector<std::pair<char const *, MDB_dbi>> compaction_databases () const;
+	/** Opens the file which replaced the ledger after an online compaction by the writer, once the running transactions finish */
+	void replica_reopen ();
+	/** Counts transactions holding a snapshot, new and renewed ones wait while the gate is closed by an online compaction swapping the environment */
+	void gate_enter ();
+	void gate_exit ();
+
 	bool not_found (int status) const override;
 	bool success (int status) const override;
 	int status_code_not_found () const override;
@@ -247,6 +308,23 @@ private:
 	nano::mdb_txn_tracker mdb_txn_tracker;
 	nano::mdb_txn_callbacks create_txn_callbacks ();
 	bool txn_tracking_enabled;
+	/** Last transaction id seen by replica_refresh */
+	std::atomic<size_t> replica_txnid{ 0 };
+	boost::filesystem::path const path;
+	int const max_dbs;
+	/** Opened without write access, the ledger is written and upgraded by a node in another process */
+	bool const read_only;
+	mutable std::mutex compaction_mutex;
+	std::unique_ptr<compaction_changes> compaction;
+	std::atomic<bool> compacting{ false };
+	std::mutex gate_mutex;
+	nano::condition_variable gate_condition;
+	std::atomic<bool> gate_closed{ false };
+	std::atomic<uint64_t> gate_active{ 0 };
+	/** Held while the environment is flushed or replaced */
+	std::mutex env_mutex;
+	/** Flushes the environment when it is opened without syncing on commit, declared after env so it is stopped first */
+	std::unique_ptr<nano::group_commit> group_commit;
 
 	size_t count (nano::transaction const & transaction_a, tables table_a) const override;
 
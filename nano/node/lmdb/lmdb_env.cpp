@@ -1,11 +1,11 @@
 #include <nano/node/lmdb/lmdb_env.hpp>
 
-nano::mdb_env::mdb_env (bool & error_a, boost::filesystem::path const & path_a, int max_dbs_a, bool use_no_mem_init_a, size_t map_size_a)
+nano::mdb_env::mdb_env (bool & error_a, boost::filesystem::path const & path_a, int max_dbs_a, bool use_no_mem_init_a, bool read_only_a, size_t map_size_a)
 {
-	init (error_a, path_a, max_dbs_a, use_no_mem_init_a, map_size_a);
+	init (error_a, path_a, max_dbs_a, use_no_mem_init_a, read_only_a, map_size_a);
 }
 
-void nano::mdb_env::init (bool & error_a, boost::filesystem::path const & path_a, int max_dbs_a, bool use_no_mem_init_a, size_t map_size_a)
+void nano::mdb_env::init (bool & error_a, boost::filesystem::path const & path_a, int max_dbs_a, bool use_no_mem_init_a, bool read_only_a, size_t map_size_a)
 {
 	boost::system::error_code error_mkdir, error_chmod;
 	if (path_a.has_parent_path ())
@@ -36,6 +36,11 @@ void nano::mdb_env::init (bool & error_a, boost::filesystem::path const & path_a
 			{
 				environment_flags |= MDB_NOMEMINIT;
 			}
+			if (read_only_a)
+			{
+				// The environment may be written by another process, only the reader table in the lock file is updated
+				environment_flags |= MDB_RDONLY;
+			}
 			auto status4 (mdb_env_open (environment, path_a.string ().c_str (), environment_flags, 00600));
 			if (status4 != 0)
 			{
@@ -47,7 +52,7 @@ void nano::mdb_env::init (bool & error_a, boost::filesystem::path const & path_a
 				}
 				std::cerr << std::endl;
 			}
-			release_assert (status4 == 0);
+			release_assert (read_only_a || status4 == 0);
 			error_a = status4 != 0;
 		}
 		else
@@ -11,8 +11,9 @@ namespace nano
 class mdb_env final
 {
 public:
-	mdb_env (bool &, boost::filesystem::path const &, int max_dbs = 128, bool use_no_mem_init = false, size_t map_size = 128ULL * 1024 * 1024 * 1024);
-	void init (bool &, boost::filesystem::path const &, int max_dbs, bool use_no_mem_init, size_t map_size = 128ULL * 1024 * 1024 * 1024);
+	/** With \p read_only write transactions cannot be started, and a missing or inaccessible file is reported as an error */
+	mdb_env (bool &, boost::filesystem::path const &, int max_dbs = 128, bool use_no_mem_init = false, bool read_only = false, size_t map_size = 128ULL * 1024 * 1024 * 1024);
+	void init (bool &, boost::filesystem::path const &, int max_dbs, bool use_no_mem_init, bool read_only = false, size_t map_size = 128ULL * 1024 * 1024 * 1024);
 	~mdb_env ();
 	operator MDB_env * () const;
 	// clang-format off
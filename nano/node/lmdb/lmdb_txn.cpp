@@ -49,6 +49,7 @@ private:
 }
 
 nano::read_mdb_txn::read_mdb_txn (nano::mdb_env const & environment_a, nano::mdb_txn_callbacks txn_callbacks_a) :
+env (environment_a),
 txn_callbacks (txn_callbacks_a)
 {
 	auto status (mdb_txn_begin (environment_a, nullptr, MDB_RDONLY, &handle));
@@ -58,21 +59,29 @@ txn_callbacks (txn_callbacks_a)
 
 nano::read_mdb_txn::~read_mdb_txn ()
 {
-	// This uses commit rather than abort, as it is needed when opening databases with a read only transaction
-	auto status (mdb_txn_commit (handle));
-	release_assert (status == MDB_SUCCESS);
-	txn_callbacks.txn_end (this);
+	if (handle != nullptr)
+	{
+		// This uses commit rather than abort, as it is needed when opening databases with a read only transaction
+		auto status (mdb_txn_commit (handle));
+		release_assert (status == MDB_SUCCESS);
+		txn_callbacks.txn_end (this);
+		txn_callbacks.txn_release (this);
+	}
 }
 
 void nano::read_mdb_txn::reset ()
 {
-	mdb_txn_reset (handle);
+	// The handle is freed rather than kept for mdb_txn_renew, as the environment may be replaced until the transaction is renewed
+	mdb_txn_abort (handle);
+	handle = nullptr;
 	txn_callbacks.txn_end (this);
+	txn_callbacks.txn_release (this);
 }
 
 void nano::read_mdb_txn::renew ()
 {
-	auto status (mdb_txn_renew (handle));
+	txn_callbacks.txn_acquire (this);
+	auto status (mdb_txn_begin (env, nullptr, MDB_RDONLY, &handle));
 	release_assert (status == 0);
 	txn_callbacks.txn_start (this);
 }
@@ -92,6 +101,7 @@ txn_callbacks (txn_callbacks_a)
 nano::write_mdb_txn::~write_mdb_txn ()
 {
 	commit ();
+	txn_callbacks.txn_release (this);
 }
 
 void nano::write_mdb_txn::commit () const
@@ -23,6 +23,10 @@ public:
 	// clang-format off
 	std::function<void (const nano::transaction_impl *)> txn_start{ [] (const nano::transaction_impl *) {} };
 	std::function<void (const nano::transaction_impl *)> txn_end{ [] (const nano::transaction_impl *) {} };
+	/** Called when the transaction stops holding a snapshot, after txn_end when a read transaction is reset and when the transaction is destroyed */
+	std::function<void (const nano::transaction_impl *)> txn_release{ [] (const nano::transaction_impl *) {} };
+	/** Called before a reset read transaction is renewed, before its txn_start */
+	std::function<void (const nano::transaction_impl *)> txn_acquire{ [] (const nano::transaction_impl *) {} };
 	// clang-format on
 };
 
@@ -34,7 +38,9 @@ public:
 	void reset () override;
 	void renew () override;
 	void * get_handle () const override;
+	/** Null while the transaction is reset */
 	MDB_txn * handle;
+	nano::mdb_env const & env;
 	mdb_txn_callbacks txn_callbacks;
 };
 
@@ -6,10 +6,13 @@
 
 nano::network::network (nano::node & node_a, uint16_t port_a) :
 buffer_container (node_a.stats, nano::network::buffer_size, 4096), // 2Mb receive buffer
+publish_filter (nano::network::publish_filter_size), // 4Mb of digests
 resolver (node_a.io_ctx),
 node (node_a),
 udp_channels (node_a, port_a),
 tcp_channels (node_a),
+fanout (node_a),
+limiter (node_a.config.bandwidth_limit),
 disconnect_observer ([]() {})
 {
 	boost::thread::attributes attrs;
@@ -133,94 +136,6 @@ void nano::network::send_node_id_handshake (std::shared_ptr<nano::transport::cha
 	channel_a->send (message);
 }
 
-template <typename T>
-bool confirm_block (nano::transaction const & transaction_a, nano::node & node_a, T & list_a, std::shared_ptr<nano::block> block_a, bool also_publish)
-{
-	bool result (false);
-	if (node_a.config.enable_voting)
-	{
-		auto hash (block_a->hash ());
-		// Search in cache
-		auto votes (node_a.votes_cache.find (hash));
-		if (votes.empty ())
-		{
-			// Generate new vote
-			node_a.wallets.foreach_representative ([&result, &list_a, &node_a, &transaction_a, &hash](nano::public_key const & pub_a, nano::raw_key const & prv_a) {
-				result = true;
-				auto vote (node_a.store.vote_generate (transaction_a, pub_a, prv_a, std::vector<nano::block_hash> (1, hash)));
-				nano::confirm_ack confirm (vote);
-				for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-				{
-					j->get ()->send (confirm);
-				}
-				node_a.votes_cache.add (vote);
-			});
-		}
-		else
-		{
-			// Send from cache
-			for (auto & vote : votes)
-			{
-				nano::confirm_ack confirm (vote);
-				for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-				{
-					j->get ()->send (confirm);
-				}
-			}
-		}
-		// Republish if required
-		if (also_publish)
-		{
-			nano::publish publish (block_a);
-			for (auto j (list_a.begin ()), m (list_a.end ()); j != m; ++j)
-			{
-				j->get ()->send (publish);
-			}
-		}
-	}
-	return result;
-}
-
-bool confirm_block (nano::transaction const & transaction_a, nano::node & node_a, std::shared_ptr<nano::transport::channel> channel_a, std::shared_ptr<nano::block> block_a, bool also_publish)
-{
-	std::array<std::shared_ptr<nano::transport::channel>, 1> endpoints = { channel_a };
-	auto result (confirm_block (transaction_a, node_a, endpoints, std::move (block_a), also_publish));
-	return result;
-}
-
-void nano::network::confirm_hashes (nano::transaction const & transaction_a, std::shared_ptr<nano::transport::channel> channel_a, std::vector<nano::block_hash> blocks_bundle_a)
-{
-	if (node.config.enable_voting)
-	{
-		node.wallets.foreach_representative ([this, &blocks_bundle_a, &channel_a, &transaction_a](nano::public_key const & pub_a, nano::raw_key const & prv_a) {
-			auto vote (this->node.store.vote_generate (transaction_a, pub_a, prv_a, blocks_bundle_a));
-			nano::confirm_ack confirm (vote);
-			std::shared_ptr<std::vector<uint8_t>> bytes (new std::vector<uint8_t>);
-			{
-				nano::vectorstream stream (*bytes);
-				confirm.serialize (stream);
-			}
-			channel_a->send (confirm);
-			this->node.votes_cache.add (vote);
-		});
-	}
-}
-
-bool nano::network::send_votes_cache (std::shared_ptr<nano::transport::channel> channel_a, nano::block_hash const & hash_a)
-{
-	// Search in cache
-	auto votes (node.votes_cache.find (hash_a));
-	// Send from cache
-	for (auto & vote : votes)
-	{
-		nano::confirm_ack confirm (vote);
-		channel_a->send (confirm);
-	}
-	// Returns true if votes were sent
-	bool result (!votes.empty ());
-	return result;
-}
-
 void nano::network::flood_message (nano::message const & message_a, bool const is_droppable_a)
 {
 	auto list (list_fanout ());
@@ -434,6 +349,7 @@ public:
 		}
 		else
 		{
+			node.network.publish_filter.clear (message_a.digest);
 			node.stats.inc (nano::stat::type::drop, nano::stat::detail::publish, nano::stat::dir::in);
 		}
 		node.active.publish (message_a.block);
@@ -455,85 +371,18 @@ public:
 		// Don't load nodes with disabled voting
 		if (node.config.enable_voting && node.wallets.reps_count)
 		{
+			std::vector<std::pair<nano::block_hash, nano::root>> hashes_roots;
 			if (message_a.block != nullptr)
 			{
-				auto hash (message_a.block->hash ());
-				if (!node.network.send_votes_cache (channel, hash))
-				{
-					auto transaction (node.store.tx_begin_read ());
-					auto successor (node.ledger.successor (transaction, message_a.block->qualified_root ()));
-					if (successor != nullptr)
-					{
-						auto same_block (successor->hash () == hash);
-						confirm_block (transaction, node, channel, std::move (successor), !same_block);
-					}
-				}
+				hashes_roots.emplace_back (message_a.block->hash (), message_a.block->root ());
 			}
-			else if (!message_a.roots_hashes.empty ())
+			else
 			{
-				auto transaction (node.store.tx_begin_read ());
-				std::vector<nano::block_hash> blocks_bundle;
-				std::vector<std::shared_ptr<nano::vote>> cached_votes;
-				size_t cached_count (0);
-				for (auto & root_hash : message_a.roots_hashes)
-				{
-					auto find_votes (node.votes_cache.find (root_hash.first));
-					if (!find_votes.empty ())
-					{
-						++cached_count;
-						cached_votes.insert (cached_votes.end (), find_votes.begin (), find_votes.end ());
-					}
-					if (!find_votes.empty () || (!root_hash.first.is_zero () && node.store.block_exists (transaction, root_hash.first)))
-					{
-						blocks_bundle.push_back (root_hash.first);
-					}
-					else if (!root_hash.second.is_zero ())
-					{
-						nano::block_hash successor (0);
-						// Search for block root
-						successor = node.store.block_successor (transaction, root_hash.second);
-						// Search for account root
-						if (successor.is_zero ())
-						{
-							nano::account_info info;
-							auto error (node.store.account_get (transaction, root_hash.second, info));
-							if (!error)
-							{
-								successor = info.open_block;
-							}
-						}
-						if (!successor.is_zero ())
-						{
-							auto find_successor_votes (node.votes_cache.find (successor));
-							if (!find_successor_votes.empty ())
-							{
-								++cached_count;
-								cached_votes.insert (cached_votes.end (), find_successor_votes.begin (), find_successor_votes.end ());
-							}
-							blocks_bundle.push_back (successor);
-							auto successor_block (node.store.block_get (transaction, successor));
-							assert (successor_block != nullptr);
-							nano::publish publish (successor_block);
-							channel->send (publish);
-						}
-					}
-				}
-				/* Decide to send cached votes or to create new vote
-				If there is at least one new hash to confirm, then create new batch vote
-				Otherwise use more bandwidth & save local resources required to sign vote */
-				if (!blocks_bundle.empty () && cached_count < blocks_bundle.size ())
-				{
-					node.network.confirm_hashes (transaction, channel, blocks_bundle);
-				}
-				else
-				{
-					// Send from cache
-					for (auto & vote : cached_votes)
-					{
-						nano::confirm_ack confirm (vote);
-						channel->send (confirm);
-					}
-				}
+				hashes_roots = message_a.roots_hashes;
+			}
+			if (!hashes_roots.empty ())
+			{
+				node.aggregator.add (channel, hashes_roots);
 			}
 		}
 	}
@@ -589,6 +438,7 @@ public:
 
 void nano::network::process_message (nano::message const & message_a, std::shared_ptr<nano::transport::channel> channel_a)
 {
+	++channel_a->stats->messages_in;
 	network_message_visitor visitor (node, channel_a);
 	message_a.visit (visitor);
 }
@@ -662,7 +512,7 @@ std::deque<std::shared_ptr<nano::transport::channel>> nano::network::list (size_
 // Simulating with sqrt_broadcast_simulate shows we only need to broadcast to sqrt(total_peers) random peers in order to successfully publish to everyone with high probability
 std::deque<std::shared_ptr<nano::transport::channel>> nano::network::list_fanout ()
 {
-	auto result (list (size_sqrt ()));
+	auto result (fanout.sample (fanout.size_sqrt ()));
 	return result;
 }
 
@@ -911,7 +761,7 @@ boost::optional<nano::uint256_union> nano::syn_cookies::assign (nano::endpoint c
 	return result;
 }
 
-bool nano::syn_cookies::validate (nano::endpoint const & endpoint_a, nano::account const & node_id, nano::signature const & sig)
+bool nano::syn_cookies::validate (nano::endpoint const & endpoint_a, nano::account const & node_id, nano::signature const & sig, std::chrono::steady_clock::duration * rtt_a)
 {
 	auto ip_addr (endpoint_a.address ());
 	assert (ip_addr.is_v6 ());
@@ -921,6 +771,10 @@ bool nano::syn_cookies::validate (nano::endpoint const & endpoint_a, nano::accou
 	if (cookie_it != cookies.end () && !nano::validate_message (node_id, cookie_it->second.cookie, sig))
 	{
 		result = false;
+		if (rtt_a != nullptr)
+		{
+			*rtt_a = std::chrono::steady_clock::now () - cookie_it->second.created_at;
+		}
 		cookies.erase (cookie_it);
 		unsigned & ip_cookies = cookies_per_ip[ip_addr];
 		if (ip_cookies > 0)
@@ -976,3 +830,157 @@ std::unique_ptr<nano::seq_con_info_component> nano::syn_cookies::collect_seq_con
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "syn_cookies_per_ip", syn_cookies_per_ip_count, sizeof (decltype (cookies_per_ip)::value_type) }));
 	return composite;
 }
+
+std::chrono::seconds constexpr nano::fanout_selector::refresh_interval;
+std::chrono::milliseconds constexpr nano::fanout_selector::latency_reference;
+
+nano::fanout_selector::fanout_selector (nano::node & node_a) :
+node (node_a),
+current_snapshot (std::make_shared<snapshot const> ())
+{
+}
+
+std::deque<std::shared_ptr<nano::transport::channel>> nano::fanout_selector::sample (size_t count_a)
+{
+	std::deque<std::shared_ptr<nano::transport::channel>> result;
+	auto snapshot_l (current ());
+	auto const & representatives (snapshot_l->representatives);
+	auto const & peers (snapshot_l->peers);
+	std::vector<bool> picked (representatives.size (), false);
+	if (count_a > 0 && !representatives.empty ())
+	{
+		// Weighted random sampling of representatives, stop trying after this many attempts
+		auto representatives_max (std::min (representatives.size (), (count_a + 1) / 2));
+		auto random_cutoff (representatives_max * 2);
+		auto total (snapshot_l->cumulative_weights.back ());
+		auto random_max (std::numeric_limits<CryptoPP::word32>::max ());
+		for (size_t i (0); i < random_cutoff && result.size () < representatives_max; ++i)
+		{
+			auto target (total * nano::random_pool::generate_word32 (0, random_max) / random_max);
+			auto index (std::min (static_cast<size_t> (std::upper_bound (snapshot_l->cumulative_weights.begin (), snapshot_l->cumulative_weights.end (), target) - snapshot_l->cumulative_weights.begin ()), representatives.size () - 1));
+			if (!picked[index])
+			{
+				picked[index] = true;
+				result.push_back (representatives[index]);
+			}
+		}
+	}
+	if (!peers.empty ())
+	{
+		// Walk a rotating window over the shuffled peers
+		auto peers_count (std::min (count_a - result.size (), peers.size ()));
+		auto start (offset.fetch_add (peers_count));
+		for (size_t i (0); i < peers_count; ++i)
+		{
+			result.push_back (peers[(start + i) % peers.size ()]);
+		}
+	}
+	// Top up with the heaviest remaining representatives when there are not enough other peers
+	for (size_t i (0), n (representatives.size ()); i < n && result.size () < count_a; ++i)
+	{
+		if (!picked[i])
+		{
+			result.push_back (representatives[i]);
+		}
+	}
+	return result;
+}
+
+void nano::fanout_selector::refresh ()
+{
+	std::deque<std::shared_ptr<nano::transport::channel>> channels;
+	node.network.tcp_channels.list (channels);
+	node.network.udp_channels.list (channels);
+	std::unordered_map<nano::endpoint, double> weights;
+	for (auto const & representative : node.rep_crawler.representatives ())
+	{
+		auto weight (representative.weight.number ().convert_to<double> ());
+		if (representative.last_response > representative.last_request)
+		{
+			auto latency (std::chrono::duration_cast<std::chrono::milliseconds> (representative.last_response - representative.last_request));
+			if (latency > latency_reference)
+			{
+				weight *= static_cast<double> (latency_reference.count ()) / latency.count ();
+			}
+		}
+		weights[representative.channel->get_endpoint ()] = weight;
+	}
+	auto snapshot_l (std::make_shared<snapshot> ());
+	snapshot_l->created = std::chrono::steady_clock::now ();
+	std::vector<std::pair<double, std::shared_ptr<nano::transport::channel>>> representatives;
+	// TCP channels are listed first and take precedence over UDP channels to the same endpoint or node ID
+	std::unordered_set<nano::endpoint> endpoints;
+	std::unordered_set<nano::account> node_ids;
+	for (auto & channel : channels)
+	{
+		auto endpoint (channel->get_endpoint ());
+		auto node_id (channel->get_node_id_optional ());
+		if (endpoints.insert (endpoint).second && (!node_id.is_initialized () || node_ids.insert (node_id.get ()).second))
+		{
+			auto existing (weights.find (endpoint));
+			if (existing != weights.end ())
+			{
+				representatives.emplace_back (existing->second, channel);
+			}
+			else
+			{
+				snapshot_l->peers.push_back (channel);
+			}
+		}
+	}
+	std::sort (representatives.begin (), representatives.end (), [](auto const & lhs, auto const & rhs) { return lhs.first > rhs.first; });
+	double total (0);
+	for (auto & representative : representatives)
+	{
+		total += representative.first;
+		snapshot_l->representatives.push_back (representative.second);
+		snapshot_l->cumulative_weights.push_back (total);
+	}
+	nano::random_pool::shuffle (snapshot_l->peers.begin (), snapshot_l->peers.end ());
+	std::atomic_store (&current_snapshot, std::shared_ptr<snapshot const> (std::move (snapshot_l)));
+}
+
+void nano::fanout_selector::invalidate ()
+{
+	stale = true;
+}
+
+size_t nano::fanout_selector::size ()
+{
+	auto snapshot_l (current ());
+	return snapshot_l->representatives.size () + snapshot_l->peers.size ();
+}
+
+size_t nano::fanout_selector::size_sqrt ()
+{
+	return (static_cast<size_t> (std::ceil (std::sqrt (size ()))));
+}
+
+std::shared_ptr<nano::fanout_selector::snapshot const> nano::fanout_selector::current ()
+{
+	auto result (std::atomic_load (&current_snapshot));
+	if ((stale || std::chrono::steady_clock::now () - result->created > refresh_interval) && !refreshing.exchange (true))
+	{
+		// Rebuilt once in the background, listing the channels locks their containers which must not delay flooding
+		std::weak_ptr<nano::node> node_w (node.shared ());
+		node.background ([node_w]() {
+			if (auto node_l = node_w.lock ())
+			{
+				auto & fanout (node_l->network.fanout);
+				fanout.stale = false;
+				fanout.refresh ();
+				fanout.refreshing = false;
+			}
+		});
+	}
+	return result;
+}
+
+std::unique_ptr<nano::seq_con_info_component> nano::fanout_selector::collect_seq_con_info (std::string const & name)
+{
+	auto snapshot_l (std::atomic_load (&current_snapshot));
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "representatives", snapshot_l->representatives.size (), sizeof (decltype (snapshot_l->representatives)::value_type) + sizeof (decltype (snapshot_l->cumulative_weights)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "peers", snapshot_l->peers.size (), sizeof (decltype (snapshot_l->peers)::value_type) }));
+	return composite;
+}
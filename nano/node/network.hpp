@@ -4,6 +4,7 @@
 #include <nano/node/common.hpp>
 #include <nano/node/transport/tcp.hpp>
 #include <nano/node/transport/udp.hpp>
+#include <nano/secure/network_filter.hpp>
 
 #include <boost/thread/thread.hpp>
 
@@ -76,8 +77,8 @@ public:
 	// or if the endpoint already has a syn cookie query
 	boost::optional<nano::uint256_union> assign (nano::endpoint const &);
 	// Returns false if valid, true if invalid (true on error convention)
-	// Also removes the syn cookie from the store if valid
-	bool validate (nano::endpoint const &, nano::account const &, nano::signature const &);
+	// Also removes the syn cookie from the store if valid, setting the time since it was assigned in \p rtt_a if given
+	bool validate (nano::endpoint const &, nano::account const &, nano::signature const &, std::chrono::steady_clock::duration * rtt_a = nullptr);
 	std::unique_ptr<seq_con_info_component> collect_seq_con_info (std::string const &);
 
 private:
@@ -91,6 +92,51 @@ private:
 	std::unordered_map<nano::endpoint, syn_cookie_info> cookies;
 	std::unordered_map<boost::asio::ip::address, unsigned> cookies_per_ip;
 };
+/**
+ * Selects the peers a message is flooded to.
+ * A snapshot of the channels, deduplicated across UDP and TCP, is rebuilt periodically and whenever channels are added or removed.
+ * Rebuilds run in the background, samples taken meanwhile use the previous snapshot.
+ * Representatives known to the rep crawler are sampled proportionally to their weight, discounted by their response latency,
+ * while the remaining peers are shuffled once per snapshot and sampled by walking a rotating window over them.
+ * Sampling works on an atomic copy of the snapshot and never locks the channel containers.
+ * All public methods are thread-safe
+ */
+class fanout_selector final
+{
+public:
+	explicit fanout_selector (nano::node &);
+	/** Returns up to \p count_a distinct channels. Representatives are sampled for half of the slots and only fill the rest when there are not enough other peers */
+	std::deque<std::shared_ptr<nano::transport::channel>> sample (size_t count_a);
+	/** Rebuilds the snapshot of channels and reshuffles it */
+	void refresh ();
+	/** Makes the next sample schedule a rebuild of the snapshot */
+	void invalidate ();
+	/** Number of channels in the current snapshot */
+	size_t size ();
+	size_t size_sqrt ();
+	std::unique_ptr<seq_con_info_component> collect_seq_con_info (std::string const &);
+	static std::chrono::seconds constexpr refresh_interval{ 5 };
+	// Representatives responding faster than this keep their full weight, slower ones are weighted down proportionally
+	static std::chrono::milliseconds constexpr latency_reference{ 100 };
+
+private:
+	class snapshot final
+	{
+	public:
+		std::vector<std::shared_ptr<nano::transport::channel>> representatives;
+		// Running sum of the effective representative weights, in the same order as representatives
+		std::vector<double> cumulative_weights;
+		std::vector<std::shared_ptr<nano::transport::channel>> peers;
+		std::chrono::steady_clock::time_point created;
+	};
+	std::shared_ptr<snapshot const> current ();
+	nano::node & node;
+	// Only accessed through std::atomic_load and std::atomic_store
+	std::shared_ptr<snapshot const> current_snapshot;
+	std::atomic<bool> stale{ true };
+	std::atomic<bool> refreshing{ false };
+	std::atomic<size_t> offset{ 0 };
+};
 class network final
 {
 public:
@@ -127,8 +173,6 @@ public:
 	void broadcast_confirm_req_base (std::shared_ptr<nano::block>, std::shared_ptr<std::vector<std::shared_ptr<nano::transport::channel>>>, unsigned, bool = false);
 	void broadcast_confirm_req_batched_many (std::unordered_map<std::shared_ptr<nano::transport::channel>, std::deque<std::pair<nano::block_hash, nano::root>>>, std::function<void()> = nullptr, unsigned = broadcast_interval_ms, bool = false);
 	void broadcast_confirm_req_many (std::deque<std::pair<std::shared_ptr<nano::block>, std::shared_ptr<std::vector<std::shared_ptr<nano::transport::channel>>>>>, std::function<void()> = nullptr, unsigned = broadcast_interval_ms);
-	void confirm_hashes (nano::transaction const &, std::shared_ptr<nano::transport::channel>, std::vector<nano::block_hash>);
-	bool send_votes_cache (std::shared_ptr<nano::transport::channel>, nano::block_hash const &);
 	std::shared_ptr<nano::transport::channel> find_node_id (nano::account const &);
 	std::shared_ptr<nano::transport::channel> find_channel (nano::endpoint const &);
 	void process_message (nano::message const &, std::shared_ptr<nano::transport::channel>);
@@ -136,7 +180,7 @@ public:
 	// Should we reach out to this endpoint with a keepalive message
 	bool reachout (nano::endpoint const &, bool = false);
 	std::deque<std::shared_ptr<nano::transport::channel>> list (size_t);
-	// A list of random peers sized for the configured rebroadcast fanout
+	// A list of peers sized for the configured rebroadcast fanout, biased towards representatives
 	std::deque<std::shared_ptr<nano::transport::channel>> list_fanout ();
 	void random_fill (std::array<nano::endpoint, 8> &) const;
 	std::unordered_set<std::shared_ptr<nano::transport::channel>> random_set (size_t) const;
@@ -153,17 +197,24 @@ public:
 	size_t size_sqrt () const;
 	bool empty () const;
 	nano::message_buffer_manager buffer_container;
+	// Drops duplicate publish messages before they are deserialized
+	nano::network_filter publish_filter;
 	boost::asio::ip::udp::resolver resolver;
 	std::vector<boost::thread> packet_processing_threads;
 	nano::node & node;
 	nano::transport::udp_channels udp_channels;
 	nano::transport::tcp_channels tcp_channels;
+	nano::fanout_selector fanout;
+	// Outbound bandwidth budget shared by all channels
+	nano::bandwidth_limiter limiter;
 	std::function<void()> disconnect_observer;
 	// Called when a new channel is observed
 	std::function<void(std::shared_ptr<nano::transport::channel>)> channel_observer;
 	std::atomic<bool> stopped{ false };
 	static unsigned const broadcast_interval_ms = 10;
 	static size_t const buffer_size = 512;
+	static size_t const publish_filter_size = 256 * 1024;
 	static size_t const confirm_req_hashes_max = 7;
+	static size_t const confirm_ack_hashes_max = 12;
 };
 }
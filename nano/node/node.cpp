@@ -87,6 +87,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (block_processor &
 	size_t blocks_filter_count = 0;
 	size_t forced_count = 0;
 	size_t rolled_back_count = 0;
+	size_t chains_blocks_count = 0;
 
 	{
 		nano::lock_guard<std::mutex> guard (block_processor.mutex);
@@ -95,6 +96,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (block_processor &
 		blocks_filter_count = block_processor.blocks_filter.size ();
 		forced_count = block_processor.forced.size ();
 		rolled_back_count = block_processor.rolled_back.size ();
+		chains_blocks_count = block_processor.chains_blocks;
 	}
 
 	auto composite = std::make_unique<seq_con_info_composite> (name);
@@ -103,6 +105,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (block_processor &
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "blocks_filter", blocks_filter_count, sizeof (decltype (block_processor.blocks_filter)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "forced", forced_count, sizeof (decltype (block_processor.forced)::value_type) }));
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "rolled_back", rolled_back_count, sizeof (decltype (block_processor.rolled_back)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "chains_blocks", chains_blocks_count, sizeof (nano::unchecked_info) }));
 	composite->add_component (collect_seq_con_info (block_processor.generator, "generator"));
 	return composite;
 }
@@ -123,14 +126,15 @@ alarm (alarm_a),
 work (work_a),
 distributed_work (*this),
 logger (config_a.logging.min_time_between_log_output),
-store_impl (nano::make_store (logger, application_path_a, flags.read_only, true, config_a.rocksdb_config, config_a.diagnostics_config.txn_tracking, config_a.block_processor_batch_max_time, config_a.lmdb_max_dbs, flags.sideband_batch_size, config_a.backup_before_upgrade, config_a.rocksdb_config.enable)),
+store_impl (nano::make_store (logger, application_path_a, flags.read_only, true, config_a.rocksdb_config, config_a.diagnostics_config.txn_tracking, config_a.block_processor_batch_max_time, config_a.lmdb_max_dbs, flags.sideband_batch_size, config_a.backup_before_upgrade, config_a.rocksdb_config.enable, config_a.durability_config, config_a.compression_config)),
 store (*store_impl),
 wallets_store_impl (std::make_unique<nano::mdb_wallets_store> (application_path_a / "wallets.ldb", config_a.lmdb_max_dbs)),
 wallets_store (*wallets_store_impl),
 gap_cache (*this),
+unchecked_staging (flags_a.unchecked_staging_size),
 ledger (store, stats, flags_a.cache_representative_weights_from_frontiers),
 checker (config.signature_checker_threads),
-network (*this, config.peering_port),
+network (*this, flags_a.read_replica ? 0 : config.peering_port),
 bootstrap_initiator (*this),
 bootstrap (config.peering_port, *this),
 application_path (application_path_a),
@@ -149,10 +153,20 @@ active (*this),
 confirmation_height_processor (pending_confirmation_height, ledger, active, write_database_queue, config.conf_height_processor_batch_min_time, logger),
 payment_observer_processor (observers.blocks),
 wallets (wallets_store.init_error (), *this),
+aggregator (*this),
 startup_time (std::chrono::steady_clock::now ())
 {
+	if (!replica_supported ())
+	{
+		logger.always_log ("A read replica requires the LMDB backend, RocksDB instances opened read-only never observe commits from the writer");
+	}
 	if (!init_error ())
 	{
+		if (flags.read_replica)
+		{
+			// The ledger is written by another process
+			block_processor.stop ();
+		}
 		if (config.websocket_config.enabled)
 		{
 			auto endpoint_l (nano::tcp_endpoint (config.websocket_config.address, config.websocket_config.port));
@@ -455,6 +469,7 @@ startup_time (std::chrono::steady_clock::now ())
 			{
 				auto transaction (store.tx_begin_write ());
 				store.unchecked_clear (transaction);
+				unchecked_staging.clear ();
 				logger.always_log ("Dropping unchecked blocks");
 			}
 		}
@@ -592,6 +607,8 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 	composite->add_component (collect_seq_con_info (node.alarm, "alarm"));
 	composite->add_component (collect_seq_con_info (node.work, "work"));
 	composite->add_component (collect_seq_con_info (node.gap_cache, "gap_cache"));
+	composite->add_component (collect_seq_con_info (node.unchecked_staging, "unchecked_staging"));
+	composite->add_component (collect_seq_con_info (node.store.cache (), "store_cache"));
 	composite->add_component (collect_seq_con_info (node.ledger, "ledger"));
 	composite->add_component (collect_seq_con_info (node.active, "active"));
 	composite->add_component (collect_seq_con_info (node.bootstrap_initiator, "bootstrap_initiator"));
@@ -599,6 +616,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 	composite->add_component (node.network.tcp_channels.collect_seq_con_info ("tcp_channels"));
 	composite->add_component (node.network.udp_channels.collect_seq_con_info ("udp_channels"));
 	composite->add_component (node.network.syn_cookies.collect_seq_con_info ("syn_cookies"));
+	composite->add_component (node.network.fanout.collect_seq_con_info ("fanout"));
 	composite->add_component (collect_seq_con_info (node.observers, "observers"));
 	composite->add_component (collect_seq_con_info (node.wallets, "wallets"));
 	composite->add_component (collect_seq_con_info (node.vote_processor, "vote_processor"));
@@ -607,6 +625,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (node & node, const
 	composite->add_component (collect_seq_con_info (node.block_arrival, "block_arrival"));
 	composite->add_component (collect_seq_con_info (node.online_reps, "online_reps"));
 	composite->add_component (collect_seq_con_info (node.votes_cache, "votes_cache"));
+	composite->add_component (collect_seq_con_info (node.aggregator, "request_aggregator"));
 	composite->add_component (collect_seq_con_info (node.block_uniquer, "block_uniquer"));
 	composite->add_component (collect_seq_con_info (node.vote_uniquer, "vote_uniquer"));
 	composite->add_component (collect_seq_con_info (node.confirmation_height_processor, "confirmation_height_processor"));
@@ -625,7 +644,7 @@ void nano::node::process_active (std::shared_ptr<nano::block> incoming)
 
 nano::process_return nano::node::process (nano::block const & block_a)
 {
-	auto transaction (store.tx_begin_write ({ tables::accounts, tables::cached_counts, tables::change_blocks, tables::frontiers, tables::open_blocks, tables::pending, tables::receive_blocks, tables::representation, tables::send_blocks, tables::state_blocks }, { tables::confirmation_height }));
+	auto transaction (store.tx_begin_write ({ tables::accounts, tables::cached_counts, tables::change_blocks, tables::confirmation_height, tables::frontiers, tables::open_blocks, tables::pending, tables::pending_amounts, tables::pending_summary, tables::receive_blocks, tables::representation, tables::send_blocks, tables::state_blocks }));
 	auto result (ledger.process (transaction, block_a));
 	return result;
 }
@@ -645,6 +664,12 @@ nano::process_return nano::node::process_local (std::shared_ptr<nano::block> blo
 
 void nano::node::start ()
 {
+	if (flags.read_replica)
+	{
+		logger.always_log ("Running as a read replica");
+		ongoing_replica_refresh ();
+		return;
+	}
 	network.start ();
 	add_initial_peers ();
 	if (!flags.disable_legacy_bootstrap)
@@ -698,11 +723,26 @@ void nano::node::stop ()
 		// Cancels ongoing work generation tasks, which may be blocking other threads
 		// No tasks may wait for work generation in I/O threads, or termination signal capturing will be unable to call node::stop()
 		distributed_work.stop ();
+		aggregator.stop ();
 		block_processor.stop ();
 		if (block_processor_thread.joinable ())
 		{
 			block_processor_thread.join ();
 		}
+		// Compaction gives up once the node is stopped
+		if (compaction_thread.joinable ())
+		{
+			compaction_thread.join ();
+		}
+		// Persist staged gap blocks so that they survive the restart
+		if (unchecked_staging.size () != 0 && !flags.read_only)
+		{
+			auto transaction (store.tx_begin_write ({ nano::tables::unchecked }));
+			for (auto const & entry : unchecked_staging.spill_all ())
+			{
+				store.unchecked_put (transaction, entry.first, entry.second);
+			}
+		}
 		vote_processor.stop ();
 		confirmation_height_processor.stop ();
 		active.stop ();
@@ -836,6 +876,64 @@ void nano::node::ongoing_store_flush ()
 	});
 }
 
+bool nano::node::replica_refresh ()
+{
+	auto result (store.replica_refresh ());
+	if (result)
+	{
+		stats.inc (nano::stat::type::ledger, nano::stat::detail::replica_refresh);
+		auto transaction (store.tx_begin_read ());
+		ledger.block_count_cache = store.block_count (transaction).sum ();
+		replica_reload_needed = true;
+	}
+	auto now (std::chrono::steady_clock::now ());
+	if (replica_reload_needed && now - replica_reloaded >= network_params.node.replica_reload_interval)
+	{
+		stats.inc (nano::stat::type::ledger, nano::stat::detail::replica_reload);
+		auto transaction (store.tx_begin_read ());
+		ledger.cache_reload (transaction);
+		replica_reloaded = now;
+		replica_reload_needed = false;
+	}
+	if (result)
+	{
+		observers.replica_refresh.notify (ledger.block_count_cache);
+	}
+	return result;
+}
+
+void nano::node::ongoing_replica_refresh ()
+{
+	replica_refresh ();
+	std::weak_ptr<nano::node> node_w (shared_from_this ());
+	alarm.add (std::chrono::steady_clock::now () + network_params.node.replica_refresh_interval, [node_w]() {
+		if (auto node_l = node_w.lock ())
+		{
+			node_l->worker.push_task ([node_l]() {
+				node_l->ongoing_replica_refresh ();
+			});
+		}
+	});
+}
+
+bool nano::node::compact_store (uint64_t max_bytes_per_second_a)
+{
+	auto error (flags.read_only || stopped || compacting.exchange (true));
+	if (!error)
+	{
+		if (compaction_thread.joinable ())
+		{
+			compaction_thread.join ();
+		}
+		compaction_thread = boost::thread ([this, max_bytes_per_second_a]() {
+			nano::thread_role::set (nano::thread_role::name::store_compaction);
+			store.compact (max_bytes_per_second_a, [this]() { return stopped.load (); });
+			compacting = false;
+		});
+	}
+	return error;
+}
+
 void nano::node::ongoing_peer_store ()
 {
 	bool stored (network.tcp_channels.store_all (true));
@@ -924,6 +1022,14 @@ void nano::node::unchecked_cleanup ()
 			}
 		}
 	}
+	if (!flags.disable_unchecked_cleanup && ledger.block_count_cache >= ledger.bootstrap_weight_max_blocks && !long_attempt)
+	{
+		auto now (nano::seconds_since_epoch ());
+		if (now > static_cast<uint64_t> (config.unchecked_cutoff_time.count ()))
+		{
+			unchecked_staging.erase_older_than (now - config.unchecked_cutoff_time.count ());
+		}
+	}
 	if (!cleaning_list.empty ())
 	{
 		logger.always_log (boost::str (boost::format ("Deleting %1% old unchecked blocks") % cleaning_list.size ()));
@@ -1335,7 +1441,12 @@ int nano::node::store_version ()
 
 bool nano::node::init_error () const
 {
-	return store.init_error () || wallets_store.init_error ();
+	return store.init_error () || wallets_store.init_error () || !replica_supported ();
+}
+
+bool nano::node::replica_supported () const
+{
+	return !flags.read_replica || dynamic_cast<nano::mdb_store *> (store_impl.get ()) != nullptr;
 }
 
 nano::inactive_node::inactive_node (boost::filesystem::path const & path_a, uint16_t peering_port_a, nano::node_flags const & node_flags) :
@@ -1373,11 +1484,11 @@ nano::node_flags const & nano::inactive_node_flag_defaults ()
 	return node_flags;
 }
 
-std::unique_ptr<nano::block_store> nano::make_store (nano::logger_mt & logger, boost::filesystem::path const & path, bool read_only, bool add_db_postfix, nano::rocksdb_config const & rocksdb_config, nano::txn_tracking_config const & txn_tracking_config_a, std::chrono::milliseconds block_processor_batch_max_time_a, int lmdb_max_dbs, size_t batch_size, bool backup_before_upgrade, bool use_rocksdb_backend)
+std::unique_ptr<nano::block_store> nano::make_store (nano::logger_mt & logger, boost::filesystem::path const & path, bool read_only, bool add_db_postfix, nano::rocksdb_config const & rocksdb_config, nano::txn_tracking_config const & txn_tracking_config_a, std::chrono::milliseconds block_processor_batch_max_time_a, int lmdb_max_dbs, size_t batch_size, bool backup_before_upgrade, bool use_rocksdb_backend, nano::durability_config const & durability_config, nano::compression_config const & compression_config)
 {
 #if NANO_ROCKSDB
-	auto make_rocksdb = [&logger, add_db_postfix, &path, &rocksdb_config, read_only]() {
-		return std::make_unique<nano::rocksdb_store> (logger, add_db_postfix ? path / "rocksdb" : path, rocksdb_config, read_only);
+	auto make_rocksdb = [&logger, add_db_postfix, &path, &rocksdb_config, read_only, &durability_config, &compression_config]() {
+		return std::make_unique<nano::rocksdb_store> (logger, add_db_postfix ? path / "rocksdb" : path, rocksdb_config, read_only, durability_config, compression_config);
 	};
 #endif
 
@@ -1404,5 +1515,5 @@ std::unique_ptr<nano::block_store> nano::make_store (nano::logger_mt & logger, b
 #endif
 	}
 
-	return std::make_unique<nano::mdb_store> (logger, add_db_postfix ? path / "data.ldb" : path, txn_tracking_config_a, block_processor_batch_max_time_a, lmdb_max_dbs, batch_size, backup_before_upgrade);
+	return std::make_unique<nano::mdb_store> (logger, add_db_postfix ? path / "data.ldb" : path, txn_tracking_config_a, block_processor_batch_max_time_a, lmdb_max_dbs, batch_size, backup_before_upgrade, durability_config, compression_config, read_only);
 }
@@ -24,7 +24,9 @@
 #include <nano/node/payment_observer_processor.hpp>
 #include <nano/node/portmapping.hpp>
 #include <nano/node/repcrawler.hpp>
+#include <nano/node/request_aggregator.hpp>
 #include <nano/node/signatures.hpp>
+#include <nano/node/unchecked_staging.hpp>
 #include <nano/node/vote_processor.hpp>
 #include <nano/node/wallet.hpp>
 #include <nano/node/websocket.hpp>
@@ -117,6 +119,11 @@ public:
 	void ongoing_bootstrap ();
 	void ongoing_store_flush ();
 	void ongoing_peer_store ();
+	/** Picks up commits made by the node writing the ledger when running as a read replica, returns true if there were any */
+	bool replica_refresh ();
+	void ongoing_replica_refresh ();
+	/** Starts an online compaction of the store on its own thread, returns true if one is already running or the store is read-only */
+	bool compact_store (uint64_t max_bytes_per_second_a);
 	void ongoing_unchecked_cleanup ();
 	void backup_wallet ();
 	void search_pending ();
@@ -143,6 +150,8 @@ public:
 	void ongoing_online_weight_calculation_queue ();
 	bool online () const;
 	bool init_error () const;
+	/** Only LMDB ledgers observe commits made by another process once opened */
+	bool replica_supported () const;
 	nano::worker worker;
 	nano::write_database_queue write_database_queue;
 	boost::asio::io_context & io_ctx;
@@ -161,6 +170,7 @@ public:
 	std::unique_ptr<nano::wallets_store> wallets_store_impl;
 	nano::wallets_store & wallets_store;
 	nano::gap_cache gap_cache;
+	nano::unchecked_staging unchecked_staging;
 	nano::ledger ledger;
 	nano::signature_checker checker;
 	nano::network network;
@@ -185,7 +195,13 @@ public:
 	nano::confirmation_height_processor confirmation_height_processor;
 	nano::payment_observer_processor payment_observer_processor;
 	nano::wallets wallets;
+	nano::request_aggregator aggregator;
 	const std::chrono::steady_clock::time_point startup_time;
+	/** Last time a read replica reloaded the ledger cache, and whether commits were picked up since */
+	std::chrono::steady_clock::time_point replica_reloaded{ std::chrono::steady_clock::now () };
+	bool replica_reload_needed{ false };
+	boost::thread compaction_thread;
+	std::atomic<bool> compacting{ false };
 	std::chrono::seconds unchecked_cutoff = std::chrono::seconds (7 * 24 * 60 * 60); // Week
 	std::atomic<bool> unresponsive_work_peers{ false };
 	std::atomic<bool> stopped{ false };
@@ -11,5 +11,6 @@ std::unique_ptr<nano::seq_con_info_component> nano::collect_seq_con_info (nano::
 	composite->add_component (collect_seq_con_info (node_observers.endpoint, "endpoint"));
 	composite->add_component (collect_seq_con_info (node_observers.disconnect, "disconnect"));
 	composite->add_component (collect_seq_con_info (node_observers.work_cancel, "work_cancel"));
+	composite->add_component (collect_seq_con_info (node_observers.replica_refresh, "replica_refresh"));
 	return composite;
 }
@@ -22,6 +22,8 @@ public:
 	nano::observer_set<> disconnect;
 	nano::observer_set<uint64_t> difficulty;
 	nano::observer_set<nano::root const &> work_cancel;
+	/** Read replicas notify the block count whenever they pick up commits from the node writing the ledger */
+	nano::observer_set<uint64_t> replica_refresh;
 };
 
 std::unique_ptr<seq_con_info_component> collect_seq_con_info (node_observers & node_observers, const std::string & name);
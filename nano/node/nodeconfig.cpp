@@ -97,7 +97,7 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	toml.put ("use_memory_pools", use_memory_pools, "If true, allocate memory from memory pools. Enabling this may improve performance. Memory is never released to the OS.\ntype:bool");
 	toml.put ("confirmation_history_size", confirmation_history_size, "Maximum confirmation history size. If tracking the rate of block confirmations, the websocket feature is recommended instead.\ntype:uint64");
 	toml.put ("active_elections_size", active_elections_size, "Number of active elections. Elections beyond this limit have limited survival time.\nWarning: modifying this value may result in a lower confirmation rate.\ntype:uint64,[250..]");
-	toml.put ("bandwidth_limit", bandwidth_limit, "Outbound traffic limit in bytes/sec after which messages will be dropped.\nNote: changing to unlimited bandwidth is not recommended for limited connections.\ntype:uint64");
+	toml.put ("bandwidth_limit", bandwidth_limit, "Outbound traffic limit in bytes/sec after which messages will be deferred or dropped.\nVotes, confirmation requests, publishes and bootstrap messages each have a guaranteed share of it.\nNote: changing to unlimited bandwidth is not recommended for limited connections.\ntype:uint64");
 	toml.put ("conf_height_processor_batch_min_time", conf_height_processor_batch_min_time.count (), "Minimum write batching time when there are blocks pending confirmation height.\ntype:milliseconds");
 	toml.put ("backup_before_upgrade", backup_before_upgrade, "Backup the ledger database before performing upgrades.\nWarning: uses more disk storage and increases startup time when upgrading.\ntype:bool");
 	toml.put ("work_watcher_period", work_watcher_period.count (), "Time between checks for confirmation and re-generating higher difficulty work if unconfirmed, for blocks in the work watcher.\ntype:seconds");
@@ -161,6 +161,14 @@ nano::error nano::node_config::serialize_toml (nano::tomlconfig & toml) const
 	rocksdb_config.serialize_toml (rocksdb_l);
 	toml.put_child ("rocksdb", rocksdb_l);
 
+	nano::tomlconfig durability_l;
+	durability_config.serialize_toml (durability_l);
+	toml.put_child ("durability", durability_l);
+
+	nano::tomlconfig compression_l;
+	compression_config.serialize_toml (compression_l);
+	toml.put_child ("compression", compression_l);
+
 	return toml.get_error ();
 }
 
@@ -212,6 +220,18 @@ nano::error nano::node_config::deserialize_toml (nano::tomlconfig & toml)
 			rocksdb_config.deserialize_toml (rocksdb_config_l);
 		}
 
+		if (toml.has_key ("durability"))
+		{
+			auto durability_config_l (toml.get_required_child ("durability"));
+			durability_config.deserialize_toml (durability_config_l);
+		}
+
+		if (toml.has_key ("compression"))
+		{
+			auto compression_config_l (toml.get_required_child ("compression"));
+			compression_config.deserialize_toml (compression_config_l);
+		}
+
 		if (toml.has_key ("work_peers"))
 		{
 			work_peers.clear ();
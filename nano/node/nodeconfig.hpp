@@ -2,6 +2,8 @@
 
 #include <nano/lib/config.hpp>
 #include <nano/lib/diagnosticsconfig.hpp>
+#include <nano/lib/compressionconfig.hpp>
+#include <nano/lib/durabilityconfig.hpp>
 #include <nano/lib/errors.hpp>
 #include <nano/lib/jsonconfig.hpp>
 #include <nano/lib/numbers.hpp>
@@ -94,6 +96,8 @@ public:
 	double max_work_generate_multiplier{ 64. };
 	uint64_t max_work_generate_difficulty{ nano::network_constants::publish_full_threshold };
 	nano::rocksdb_config rocksdb_config;
+	nano::durability_config durability_config;
+	nano::compression_config compression_config;
 	nano::frontiers_confirmation_mode frontiers_confirmation{ nano::frontiers_confirmation_mode::automatic };
 	std::string serialize_frontiers_confirmation (nano::frontiers_confirmation_mode) const;
 	nano::frontiers_confirmation_mode deserialize_frontiers_confirmation (std::string const &);
@@ -124,6 +128,8 @@ public:
 	bool disable_unchecked_drop{ true };
 	bool fast_bootstrap{ false };
 	bool read_only{ false };
+	/** Serve queries from a ledger written by a node in another process, without networking, voting or block processing. Implies read_only */
+	bool read_replica{ false };
 	/** Whether to read all frontiers and construct the representative weights */
 	bool cache_representative_weights_from_frontiers{ true };
 	/** Whether to read all frontiers and construct the total cemented count */
@@ -133,5 +139,7 @@ public:
 	size_t block_processor_batch_size{ 0 };
 	size_t block_processor_full_size{ 65536 };
 	size_t block_processor_verification_size{ 0 };
+	/** Memory budget for gap blocks staged in memory while bootstrapping, 0 writes them to the unchecked table directly. Staged blocks are persisted when the node stops, not on a crash */
+	size_t unchecked_staging_size{ 64 * 1024 * 1024 };
 };
 }
@@ -127,7 +127,13 @@ bool nano::rep_crawler::response (std::shared_ptr<nano::transport::channel> chan
 	if (existing != probable_reps.end ())
 	{
 		probable_reps.modify (existing, [weight_a, &updated_or_inserted, rep_account_a, channel_a](nano::representative & info) {
-			info.last_response = std::chrono::steady_clock::now ();
+			auto now (std::chrono::steady_clock::now ());
+			// Only the first vote after a query is a response to it
+			if (info.last_request > info.last_response && info.channel->get_endpoint () == channel_a->get_endpoint ())
+			{
+				channel_a->stats->add_rtt (now - info.last_request);
+			}
+			info.last_response = now;
 
 			// Update if representative channel was changed
 			if (info.channel->get_endpoint () != channel_a->get_endpoint ())
@@ -0,0 +1,224 @@
+#include <nano/lib/stats.hpp>
+#include <nano/node/node.hpp>
+#include <nano/node/request_aggregator.hpp>
+
+#include <algorithm>
+
+nano::request_aggregator::request_aggregator (nano::node & node_a) :
+max_delay (node_a.network_params.network.is_test_network () ? 50 : 300),
+small_delay (node_a.network_params.network.is_test_network () ? 10 : 50),
+node (node_a),
+thread ([this]() { run (); })
+{
+	nano::unique_lock<std::mutex> lock (mutex);
+	condition.wait (lock, [& started = started] { return started; });
+}
+
+void nano::request_aggregator::add (std::shared_ptr<nano::transport::channel> const & channel_a, std::vector<std::pair<nano::block_hash, nano::root>> const & hashes_roots_a)
+{
+	bool error (true);
+	auto const endpoint (channel_a->get_endpoint ());
+	auto const now (std::chrono::steady_clock::now ());
+	nano::unique_lock<std::mutex> lock (mutex);
+	// Protect from ever-increasing memory usage when requests are consumed slower than they arrive:
+	// reject new requests while the oldest pool is overdue by more than max_delay
+	if (requests.empty () || requests.get<tag_deadline> ().begin ()->deadline + max_delay > now)
+	{
+		auto & requests_by_endpoint (requests.get<tag_endpoint> ());
+		auto existing (requests_by_endpoint.find (endpoint));
+		if (existing == requests_by_endpoint.end ())
+		{
+			existing = requests_by_endpoint.emplace (channel_a, now + small_delay).first;
+		}
+		requests_by_endpoint.modify (existing, [&hashes_roots_a, &channel_a, &error, &now, this](channel_pool & pool_a) {
+			// Replies go to the most recent channel for this endpoint
+			pool_a.channel = channel_a;
+			if (pool_a.hashes_roots.size () + hashes_roots_a.size () <= this->max_channel_requests)
+			{
+				error = false;
+				pool_a.deadline = std::min (pool_a.start + this->max_delay, now + this->small_delay);
+				pool_a.hashes_roots.insert (pool_a.hashes_roots.end (), hashes_roots_a.begin (), hashes_roots_a.end ());
+			}
+		});
+		if (requests.size () == 1)
+		{
+			lock.unlock ();
+			condition.notify_all ();
+		}
+	}
+	node.stats.inc (nano::stat::type::aggregator, !error ? nano::stat::detail::aggregator_accepted : nano::stat::detail::aggregator_dropped);
+}
+
+void nano::request_aggregator::run ()
+{
+	nano::thread_role::set (nano::thread_role::name::request_aggregator);
+	nano::unique_lock<std::mutex> lock (mutex);
+	started = true;
+	lock.unlock ();
+	condition.notify_all ();
+	lock.lock ();
+	while (!stopped)
+	{
+		if (!requests.empty ())
+		{
+			auto & requests_by_deadline (requests.get<tag_deadline> ());
+			auto front (requests_by_deadline.begin ());
+			if (front->deadline < std::chrono::steady_clock::now ())
+			{
+				// Take ownership of the pool contents so the lock is not held while replying
+				std::vector<std::pair<nano::block_hash, nano::root>> hashes_roots;
+				requests_by_deadline.modify (front, [&hashes_roots](channel_pool & pool_a) {
+					hashes_roots.swap (pool_a.hashes_roots);
+				});
+				auto channel (front->channel);
+				requests_by_deadline.erase (front);
+				lock.unlock ();
+				{
+					auto transaction (node.store.tx_begin_read ());
+					aggregate (transaction, channel, hashes_roots);
+				}
+				lock.lock ();
+			}
+			else
+			{
+				auto deadline (front->deadline);
+				condition.wait_until (lock, deadline, [this, &deadline]() { return this->stopped || deadline < std::chrono::steady_clock::now (); });
+			}
+		}
+		else
+		{
+			condition.wait_for (lock, small_delay, [this]() { return this->stopped || !this->requests.empty (); });
+		}
+	}
+}
+
+void nano::request_aggregator::stop ()
+{
+	{
+		nano::lock_guard<std::mutex> guard (mutex);
+		stopped = true;
+	}
+	condition.notify_all ();
+	if (thread.joinable ())
+	{
+		thread.join ();
+	}
+}
+
+size_t nano::request_aggregator::size ()
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	return requests.size ();
+}
+
+bool nano::request_aggregator::empty ()
+{
+	return size () == 0;
+}
+
+void nano::request_aggregator::aggregate (nano::transaction const & transaction_a, std::shared_ptr<nano::transport::channel> const & channel_a, std::vector<std::pair<nano::block_hash, nano::root>> & hashes_roots_a)
+{
+	// The same hash is often requested several times within the window
+	std::sort (hashes_roots_a.begin (), hashes_roots_a.end (), [](std::pair<nano::block_hash, nano::root> const & a, std::pair<nano::block_hash, nano::root> const & b) {
+		return a.first < b.first || (a.first == b.first && a.second.raw < b.second.raw);
+	});
+	hashes_roots_a.erase (std::unique (hashes_roots_a.begin (), hashes_roots_a.end ()), hashes_roots_a.end ());
+
+	size_t cached_hashes (0);
+	size_t unknown (0);
+	std::vector<nano::block_hash> to_generate;
+	std::vector<std::shared_ptr<nano::vote>> cached_votes;
+	for (auto const & hash_root : hashes_roots_a)
+	{
+		auto find_votes (node.votes_cache.find (hash_root.first));
+		if (!find_votes.empty ())
+		{
+			++cached_hashes;
+			cached_votes.insert (cached_votes.end (), find_votes.begin (), find_votes.end ());
+		}
+		else if (!hash_root.first.is_zero () && node.store.block_exists (transaction_a, hash_root.first))
+		{
+			to_generate.push_back (hash_root.first);
+		}
+		else if (!hash_root.second.is_zero ())
+		{
+			// Search for block root
+			auto successor (node.store.block_successor (transaction_a, hash_root.second));
+			// Search for account root
+			if (successor.is_zero ())
+			{
+				nano::account_info info;
+				auto error (node.store.account_get (transaction_a, hash_root.second, info));
+				if (!error)
+				{
+					successor = info.open_block;
+				}
+			}
+			if (!successor.is_zero ())
+			{
+				auto find_successor_votes (node.votes_cache.find (successor));
+				if (!find_successor_votes.empty ())
+				{
+					++cached_hashes;
+					cached_votes.insert (cached_votes.end (), find_successor_votes.begin (), find_successor_votes.end ());
+				}
+				else
+				{
+					to_generate.push_back (successor);
+				}
+				// The requester does not have our winning block for this root
+				auto successor_block (node.store.block_get (transaction_a, successor));
+				assert (successor_block != nullptr);
+				nano::publish publish (successor_block);
+				channel_a->send (publish);
+			}
+			else
+			{
+				++unknown;
+			}
+		}
+		else
+		{
+			++unknown;
+		}
+	}
+	// A cached vote usually covers several of the requested hashes, send it once
+	std::sort (cached_votes.begin (), cached_votes.end ());
+	cached_votes.erase (std::unique (cached_votes.begin (), cached_votes.end ()), cached_votes.end ());
+	for (auto const & vote : cached_votes)
+	{
+		nano::confirm_ack confirm (vote);
+		channel_a->send (confirm);
+	}
+	// Remove duplicates introduced by several roots resolving to the same successor
+	std::sort (to_generate.begin (), to_generate.end ());
+	to_generate.erase (std::unique (to_generate.begin (), to_generate.end ()), to_generate.end ());
+	size_t generated_votes (0);
+	if (!to_generate.empty ())
+	{
+		generated_votes = node.block_processor.generator.generate (to_generate, channel_a);
+	}
+	node.stats.add (nano::stat::type::requests, nano::stat::detail::requests_cached_hashes, nano::stat::dir::in, cached_hashes);
+	node.stats.add (nano::stat::type::requests, nano::stat::detail::requests_cached_votes, nano::stat::dir::in, cached_votes.size ());
+	node.stats.add (nano::stat::type::requests, nano::stat::detail::requests_generated_hashes, nano::stat::dir::in, to_generate.size ());
+	node.stats.add (nano::stat::type::requests, nano::stat::detail::requests_generated_votes, nano::stat::dir::in, generated_votes);
+	node.stats.add (nano::stat::type::requests, nano::stat::detail::requests_unknown, nano::stat::dir::in, unknown);
+}
+
+std::unique_ptr<nano::seq_con_info_component> nano::collect_seq_con_info (nano::request_aggregator & aggregator, const std::string & name)
+{
+	size_t pools_count = 0;
+	size_t hashes_count = 0;
+	{
+		nano::lock_guard<std::mutex> guard (aggregator.mutex);
+		pools_count = aggregator.requests.size ();
+		for (auto const & pool : aggregator.requests)
+		{
+			hashes_count += pool.hashes_roots.size ();
+		}
+	}
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "pools", pools_count, sizeof (decltype (aggregator.requests)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "hashes_roots", hashes_count, sizeof (std::pair<nano::block_hash, nano::root>) }));
+	return composite;
+}
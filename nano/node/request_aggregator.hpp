@@ -0,0 +1,99 @@
+#pragma once
+
+#include <nano/lib/locks.hpp>
+#include <nano/lib/numbers.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/node/transport/transport.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/thread.hpp>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mi = boost::multi_index;
+
+namespace nano
+{
+class node;
+class transaction;
+
+/**
+ * Pools confirmation requests by channel to reduce duplicate vote generation and bandwidth.
+ * Requests arriving from the same channel within a short window are merged into a single batch. A batch is answered
+ * with cached votes where available and with at most one new vote per local representative for every 12 remaining hashes.
+ */
+class request_aggregator final
+{
+	/**
+	 * Holds the requests of a single channel. The deadline is pushed back by small_delay with every new request,
+	 * up to max_delay after the pool was created.
+	 */
+	class channel_pool final
+	{
+	public:
+		channel_pool () = delete;
+		explicit channel_pool (std::shared_ptr<nano::transport::channel> const & channel_a, std::chrono::steady_clock::time_point const & deadline_a) :
+		channel (channel_a),
+		endpoint (channel_a->get_endpoint ()),
+		deadline (deadline_a)
+		{
+		}
+		std::vector<std::pair<nano::block_hash, nano::root>> hashes_roots;
+		std::shared_ptr<nano::transport::channel> channel;
+		nano::endpoint endpoint;
+		std::chrono::steady_clock::time_point const start{ std::chrono::steady_clock::now () };
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	// clang-format off
+	class tag_endpoint {};
+	class tag_deadline {};
+	// clang-format on
+
+public:
+	request_aggregator () = delete;
+	request_aggregator (nano::node &);
+
+	/** Add requests from \p channel_a, merging them with any requests from the same endpoint that are not yet processed */
+	void add (std::shared_ptr<nano::transport::channel> const & channel_a, std::vector<std::pair<nano::block_hash, nano::root>> const & hashes_roots_a);
+	void stop ();
+	/** Returns the number of currently queued channel pools */
+	size_t size ();
+	bool empty ();
+
+	std::chrono::milliseconds const max_delay;
+	std::chrono::milliseconds const small_delay;
+	size_t const max_channel_requests{ 4096 };
+
+private:
+	void run ();
+	/** Replies to the requests of a single channel. Cached votes are sent as they are, the remaining hashes are signed in bulk */
+	void aggregate (nano::transaction const &, std::shared_ptr<nano::transport::channel> const &, std::vector<std::pair<nano::block_hash, nano::root>> &);
+
+	nano::node & node;
+	// clang-format off
+	boost::multi_index_container<channel_pool,
+	mi::indexed_by<
+		mi::hashed_unique<mi::tag<tag_endpoint>,
+			mi::member<channel_pool, nano::endpoint, &channel_pool::endpoint>>,
+		mi::ordered_non_unique<mi::tag<tag_deadline>,
+			mi::member<channel_pool, std::chrono::steady_clock::time_point, &channel_pool::deadline>>>>
+	requests;
+	// clang-format on
+
+	bool stopped{ false };
+	bool started{ false };
+	nano::condition_variable condition;
+	std::mutex mutex;
+	boost::thread thread;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (request_aggregator &, const std::string &);
+};
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (request_aggregator &, const std::string &);
+}
@@ -7,8 +7,11 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/polymorphic_cast.hpp>
 
+#include <unordered_set>
+
 #include <rocksdb/merge_operator.h>
 #include <rocksdb/slice.h>
+#include <rocksdb/slice_transform.h>
 #include <rocksdb/utilities/backupable_db.h>
 #include <rocksdb/utilities/transaction.h>
 #include <rocksdb/utilities/transaction_db.h>
@@ -40,10 +43,59 @@ void rocksdb_val::convert_buffer_to_value ()
 }
 }
 
-nano::rocksdb_store::rocksdb_store (nano::logger_mt & logger_a, boost::filesystem::path const & path_a, nano::rocksdb_config const & rocksdb_config_a, bool open_read_only_a) :
+namespace
+{
+/**
+ * Adds big-endian 64-bit operands to the stored counter, wrapping on overflow so decrements are merged as two's complement additions.
+ * Merges commute, allowing concurrent write transactions to update the same counter without conflicting
+ */
+class counter_merge_operator final : public rocksdb::AssociativeMergeOperator
+{
+public:
+	bool Merge (rocksdb::Slice const &, rocksdb::Slice const * existing_value_a, rocksdb::Slice const & value_a, std::string * new_value_a, rocksdb::Logger *) const override
+	{
+		auto result (value_a.size () == sizeof (uint64_t) && (existing_value_a == nullptr || existing_value_a->size () == sizeof (uint64_t)));
+		if (result)
+		{
+			auto sum (decode (value_a));
+			if (existing_value_a != nullptr)
+			{
+				sum += decode (*existing_value_a);
+			}
+			boost::endian::native_to_big_inplace (sum);
+			new_value_a->assign (reinterpret_cast<char const *> (&sum), sizeof (sum));
+		}
+		return result;
+	}
+
+	char const * Name () const override
+	{
+		return "nano_counter";
+	}
+
+private:
+	static uint64_t decode (rocksdb::Slice const & slice_a)
+	{
+		uint64_t result;
+		std::memcpy (&result, slice_a.data (), sizeof (result));
+		return boost::endian::big_to_native (result);
+	}
+};
+}
+
+nano::rocksdb_store::rocksdb_store (nano::logger_mt & logger_a, boost::filesystem::path const & path_a, nano::rocksdb_config const & rocksdb_config_a, bool open_read_only_a, nano::durability_config const & durability_config_a, nano::compression_config const & compression_config_a) :
 logger (logger_a),
-rocksdb_config (rocksdb_config_a)
+rocksdb_config (rocksdb_config_a),
+compression_config (compression_config_a)
 {
+	if (compression_config.enable)
+	{
+		for (auto const & table : compression_config.tables)
+		{
+			// Block column families are named after their block type, except for state blocks
+			compressed_families.insert (table == "state" ? "state_blocks" : table);
+		}
+	}
 	boost::system::error_code error_mkdir, error_chmod;
 	boost::filesystem::create_directories (path_a, error_mkdir);
 	nano::set_secure_perm_directory (path_a, error_chmod);
@@ -51,18 +103,32 @@ rocksdb_config (rocksdb_config_a)
 
 	if (!error)
 	{
-		auto table_options = get_table_options ();
-		table_factory.reset (rocksdb::NewBlockBasedTableFactory (table_options));
+		block_cache = rocksdb::NewLRUCache (rocksdb_config.block_cache * 1024 * 1024ULL);
 		if (!open_read_only_a)
 		{
 			construct_column_family_mutexes ();
 		}
 		open (error, path_a, open_read_only_a);
+		if (!error && !open_read_only_a)
+		{
+			initialize_counts ();
+			do_upgrades ();
+		}
+	}
+	if (!error && !open_read_only_a && durability_config_a.mode != nano::durability_mode::sync)
+	{
+		// Writes do not sync the write-ahead log
+		group_commit = std::make_unique<nano::group_commit> (durability_config_a, [db = db]() {
+			auto status (db->SyncWAL ());
+			release_assert (status.ok ());
+		});
 	}
 }
 
 nano::rocksdb_store::~rocksdb_store ()
 {
+	// Flushes outstanding commits before the database is closed
+	group_commit.reset ();
 	for (auto handle : handles)
 	{
 		delete handle;
@@ -73,11 +139,11 @@ nano::rocksdb_store::~rocksdb_store ()
 
 void nano::rocksdb_store::open (bool & error_a, boost::filesystem::path const & path_a, bool open_read_only_a)
 {
-	std::initializer_list<const char *> names{ rocksdb::kDefaultColumnFamilyName.c_str (), "frontiers", "accounts", "send", "receive", "open", "change", "state_blocks", "pending", "representation", "unchecked", "vote", "online_weight", "meta", "peers", "cached_counts", "confirmation_height" };
+	std::initializer_list<const char *> names{ rocksdb::kDefaultColumnFamilyName.c_str (), "frontiers", "accounts", "send", "receive", "open", "change", "state_blocks", "pending", "representation", "unchecked", "vote", "online_weight", "meta", "peers", "cached_counts", "confirmation_height", "pending_amounts", "pending_summary" };
 	std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
 	for (const auto & cf_name : names)
 	{
-		column_families.emplace_back (cf_name, get_cf_options ());
+		column_families.emplace_back (cf_name, get_cf_options (cf_name));
 	}
 
 	auto options = get_db_options ();
@@ -128,12 +194,21 @@ nano::write_transaction nano::rocksdb_store::tx_begin_write (std::vector<nano::t
 	// Tables must be kept in alphabetical order. These can be used for mutex locking, so order is important to prevent deadlocking
 	assert (std::is_sorted (tables_requiring_locks_a.begin (), tables_requiring_locks_a.end ()));
 
-	return nano::write_transaction{ std::move (txn) };
+	nano::write_transaction result{ std::move (txn) };
+	result.track_cache (cache_m);
+	if (group_commit != nullptr)
+	{
+		result.track_group_commit (*group_commit);
+	}
+	return result;
 }
 
 nano::read_transaction nano::rocksdb_store::tx_begin_read ()
 {
-	return nano::read_transaction{ std::make_unique<nano::read_rocksdb_txn> (db) };
+	auto generation (cache_m.generation.load ());
+	nano::read_transaction result{ std::make_unique<nano::read_rocksdb_txn> (db) };
+	result.track_cache (cache_m, generation);
+	return result;
 }
 
 rocksdb::ColumnFamilyHandle * nano::rocksdb_store::table_to_column_family (tables table_a) const
@@ -165,6 +240,10 @@ rocksdb::ColumnFamilyHandle * nano::rocksdb_store::table_to_column_family (table
 			return get_handle ("state_blocks");
 		case tables::pending:
 			return get_handle ("pending");
+		case tables::pending_amounts:
+			return get_handle ("pending_amounts");
+		case tables::pending_summary:
+			return get_handle ("pending_summary");
 		case tables::blocks_info:
 			assert (false);
 		case tables::representation:
@@ -271,49 +350,110 @@ int nano::rocksdb_store::get (nano::transaction const & transaction_a, tables ta
 	return status.code ();
 }
 
+void nano::rocksdb_store::get_many (nano::transaction const & transaction_a, tables table_a, std::vector<nano::rocksdb_val> const & keys_a, std::vector<nano::rocksdb_val> & values_a, std::vector<int> & statuses_a) const
+{
+	std::vector<rocksdb::ColumnFamilyHandle *> handles_l (keys_a.size (), table_to_column_family (table_a));
+	std::vector<rocksdb::Slice> keys_l (keys_a.begin (), keys_a.end ());
+	std::vector<std::string> values_l;
+	std::vector<rocksdb::Status> statuses_l;
+	if (is_read (transaction_a))
+	{
+		statuses_l = db->MultiGet (snapshot_options (transaction_a), handles_l, keys_l, &values_l);
+	}
+	else
+	{
+		statuses_l = tx (transaction_a)->MultiGet (rocksdb::ReadOptions{}, handles_l, keys_l, &values_l);
+	}
+	values_a.resize (keys_a.size ());
+	statuses_a.resize (keys_a.size ());
+	for (size_t i (0); i < keys_a.size (); ++i)
+	{
+		statuses_a[i] = statuses_l[i].code ();
+		if (statuses_l[i].ok ())
+		{
+			values_a[i].buffer = std::make_shared<std::vector<uint8_t>> (values_l[i].begin (), values_l[i].end ());
+			values_a[i].convert_buffer_to_value ();
+		}
+	}
+}
+
 /** The column families which need to have their counts cached for later querying */
 bool nano::rocksdb_store::is_caching_counts (nano::tables table_a) const
 {
-	switch (table_a)
+	// FIFO compaction drops unchecked files without deleting their keys
+	return table_a != tables::cached_counts && !(table_a == tables::unchecked && rocksdb_config.unchecked_fifo_size > 0);
+}
+
+/*
+ * Counters are updated with untracked merges, they neither need the cached_counts table lock nor take part in conflict detection
+ * as merges from concurrent write transactions commute.
+ */
+int nano::rocksdb_store::increment (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a)
+{
+	return tx (transaction_a)->MergeUntracked (table_to_column_family (table_a), key_a, nano::rocksdb_val (amount_a)).code ();
+}
+
+int nano::rocksdb_store::decrement (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a)
+{
+	return tx (transaction_a)->MergeUntracked (table_to_column_family (table_a), key_a, nano::rocksdb_val (uint64_t{ 0 } - amount_a)).code ();
+}
+
+void nano::rocksdb_store::do_upgrades ()
+{
+	// Versions are only recorded from version 16, earlier databases are seen as version 1
+	auto transaction (tx_begin_write ());
+	if (version_get (transaction) < 16)
 	{
-		case tables::accounts:
-		case tables::unchecked:
-		case tables::send_blocks:
-		case tables::receive_blocks:
-		case tables::open_blocks:
-		case tables::change_blocks:
-		case tables::state_blocks:
-			return true;
-		default:
-			return false;
+		pending_index_rebuild (transaction);
+		version_put (transaction, 16);
 	}
 }
 
-int nano::rocksdb_store::increment (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a)
+void nano::rocksdb_store::initialize_counts ()
 {
-	release_assert (transaction_a.contains (table_a));
-	uint64_t base;
-	nano::rocksdb_val value;
-	if (!success (get (transaction_a, table_a, key_a, value)))
+	// Tables which were not counted by earlier versions are iterated once. Counters of tables which are no longer counted
+	// are removed so they are recounted if this changes back
+	std::vector<nano::tables> uncounted;
+	std::vector<nano::tables> stale;
 	{
-		base = 0;
+		auto transaction (tx_begin_read ());
+		for (auto table : all_tables ())
+		{
+			nano::rocksdb_val value;
+			auto exists_l (success (get (transaction, tables::cached_counts, nano::rocksdb_val (rocksdb::Slice (table_to_column_family (table)->GetName ())), value)));
+			if (is_caching_counts (table) && !exists_l)
+			{
+				uncounted.push_back (table);
+			}
+			else if (!is_caching_counts (table) && exists_l)
+			{
+				stale.push_back (table);
+			}
+		}
 	}
-	else
+	if (!uncounted.empty () || !stale.empty ())
 	{
-		base = static_cast<uint64_t> (value);
+		auto transaction (tx_begin_write ({ tables::cached_counts }));
+		for (auto table : uncounted)
+		{
+			auto status (put (transaction, tables::cached_counts, nano::rocksdb_val (rocksdb::Slice (table_to_column_family (table)->GetName ())), nano::rocksdb_val (iterate_count (transaction, table))));
+			release_assert (success (status));
+		}
+		for (auto table : stale)
+		{
+			auto status (del (transaction, tables::cached_counts, nano::rocksdb_val (rocksdb::Slice (table_to_column_family (table)->GetName ()))));
+			release_assert (success (status));
+		}
 	}
-
-	return put (transaction_a, table_a, key_a, nano::rocksdb_val (base + amount_a));
 }
 
-int nano::rocksdb_store::decrement (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a)
+uint64_t nano::rocksdb_store::iterate_count (nano::transaction const & transaction_a, tables table_a) const
 {
-	release_assert (transaction_a.contains (table_a));
-	nano::rocksdb_val value;
-	auto status = get (transaction_a, table_a, key_a, value);
-	release_assert (success (status));
-	auto base = static_cast<uint64_t> (value);
-	return put (transaction_a, table_a, key_a, nano::rocksdb_val (base - amount_a));
+	uint64_t result (0);
+	raw_for_each (transaction_a, table_a, [&result](uint8_t const *, size_t, uint8_t const *, size_t) {
+		++result;
+	});
+	return result;
 }
 
 int nano::rocksdb_store::put (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, nano::rocksdb_val const & value_a)
@@ -348,45 +488,30 @@ int nano::rocksdb_store::status_code_not_found () const
 	return static_cast<int> (rocksdb::Status::Code::kNotFound);
 }
 
-uint64_t nano::rocksdb_store::count (nano::transaction const & transaction_a, rocksdb::ColumnFamilyHandle * handle) const
-{
-	uint64_t count = 0;
-	nano::rocksdb_val val;
-	auto const & key = handle->GetName ();
-	auto status = get (transaction_a, tables::cached_counts, nano::rocksdb_val (key.size (), (void *)key.data ()), val);
-	if (success (status))
-	{
-		count = static_cast<uint64_t> (val);
-	}
-
-	release_assert (success (status) || not_found (status));
-	return count;
-}
-
 size_t nano::rocksdb_store::count (nano::transaction const & transaction_a, tables table_a) const
 {
-	size_t sum = 0;
-	// Some column families are small enough that they can just be iterated, rather than doing extra io caching counts
-	if (table_a == tables::peers)
+	uint64_t count = 0;
+	if (is_caching_counts (table_a))
 	{
-		for (auto i (peers_begin (transaction_a)), n (peers_end ()); i != n; ++i)
+		nano::rocksdb_val val;
+		auto const & key = table_to_column_family (table_a)->GetName ();
+		auto status = get (transaction_a, tables::cached_counts, nano::rocksdb_val (key.size (), (void *)key.data ()), val);
+		if (success (status))
 		{
-			++sum;
+			count = static_cast<uint64_t> (val);
 		}
-	}
-	else if (table_a == tables::online_weight)
-	{
-		for (auto i (online_weight_begin (transaction_a)), n (online_weight_end ()); i != n; ++i)
+		else
 		{
-			++sum;
+			// Counters are only initialized when opening for writing, read-only stores of older databases may miss some
+			release_assert (not_found (status));
+			count = iterate_count (transaction_a, table_a);
 		}
 	}
 	else
 	{
-		return count (transaction_a, table_to_column_family (table_a));
+		db->GetIntProperty (table_to_column_family (table_a), "rocksdb.estimate-num-keys", &count);
 	}
-
-	return sum;
+	return count;
 }
 
 int nano::rocksdb_store::drop (nano::write_transaction const & transaction_a, tables table_a)
@@ -395,7 +520,8 @@ int nano::rocksdb_store::drop (nano::write_transaction const & transaction_a, ta
 	auto col = table_to_column_family (table_a);
 
 	int status = static_cast<int> (rocksdb::Status::Code::kOk);
-	if (is_caching_counts (table_a))
+	// Peers are deleted one by one below which decrements their counter
+	if (is_caching_counts (table_a) && table_a != tables::peers)
 	{
 		// Reset counter to 0
 		status = put (transaction_a, tables::cached_counts, nano::rocksdb_val (rocksdb::Slice (col->GetName ())), nano::rocksdb_val (uint64_t{ 0 }));
@@ -433,7 +559,7 @@ int nano::rocksdb_store::clear (rocksdb::ColumnFamilyHandle * column_family)
 	// Need to add it back as we just want to clear the contents
 	auto handle_it = std::find (handles.begin (), handles.end (), column_family);
 	assert (handle_it != handles.cend ());
-	status = db->CreateColumnFamily (get_cf_options (), name, &column_family);
+	status = db->CreateColumnFamily (get_cf_options (name), name, &column_family);
 	release_assert (status.ok ());
 	*handle_it = column_family;
 	return status.code ();
@@ -472,20 +598,26 @@ rocksdb::Options nano::rocksdb_store::get_db_options () const
 	return db_options;
 }
 
-rocksdb::BlockBasedTableOptions nano::rocksdb_store::get_table_options () const
+rocksdb::BlockBasedTableOptions nano::rocksdb_store::get_table_options (std::string const & cf_name_a) const
 {
 	rocksdb::BlockBasedTableOptions table_options;
 
-	// Block cache for reads
-	table_options.block_cache = rocksdb::NewLRUCache (rocksdb_config.block_cache * 1024 * 1024ULL);
+	// Block cache for reads, shared by all column families
+	table_options.block_cache = block_cache;
 
 	// Bloom filter to help with point reads
-	auto bloom_filter_bits = rocksdb_config.bloom_filter_bits;
+	auto bloom_filter_bits = is_point_lookup_family (cf_name_a) ? rocksdb_config.point_lookup_bloom_filter_bits : rocksdb_config.bloom_filter_bits;
 	if (bloom_filter_bits > 0)
 	{
 		table_options.filter_policy.reset (rocksdb::NewBloomFilterPolicy (bloom_filter_bits, false));
 	}
 
+	if (is_point_lookup_family (cf_name_a))
+	{
+		// Hash index inside data blocks, point lookups avoid the binary search once the block is found
+		table_options.data_block_index_type = rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+	}
+
 	// Increasing block_size decreases memory usage and space amplification, but increases read amplification.
 	table_options.block_size = rocksdb_config.block_size * 1024ULL;
 
@@ -493,13 +625,33 @@ rocksdb::BlockBasedTableOptions nano::rocksdb_store::get_table_options () const
 	table_options.cache_index_and_filter_blocks = rocksdb_config.cache_index_and_filter_blocks;
 	table_options.pin_l0_filter_and_index_blocks_in_cache = rocksdb_config.cache_index_and_filter_blocks;
 
+	if (cf_name_a == "confirmation_height")
+	{
+		// Small and read for every cemented block, keep its index and filters pinned in the cache
+		table_options.cache_index_and_filter_blocks = true;
+		table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+		table_options.pin_top_level_index_and_filter = true;
+	}
+
 	return table_options;
 }
 
-rocksdb::ColumnFamilyOptions nano::rocksdb_store::get_cf_options () const
+/** Column families read by key far more often than they are iterated */
+bool nano::rocksdb_store::is_point_lookup_family (std::string const & cf_name_a) const
+{
+	static std::unordered_set<std::string> const names{ "accounts", "send", "receive", "open", "change", "state_blocks", "pending", "confirmation_height" };
+	return names.find (cf_name_a) != names.end ();
+}
+
+rocksdb::ColumnFamilyOptions nano::rocksdb_store::get_cf_options (std::string const & cf_name_a) const
 {
 	rocksdb::ColumnFamilyOptions cf_options;
-	cf_options.table_factory = table_factory;
+	cf_options.table_factory.reset (rocksdb::NewBlockBasedTableFactory (get_table_options (cf_name_a)));
+
+	if (cf_name_a == "cached_counts")
+	{
+		cf_options.merge_operator = std::make_shared<counter_merge_operator> ();
+	}
 
 	// Number of files in level which triggers compaction. Size of L0 and L1 should be kept similar as this is the only compaction which is single threaded
 	cf_options.level0_file_num_compaction_trigger = 4;
@@ -525,12 +677,129 @@ rocksdb::ColumnFamilyOptions nano::rocksdb_store::get_cf_options () const
 	// Number of memtables to keep in memory (1 active, rest inactive/immutable)
 	cf_options.max_write_buffer_number = rocksdb_config.num_memtables;
 
+	if (cf_name_a == "pending" && rocksdb_config.pending_prefix_extractor)
+	{
+		// Entries are keyed by destination account followed by the send block hash. The account prefix is added to the bloom filters
+		// and to a memtable bloom filter, so seeks to accounts without receivable entries are mostly answered without reading blocks
+		cf_options.prefix_extractor.reset (rocksdb::NewFixedPrefixTransform (sizeof (nano::account)));
+		cf_options.memtable_prefix_bloom_size_ratio = 0.02;
+	}
+	else if (cf_name_a == "unchecked" && rocksdb_config.unchecked_fifo_size > 0)
+	{
+		// Unchecked blocks are transient, the oldest files are dropped once the total size is exceeded or they are older than the ttl
+		cf_options.compaction_style = rocksdb::kCompactionStyleFIFO;
+		cf_options.compaction_options_fifo.max_table_files_size = rocksdb_config.unchecked_fifo_size * 1024 * 1024ULL;
+		cf_options.compaction_options_fifo.allow_compaction = true;
+	}
+	else if (cf_name_a == "confirmation_height")
+	{
+		cf_options.write_buffer_size = 1024ULL * 1024 * rocksdb_config.confirmation_height_memtable_size;
+		cf_options.target_file_size_base = 1024ULL * 1024 * rocksdb_config.confirmation_height_memtable_size;
+	}
+
+	if (compressed_families.find (cf_name_a) != compressed_families.end ())
+	{
+		// Files are compressed with a dictionary sampled from their own blocks, files written before keep their compression
+		cf_options.compression = rocksdb::kZlibCompression;
+		cf_options.compression_opts.max_dict_bytes = compression_config.dictionary_size * 1024;
+	}
+
 	return cf_options;
 }
 
 std::vector<nano::tables> nano::rocksdb_store::all_tables () const
 {
-	return std::vector<nano::tables>{ tables::accounts, tables::cached_counts, tables::change_blocks, tables::confirmation_height, tables::frontiers, tables::meta, tables::online_weight, tables::open_blocks, tables::peers, tables::pending, tables::receive_blocks, tables::representation, tables::send_blocks, tables::state_blocks, tables::unchecked, tables::vote };
+	return std::vector<nano::tables>{ tables::accounts, tables::cached_counts, tables::change_blocks, tables::confirmation_height, tables::frontiers, tables::meta, tables::online_weight, tables::open_blocks, tables::peers, tables::pending, tables::pending_amounts, tables::pending_summary, tables::receive_blocks, tables::representation, tables::send_blocks, tables::state_blocks, tables::unchecked, tables::vote };
+}
+
+void nano::rocksdb_store::raw_for_each (nano::transaction const & transaction_a, nano::tables table_a, std::function<void(uint8_t const *, size_t, uint8_t const *, size_t)> const & action_a) const
+{
+	std::unique_ptr<rocksdb::Iterator> iterator;
+	if (is_read (transaction_a))
+	{
+		iterator.reset (db->NewIterator (snapshot_options (transaction_a), table_to_column_family (table_a)));
+	}
+	else
+	{
+		rocksdb::ReadOptions options;
+		options.fill_cache = false;
+		options.total_order_seek = true;
+		iterator.reset (tx (transaction_a)->GetIterator (options, table_to_column_family (table_a)));
+	}
+	for (iterator->SeekToFirst (); iterator->Valid (); iterator->Next ())
+	{
+		auto key (iterator->key ());
+		auto value (iterator->value ());
+		action_a (reinterpret_cast<uint8_t const *> (key.data ()), key.size (), reinterpret_cast<uint8_t const *> (value.data ()), value.size ());
+	}
+}
+
+bool nano::rocksdb_store::raw_put (nano::write_transaction const & transaction_a, nano::tables table_a, uint8_t const * key_a, size_t key_size_a, uint8_t const * value_a, size_t value_size_a, bool append_a)
+{
+	assert (transaction_a.contains (table_a));
+	cache_m.all_modified (transaction_a);
+	nano::rocksdb_val key (key_size_a, const_cast<uint8_t *> (key_a));
+	nano::rocksdb_val value (value_size_a, const_cast<uint8_t *> (value_a));
+	auto status (static_cast<int> (rocksdb::Status::Code::kOk));
+	if (append_a)
+	{
+		if (is_caching_counts (table_a))
+		{
+			status = increment (transaction_a, tables::cached_counts, rocksdb_val (rocksdb::Slice (table_to_column_family (table_a)->GetName ())), 1);
+		}
+		if (success (status))
+		{
+			status = tx (transaction_a)->PutUntracked (table_to_column_family (table_a), key, value).code ();
+		}
+	}
+	else
+	{
+		status = put (transaction_a, table_a, key, value);
+	}
+	return !success (status);
+}
+
+void nano::rocksdb_store::raw_clear (nano::write_transaction const & transaction_a, nano::tables table_a)
+{
+	assert (transaction_a.contains (table_a));
+	cache_m.all_modified (transaction_a);
+	auto txn (tx (transaction_a));
+	auto column_family (table_to_column_family (table_a));
+	rocksdb::ReadOptions options;
+	options.fill_cache = false;
+	options.total_order_seek = true;
+	// Reads the transaction snapshot, which is not affected by the deletions
+	options.snapshot = txn->GetSnapshot ();
+	std::unique_ptr<rocksdb::Iterator> iterator (db->NewIterator (options, column_family));
+	for (iterator->SeekToFirst (); iterator->Valid (); iterator->Next ())
+	{
+		auto status (txn->Delete (column_family, iterator->key ()));
+		release_assert (status.ok ());
+	}
+	release_assert (iterator->status ().ok ());
+	if (is_caching_counts (table_a))
+	{
+		auto status (put (transaction_a, tables::cached_counts, nano::rocksdb_val (rocksdb::Slice (column_family->GetName ())), nano::rocksdb_val (uint64_t{ 0 })));
+		release_assert (success (status));
+	}
+}
+
+bool nano::rocksdb_store::replica_refresh ()
+{
+	// Read-only instances keep the state found when they were opened and never observe commits from the writer, nodes refuse to run them as a replica
+	return false;
+}
+
+bool nano::rocksdb_store::compact (uint64_t max_bytes_per_second_a, std::function<bool()> const & stopped_a)
+{
+	// Read-only instances cannot rewrite files
+	auto error (optimistic_db == nullptr);
+	for (auto i (handles.begin ()), n (handles.end ()); i != n && !error && !stopped_a (); ++i)
+	{
+		// Runs alongside readers and writers, files are replaced as the new ones are written
+		error = !db->CompactRange (rocksdb::CompactRangeOptions{}, *i, nullptr, nullptr).ok ();
+	}
+	return error || stopped_a ();
 }
 
 bool nano::rocksdb_store::copy_db (boost::filesystem::path const & destination_path)
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <nano/lib/compressionconfig.hpp>
 #include <nano/lib/config.hpp>
 #include <nano/lib/logger_mt.hpp>
 #include <nano/lib/numbers.hpp>
 #include <nano/node/rocksdb/rocksdb_iterator.hpp>
 #include <nano/secure/blockstore_partial.hpp>
 #include <nano/secure/common.hpp>
+#include <nano/secure/group_commit.hpp>
 
 #include <rocksdb/db.h>
 #include <rocksdb/filter_policy.h>
@@ -25,7 +27,7 @@ class rocksdb_config;
 class rocksdb_store : public block_store_partial<rocksdb::Slice, rocksdb_store>
 {
 public:
-	rocksdb_store (nano::logger_mt &, boost::filesystem::path const &, nano::rocksdb_config const & = nano::rocksdb_config{}, bool open_read_only = false);
+	rocksdb_store (nano::logger_mt &, boost::filesystem::path const &, nano::rocksdb_config const & = nano::rocksdb_config{}, bool open_read_only = false, nano::durability_config const & = nano::durability_config{}, nano::compression_config const & = nano::compression_config{});
 	~rocksdb_store ();
 	nano::write_transaction tx_begin_write (std::vector<nano::tables> const & tables_requiring_lock = {}, std::vector<nano::tables> const & tables_no_lock = {}) override;
 	nano::read_transaction tx_begin_read () override;
@@ -36,6 +38,7 @@ public:
 
 	bool exists (nano::transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a) const;
 	int get (nano::transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, nano::rocksdb_val & value_a) const;
+	void get_many (nano::transaction const & transaction_a, tables table_a, std::vector<nano::rocksdb_val> const & keys_a, std::vector<nano::rocksdb_val> & values_a, std::vector<int> & statuses_a) const;
 	int put (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, nano::rocksdb_val const & value_a);
 	int del (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a);
 
@@ -52,6 +55,14 @@ public:
 	}
 
 	bool copy_db (boost::filesystem::path const & destination) override;
+	bool replica_refresh () override;
+	/** Compacts every column family in place, writes are not rate limited */
+	bool compact (uint64_t max_bytes_per_second_a, std::function<bool()> const & stopped_a) override;
+	void raw_for_each (nano::transaction const &, nano::tables, std::function<void(uint8_t const *, size_t, uint8_t const *, size_t)> const &) const override;
+	/** Appended keys are new to the table, their existence is not checked and they are not tracked for write conflicts */
+	bool raw_put (nano::write_transaction const &, nano::tables, uint8_t const *, size_t, uint8_t const *, size_t, bool) override;
+	/** Entries are deleted in the transaction, unlike drop which recreates the column family immediately */
+	void raw_clear (nano::write_transaction const &, nano::tables) override;
 
 	template <typename Key, typename Value>
 	nano::store_iterator<Key, Value> make_iterator (nano::transaction const & transaction_a, tables table_a) const
@@ -65,6 +76,13 @@ public:
 		return nano::store_iterator<Key, Value> (std::make_unique<nano::rocksdb_iterator<Key, Value>> (db, transaction_a, table_to_column_family (table_a), key));
 	}
 
+	/** Ends after the entries sharing the prefix of \p key in column families with a prefix extractor, seeks then use the prefix bloom filters */
+	template <typename Key, typename Value>
+	nano::store_iterator<Key, Value> make_prefix_iterator (nano::transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key) const
+	{
+		return nano::store_iterator<Key, Value> (std::make_unique<nano::rocksdb_iterator<Key, Value>> (db, transaction_a, table_to_column_family (table_a), key, true));
+	}
+
 	bool init_error () const override;
 
 private:
@@ -74,8 +92,10 @@ private:
 	// Optimistic transactions are used in write mode
 	rocksdb::OptimisticTransactionDB * optimistic_db = nullptr;
 	rocksdb::DB * db = nullptr;
-	std::shared_ptr<rocksdb::TableFactory> table_factory;
+	std::shared_ptr<rocksdb::Cache> block_cache;
 	std::unordered_map<nano::tables, std::mutex> write_lock_mutexes;
+	/** Syncs the write-ahead log in group and async durability modes */
+	std::unique_ptr<nano::group_commit> group_commit;
 
 	rocksdb::Transaction * tx (nano::transaction const & transaction_a) const;
 	std::vector<nano::tables> all_tables () const;
@@ -89,15 +109,21 @@ private:
 	int clear (rocksdb::ColumnFamilyHandle * column_family);
 
 	void open (bool & error_a, boost::filesystem::path const & path_a, bool open_read_only_a);
-	uint64_t count (nano::transaction const & transaction_a, rocksdb::ColumnFamilyHandle * handle) const;
 	bool is_caching_counts (nano::tables table_a) const;
+	void initialize_counts ();
+	void do_upgrades ();
+	uint64_t iterate_count (nano::transaction const & transaction_a, tables table_a) const;
 
 	int increment (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a);
 	int decrement (nano::write_transaction const & transaction_a, tables table_a, nano::rocksdb_val const & key_a, uint64_t amount_a);
-	rocksdb::ColumnFamilyOptions get_cf_options () const;
+	rocksdb::ColumnFamilyOptions get_cf_options (std::string const & cf_name_a) const;
 	void construct_column_family_mutexes ();
 	rocksdb::Options get_db_options () const;
-	rocksdb::BlockBasedTableOptions get_table_options () const;
+	rocksdb::BlockBasedTableOptions get_table_options (std::string const & cf_name_a) const;
+	bool is_point_lookup_family (std::string const & cf_name_a) const;
 	nano::rocksdb_config rocksdb_config;
+	nano::compression_config compression_config;
+	/** Block column families compressed with a sampled dictionary */
+	std::unordered_set<std::string> compressed_families;
 };
 }
@@ -42,6 +42,7 @@ public:
 		{
 			rocksdb::ReadOptions ropts;
 			ropts.fill_cache = false;
+			ropts.total_order_seek = true;
 			iter = tx (transaction_a)->GetIterator (ropts, handle_a);
 		}
 
@@ -61,16 +62,31 @@ public:
 
 	rocksdb_iterator () = default;
 
-	rocksdb_iterator (rocksdb::DB * db, nano::transaction const & transaction_a, rocksdb::ColumnFamilyHandle * handle_a, rocksdb_val const & val_a)
+	rocksdb_iterator (rocksdb::DB * db, nano::transaction const & transaction_a, rocksdb::ColumnFamilyHandle * handle_a, rocksdb_val const & val_a, bool prefix_a = false)
 	{
+		rocksdb::ReadOptions ropts;
+		if (is_read (transaction_a))
+		{
+			ropts = snapshot_options (transaction_a);
+		}
+		else
+		{
+			ropts.total_order_seek = true;
+		}
+		if (prefix_a)
+		{
+			// Total order seeks ignore the prefix bloom filters
+			ropts.total_order_seek = false;
+			ropts.prefix_same_as_start = true;
+		}
 		rocksdb::Iterator * iter;
 		if (is_read (transaction_a))
 		{
-			iter = db->NewIterator (snapshot_options (transaction_a), handle_a);
+			iter = db->NewIterator (ropts, handle_a);
 		}
 		else
 		{
-			iter = tx (transaction_a)->GetIterator (rocksdb::ReadOptions (), handle_a);
+			iter = tx (transaction_a)->GetIterator (ropts, handle_a);
 		}
 
 		cursor.reset (iter);
@@ -4,6 +4,8 @@ nano::read_rocksdb_txn::read_rocksdb_txn (rocksdb::DB * db_a) :
 db (db_a)
 {
 	options.snapshot = db_a->GetSnapshot ();
+	// Iterators scan across the prefixes of column families with a prefix extractor, such as accounts in pending, unless they are confined to one
+	options.total_order_seek = true;
 }
 
 nano::read_rocksdb_txn::~read_rocksdb_txn ()
@@ -119,6 +119,7 @@ bool nano::transport::tcp_channels::insert (std::shared_ptr<nano::transport::cha
 			channels.get<endpoint_tag> ().insert ({ channel_a, socket_a, bootstrap_server_a });
 			error = false;
 			lock.unlock ();
+			node.network.fanout.invalidate ();
 			node.network.channel_observer (channel_a);
 			// Remove UDP channel to same IP:port if exists
 			node.network.udp_channels.erase (udp_endpoint);
@@ -131,8 +132,11 @@ bool nano::transport::tcp_channels::insert (std::shared_ptr<nano::transport::cha
 
 void nano::transport::tcp_channels::erase (nano::tcp_endpoint const & endpoint_a)
 {
-	nano::lock_guard<std::mutex> lock (mutex);
-	channels.get<endpoint_tag> ().erase (endpoint_a);
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		channels.get<endpoint_tag> ().erase (endpoint_a);
+	}
+	node.network.fanout.invalidate ();
 }
 
 size_t nano::transport::tcp_channels::size () const
@@ -390,6 +394,10 @@ void nano::transport::tcp_channels::purge (std::chrono::steady_clock::time_point
 {
 	nano::lock_guard<std::mutex> lock (mutex);
 	auto disconnect_cutoff (channels.get<last_packet_sent_tag> ().lower_bound (cutoff_a));
+	if (disconnect_cutoff != channels.get<last_packet_sent_tag> ().begin ())
+	{
+		node.network.fanout.invalidate ();
+	}
 	channels.get<last_packet_sent_tag> ().erase (channels.get<last_packet_sent_tag> ().begin (), disconnect_cutoff);
 	// Remove keepalive attempt tracking for attempts older than cutoff
 	auto attempts_cutoff (attempts.get<1> ().lower_bound (cutoff_a));
@@ -593,7 +601,8 @@ void nano::transport::tcp_channels::start_tcp_receive_node_id (std::shared_ptr<n
 						{
 							channel_a->set_network_version (header.version_using);
 							auto node_id (message.response->first);
-							bool process (!node_l->network.syn_cookies.validate (endpoint_a, node_id, message.response->second) && node_id != node_l->node_id.pub);
+							std::chrono::steady_clock::duration rtt;
+							bool process (!node_l->network.syn_cookies.validate (endpoint_a, node_id, message.response->second, &rtt) && node_id != node_l->node_id.pub);
 							if (process)
 							{
 								/* If node ID is known, don't establish new connection
@@ -606,6 +615,7 @@ void nano::transport::tcp_channels::start_tcp_receive_node_id (std::shared_ptr<n
 							}
 							if (process)
 							{
+								channel_a->stats->add_rtt (rtt);
 								channel_a->set_node_id (node_id);
 								channel_a->set_last_packet_received (std::chrono::steady_clock::now ());
 								boost::optional<std::pair<nano::account, nano::signature>> response (std::make_pair (node_l->node_id.pub, nano::sign_message (node_l->node_id.prv, node_l->node_id.pub, *message.query)));
@@ -2,7 +2,6 @@
 #include <nano/node/node.hpp>
 #include <nano/node/transport/transport.hpp>
 
-#include <numeric>
 
 namespace
 {
@@ -70,25 +69,99 @@ nano::tcp_endpoint nano::transport::map_endpoint_to_tcp (nano::endpoint const &
 }
 
 nano::transport::channel::channel (nano::node & node_a) :
-limiter (node_a.config.bandwidth_limit),
 node (node_a)
 {
 	set_network_version (node_a.network_params.protocol.protocol_version);
 }
 
+nano::transport::channel_stats::pending_send::pending_send (std::shared_ptr<nano::transport::channel_stats> const & stats_a, std::chrono::steady_clock::time_point const & start_a) :
+stats (stats_a),
+start (start_a)
+{
+	auto depth (++stats->queue_depth);
+	auto current (stats->queue_depth_max.load ());
+	while (depth > current && !stats->queue_depth_max.compare_exchange_weak (current, depth))
+	{
+	}
+}
+
+nano::transport::channel_stats::pending_send::~pending_send ()
+{
+	--stats->queue_depth;
+}
+
+void nano::transport::channel_stats::pending_send::complete (boost::system::error_code const & ec, size_t size_a)
+{
+	if (!ec)
+	{
+		++stats->messages_out;
+		stats->bytes_out += size_a;
+		stats->send_latency.add (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now () - start).count ());
+	}
+	else
+	{
+		++stats->send_errors;
+	}
+}
+
+void nano::transport::channel_stats::add_rtt (std::chrono::steady_clock::duration const & rtt_a)
+{
+	rtt.add (std::chrono::duration_cast<std::chrono::microseconds> (rtt_a).count ());
+}
+
+void nano::transport::channel_stats::serialize (boost::property_tree::ptree & tree_a) const
+{
+	tree_a.put ("messages_out", messages_out.load ());
+	tree_a.put ("bytes_out", bytes_out.load ());
+	tree_a.put ("messages_in", messages_in.load ());
+	tree_a.put ("send_errors", send_errors.load ());
+	tree_a.put ("drops", drops.load ());
+	tree_a.put ("queue_depth", queue_depth.load ());
+	tree_a.put ("queue_depth_max", queue_depth_max.load ());
+	boost::property_tree::ptree send_latency_l;
+	send_latency.serialize (send_latency_l);
+	tree_a.add_child ("send_latency_us", send_latency_l);
+	boost::property_tree::ptree rtt_l;
+	rtt.serialize (rtt_l);
+	tree_a.add_child ("rtt_us", rtt_l);
+}
+
 void nano::transport::channel::send (nano::message const & message_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, bool const is_droppable_a)
 {
+	auto start (std::chrono::steady_clock::now ());
 	callback_visitor visitor;
 	message_a.visit (visitor);
 	auto buffer (message_a.to_shared_const_buffer ());
 	auto detail (visitor.result);
-	if (!is_droppable_a || !limiter.should_drop (buffer.size ()))
+	auto traffic_class (nano::bandwidth_limiter::classify (detail));
+	auto & limiter (node.network.limiter);
+	if (!is_droppable_a)
+	{
+		limiter.consume_force (buffer.size (), traffic_class);
+		send_buffer_tracked (buffer, detail, callback_a, std::make_shared<nano::transport::channel_stats::pending_send> (stats, start));
+		node.stats.inc (nano::stat::type::message, detail, nano::stat::dir::out);
+		return;
+	}
+	bool queued;
+	{
+		// Keep messages of a class in order while some of them are waiting for bandwidth
+		nano::lock_guard<std::mutex> lock (deferred_mutex);
+		queued = !deferred[static_cast<size_t> (traffic_class)].empty ();
+	}
+	// Messages which never fit are dropped rather than queued, where they would hold back their class for good
+	auto wait (limiter.exceeds_capacity (buffer.size (), traffic_class) ? std::chrono::steady_clock::duration::max () : queued ? nano::bandwidth_limiter::max_deferral : limiter.consume (buffer.size (), traffic_class));
+	if (wait == std::chrono::steady_clock::duration::zero ())
 	{
-		send_buffer (buffer, detail, callback_a);
+		send_buffer_tracked (buffer, detail, callback_a, std::make_shared<nano::transport::channel_stats::pending_send> (stats, start));
 		node.stats.inc (nano::stat::type::message, detail, nano::stat::dir::out);
 	}
+	else if (wait <= nano::bandwidth_limiter::max_deferral && !defer (buffer, detail, callback_a, traffic_class, wait, std::make_shared<nano::transport::channel_stats::pending_send> (stats, start)))
+	{
+		node.stats.inc (nano::stat::type::defer, detail, nano::stat::dir::out);
+	}
 	else
 	{
+		++stats->drops;
 		node.stats.inc (nano::stat::type::drop, detail, nano::stat::dir::out);
 		if (node.config.logging.network_packet_logging ())
 		{
@@ -98,6 +171,109 @@ void nano::transport::channel::send (nano::message const & message_a, std::funct
 	}
 }
 
+void nano::transport::channel::send_buffer_tracked (nano::shared_const_buffer const & buffer_a, nano::stat::detail detail_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, std::shared_ptr<nano::transport::channel_stats::pending_send> const & pending_a)
+{
+	send_buffer (buffer_a, detail_a, [pending_a, callback_a](boost::system::error_code const & ec, size_t size_a) {
+		pending_a->complete (ec, size_a);
+		if (callback_a)
+		{
+			callback_a (ec, size_a);
+		}
+	});
+}
+
+size_t nano::transport::channel::deferred_size ()
+{
+	size_t result (0);
+	nano::lock_guard<std::mutex> lock (deferred_mutex);
+	for (auto const & queue : deferred)
+	{
+		result += queue.size ();
+	}
+	return result;
+}
+
+bool nano::transport::channel::defer (nano::shared_const_buffer const & buffer_a, nano::stat::detail detail_a, std::function<void(boost::system::error_code const &, size_t)> const & callback_a, nano::bandwidth_limiter::traffic_class class_a, std::chrono::steady_clock::duration wait_a, std::shared_ptr<nano::transport::channel_stats::pending_send> const & pending_a)
+{
+	nano::unique_lock<std::mutex> lock (deferred_mutex);
+	auto & queue (deferred[static_cast<size_t> (class_a)]);
+	bool result (queue.size () >= max_deferred);
+	if (!result)
+	{
+		queue.push_back ({ buffer_a, detail_a, callback_a, std::chrono::steady_clock::now () + nano::bandwidth_limiter::max_deferral, pending_a });
+		schedule_deferred (lock, wait_a);
+	}
+	return result;
+}
+
+void nano::transport::channel::schedule_deferred (nano::unique_lock<std::mutex> & lock_a, std::chrono::steady_clock::duration wait_a)
+{
+	assert (lock_a.owns_lock ());
+	if (!deferred_scheduled)
+	{
+		deferred_scheduled = true;
+		std::weak_ptr<nano::node> node_w (node.shared ());
+		std::weak_ptr<nano::transport::channel> channel_w (shared_from_this ());
+		node.alarm.add (std::chrono::steady_clock::now () + wait_a, [node_w, channel_w]() {
+			auto node_l (node_w.lock ());
+			auto channel_l (channel_w.lock ());
+			if (node_l && channel_l)
+			{
+				channel_l->send_deferred ();
+			}
+		});
+	}
+}
+
+void nano::transport::channel::send_deferred ()
+{
+	nano::unique_lock<std::mutex> lock (deferred_mutex);
+	deferred_scheduled = false;
+	auto next (std::chrono::steady_clock::duration::max ());
+	for (size_t i (0); i < deferred.size (); ++i)
+	{
+		auto & queue (deferred[i]);
+		auto traffic_class (static_cast<nano::bandwidth_limiter::traffic_class> (i));
+		auto wait (std::chrono::steady_clock::duration::zero ());
+		while (!queue.empty () && wait == std::chrono::steady_clock::duration::zero ())
+		{
+			auto message (queue.front ());
+			wait = node.network.limiter.consume (message.buffer.size (), traffic_class);
+			// Compared as durations, adding a wait of max () to the current time overflows
+			if (wait == std::chrono::steady_clock::duration::zero () || wait > message.deadline - std::chrono::steady_clock::now ())
+			{
+				queue.pop_front ();
+				lock.unlock ();
+				if (wait == std::chrono::steady_clock::duration::zero ())
+				{
+					send_buffer_tracked (message.buffer, message.detail, message.callback, message.pending);
+					node.stats.inc (nano::stat::type::message, message.detail, nano::stat::dir::out);
+				}
+				else
+				{
+					// Waited for too long, try the next one
+					++stats->drops;
+					node.stats.inc (nano::stat::type::drop, message.detail, nano::stat::dir::out);
+					if (message.callback)
+					{
+						message.callback (boost::asio::error::timed_out, 0);
+					}
+					wait = std::chrono::steady_clock::duration::zero ();
+				}
+				lock.lock ();
+			}
+		}
+		if (!queue.empty ())
+		{
+			next = std::min (next, wait);
+		}
+	}
+	if (next != std::chrono::steady_clock::duration::max ())
+	{
+		schedule_deferred (lock, next);
+	}
+}
+
 namespace
 {
 boost::asio::ip::address_v6 mapped_from_v4_bytes (unsigned long address_a)
@@ -205,45 +381,114 @@ bool nano::transport::reserved_address (nano::endpoint const & endpoint_a, bool
 	return result;
 }
 
-using namespace std::chrono_literals;
+std::chrono::milliseconds constexpr nano::bandwidth_limiter::max_deferral;
+
+namespace
+{
+// Share of the limit guaranteed to each traffic class, in the order of nano::bandwidth_limiter::traffic_class
+std::array<double, nano::bandwidth_limiter::traffic_class_count> constexpr traffic_class_shares{ { 0.4, 0.2, 0.3, 0.05, 0.05 } };
+}
 
 nano::bandwidth_limiter::bandwidth_limiter (const size_t limit_a) :
-next_trend (std::chrono::steady_clock::now () + 50ms),
 limit (limit_a),
-rate (0),
-trended_rate (0)
+last_refill (std::chrono::steady_clock::now ())
 {
+	// Buckets start full and can hold one second worth of their rate
+	root.rate = root.capacity = root.tokens = static_cast<double> (limit);
+	for (size_t i (0); i < classes.size (); ++i)
+	{
+		classes[i].rate = classes[i].capacity = classes[i].tokens = limit * traffic_class_shares[i];
+	}
 }
 
-bool nano::bandwidth_limiter::should_drop (const size_t & message_size)
+std::chrono::steady_clock::duration nano::bandwidth_limiter::consume (size_t size_a, nano::bandwidth_limiter::traffic_class class_a)
 {
-	bool result (false);
-	if (limit == 0) //never drop if limit is 0
+	auto result (std::chrono::steady_clock::duration::zero ());
+	if (limit != 0) //never limit if limit is 0
 	{
-		return result;
+		nano::lock_guard<std::mutex> lock (mutex);
+		refill ();
+		auto & class_bucket (classes[static_cast<size_t> (class_a)]);
+		if (class_bucket.tokens >= size_a)
+		{
+			class_bucket.tokens -= size_a;
+			root.tokens = std::max (root.tokens - size_a, -root.capacity);
+		}
+		else if (root.tokens >= size_a)
+		{
+			// Borrow spare bandwidth
+			root.tokens -= size_a;
+		}
+		else
+		{
+			result = std::max (std::min (class_bucket.refill_time (size_a), root.refill_time (size_a)), std::chrono::steady_clock::duration (1));
+		}
 	}
-	nano::lock_guard<std::mutex> lock (mutex);
+	return result;
+}
 
-	if (message_size > limit / rate_buffer.size () || rate + message_size > limit)
+void nano::bandwidth_limiter::consume_force (size_t size_a, nano::bandwidth_limiter::traffic_class class_a)
+{
+	if (limit != 0)
 	{
-		result = true;
+		nano::lock_guard<std::mutex> lock (mutex);
+		refill ();
+		auto & class_bucket (classes[static_cast<size_t> (class_a)]);
+		class_bucket.tokens = std::max (class_bucket.tokens - size_a, -class_bucket.capacity);
+		root.tokens = std::max (root.tokens - size_a, -root.capacity);
 	}
-	else
+}
+
+bool nano::bandwidth_limiter::exceeds_capacity (size_t size_a, nano::bandwidth_limiter::traffic_class class_a) const
+{
+	// Capacities do not change after construction
+	return limit != 0 && size_a > classes[static_cast<size_t> (class_a)].capacity && size_a > root.capacity;
+}
+
+void nano::bandwidth_limiter::refill ()
+{
+	auto now (std::chrono::steady_clock::now ());
+	auto elapsed (std::chrono::duration<double> (now - last_refill).count ());
+	last_refill = now;
+	root.tokens = std::min (root.tokens + root.rate * elapsed, root.capacity);
+	for (auto & bucket : classes)
 	{
-		rate = rate + message_size;
+		bucket.tokens = std::min (bucket.tokens + bucket.rate * elapsed, bucket.capacity);
 	}
-	if (next_trend < std::chrono::steady_clock::now ())
+}
+
+std::chrono::steady_clock::duration nano::bandwidth_limiter::bucket::refill_time (double size_a) const
+{
+	auto result (std::chrono::steady_clock::duration::max ());
+	if (size_a <= capacity && rate > 0)
 	{
-		next_trend = std::chrono::steady_clock::now () + 50ms;
-		rate_buffer.push_back (rate);
-		trended_rate = std::accumulate (rate_buffer.begin (), rate_buffer.end (), size_t{ 0 }) / rate_buffer.size ();
-		rate = 0;
+		result = std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double> ((size_a - tokens) / rate));
 	}
 	return result;
 }
 
-size_t nano::bandwidth_limiter::get_rate ()
+nano::bandwidth_limiter::traffic_class nano::bandwidth_limiter::classify (nano::stat::detail detail_a)
 {
-	nano::lock_guard<std::mutex> lock (mutex);
-	return trended_rate;
+	auto result (traffic_class::other);
+	switch (detail_a)
+	{
+		case nano::stat::detail::confirm_ack:
+			result = traffic_class::vote;
+			break;
+		case nano::stat::detail::confirm_req:
+			result = traffic_class::confirm_req;
+			break;
+		case nano::stat::detail::publish:
+			result = traffic_class::publish;
+			break;
+		case nano::stat::detail::bulk_pull:
+		case nano::stat::detail::bulk_pull_account:
+		case nano::stat::detail::bulk_push:
+		case nano::stat::detail::frontier_req:
+			result = traffic_class::bootstrap;
+			break;
+		default:
+			break;
+	}
+	return result;
 }
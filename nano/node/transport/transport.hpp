@@ -8,25 +8,55 @@
 
 namespace nano
 {
+/**
+ * Outbound bandwidth limiter using hierarchical token buckets.
+ * The root bucket refills at the configured limit and every traffic class has its own bucket refilling at a share of it.
+ * A message is charged to its class bucket while that has enough tokens, which guarantees each class its share of the limit,
+ * and may borrow spare tokens from the root bucket beyond that. Guaranteed traffic is charged to the root bucket as well.
+ */
 class bandwidth_limiter final
 {
 public:
-	// initialize with rate 0 = unbounded
+	/** Traffic classes in decreasing order of send priority */
+	enum class traffic_class : uint8_t
+	{
+		vote,
+		confirm_req,
+		publish,
+		bootstrap,
+		other
+	};
+	static size_t constexpr traffic_class_count = static_cast<size_t> (traffic_class::other) + 1;
+	// initialize with limit 0 = unbounded
 	bandwidth_limiter (const size_t);
-	bool should_drop (const size_t &);
-	size_t get_rate ();
+	/**
+	 * Takes tokens for a message of \p size_a bytes if available
+	 * @return zero if the message can be sent now, otherwise the time until enough tokens will be available, during which nothing was taken
+	 */
+	std::chrono::steady_clock::duration consume (size_t size_a, traffic_class class_a);
+	/** Takes tokens for a message that cannot be delayed or dropped, even if this exceeds the budget */
+	void consume_force (size_t size_a, traffic_class class_a);
+	/** Returns true if a message of \p size_a bytes is larger than the buckets of its class can ever hold */
+	bool exceeds_capacity (size_t size_a, traffic_class class_a) const;
+	static traffic_class classify (nano::stat::detail);
+	// Messages which can be sent within this time are deferred instead of dropped
+	static std::chrono::milliseconds constexpr max_deferral{ 250 };
 
 private:
-	//last time rate was adjusted
-	std::chrono::steady_clock::time_point next_trend;
-	//trend rate over 20 poll periods
-	boost::circular_buffer<size_t> rate_buffer{ 20, 0 };
-	//limit bandwidth to
+	class bucket final
+	{
+	public:
+		double tokens{ 0 };
+		double rate{ 0 };
+		double capacity{ 0 };
+		// Time until the bucket holds \p size_a tokens, or max () if it never can
+		std::chrono::steady_clock::duration refill_time (double size_a) const;
+	};
+	void refill ();
 	const size_t limit;
-	//rate, increment if message_size + rate < rate
-	size_t rate;
-	//trended rate to even out spikes in traffic
-	size_t trended_rate;
+	bucket root;
+	std::array<bucket, traffic_class_count> classes;
+	std::chrono::steady_clock::time_point last_refill;
 	std::mutex mutex;
 };
 namespace transport
@@ -46,7 +76,41 @@ namespace transport
 		udp = 1,
 		tcp = 2
 	};
-	class channel
+	/**
+	 * Traffic and latency statistics of a single channel.
+	 * Only atomics are updated when recording, so the send path never blocks on them. The statistics are held by a shared
+	 * pointer, which lets writes still in progress complete after their channel was removed.
+	 */
+	class channel_stats final
+	{
+	public:
+		/** A buffer handed to a channel, counted in the queue depth until its write completes or is abandoned */
+		class pending_send final
+		{
+		public:
+			pending_send (std::shared_ptr<nano::transport::channel_stats> const &, std::chrono::steady_clock::time_point const &);
+			~pending_send ();
+			void complete (boost::system::error_code const &, size_t);
+
+		private:
+			std::shared_ptr<nano::transport::channel_stats> stats;
+			std::chrono::steady_clock::time_point const start;
+		};
+		void add_rtt (std::chrono::steady_clock::duration const &);
+		void serialize (boost::property_tree::ptree &) const;
+		std::atomic<uint64_t> messages_out{ 0 };
+		std::atomic<uint64_t> bytes_out{ 0 };
+		std::atomic<uint64_t> messages_in{ 0 };
+		std::atomic<uint64_t> send_errors{ 0 };
+		std::atomic<uint64_t> drops{ 0 };
+		std::atomic<uint64_t> queue_depth{ 0 };
+		std::atomic<uint64_t> queue_depth_max{ 0 };
+		/** Microseconds from send () until the write completed, including time spent deferred and in the socket queue */
+		nano::histogram send_latency;
+		/** Microseconds between node ID handshake queries or representative queries and their responses */
+		nano::histogram rtt;
+	};
+	class channel : public std::enable_shared_from_this<nano::transport::channel>
 	{
 	public:
 		channel (nano::node &);
@@ -132,10 +196,35 @@ namespace transport
 			network_version = network_version_a;
 		}
 
+		/** Number of messages waiting for bandwidth in all traffic classes */
+		size_t deferred_size ();
+
 		mutable std::mutex channel_mutex;
-		nano::bandwidth_limiter limiter;
+		std::shared_ptr<nano::transport::channel_stats> const stats{ std::make_shared<nano::transport::channel_stats> () };
+		// Maximum number of messages waiting for bandwidth in each traffic class
+		static size_t constexpr max_deferred = 128;
 
 	private:
+		class deferred_message final
+		{
+		public:
+			nano::shared_const_buffer buffer;
+			nano::stat::detail detail;
+			std::function<void(boost::system::error_code const &, size_t)> callback;
+			std::chrono::steady_clock::time_point deadline;
+			std::shared_ptr<nano::transport::channel_stats::pending_send> pending;
+		};
+		/** Queues a message until the limiter has tokens for it, returns true if the queue is full */
+		bool defer (nano::shared_const_buffer const &, nano::stat::detail, std::function<void(boost::system::error_code const &, size_t)> const &, nano::bandwidth_limiter::traffic_class, std::chrono::steady_clock::duration, std::shared_ptr<nano::transport::channel_stats::pending_send> const &);
+		/** Sends the buffer, recording its completion in the channel statistics */
+		void send_buffer_tracked (nano::shared_const_buffer const &, nano::stat::detail, std::function<void(boost::system::error_code const &, size_t)> const &, std::shared_ptr<nano::transport::channel_stats::pending_send> const &);
+		/** Sends deferred messages in priority order as tokens become available, the callback of messages dropped past their deadline gets boost::asio::error::timed_out */
+		void send_deferred ();
+		void schedule_deferred (nano::unique_lock<std::mutex> &, std::chrono::steady_clock::duration);
+		std::mutex deferred_mutex;
+		std::array<std::deque<deferred_message>, nano::bandwidth_limiter::traffic_class_count> deferred;
+		bool deferred_scheduled{ false };
+
 		std::chrono::steady_clock::time_point last_bootstrap_attempt{ std::chrono::steady_clock::time_point () };
 		std::chrono::steady_clock::time_point last_packet_received{ std::chrono::steady_clock::time_point () };
 		std::chrono::steady_clock::time_point last_packet_sent{ std::chrono::steady_clock::time_point () };
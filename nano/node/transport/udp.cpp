@@ -106,6 +106,7 @@ std::shared_ptr<nano::transport::channel_udp> nano::transport::udp_channels::ins
 			result = std::make_shared<nano::transport::channel_udp> (*this, endpoint_a, network_version_a);
 			channels.get<endpoint_tag> ().insert ({ result });
 			lock.unlock ();
+			node.network.fanout.invalidate ();
 			node.network.channel_observer (result);
 		}
 	}
@@ -114,8 +115,11 @@ std::shared_ptr<nano::transport::channel_udp> nano::transport::udp_channels::ins
 
 void nano::transport::udp_channels::erase (nano::endpoint const & endpoint_a)
 {
-	nano::lock_guard<std::mutex> lock (mutex);
-	channels.get<endpoint_tag> ().erase (endpoint_a);
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		channels.get<endpoint_tag> ().erase (endpoint_a);
+	}
+	node.network.fanout.invalidate ();
 }
 
 size_t nano::transport::udp_channels::size () const
@@ -217,8 +221,11 @@ std::shared_ptr<nano::transport::channel_udp> nano::transport::udp_channels::fin
 
 void nano::transport::udp_channels::clean_node_id (nano::account const & node_id_a)
 {
-	nano::lock_guard<std::mutex> lock (mutex);
-	channels.get<node_id_tag> ().erase (node_id_a);
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		channels.get<node_id_tag> ().erase (node_id_a);
+	}
+	node.network.fanout.invalidate ();
 }
 
 void nano::transport::udp_channels::clean_node_id (nano::endpoint const & endpoint_a, nano::account const & node_id_a)
@@ -231,6 +238,7 @@ void nano::transport::udp_channels::clean_node_id (nano::endpoint const & endpoi
 		if (record.endpoint ().address () == endpoint_a.address () && record.endpoint ().port () != endpoint_a.port ())
 		{
 			channels.get<endpoint_tag> ().erase (record.endpoint ());
+			node.network.fanout.invalidate ();
 			break;
 		}
 	}
@@ -425,7 +433,8 @@ public:
 		auto validated_response (false);
 		if (message_a.response)
 		{
-			if (!node.network.syn_cookies.validate (endpoint, message_a.response->first, message_a.response->second))
+			std::chrono::steady_clock::duration rtt;
+			if (!node.network.syn_cookies.validate (endpoint, message_a.response->first, message_a.response->second, &rtt))
 			{
 				validated_response = true;
 				if (message_a.response->first != node.node_id.pub && !node.network.tcp_channels.find_node_id (message_a.response->first))
@@ -434,6 +443,7 @@ public:
 					auto new_channel (node.network.udp_channels.insert (endpoint, message_a.header.version_using));
 					if (new_channel)
 					{
+						new_channel->stats->add_rtt (rtt);
 						node.network.udp_channels.modify (new_channel, [&message_a](std::shared_ptr<nano::transport::channel_udp> channel_a) {
 							channel_a->set_node_id (message_a.response->first);
 							channel_a->set_last_packet_received (std::chrono::steady_clock::now ());
@@ -495,9 +505,13 @@ void nano::transport::udp_channels::receive_action (nano::message_buffer * data_
 	if (allowed_sender)
 	{
 		udp_message_visitor visitor (node, data_a->endpoint);
-		nano::message_parser parser (node.block_uniquer, node.vote_uniquer, visitor, node.work);
+		nano::message_parser parser (node.network.publish_filter, node.block_uniquer, node.vote_uniquer, visitor, node.work);
 		parser.deserialize_buffer (data_a->buffer, data_a->size);
-		if (parser.status != nano::message_parser::parse_status::success)
+		if (parser.status == nano::message_parser::parse_status::duplicate_publish_message)
+		{
+			node.stats.inc (nano::stat::type::filter, nano::stat::detail::duplicate_publish);
+		}
+		else if (parser.status != nano::message_parser::parse_status::success)
 		{
 			node.stats.inc (nano::stat::type::error);
 
@@ -538,6 +552,7 @@ void nano::transport::udp_channels::receive_action (nano::message_buffer * data_
 					node.stats.inc (nano::stat::type::udp, nano::stat::detail::outdated_version);
 					break;
 				case nano::message_parser::parse_status::success:
+				case nano::message_parser::parse_status::duplicate_publish_message:
 					/* Already checked, unreachable */
 					break;
 			}
@@ -622,6 +637,10 @@ void nano::transport::udp_channels::purge (std::chrono::steady_clock::time_point
 {
 	nano::lock_guard<std::mutex> lock (mutex);
 	auto disconnect_cutoff (channels.get<last_packet_received_tag> ().lower_bound (cutoff_a));
+	if (disconnect_cutoff != channels.get<last_packet_received_tag> ().begin ())
+	{
+		node.network.fanout.invalidate ();
+	}
 	channels.get<last_packet_received_tag> ().erase (channels.get<last_packet_received_tag> ().begin (), disconnect_cutoff);
 	// Remove keepalive attempt tracking for attempts older than cutoff
 	auto attempts_cutoff (attempts.get<1> ().lower_bound (cutoff_a));
@@ -0,0 +1,213 @@
+#include <nano/lib/blocks.hpp>
+#include <nano/lib/locks.hpp>
+#include <nano/node/unchecked_staging.hpp>
+
+nano::unchecked_staging::unchecked_staging (size_t max_bytes_a) :
+max_bytes (max_bytes_a)
+{
+}
+
+size_t nano::unchecked_staging::entry_bytes (nano::block_type type_a)
+{
+	size_t block_bytes (0);
+	switch (type_a)
+	{
+		case nano::block_type::send:
+			block_bytes = sizeof (nano::send_block);
+			break;
+		case nano::block_type::receive:
+			block_bytes = sizeof (nano::receive_block);
+			break;
+		case nano::block_type::open:
+			block_bytes = sizeof (nano::open_block);
+			break;
+		case nano::block_type::change:
+			block_bytes = sizeof (nano::change_block);
+			break;
+		case nano::block_type::state:
+			block_bytes = sizeof (nano::state_block);
+			break;
+		default:
+			block_bytes = nano::block::size (type_a);
+			break;
+	}
+	// Sequenced: 2 links, ordered: 3 links, hashed: node link and bucket slot. The control block holds 2 counters and a vtable pointer
+	auto const links (2 + 3 + 2);
+	auto const control_block (3 * sizeof (void *));
+	return sizeof (entry) + links * sizeof (void *) + block_bytes + control_block;
+}
+
+bool nano::unchecked_staging::put (nano::unchecked_key const & key_a, nano::unchecked_info const & info_a)
+{
+	auto result (enabled ());
+	if (result)
+	{
+		auto bytes_l (entry_bytes (info_a.block->type ()));
+		nano::lock_guard<std::mutex> guard (mutex);
+		auto & entries_by_key (entries.get<tag_key> ());
+		auto existing (entries_by_key.find (boost::make_tuple (key_a.previous, key_a.hash)));
+		if (existing != entries_by_key.end ())
+		{
+			// Same behaviour as the store, the newest information replaces the existing one
+			entries_by_key.modify (existing, [&info_a](entry & entry_a) {
+				entry_a.info = info_a;
+			});
+		}
+		else
+		{
+			entries.get<tag_sequence> ().push_back ({ key_a.previous, key_a.hash, info_a, bytes_l });
+			bytes_m += bytes_l;
+		}
+	}
+	return result;
+}
+
+std::vector<nano::unchecked_info> nano::unchecked_staging::take (nano::block_hash const & dependency_a)
+{
+	std::vector<nano::unchecked_info> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto & entries_by_key (entries.get<tag_key> ());
+	auto range (entries_by_key.equal_range (boost::make_tuple (dependency_a)));
+	for (auto i (range.first); i != range.second; ++i)
+	{
+		result.push_back (i->info);
+		bytes_m -= i->bytes;
+	}
+	entries_by_key.erase (range.first, range.second);
+	return result;
+}
+
+std::vector<nano::unchecked_info> nano::unchecked_staging::get (nano::block_hash const & dependency_a)
+{
+	std::vector<nano::unchecked_info> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto range (entries.get<tag_key> ().equal_range (boost::make_tuple (dependency_a)));
+	for (auto i (range.first); i != range.second; ++i)
+	{
+		result.push_back (i->info);
+	}
+	return result;
+}
+
+bool nano::unchecked_staging::find (nano::block_hash const & hash_a, nano::unchecked_info & info_a)
+{
+	bool error (true);
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto & entries_by_hash (entries.get<tag_hash> ());
+	auto existing (entries_by_hash.find (hash_a));
+	if (existing != entries_by_hash.end ())
+	{
+		info_a = existing->info;
+		error = false;
+	}
+	return error;
+}
+
+std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> nano::unchecked_staging::spill ()
+{
+	std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	if (bytes_m > max_bytes)
+	{
+		// Spill down to 3/4 of the budget so that writes to the store are batched rather than made for every new entry
+		auto target (max_bytes / 4 * 3);
+		auto & entries_by_sequence (entries.get<tag_sequence> ());
+		while (bytes_m > target && !entries_by_sequence.empty ())
+		{
+			auto const & front (entries_by_sequence.front ());
+			result.emplace_back (nano::unchecked_key (front.dependency, front.hash), front.info);
+			bytes_m -= front.bytes;
+			entries_by_sequence.pop_front ();
+		}
+	}
+	return result;
+}
+
+std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> nano::unchecked_staging::spill_all ()
+{
+	std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	for (auto const & entry_l : entries)
+	{
+		result.emplace_back (nano::unchecked_key (entry_l.dependency, entry_l.hash), entry_l.info);
+	}
+	entries.clear ();
+	bytes_m = 0;
+	return result;
+}
+
+size_t nano::unchecked_staging::erase_older_than (uint64_t cutoff_a)
+{
+	size_t result (0);
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto & entries_by_sequence (entries.get<tag_sequence> ());
+	for (auto i (entries_by_sequence.begin ()), n (entries_by_sequence.end ()); i != n;)
+	{
+		if (i->info.modified < cutoff_a)
+		{
+			bytes_m -= i->bytes;
+			i = entries_by_sequence.erase (i);
+			++result;
+		}
+		else
+		{
+			++i;
+		}
+	}
+	return result;
+}
+
+std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> nano::unchecked_staging::list (size_t count_a)
+{
+	std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	for (auto i (entries.begin ()), n (entries.end ()); i != n && result.size () < count_a; ++i)
+	{
+		result.emplace_back (nano::unchecked_key (i->dependency, i->hash), i->info);
+	}
+	return result;
+}
+
+std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> nano::unchecked_staging::list (nano::block_hash const & dependency_a, size_t count_a)
+{
+	std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> result;
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto & by_key (entries.get<tag_key> ());
+	for (auto i (by_key.lower_bound (dependency_a)), n (by_key.end ()); i != n && result.size () < count_a; ++i)
+	{
+		result.emplace_back (nano::unchecked_key (i->dependency, i->hash), i->info);
+	}
+	return result;
+}
+
+void nano::unchecked_staging::clear ()
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	entries.clear ();
+	bytes_m = 0;
+}
+
+size_t nano::unchecked_staging::size ()
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	return entries.size ();
+}
+
+size_t nano::unchecked_staging::bytes ()
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	return bytes_m;
+}
+
+bool nano::unchecked_staging::enabled () const
+{
+	return max_bytes != 0;
+}
+
+std::unique_ptr<nano::seq_con_info_component> nano::collect_seq_con_info (nano::unchecked_staging & staging, const std::string & name)
+{
+	auto count (staging.size ());
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "entries", count, sizeof (decltype (staging.entries)::value_type) }));
+	return composite;
+}
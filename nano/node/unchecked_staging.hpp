@@ -0,0 +1,96 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/secure/common.hpp>
+
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace mi = boost::multi_index;
+
+namespace nano
+{
+/**
+ * In-memory staging area for unchecked blocks, keyed by the dependency they wait for.
+ * Gap blocks are usually resolved within seconds during bootstrap, keeping them here avoids writing each of them to the
+ * unchecked table only to delete it again. Memory use is bounded by \p max_bytes, oldest entries are spilled to the store under pressure.
+ * Staged entries are only written to the store when spilled or when the node stops, they are lost if the node crashes and must then be
+ * pulled again by the next bootstrap attempt.
+ * All public methods are thread-safe
+ */
+class unchecked_staging final
+{
+	class entry final
+	{
+	public:
+		nano::block_hash dependency;
+		nano::block_hash hash;
+		nano::unchecked_info info;
+		size_t bytes;
+	};
+
+	// clang-format off
+	class tag_sequence {};
+	class tag_key {};
+	class tag_hash {};
+	// clang-format on
+
+public:
+	unchecked_staging () = delete;
+	explicit unchecked_staging (size_t max_bytes_a);
+	/** Returns false if staging is disabled and the block must be written to the store directly */
+	bool put (nano::unchecked_key const &, nano::unchecked_info const &);
+	/** Removes and returns every block waiting for \p dependency_a */
+	std::vector<nano::unchecked_info> take (nano::block_hash const & dependency_a);
+	/** Returns the blocks waiting for \p dependency_a without removing them */
+	std::vector<nano::unchecked_info> get (nano::block_hash const & dependency_a);
+	/** Searches a staged block by its own hash */
+	bool find (nano::block_hash const & hash_a, nano::unchecked_info & info_a);
+	/** Removes the oldest entries until memory use is back under the budget, they must be written to the store by the caller */
+	std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> spill ();
+	/** Removes and returns all entries */
+	std::deque<std::pair<nano::unchecked_key, nano::unchecked_info>> spill_all ();
+	/** Drops entries last modified before \p cutoff_a, returns the number of dropped entries */
+	size_t erase_older_than (uint64_t cutoff_a);
+	/** Copies up to \p count_a entries, oldest first */
+	std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> list (size_t count_a);
+	/** Copies up to \p count_a entries waiting for \p dependency_a or a later dependency, in key order */
+	std::vector<std::pair<nano::unchecked_key, nano::unchecked_info>> list (nano::block_hash const & dependency_a, size_t count_a);
+	void clear ();
+	size_t size ();
+	size_t bytes ();
+	bool enabled () const;
+
+	size_t const max_bytes;
+
+private:
+	/** Estimated memory held by a staged block: the container node with the links of its indices, and the block object with its shared_ptr control block */
+	static size_t entry_bytes (nano::block_type);
+	// clang-format off
+	boost::multi_index_container<entry,
+	mi::indexed_by<
+		mi::sequenced<mi::tag<tag_sequence>>,
+		mi::ordered_unique<mi::tag<tag_key>,
+			mi::composite_key<entry,
+				mi::member<entry, nano::block_hash, &entry::dependency>,
+				mi::member<entry, nano::block_hash, &entry::hash>>>,
+		mi::hashed_non_unique<mi::tag<tag_hash>,
+			mi::member<entry, nano::block_hash, &entry::hash>>>>
+	entries;
+	// clang-format on
+	size_t bytes_m{ 0 };
+	std::mutex mutex;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (unchecked_staging &, const std::string &);
+};
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (unchecked_staging &, const std::string &);
+}
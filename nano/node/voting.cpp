@@ -22,6 +22,26 @@ void nano::vote_generator::add (nano::block_hash const & hash_a)
 	}
 }
 
+size_t nano::vote_generator::generate (std::vector<nano::block_hash> const & hashes_a, std::shared_ptr<nano::transport::channel> const & channel_a)
+{
+	size_t result (0);
+	auto transaction (node.store.tx_begin_read ());
+	for (auto i (hashes_a.begin ()), n (hashes_a.end ()); i != n;)
+	{
+		auto count (std::min<size_t> (std::distance (i, n), nano::network::confirm_ack_hashes_max));
+		std::vector<nano::block_hash> hashes_l (i, i + count);
+		node.wallets.foreach_representative ([this, &result, &hashes_l, &transaction, &channel_a](nano::public_key const & pub_a, nano::raw_key const & prv_a) {
+			auto vote (this->node.store.vote_generate (transaction, pub_a, prv_a, hashes_l));
+			this->node.votes_cache.add (vote);
+			nano::confirm_ack confirm (vote);
+			channel_a->send (confirm);
+			++result;
+		});
+		i += count;
+	}
+	return result;
+}
+
 void nano::vote_generator::stop ()
 {
 	nano::unique_lock<std::mutex> lock (mutex);
@@ -19,11 +19,17 @@
 namespace nano
 {
 class node;
+namespace transport
+{
+	class channel;
+}
 class vote_generator final
 {
 public:
 	vote_generator (nano::node &);
 	void add (nano::block_hash const &);
+	/** Signs \p hashes_a with every local representative, bundling up to 12 hashes per vote, and replies to \p channel_a. Returns the number of votes generated */
+	size_t generate (std::vector<nano::block_hash> const & hashes_a, std::shared_ptr<nano::transport::channel> const & channel_a);
 	void stop ();
 
 private:
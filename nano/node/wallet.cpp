@@ -1255,13 +1255,13 @@ bool nano::wallet::search_pending ()
 			// Don't search pending for watch-only accounts
 			if (!nano::wallet_value (i->second).key.is_zero ())
 			{
-				for (auto j (wallets.node.store.pending_begin (block_transaction, nano::pending_key (account, 0))); nano::pending_key (j->first).account == account; ++j)
+				// Entries are sorted by decreasing amount, the search stops at the first one below the receive minimum
+				for (auto j (wallets.node.store.pending_amounts_begin (block_transaction, account)), m (wallets.node.store.pending_amounts_end ()); j != m && nano::pending_amount_key (j->first).account == account && wallets.node.config.receive_minimum.number () <= nano::pending_amount_key (j->first).amount ().number (); ++j)
 				{
-					nano::pending_key key (j->first);
+					nano::pending_amount_key key (j->first);
 					auto hash (key.hash);
-					nano::pending_info pending (j->second);
-					auto amount (pending.amount.number ());
-					if (wallets.node.config.receive_minimum.number () <= amount)
+					nano::pending_info pending;
+					if (!wallets.node.store.pending_get (block_transaction, key.pending (), pending))
 					{
 						wallets.node.logger.try_log (boost::str (boost::format ("Found a pending block %1% for account %2%") % hash.to_string () % pending.source.to_account ()));
 						auto block (wallets.node.store.block_get (block_transaction, hash));
@@ -1320,11 +1320,11 @@ uint32_t nano::wallet::deterministic_check (nano::transaction const & transactio
 		else
 		{
 			// Check if there are pending blocks for account
-			for (auto ii (wallets.node.store.pending_begin (block_transaction, nano::pending_key (pair.pub, 0))); nano::pending_key (ii->first).account == pair.pub; ++ii)
+			nano::pending_summary summary;
+			if (!wallets.node.store.pending_summary_get (block_transaction, pair.pub, summary))
 			{
 				index = i;
 				n = i + 64 + (i / 64);
-				break;
 			}
 		}
 	}
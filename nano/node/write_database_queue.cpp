@@ -1,5 +1,6 @@
 #include <nano/lib/utility.hpp>
 #include <nano/node/write_database_queue.hpp>
+#include <nano/secure/group_commit.hpp>
 
 #include <algorithm>
 
@@ -7,12 +8,15 @@ nano::write_guard::write_guard (nano::condition_variable & cv_a, std::function<v
 cv (cv_a),
 guard_finish_callback (guard_finish_callback_a)
 {
+	nano::group_commit::defer_begin ();
 }
 
 nano::write_guard::~write_guard ()
 {
 	guard_finish_callback ();
 	cv.notify_all ();
+	// Waits for commits made under this guard to be flushed once other writers can proceed
+	nano::group_commit::defer_end ();
 }
 
 nano::write_database_queue::write_database_queue () :
@@ -2476,6 +2476,56 @@ TEST (rpc, peers_node_id)
 	ASSERT_EQ ("", tree2.get<std::string> ("node_id"));
 }
 
+TEST (rpc, peers_stats)
+{
+	nano::system system (24000, 2);
+	scoped_io_thread_name_change scoped_thread_name_io;
+	auto node = system.nodes.front ();
+	enable_ipc_transport_tcp (node->config.ipc_config.transport_tcp);
+	nano::node_rpc_config node_rpc_config;
+	nano::ipc::ipc_server ipc_server (*node, node_rpc_config);
+	nano::rpc_config rpc_config (true);
+	nano::ipc_rpc_processor ipc_rpc_processor (system.io_ctx, rpc_config);
+	nano::rpc rpc (system.io_ctx, rpc_config, ipc_rpc_processor);
+	rpc.start ();
+	auto channel (node->network.find_node_id (system.nodes[1]->node_id.pub));
+	ASSERT_NE (nullptr, channel);
+	system.deadline_set (5s);
+	while (channel->stats->messages_out == 0)
+	{
+		node->network.send_keepalive (channel);
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	boost::property_tree::ptree request;
+	request.put ("action", "peers_stats");
+	test_response response (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response.status);
+	auto & peers_node (response.json.get_child ("peers"));
+	ASSERT_EQ (1, peers_node.size ());
+	auto & peer (peers_node.begin ()->second);
+	ASSERT_EQ (system.nodes[1]->node_id.pub.to_node_id (), peer.get<std::string> ("node_id"));
+	ASSERT_LE (1, peer.get<uint64_t> ("messages_out"));
+	ASSERT_LT (0, peer.get<uint64_t> ("bytes_out"));
+	ASSERT_LE (1, peer.get<uint64_t> ("send_latency_us.count"));
+	request.put ("action", "stats");
+	request.put ("type", "peers");
+	test_response response1 (request, rpc.config.port, system.io_ctx);
+	system.deadline_set (5s);
+	while (response1.status == 0)
+	{
+		ASSERT_NO_ERROR (system.poll ());
+	}
+	ASSERT_EQ (200, response1.status);
+	ASSERT_EQ (1, response1.json.get<size_t> ("peers"));
+	ASSERT_LE (peer.get<uint64_t> ("messages_out"), response1.json.get<uint64_t> ("messages_out"));
+	ASSERT_LE (1, response1.json.get<uint64_t> ("send_latency_us.count"));
+}
+
 TEST (rpc, pending)
 {
 	nano::system system (24000, 1);
@@ -0,0 +1,99 @@
+#include <nano/lib/locks.hpp>
+#include <nano/secure/account_age_index.hpp>
+
+#include <algorithm>
+
+nano::account_age_index::account_age_index (uint64_t window_a) :
+window (window_a),
+complete_since (nano::seconds_since_epoch ())
+{
+}
+
+void nano::account_age_index::update (nano::account const & account_a, uint64_t modified_a)
+{
+	auto now (nano::seconds_since_epoch ());
+	nano::lock_guard<std::mutex> guard (mutex);
+	auto & entries_by_account (entries.get<tag_account> ());
+	auto existing (entries_by_account.find (account_a));
+	if (now < window || modified_a >= now - window)
+	{
+		if (existing != entries_by_account.end ())
+		{
+			entries_by_account.modify (existing, [modified_a](entry & entry_a) {
+				entry_a.modified = modified_a;
+			});
+		}
+		else
+		{
+			entries_by_account.insert ({ account_a, modified_a });
+		}
+	}
+	else if (existing != entries_by_account.end ())
+	{
+		// Rolled back to a state outside of the window
+		entries_by_account.erase (existing);
+	}
+	prune (now);
+}
+
+void nano::account_age_index::erase (nano::account const & account_a)
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	entries.get<tag_account> ().erase (account_a);
+}
+
+void nano::account_age_index::complete (uint64_t time_a)
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	complete_since = std::min (complete_since, time_a);
+}
+
+boost::optional<std::vector<nano::account>> nano::account_age_index::recent (uint64_t cutoff_a, nano::account const & start_a, size_t count_a)
+{
+	boost::optional<std::vector<nano::account>> result;
+	auto now (nano::seconds_since_epoch ());
+	nano::lock_guard<std::mutex> guard (mutex);
+	// Entries older than the window may have been pruned already
+	if (cutoff_a >= complete_since && (now < window || cutoff_a >= now - window))
+	{
+		result = std::vector<nano::account> ();
+		auto & entries_by_modified (entries.get<tag_modified> ());
+		for (auto i (entries_by_modified.lower_bound (cutoff_a)), n (entries_by_modified.end ()); i != n; ++i)
+		{
+			if (!(i->account < start_a))
+			{
+				result->push_back (i->account);
+			}
+		}
+		std::sort (result->begin (), result->end ());
+		if (result->size () > count_a)
+		{
+			result->resize (count_a);
+		}
+	}
+	return result;
+}
+
+size_t nano::account_age_index::size ()
+{
+	nano::lock_guard<std::mutex> guard (mutex);
+	return entries.size ();
+}
+
+void nano::account_age_index::prune (uint64_t now_a)
+{
+	assert (!mutex.try_lock ());
+	if (now_a > window)
+	{
+		auto & entries_by_modified (entries.get<tag_modified> ());
+		entries_by_modified.erase (entries_by_modified.begin (), entries_by_modified.lower_bound (now_a - window));
+	}
+}
+
+std::unique_ptr<nano::seq_con_info_component> nano::collect_seq_con_info (nano::account_age_index & index, const std::string & name)
+{
+	auto count (index.size ());
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "entries", count, sizeof (decltype (index.entries)::value_type) }));
+	return composite;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/secure/common.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/optional.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace mi = boost::multi_index;
+
+namespace nano
+{
+/**
+ * Auxiliary in-memory index of accounts ordered by their last modification time, used to answer age-filtered
+ * frontier requests without scanning the whole accounts table.
+ * Only accounts modified within the last \p window seconds are kept. The index is complete for every modification
+ * at or after complete_since, earlier changes may be missing if the index was not populated from the store at startup.
+ * All public methods are thread-safe
+ */
+class account_age_index final
+{
+	class entry final
+	{
+	public:
+		nano::account account;
+		uint64_t modified;
+	};
+
+	// clang-format off
+	class tag_account {};
+	class tag_modified {};
+	// clang-format on
+
+public:
+	account_age_index () = delete;
+	explicit account_age_index (uint64_t window_a);
+	/** Records that \p account_a was modified at \p modified_a, in seconds since epoch */
+	void update (nano::account const & account_a, uint64_t modified_a);
+	void erase (nano::account const & account_a);
+	/** Marks the index as holding every account modified at or after \p time_a */
+	void complete (uint64_t time_a);
+	/**
+	 * Returns up to \p count_a accounts greater or equal to \p start_a that were modified at or after \p cutoff_a, in ascending order.
+	 * Entries are not checked against the store and may be stale after a rollback.
+	 * Returns boost::none when the index does not cover \p cutoff_a and a full scan is required instead
+	 */
+	boost::optional<std::vector<nano::account>> recent (uint64_t cutoff_a, nano::account const & start_a, size_t count_a);
+	size_t size ();
+
+	uint64_t const window;
+
+private:
+	void prune (uint64_t now_a);
+
+	// clang-format off
+	boost::multi_index_container<entry,
+	mi::indexed_by<
+		mi::hashed_unique<mi::tag<tag_account>,
+			mi::member<entry, nano::account, &entry::account>>,
+		mi::ordered_non_unique<mi::tag<tag_modified>,
+			mi::member<entry, uint64_t, &entry::modified>>>>
+	entries;
+	// clang-format on
+	uint64_t complete_since;
+	std::mutex mutex;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (account_age_index &, const std::string &);
+};
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (account_age_index &, const std::string &);
+}
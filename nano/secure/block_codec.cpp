@@ -0,0 +1,165 @@
+#include <nano/lib/locks.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/secure/block_codec.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <unordered_map>
+
+uint8_t constexpr nano::block_codec::format_version;
+
+namespace
+{
+/** Length of the sequences counted when training, the size of an account or a block hash */
+size_t constexpr train_sequence_size{ 32 };
+/** Sequences start at multiples of this offset, fields of serialized blocks are aligned to it */
+size_t constexpr train_sequence_step{ 16 };
+
+class sequence_hash final
+{
+public:
+	size_t operator() (std::array<uint8_t, train_sequence_size> const & sequence_a) const
+	{
+		size_t result;
+		std::copy (sequence_a.begin (), sequence_a.begin () + sizeof (result), reinterpret_cast<uint8_t *> (&result));
+		return result;
+	}
+};
+}
+
+class nano::block_codec::stream final
+{
+public:
+	z_stream z{};
+};
+
+nano::block_codec::block_codec (std::vector<uint8_t> const & dictionary_a) :
+dictionary (dictionary_a)
+{
+}
+
+nano::block_codec::~block_codec ()
+{
+	for (auto & stream_l : deflaters)
+	{
+		deflateEnd (&stream_l->z);
+	}
+	for (auto & stream_l : inflaters)
+	{
+		inflateEnd (&stream_l->z);
+	}
+}
+
+std::unique_ptr<nano::block_codec::stream> nano::block_codec::stream_take (bool deflate_a) const
+{
+	std::unique_ptr<stream> result;
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		auto & streams (deflate_a ? deflaters : inflaters);
+		if (!streams.empty ())
+		{
+			result = std::move (streams.back ());
+			streams.pop_back ();
+		}
+	}
+	if (result == nullptr)
+	{
+		result = std::make_unique<stream> ();
+		// Negative window bits select raw streams, without the zlib header and checksum
+		auto status (deflate_a ? deflateInit2 (&result->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) : inflateInit2 (&result->z, -15));
+		release_assert (status == Z_OK);
+	}
+	else
+	{
+		auto status (deflate_a ? deflateReset (&result->z) : inflateReset (&result->z));
+		release_assert (status == Z_OK);
+	}
+	if (!dictionary.empty ())
+	{
+		// Raw streams take the dictionary before any data, it is lost on every reset
+		auto status (deflate_a ? deflateSetDictionary (&result->z, dictionary.data (), static_cast<uInt> (dictionary.size ())) : inflateSetDictionary (&result->z, dictionary.data (), static_cast<uInt> (dictionary.size ())));
+		release_assert (status == Z_OK);
+	}
+	return result;
+}
+
+void nano::block_codec::stream_return (std::unique_ptr<stream> stream_a, bool deflate_a) const
+{
+	nano::lock_guard<std::mutex> lock (mutex);
+	(deflate_a ? deflaters : inflaters).push_back (std::move (stream_a));
+}
+
+bool nano::block_codec::compress (uint8_t const * data_a, size_t size_a, size_t limit_a, std::vector<uint8_t> & result_a) const
+{
+	auto stream_l (stream_take (true));
+	result_a.resize (limit_a);
+	stream_l->z.next_in = const_cast<Bytef *> (data_a);
+	stream_l->z.avail_in = static_cast<uInt> (size_a);
+	stream_l->z.next_out = result_a.data ();
+	stream_l->z.avail_out = static_cast<uInt> (result_a.size ());
+	// Output which does not fit below the limit leaves the stream unfinished
+	auto error (deflate (&stream_l->z, Z_FINISH) != Z_STREAM_END || stream_l->z.total_out >= limit_a);
+	result_a.resize (error ? 0 : stream_l->z.total_out);
+	stream_return (std::move (stream_l), true);
+	return error;
+}
+
+bool nano::block_codec::decompress (uint8_t const * data_a, size_t size_a, std::vector<uint8_t> & result_a) const
+{
+	auto stream_l (stream_take (false));
+	result_a.resize (std::max<size_t> (size_a * 4, 256));
+	stream_l->z.next_in = const_cast<Bytef *> (data_a);
+	stream_l->z.avail_in = static_cast<uInt> (size_a);
+	auto status (Z_OK);
+	while (status == Z_OK)
+	{
+		if (stream_l->z.total_out == result_a.size ())
+		{
+			result_a.resize (result_a.size () * 2);
+		}
+		stream_l->z.next_out = result_a.data () + stream_l->z.total_out;
+		stream_l->z.avail_out = static_cast<uInt> (result_a.size () - stream_l->z.total_out);
+		status = inflate (&stream_l->z, Z_FINISH);
+		// Z_BUF_ERROR only reports that the output was full
+		if (status == Z_BUF_ERROR && stream_l->z.avail_out == 0)
+		{
+			status = Z_OK;
+		}
+	}
+	auto error (status != Z_STREAM_END || stream_l->z.avail_in != 0);
+	result_a.resize (error ? 0 : stream_l->z.total_out);
+	stream_return (std::move (stream_l), false);
+	return error;
+}
+
+std::vector<uint8_t> nano::block_codec::train (std::vector<std::vector<uint8_t>> const & samples_a, size_t max_size_a)
+{
+	std::unordered_map<std::array<uint8_t, train_sequence_size>, uint64_t, sequence_hash> counts;
+	for (auto const & sample : samples_a)
+	{
+		for (size_t offset (0); offset + train_sequence_size <= sample.size (); offset += train_sequence_step)
+		{
+			std::array<uint8_t, train_sequence_size> sequence;
+			std::copy (sample.begin () + offset, sample.begin () + offset + train_sequence_size, sequence.begin ());
+			++counts[sequence];
+		}
+	}
+	// Sequences seen once would never be referenced again
+	std::multimap<uint64_t, std::array<uint8_t, train_sequence_size> const *, std::greater<uint64_t>> ranked;
+	for (auto const & entry : counts)
+	{
+		if (entry.second > 1)
+		{
+			ranked.emplace (entry.second, &entry.first);
+		}
+	}
+	std::vector<uint8_t> result;
+	for (auto i (ranked.begin ()), n (ranked.end ()); i != n && result.size () + train_sequence_size <= max_size_a; ++i)
+	{
+		result.insert (result.begin (), i->second->begin (), i->second->end ());
+	}
+	return result;
+}
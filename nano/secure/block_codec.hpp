@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Deflate compression of stored blocks with a preset dictionary.
+ * The dictionary holds the byte sequences most repeated across sampled blocks, such as popular representatives and busy accounts,
+ * so that they are encoded as short back references. Streams are raw deflate without headers and are reused across calls.
+ * All methods are thread-safe
+ */
+class block_codec final
+{
+public:
+	explicit block_codec (std::vector<uint8_t> const & dictionary_a);
+	~block_codec ();
+	/** Compresses \p size_a bytes of \p data_a into \p result_a. Returns true if the result would not be smaller than \p limit_a */
+	bool compress (uint8_t const * data_a, size_t size_a, size_t limit_a, std::vector<uint8_t> & result_a) const;
+	/** Returns true if \p data_a is not a valid stream for this dictionary */
+	bool decompress (uint8_t const * data_a, size_t size_a, std::vector<uint8_t> & result_a) const;
+	/** Builds a dictionary of at most \p max_size_a bytes from the sequences repeated across \p samples_a, most repeated last */
+	static std::vector<uint8_t> train (std::vector<std::vector<uint8_t>> const & samples_a, size_t max_size_a);
+
+	std::vector<uint8_t> const dictionary;
+	/** Stored along with the dictionary, values written by other versions are not decoded */
+	static uint8_t constexpr format_version{ 1 };
+
+private:
+	class stream;
+	std::unique_ptr<stream> stream_take (bool deflate_a) const;
+	void stream_return (std::unique_ptr<stream>, bool deflate_a) const;
+	mutable std::mutex mutex;
+	mutable std::vector<std::unique_ptr<stream>> deflaters;
+	mutable std::vector<std::unique_ptr<stream>> inflaters;
+};
+}
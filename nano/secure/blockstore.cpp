@@ -1,4 +1,6 @@
 #include <nano/secure/blockstore.hpp>
+#include <nano/secure/group_commit.hpp>
+#include <nano/secure/store_cache.hpp>
 
 #include <boost/endian/conversion.hpp>
 #include <boost/polymorphic_cast.hpp>
@@ -394,6 +396,11 @@ void * nano::read_transaction::get_handle () const
 	return impl->get_handle ();
 }
 
+uint64_t nano::read_transaction::cache_generation () const
+{
+	return generation;
+}
+
 void nano::read_transaction::reset () const
 {
 	impl->reset ();
@@ -401,9 +408,20 @@ void nano::read_transaction::reset () const
 
 void nano::read_transaction::renew () const
 {
+	if (cache != nullptr)
+	{
+		// Read before the new snapshot is taken, so that every commit up to this generation is visible to it
+		generation = cache->generation;
+	}
 	impl->renew ();
 }
 
+void nano::read_transaction::track_cache (nano::store_cache const & cache_a, uint64_t generation_a)
+{
+	cache = &cache_a;
+	generation = generation_a;
+}
+
 void nano::read_transaction::refresh () const
 {
 	reset ();
@@ -424,9 +442,36 @@ void * nano::write_transaction::get_handle () const
 	return impl->get_handle ();
 }
 
+nano::write_transaction::~write_transaction ()
+{
+	if (impl != nullptr)
+	{
+		auto modified (cache != nullptr && cache->commit_begin (*this));
+		// Commits the transaction
+		impl.reset ();
+		if (modified)
+		{
+			cache->commit_end ();
+		}
+		if (group_commit != nullptr)
+		{
+			group_commit->committed ();
+		}
+	}
+}
+
 void nano::write_transaction::commit () const
 {
+	auto modified (cache != nullptr && cache->commit_begin (*this));
 	impl->commit ();
+	if (modified)
+	{
+		cache->commit_end ();
+	}
+	if (group_commit != nullptr)
+	{
+		group_commit->committed ();
+	}
 }
 
 void nano::write_transaction::renew ()
@@ -438,3 +483,13 @@ bool nano::write_transaction::contains (nano::tables table_a) const
 {
 	return impl->contains (table_a);
 }
+
+void nano::write_transaction::track_cache (nano::store_cache & cache_a)
+{
+	cache = &cache_a;
+}
+
+void nano::write_transaction::track_group_commit (nano::group_commit & group_commit_a)
+{
+	group_commit = &group_commit_a;
+}
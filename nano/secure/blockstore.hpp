@@ -1,8 +1,10 @@
 #pragma once
 
 #include <nano/crypto_lib/random_pool.hpp>
+#include <nano/lib/compressionconfig.hpp>
 #include <nano/lib/config.hpp>
 #include <nano/lib/diagnosticsconfig.hpp>
+#include <nano/lib/durabilityconfig.hpp>
 #include <nano/lib/logger_mt.hpp>
 #include <nano/lib/memory.hpp>
 #include <nano/lib/rocksdbconfig.hpp>
@@ -10,8 +12,10 @@
 #include <nano/secure/versioning.hpp>
 
 #include <boost/endian/conversion.hpp>
+#include <boost/optional.hpp>
 #include <boost/polymorphic_cast.hpp>
 
+#include <functional>
 #include <stack>
 
 namespace nano
@@ -76,6 +80,18 @@ public:
 		static_assert (std::is_standard_layout<nano::pending_key>::value, "Standard layout is required");
 	}
 
+	db_val (nano::pending_amount_key const & val_a) :
+	db_val (sizeof (val_a), const_cast<nano::pending_amount_key *> (&val_a))
+	{
+		static_assert (std::is_standard_layout<nano::pending_amount_key>::value, "Standard layout is required");
+	}
+
+	db_val (nano::pending_summary const & val_a) :
+	db_val (val_a.db_size (), const_cast<nano::pending_summary *> (&val_a))
+	{
+		static_assert (std::is_standard_layout<nano::pending_summary>::value, "Standard layout is required");
+	}
+
 	db_val (nano::unchecked_info const & val_a) :
 	buffer (std::make_shared<std::vector<uint8_t>> ())
 	{
@@ -183,6 +199,23 @@ public:
 		return result;
 	}
 
+	explicit operator nano::pending_amount_key () const
+	{
+		nano::pending_amount_key result;
+		assert (size () == sizeof (result));
+		static_assert (sizeof (nano::pending_amount_key::account) + sizeof (nano::pending_amount_key::amount_complement) + sizeof (nano::pending_amount_key::hash) == sizeof (result), "Packed class");
+		std::copy (reinterpret_cast<uint8_t const *> (data ()), reinterpret_cast<uint8_t const *> (data ()) + sizeof (result), reinterpret_cast<uint8_t *> (&result));
+		return result;
+	}
+
+	explicit operator nano::pending_summary () const
+	{
+		nano::pending_summary result;
+		assert (size () == result.db_size ());
+		std::copy (reinterpret_cast<uint8_t const *> (data ()), reinterpret_cast<uint8_t const *> (data ()) + result.db_size (), reinterpret_cast<uint8_t *> (&result));
+		return result;
+	}
+
 	explicit operator nano::unchecked_info () const
 	{
 		nano::bufferstream stream (reinterpret_cast<uint8_t const *> (data ()), size ());
@@ -555,6 +588,8 @@ enum class tables
 	open_blocks,
 	peers,
 	pending,
+	pending_amounts,
+	pending_summary,
 	receive_blocks,
 	representation,
 	send_blocks,
@@ -585,11 +620,19 @@ public:
 	virtual bool contains (nano::tables table_a) const = 0;
 };
 
+class group_commit;
+class store_cache;
+
 class transaction
 {
 public:
 	virtual ~transaction () = default;
 	virtual void * get_handle () const = 0;
+	/** Store cache generation included in the transaction snapshot, zero if the transaction must not use the cache */
+	virtual uint64_t cache_generation () const
+	{
+		return 0;
+	}
 };
 
 /**
@@ -601,12 +644,17 @@ class read_transaction final : public transaction
 public:
 	explicit read_transaction (std::unique_ptr<nano::read_transaction_impl> read_transaction_impl);
 	void * get_handle () const override;
+	uint64_t cache_generation () const override;
 	void reset () const;
 	void renew () const;
 	void refresh () const;
+	/** Enables the store cache, \p generation_a is the value of \p cache_a generation read before the transaction started */
+	void track_cache (nano::store_cache const & cache_a, uint64_t generation_a);
 
 private:
 	std::unique_ptr<nano::read_transaction_impl> impl;
+	nano::store_cache const * cache{ nullptr };
+	mutable uint64_t generation{ 0 };
 };
 
 /**
@@ -617,13 +665,21 @@ class write_transaction final : public transaction
 {
 public:
 	explicit write_transaction (std::unique_ptr<nano::write_transaction_impl> write_transaction_impl);
+	write_transaction (write_transaction &&) = default;
+	~write_transaction ();
 	void * get_handle () const override;
 	void commit () const;
 	void renew ();
 	bool contains (nano::tables table_a) const;
+	/** Drops objects modified by this transaction from \p cache_a on every commit */
+	void track_cache (nano::store_cache & cache_a);
+	/** Reports every commit to \p group_commit_a, which flushes it to disk */
+	void track_group_commit (nano::group_commit & group_commit_a);
 
 private:
 	std::unique_ptr<nano::write_transaction_impl> impl;
+	nano::store_cache * cache{ nullptr };
+	nano::group_commit * group_commit{ nullptr };
 };
 
 class rep_weights;
@@ -640,6 +696,16 @@ public:
 	virtual nano::block_hash block_successor (nano::transaction const &, nano::block_hash const &) const = 0;
 	virtual void block_successor_clear (nano::write_transaction const &, nano::block_hash const &) = 0;
 	virtual std::shared_ptr<nano::block> block_get (nano::transaction const &, nano::block_hash const &, nano::block_sideband * = nullptr) const = 0;
+	/**
+	 * Looks up several blocks at once, results are in the order of the hashes and null for missing blocks.
+	 * Sidebands are filled in the same order when requested
+	 */
+	virtual std::vector<std::shared_ptr<nano::block>> blocks_get (nano::transaction const &, std::vector<nano::block_hash> const &, std::vector<nano::block_sideband> * = nullptr) const = 0;
+	/**
+	 * Appends the network serialization of a block, its type followed by the block, copied from the stored bytes without deserializing.
+	 * Sets the previous hash, zero for open blocks. Returns true if the block does not exist
+	 */
+	virtual bool block_serialized_append (nano::transaction const &, nano::block_hash const &, std::vector<uint8_t> &, nano::block_hash &) const = 0;
 	virtual std::shared_ptr<nano::block> block_get_v14 (nano::transaction const &, nano::block_hash const &, nano::block_sideband_v14 * = nullptr, bool * = nullptr) const = 0;
 	virtual std::shared_ptr<nano::block> block_random (nano::transaction const &) = 0;
 	virtual void block_del (nano::write_transaction const &, nano::block_hash const &) = 0;
@@ -656,6 +722,8 @@ public:
 
 	virtual void account_put (nano::write_transaction const &, nano::account const &, nano::account_info const &) = 0;
 	virtual bool account_get (nano::transaction const &, nano::account const &, nano::account_info &) = 0;
+	/** Looks up several accounts at once, results are in the order of the accounts and empty for missing accounts */
+	virtual std::vector<boost::optional<nano::account_info>> accounts_get (nano::transaction const &, std::vector<nano::account> const &) = 0;
 	virtual void account_del (nano::write_transaction const &, nano::account const &) = 0;
 	virtual bool account_exists (nano::transaction const &, nano::account const &) = 0;
 	virtual size_t account_count (nano::transaction const &) = 0;
@@ -671,7 +739,15 @@ public:
 	virtual bool pending_exists (nano::transaction const &, nano::pending_key const &) = 0;
 	virtual nano::store_iterator<nano::pending_key, nano::pending_info> pending_begin (nano::transaction const &, nano::pending_key const &) = 0;
 	virtual nano::store_iterator<nano::pending_key, nano::pending_info> pending_begin (nano::transaction const &) = 0;
+	/** Pending entries of \p account_a, entries of the following accounts may be returned after them and must end the iteration */
+	virtual nano::store_iterator<nano::pending_key, nano::pending_info> pending_begin (nano::transaction const &, nano::account const & account_a) = 0;
 	virtual nano::store_iterator<nano::pending_key, nano::pending_info> pending_end () = 0;
+	/** Pending entries of \p account_a and the following accounts, ordered by account and then by decreasing amount */
+	virtual nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const &, nano::account const & account_a) = 0;
+	virtual nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const &, nano::pending_amount_key const &) = 0;
+	virtual nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_end () = 0;
+	/** Returns true if \p account_a has no pending entries */
+	virtual bool pending_summary_get (nano::transaction const &, nano::account const & account_a, nano::pending_summary &) = 0;
 
 	virtual bool block_info_get (nano::transaction const &, nano::block_hash const &, nano::block_info &) const = 0;
 	virtual nano::uint128_t block_balance (nano::transaction const &, nano::block_hash const &) = 0;
@@ -732,6 +808,28 @@ public:
 	virtual std::mutex & get_cache_mutex () = 0;
 
 	virtual bool copy_db (boost::filesystem::path const & destination) = 0;
+	/**
+	 * Rewrites the store to release free space while it stays in use, writing at most \p max_bytes_per_second_a unless it is 0.
+	 * Gives up when \p stopped_a returns true. Returns true on error
+	 */
+	virtual bool compact (uint64_t max_bytes_per_second_a, std::function<bool()> const & stopped_a) = 0;
+
+	/** Calls \p action_a with the stored key and value bytes of every entry of \p table_a, in key order */
+	virtual void raw_for_each (nano::transaction const &, nano::tables table_a, std::function<void(uint8_t const *, size_t, uint8_t const *, size_t)> const & action_a) const = 0;
+	/**
+	 * Stores raw key and value bytes in \p table_a. When \p append_a is set keys must arrive in ascending order after any existing key,
+	 * which lets the backend skip the ordered insertion. Returns true on error
+	 */
+	virtual bool raw_put (nano::write_transaction const &, nano::tables table_a, uint8_t const *, size_t, uint8_t const *, size_t, bool append_a) = 0;
+	virtual void raw_clear (nano::write_transaction const &, nano::tables table_a) = 0;
+
+	/** Cache of hot blocks, account information and confirmation heights in front of the tables */
+	virtual nano::store_cache & cache () = 0;
+	/**
+	 * Used by read replicas sharing the store with a node in another process. Returns true if a commit was made since the
+	 * previous call. Replicas which can observe such commits do not use the cache
+	 */
+	virtual bool replica_refresh () = 0;
 
 	/** Not applicable to all sub-classes */
 	virtual void serialize_mdb_tracker (boost::property_tree::ptree &, std::chrono::milliseconds, std::chrono::milliseconds) = 0;
@@ -745,7 +843,7 @@ public:
 	virtual nano::read_transaction tx_begin_read () = 0;
 };
 
-std::unique_ptr<nano::block_store> make_store (nano::logger_mt & logger, boost::filesystem::path const & path, bool open_read_only = false, bool add_db_postfix = false, nano::rocksdb_config const & rocksdb_config = nano::rocksdb_config{}, nano::txn_tracking_config const & txn_tracking_config_a = nano::txn_tracking_config{}, std::chrono::milliseconds block_processor_batch_max_time_a = std::chrono::milliseconds (5000), int lmdb_max_dbs = 128, size_t batch_size = 512, bool backup_before_upgrade = false, bool rocksdb_backend = false);
+std::unique_ptr<nano::block_store> make_store (nano::logger_mt & logger, boost::filesystem::path const & path, bool open_read_only = false, bool add_db_postfix = false, nano::rocksdb_config const & rocksdb_config = nano::rocksdb_config{}, nano::txn_tracking_config const & txn_tracking_config_a = nano::txn_tracking_config{}, std::chrono::milliseconds block_processor_batch_max_time_a = std::chrono::milliseconds (5000), int lmdb_max_dbs = 128, size_t batch_size = 512, bool backup_before_upgrade = false, bool rocksdb_backend = false, nano::durability_config const & durability_config = nano::durability_config{}, nano::compression_config const & compression_config = nano::compression_config{});
 }
 
 namespace std
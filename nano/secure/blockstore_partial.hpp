@@ -1,7 +1,11 @@
 #pragma once
 
 #include <nano/lib/rep_weights.hpp>
+#include <nano/secure/block_codec.hpp>
 #include <nano/secure/blockstore.hpp>
+#include <nano/secure/store_cache.hpp>
+
+#include <unordered_set>
 
 namespace nano
 {
@@ -38,6 +42,18 @@ public:
 		frontier_put (transaction_a, hash_l, network_params.ledger.genesis_account);
 	}
 
+	void raw_clear (nano::write_transaction const & transaction_a, nano::tables table_a) override
+	{
+		cache_m.all_modified (transaction_a);
+		auto status (drop (transaction_a, table_a));
+		release_assert (success (status));
+	}
+
+	nano::store_cache & cache () override
+	{
+		return cache_m;
+	}
+
 	nano::uint128_t block_balance (nano::transaction const & transaction_a, nano::block_hash const & hash_a) override
 	{
 		nano::block_sideband sideband;
@@ -112,41 +128,137 @@ public:
 
 	std::shared_ptr<nano::block> block_get (nano::transaction const & transaction_a, nano::block_hash const & hash_a, nano::block_sideband * sideband_a = nullptr) const override
 	{
-		nano::block_type type;
-		auto value (block_raw_get (transaction_a, hash_a, type));
 		std::shared_ptr<nano::block> result;
-		if (value.size () != 0)
+		if (cache_m.block_get (transaction_a, hash_a, result, sideband_a))
 		{
-			nano::bufferstream stream (reinterpret_cast<uint8_t const *> (value.data ()), value.size ());
-			result = nano::deserialize_block (stream, type);
-			assert (result != nullptr);
-			if (sideband_a)
+			result = block_get_uncached (transaction_a, hash_a, sideband_a);
+		}
+		return result;
+	}
+
+	std::vector<std::shared_ptr<nano::block>> blocks_get (nano::transaction const & transaction_a, std::vector<nano::block_hash> const & hashes_a, std::vector<nano::block_sideband> * sidebands_a) const override
+	{
+		std::vector<std::shared_ptr<nano::block>> result (hashes_a.size ());
+		if (sidebands_a != nullptr)
+		{
+			sidebands_a->assign (hashes_a.size (), nano::block_sideband{});
+		}
+		std::vector<size_t> missing;
+		for (size_t i (0); i < hashes_a.size (); ++i)
+		{
+			if (cache_m.block_get (transaction_a, hashes_a[i], result[i], sidebands_a != nullptr ? &(*sidebands_a)[i] : nullptr))
 			{
-				sideband_a->type = type;
-				if (full_sideband (transaction_a) || entry_has_sideband (value.size (), type))
+				missing.push_back (i);
+			}
+		}
+		// Table lookups are ordered by match probability, each table is only asked for the hashes not found so far
+		nano::block_type block_types[]{ nano::block_type::state, nano::block_type::send, nano::block_type::receive, nano::block_type::open, nano::block_type::change };
+		for (auto i (std::begin (block_types)), n (std::end (block_types)); i != n && !missing.empty (); ++i)
+		{
+			std::vector<nano::db_val<Val>> keys;
+			keys.reserve (missing.size ());
+			for (auto index : missing)
+			{
+				keys.emplace_back (hashes_a[index]);
+			}
+			std::vector<nano::db_val<Val>> values;
+			std::vector<int> statuses;
+			get_many (transaction_a, block_database (*i), keys, values, statuses);
+			std::vector<size_t> still_missing;
+			for (size_t j (0); j < missing.size (); ++j)
+			{
+				release_assert (success (statuses[j]) || not_found (statuses[j]));
+				if (success (statuses[j]))
 				{
-					auto error (sideband_a->deserialize (stream));
-					(void)error;
-					assert (!error);
+					auto index (missing[j]);
+					result[index] = block_deserialize (transaction_a, hashes_a[index], values[j], *i, sidebands_a != nullptr ? &(*sidebands_a)[index] : nullptr);
 				}
 				else
 				{
-					// Reconstruct sideband data for block.
-					sideband_a->account = block_account_computed (transaction_a, hash_a);
-					sideband_a->balance = block_balance_computed (transaction_a, hash_a);
-					sideband_a->successor = block_successor (transaction_a, hash_a);
-					sideband_a->height = 0;
-					sideband_a->timestamp = 0;
+					still_missing.push_back (missing[j]);
 				}
 			}
+			missing.swap (still_missing);
+		}
+		return result;
+	}
+
+	std::shared_ptr<nano::block> block_get_uncached (nano::transaction const & transaction_a, nano::block_hash const & hash_a, nano::block_sideband * sideband_a) const
+	{
+		nano::block_type type;
+		auto value (block_raw_get (transaction_a, hash_a, type));
+		std::shared_ptr<nano::block> result;
+		if (value.size () != 0)
+		{
+			result = block_deserialize (transaction_a, hash_a, value, type, sideband_a);
+		}
+		return result;
+	}
+
+	/** Deserializes a stored block entry of \p type_a, entries stored without a sideband have it reconstructed from other tables */
+	std::shared_ptr<nano::block> block_deserialize (nano::transaction const & transaction_a, nano::block_hash const & hash_a, nano::db_val<Val> const & value_a, nano::block_type type_a, nano::block_sideband * sideband_a) const
+	{
+		nano::bufferstream stream (reinterpret_cast<uint8_t const *> (value_a.data ()), value_a.size ());
+		auto result (nano::deserialize_block (stream, type_a));
+		assert (result != nullptr);
+		if (entry_has_sideband (value_a.size (), type_a))
+		{
+			// Only blocks stored with their sideband are cached, older entries reconstruct it from other tables
+			nano::block_sideband sideband;
+			sideband.type = type_a;
+			auto error (sideband.deserialize (stream));
+			(void)error;
+			assert (!error);
+			cache_m.block_put (transaction_a, hash_a, result, sideband);
+			if (sideband_a)
+			{
+				*sideband_a = sideband;
+			}
+		}
+		else if (sideband_a)
+		{
+			sideband_a->type = type_a;
+			if (full_sideband (transaction_a))
+			{
+				auto error (sideband_a->deserialize (stream));
+				(void)error;
+				assert (!error);
+			}
+			else
+			{
+				// Reconstruct sideband data for block.
+				sideband_a->account = block_account_computed (transaction_a, hash_a);
+				sideband_a->balance = block_balance_computed (transaction_a, hash_a);
+				sideband_a->successor = block_successor (transaction_a, hash_a);
+				sideband_a->height = 0;
+				sideband_a->timestamp = 0;
+			}
+		}
+		return result;
+	}
+
+	bool block_serialized_append (nano::transaction const & transaction_a, nano::block_hash const & hash_a, std::vector<uint8_t> & buffer_a, nano::block_hash & previous_a) const override
+	{
+		nano::block_type type;
+		auto value (block_raw_get (transaction_a, hash_a, type));
+		auto result (value.size () == 0);
+		if (!result)
+		{
+			// Stored entries are the serialized block followed by its sideband
+			auto block_size (nano::block::size (type));
+			assert (value.size () >= block_size);
+			auto data (reinterpret_cast<uint8_t const *> (value.data ()));
+			buffer_a.push_back (static_cast<uint8_t> (type));
+			buffer_a.insert (buffer_a.end (), data, data + block_size);
+			previous_a = nano::block::serialized_previous (type, data);
 		}
 		return result;
 	}
 
 	bool block_exists (nano::transaction const & transaction_a, nano::block_type type, nano::block_hash const & hash_a) override
 	{
-		auto junk = block_raw_get_by_type (transaction_a, hash_a, type);
-		return junk.is_initialized ();
+		// Avoids reading and decompressing the value
+		return static_cast<Derived_Store const &> (*this).exists (transaction_a, block_database (type), nano::db_val<Val> (hash_a));
 	}
 
 	bool block_exists (nano::transaction const & tx_a, nano::block_hash const & hash_a) override
@@ -329,6 +441,11 @@ public:
 		return nano::store_iterator<nano::pending_key, nano::pending_info> (nullptr);
 	}
 
+	nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_end () override
+	{
+		return nano::store_iterator<nano::pending_amount_key, nano::no_value> (nullptr);
+	}
+
 	nano::store_iterator<uint64_t, nano::amount> online_weight_end () const override
 	{
 		return nano::store_iterator<uint64_t, nano::amount> (nullptr);
@@ -351,6 +468,7 @@ public:
 
 	void block_del (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a) override
 	{
+		cache_m.block_modified (transaction_a, hash_a);
 		auto status = del (transaction_a, tables::state_blocks, hash_a);
 		release_assert (success (status) || not_found (status));
 		if (!success (status))
@@ -405,6 +523,7 @@ public:
 
 	void block_raw_put (nano::write_transaction const & transaction_a, std::vector<uint8_t> const & data, nano::block_type block_type_a, nano::block_hash const & hash_a)
 	{
+		cache_m.block_modified (transaction_a, hash_a);
 		auto database_a = block_database (block_type_a);
 		nano::db_val<Val> value{ data.size (), (void *)data.data () };
 		auto status = put (transaction_a, database_a, hash_a, value);
@@ -413,17 +532,42 @@ public:
 
 	void pending_put (nano::write_transaction const & transaction_a, nano::pending_key const & key_a, nano::pending_info const & pending_info_a) override
 	{
+		nano::pending_info existing;
+		if (!pending_get (transaction_a, key_a, existing))
+		{
+			pending_index_del (transaction_a, key_a, existing.amount);
+		}
 		nano::db_val<Val> pending (pending_info_a);
 		auto status = put (transaction_a, tables::pending, key_a, pending);
 		release_assert (success (status));
+		pending_index_put (transaction_a, key_a, pending_info_a.amount);
 	}
 
 	void pending_del (nano::write_transaction const & transaction_a, nano::pending_key const & key_a) override
 	{
+		nano::pending_info existing;
+		if (!pending_get (transaction_a, key_a, existing))
+		{
+			pending_index_del (transaction_a, key_a, existing.amount);
+		}
 		auto status1 = del (transaction_a, tables::pending, key_a);
 		release_assert (success (status1));
 	}
 
+	bool pending_summary_get (nano::transaction const & transaction_a, nano::account const & account_a, nano::pending_summary & summary_a) override
+	{
+		nano::db_val<Val> value;
+		auto status (get (transaction_a, tables::pending_summary, nano::db_val<Val> (account_a), value));
+		release_assert (success (status) || not_found (status));
+		bool result (true);
+		if (success (status))
+		{
+			summary_a = static_cast<nano::pending_summary> (value);
+			result = false;
+		}
+		return result;
+	}
+
 	bool pending_get (nano::transaction const & transaction_a, nano::pending_key const & key_a, nano::pending_info & pending_a) override
 	{
 		nano::db_val<Val> value;
@@ -529,6 +673,7 @@ public:
 	{
 		// Check we are still in sync with other tables
 		assert (confirmation_height_exists (transaction_a, account_a));
+		cache_m.account_modified (transaction_a, account_a);
 		nano::db_val<Val> info (info_a);
 		auto status = put (transaction_a, tables::accounts, account_a, info);
 		release_assert (success (status));
@@ -536,21 +681,70 @@ public:
 
 	void account_del (nano::write_transaction const & transaction_a, nano::account const & account_a) override
 	{
+		cache_m.account_modified (transaction_a, account_a);
 		auto status1 = del (transaction_a, tables::accounts, account_a);
 		release_assert (success (status1));
 	}
 
 	bool account_get (nano::transaction const & transaction_a, nano::account const & account_a, nano::account_info & info_a) override
 	{
-		nano::db_val<Val> value;
-		nano::db_val<Val> account (account_a);
-		auto status1 (get (transaction_a, tables::accounts, account, value));
-		release_assert (success (status1) || not_found (status1));
-		bool result (true);
-		if (success (status1))
+		bool result (cache_m.account_get (transaction_a, account_a, info_a));
+		if (result)
 		{
-			nano::bufferstream stream (reinterpret_cast<uint8_t const *> (value.data ()), value.size ());
-			result = info_a.deserialize (stream);
+			nano::db_val<Val> value;
+			nano::db_val<Val> account (account_a);
+			auto status1 (get (transaction_a, tables::accounts, account, value));
+			release_assert (success (status1) || not_found (status1));
+			if (success (status1))
+			{
+				nano::bufferstream stream (reinterpret_cast<uint8_t const *> (value.data ()), value.size ());
+				result = info_a.deserialize (stream);
+				if (!result)
+				{
+					cache_m.account_put (transaction_a, account_a, info_a);
+				}
+			}
+		}
+		return result;
+	}
+
+	std::vector<boost::optional<nano::account_info>> accounts_get (nano::transaction const & transaction_a, std::vector<nano::account> const & accounts_a) override
+	{
+		std::vector<boost::optional<nano::account_info>> result (accounts_a.size ());
+		std::vector<size_t> missing;
+		std::vector<nano::db_val<Val>> keys;
+		for (size_t i (0); i < accounts_a.size (); ++i)
+		{
+			nano::account_info info;
+			if (!cache_m.account_get (transaction_a, accounts_a[i], info))
+			{
+				result[i] = info;
+			}
+			else
+			{
+				missing.push_back (i);
+				keys.emplace_back (accounts_a[i]);
+			}
+		}
+		if (!missing.empty ())
+		{
+			std::vector<nano::db_val<Val>> values;
+			std::vector<int> statuses;
+			get_many (transaction_a, tables::accounts, keys, values, statuses);
+			for (size_t j (0); j < missing.size (); ++j)
+			{
+				release_assert (success (statuses[j]) || not_found (statuses[j]));
+				if (success (statuses[j]))
+				{
+					nano::account_info info;
+					nano::bufferstream stream (reinterpret_cast<uint8_t const *> (values[j].data ()), values[j].size ());
+					if (!info.deserialize (stream))
+					{
+						cache_m.account_put (transaction_a, accounts_a[missing[j]], info);
+						result[missing[j]] = info;
+					}
+				}
+			}
 		}
 		return result;
 	}
@@ -672,6 +866,7 @@ public:
 
 	void confirmation_height_put (nano::write_transaction const & transaction_a, nano::account const & account_a, uint64_t confirmation_height_a) override
 	{
+		cache_m.confirmation_height_modified (transaction_a, account_a);
 		nano::db_val<Val> confirmation_height (confirmation_height_a);
 		auto status = put (transaction_a, tables::confirmation_height, account_a, confirmation_height);
 		release_assert (success (status));
@@ -679,19 +874,26 @@ public:
 
 	bool confirmation_height_get (nano::transaction const & transaction_a, nano::account const & account_a, uint64_t & confirmation_height_a) override
 	{
-		nano::db_val<Val> value;
-		auto status = get (transaction_a, tables::confirmation_height, nano::db_val<Val> (account_a), value);
-		release_assert (success (status) || not_found (status));
-		confirmation_height_a = 0;
-		if (success (status))
+		bool result (cache_m.confirmation_height_get (transaction_a, account_a, confirmation_height_a));
+		if (result)
 		{
-			confirmation_height_a = static_cast<uint64_t> (value);
+			nano::db_val<Val> value;
+			auto status = get (transaction_a, tables::confirmation_height, nano::db_val<Val> (account_a), value);
+			release_assert (success (status) || not_found (status));
+			confirmation_height_a = 0;
+			result = !success (status);
+			if (!result)
+			{
+				confirmation_height_a = static_cast<uint64_t> (value);
+				cache_m.confirmation_height_put (transaction_a, account_a, confirmation_height_a);
+			}
 		}
-		return (!success (status));
+		return result;
 	}
 
 	void confirmation_height_del (nano::write_transaction const & transaction_a, nano::account const & account_a) override
 	{
+		cache_m.confirmation_height_modified (transaction_a, account_a);
 		auto status (del (transaction_a, tables::confirmation_height, nano::db_val<Val> (account_a)));
 		release_assert (success (status));
 	}
@@ -721,6 +923,22 @@ public:
 		return make_iterator<nano::pending_key, nano::pending_info> (transaction_a, tables::pending);
 	}
 
+	nano::store_iterator<nano::pending_key, nano::pending_info> pending_begin (nano::transaction const & transaction_a, nano::account const & account_a) override
+	{
+		return make_prefix_iterator<nano::pending_key, nano::pending_info> (transaction_a, tables::pending, nano::db_val<Val> (nano::pending_key (account_a, 0)));
+	}
+
+	nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const & transaction_a, nano::account const & account_a) override
+	{
+		// Largest amounts have the smallest complement
+		return pending_amounts_begin (transaction_a, nano::pending_amount_key (account_a, std::numeric_limits<nano::uint128_t>::max (), 0));
+	}
+
+	nano::store_iterator<nano::pending_amount_key, nano::no_value> pending_amounts_begin (nano::transaction const & transaction_a, nano::pending_amount_key const & key_a) override
+	{
+		return make_iterator<nano::pending_amount_key, nano::no_value> (transaction_a, tables::pending_amounts, nano::db_val<Val> (key_a));
+	}
+
 	nano::store_iterator<nano::unchecked_key, nano::unchecked_info> unchecked_begin (nano::transaction const & transaction_a) override
 	{
 		return make_iterator<nano::unchecked_key, nano::unchecked_info> (transaction_a, tables::unchecked);
@@ -763,21 +981,76 @@ public:
 
 protected:
 	nano::network_params network_params;
+	mutable nano::store_cache cache_m;
 	std::unordered_map<nano::account, std::shared_ptr<nano::vote>> vote_cache_l1;
 	std::unordered_map<nano::account, std::shared_ptr<nano::vote>> vote_cache_l2;
-	static int constexpr version{ 15 };
+	static int constexpr version{ 16 };
+	/** Block tables whose new values are compressed once a dictionary is available */
+	std::unordered_set<nano::tables> compressed_tables;
+	std::unique_ptr<nano::block_codec> codec_m;
+	/** Set once, block values may be read while a read replica loads the dictionary */
+	std::atomic<nano::block_codec const *> codec{ nullptr };
+
+	/** Adds the entry to the pending amounts index and to the summary of its account */
+	void pending_index_put (nano::write_transaction const & transaction_a, nano::pending_key const & key_a, nano::amount const & amount_a)
+	{
+		auto status (put (transaction_a, tables::pending_amounts, nano::pending_amount_key (key_a.account, amount_a, key_a.hash), nano::db_val<Val> ()));
+		release_assert (success (status));
+		nano::pending_summary summary;
+		pending_summary_get (transaction_a, key_a.account, summary);
+		++summary.count;
+		summary.total = summary.total.number () + amount_a.number ();
+		status = put (transaction_a, tables::pending_summary, key_a.account, summary);
+		release_assert (success (status));
+	}
+
+	void pending_index_del (nano::write_transaction const & transaction_a, nano::pending_key const & key_a, nano::amount const & amount_a)
+	{
+		auto status (del (transaction_a, tables::pending_amounts, nano::pending_amount_key (key_a.account, amount_a, key_a.hash)));
+		release_assert (success (status));
+		nano::pending_summary summary;
+		auto error (pending_summary_get (transaction_a, key_a.account, summary));
+		release_assert (!error && summary.count > 0);
+		--summary.count;
+		summary.total = summary.total.number () - amount_a.number ();
+		if (summary.count == 0)
+		{
+			status = del (transaction_a, tables::pending_summary, key_a.account);
+		}
+		else
+		{
+			status = put (transaction_a, tables::pending_summary, key_a.account, summary);
+		}
+		release_assert (success (status));
+	}
+
+	/** Builds the pending amounts index and the account summaries of existing pending entries */
+	void pending_index_rebuild (nano::write_transaction const & transaction_a)
+	{
+		auto status (drop (transaction_a, tables::pending_amounts));
+		release_assert (success (status));
+		status = drop (transaction_a, tables::pending_summary);
+		release_assert (success (status));
+		for (auto i (pending_begin (transaction_a)), n (pending_end ()); i != n; ++i)
+		{
+			nano::pending_key const & key (i->first);
+			nano::pending_info const & info (i->second);
+			pending_index_put (transaction_a, key, info.amount);
+		}
+	}
 
 	template <typename T>
 	std::shared_ptr<nano::block> block_random (nano::transaction const & transaction_a, tables table_a)
 	{
 		nano::block_hash hash;
 		nano::random_pool::generate_block (hash.bytes.data (), hash.bytes.size ());
-		auto existing = make_iterator<nano::block_hash, std::shared_ptr<T>> (transaction_a, table_a, nano::db_val<Val> (hash));
-		if (existing == nano::store_iterator<nano::block_hash, std::shared_ptr<T>> (nullptr))
+		// Values are not deserialized by the iterator as they may be compressed
+		auto existing = make_iterator<nano::block_hash, nano::no_value> (transaction_a, table_a, nano::db_val<Val> (hash));
+		if (existing == nano::store_iterator<nano::block_hash, nano::no_value> (nullptr))
 		{
-			existing = make_iterator<nano::block_hash, std::shared_ptr<T>> (transaction_a, table_a);
+			existing = make_iterator<nano::block_hash, nano::no_value> (transaction_a, table_a);
 		}
-		auto end (nano::store_iterator<nano::block_hash, std::shared_ptr<T>> (nullptr));
+		auto end (nano::store_iterator<nano::block_hash, nano::no_value> (nullptr));
 		assert (existing != end);
 		return block_get (transaction_a, nano::block_hash (existing->first));
 	}
@@ -794,6 +1067,12 @@ protected:
 		return static_cast<Derived_Store const &> (*this).template make_iterator<Key, Value> (transaction_a, table_a, key);
 	}
 
+	template <typename Key, typename Value>
+	nano::store_iterator<Key, Value> make_prefix_iterator (nano::transaction const & transaction_a, tables table_a, nano::db_val<Val> const & key) const
+	{
+		return static_cast<Derived_Store const &> (*this).template make_prefix_iterator<Key, Value> (transaction_a, table_a, key);
+	}
+
 	bool entry_has_sideband (size_t entry_size_a, nano::block_type type_a) const
 	{
 		return entry_size_a == nano::block::size (type_a) + nano::block_sideband::size (type_a);
@@ -932,7 +1211,7 @@ protected:
 		return result;
 	}
 
-	tables block_database (nano::block_type type_a)
+	tables block_database (nano::block_type type_a) const
 	{
 		tables result = tables::frontiers;
 		switch (type_a)
@@ -959,6 +1238,74 @@ protected:
 		return result;
 	}
 
+	/** Block type held by \p table_a, invalid for tables which do not hold blocks */
+	static nano::block_type block_table_type (tables table_a)
+	{
+		auto result (nano::block_type::invalid);
+		switch (table_a)
+		{
+			case tables::send_blocks:
+				result = nano::block_type::send;
+				break;
+			case tables::receive_blocks:
+				result = nano::block_type::receive;
+				break;
+			case tables::open_blocks:
+				result = nano::block_type::open;
+				break;
+			case tables::change_blocks:
+				result = nano::block_type::change;
+				break;
+			case tables::state_blocks:
+				result = nano::block_type::state;
+				break;
+			default:
+				break;
+		}
+		return result;
+	}
+
+	/** Uses \p dictionary_a to decode compressed block values, and to compress new values of the compressed tables */
+	void codec_set (std::vector<uint8_t> const & dictionary_a)
+	{
+		assert (codec == nullptr);
+		codec_m = std::make_unique<nano::block_codec> (dictionary_a);
+		codec = codec_m.get ();
+	}
+
+	/**
+	 * Raw block values are never shorter than their block, shorter values are compressed. Tables can hold both kinds of values,
+	 * which lets compression be enabled or disabled without rewriting existing entries
+	 */
+	void block_value_decode (tables table_a, nano::db_val<Val> & value_a) const
+	{
+		auto codec_l (codec.load ());
+		if (codec_l != nullptr)
+		{
+			auto type (block_table_type (table_a));
+			if (type != nano::block_type::invalid && value_a.size () < nano::block::size (type))
+			{
+				auto buffer (std::make_shared<std::vector<uint8_t>> ());
+				auto error (codec_l->decompress (static_cast<uint8_t const *> (value_a.data ()), value_a.size (), *buffer));
+				release_assert (!error);
+				value_a.buffer = buffer;
+				value_a.convert_buffer_to_value ();
+			}
+		}
+	}
+
+	/** Compresses a value written to a compressed table into \p result_a. Returns true if the value must be stored as is */
+	bool block_value_encode (tables table_a, uint8_t const * data_a, size_t size_a, std::vector<uint8_t> & result_a) const
+	{
+		auto result (true);
+		auto codec_l (codec.load ());
+		if (codec_l != nullptr && compressed_tables.count (table_a) > 0)
+		{
+			result = codec_l->compress (data_a, size_a, nano::block::size (block_table_type (table_a)), result_a);
+		}
+		return result;
+	}
+
 	size_t count (nano::transaction const & transaction_a, std::initializer_list<tables> dbs_a) const
 	{
 		size_t total_count = 0;
@@ -971,12 +1318,32 @@ protected:
 
 	int get (nano::transaction const & transaction_a, tables table_a, nano::db_val<Val> const & key_a, nano::db_val<Val> & value_a) const
 	{
-		return static_cast<Derived_Store const &> (*this).get (transaction_a, table_a, key_a, value_a);
+		auto status (static_cast<Derived_Store const &> (*this).get (transaction_a, table_a, key_a, value_a));
+		if (success (status))
+		{
+			block_value_decode (table_a, value_a);
+		}
+		return status;
+	}
+
+	/** Looks up every key of \p keys_a in \p table_a, values and status codes are in the same order */
+	void get_many (nano::transaction const & transaction_a, tables table_a, std::vector<nano::db_val<Val>> const & keys_a, std::vector<nano::db_val<Val>> & values_a, std::vector<int> & statuses_a) const
+	{
+		static_cast<Derived_Store const &> (*this).get_many (transaction_a, table_a, keys_a, values_a, statuses_a);
+		for (size_t i (0); i < values_a.size (); ++i)
+		{
+			if (success (statuses_a[i]))
+			{
+				block_value_decode (table_a, values_a[i]);
+			}
+		}
 	}
 
 	int put (nano::write_transaction const & transaction_a, tables table_a, nano::db_val<Val> const & key_a, nano::db_val<Val> const & value_a)
 	{
-		return static_cast<Derived_Store &> (*this).put (transaction_a, table_a, key_a, value_a);
+		std::vector<uint8_t> compressed;
+		auto raw (block_value_encode (table_a, static_cast<uint8_t const *> (value_a.data ()), value_a.size (), compressed));
+		return static_cast<Derived_Store &> (*this).put (transaction_a, table_a, key_a, raw ? value_a : nano::db_val<Val> (compressed.size (), compressed.data ()));
 	}
 
 	int del (nano::write_transaction const & transaction_a, tables table_a, nano::db_val<Val> const & key_a)
@@ -125,6 +125,8 @@ nano::node_constants::node_constants (nano::network_constants & network_constant
 	peer_interval = search_pending_interval;
 	unchecked_cleaning_interval = std::chrono::minutes (30);
 	process_confirmed_interval = network_constants.is_test_network () ? std::chrono::milliseconds (50) : std::chrono::milliseconds (500);
+	replica_refresh_interval = network_constants.is_test_network () ? std::chrono::milliseconds (50) : std::chrono::milliseconds (1000);
+	replica_reload_interval = network_constants.is_test_network () ? std::chrono::seconds (1) : std::chrono::seconds (5 * 60);
 	max_weight_samples = network_constants.is_live_network () ? 4032 : 864;
 	weight_period = 5 * 60; // 5 minutes
 }
@@ -324,6 +326,44 @@ nano::account const & nano::pending_key::key () const
 	return account;
 }
 
+nano::pending_amount_key::pending_amount_key (nano::account const & account_a, nano::amount const & amount_a, nano::block_hash const & hash_a) :
+account (account_a),
+amount_complement (~amount_a.number ()),
+hash (hash_a)
+{
+}
+
+nano::amount nano::pending_amount_key::amount () const
+{
+	return ~amount_complement.number ();
+}
+
+nano::pending_key nano::pending_amount_key::pending () const
+{
+	return nano::pending_key (account, hash);
+}
+
+bool nano::pending_amount_key::operator== (nano::pending_amount_key const & other_a) const
+{
+	return account == other_a.account && amount_complement == other_a.amount_complement && hash == other_a.hash;
+}
+
+nano::pending_summary::pending_summary (uint64_t count_a, nano::amount const & total_a) :
+count (count_a),
+total (total_a)
+{
+}
+
+size_t nano::pending_summary::db_size () const
+{
+	return sizeof (count) + sizeof (total);
+}
+
+bool nano::pending_summary::operator== (nano::pending_summary const & other_a) const
+{
+	return count == other_a.count && total == other_a.total;
+}
+
 nano::unchecked_info::unchecked_info (std::shared_ptr<nano::block> block_a, nano::account const & account_a, uint64_t modified_a, nano::signature_verification verified_a, bool confirmed_a) :
 block (block_a),
 account (account_a),
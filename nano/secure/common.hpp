@@ -126,6 +126,35 @@ public:
 	nano::block_hash hash{ 0 };
 };
 
+/**
+ * Key of the pending amounts index, the entries of an account are ordered by decreasing amount and then by block hash
+ */
+class pending_amount_key final
+{
+public:
+	pending_amount_key () = default;
+	pending_amount_key (nano::account const &, nano::amount const &, nano::block_hash const &);
+	nano::amount amount () const;
+	nano::pending_key pending () const;
+	bool operator== (nano::pending_amount_key const &) const;
+	nano::account account{ 0 };
+	/** Bitwise complement of the amount, as keys are compared bytewise */
+	nano::amount amount_complement{ 0 };
+	nano::block_hash hash{ 0 };
+};
+
+/** Number and total amount of the pending entries of an account */
+class pending_summary final
+{
+public:
+	pending_summary () = default;
+	pending_summary (uint64_t, nano::amount const &);
+	size_t db_size () const;
+	bool operator== (nano::pending_summary const &) const;
+	uint64_t count{ 0 };
+	nano::amount total{ 0 };
+};
+
 class endpoint_key final
 {
 public:
@@ -394,6 +423,10 @@ public:
 	std::chrono::seconds peer_interval;
 	std::chrono::minutes unchecked_cleaning_interval;
 	std::chrono::milliseconds process_confirmed_interval;
+	/** How often read replicas look for commits made by the node writing the ledger */
+	std::chrono::milliseconds replica_refresh_interval;
+	/** Minimum time between read replica reloads of the representative weights and cemented count, which visit every account */
+	std::chrono::seconds replica_reload_interval;
 
 	/** The maximum amount of samples for a 2 week period on live or 3 days on beta */
 	uint64_t max_weight_samples;
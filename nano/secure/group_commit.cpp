@@ -0,0 +1,118 @@
+#include <nano/lib/utility.hpp>
+#include <nano/secure/group_commit.hpp>
+
+namespace
+{
+class deferred_commit final
+{
+public:
+	unsigned depth{ 0 };
+	nano::group_commit * group{ nullptr };
+	uint64_t sequence{ 0 };
+};
+thread_local deferred_commit deferred;
+}
+
+nano::group_commit::group_commit (nano::durability_config const & config_a, std::function<void()> const & flush_a) :
+config (config_a),
+flush (flush_a),
+thread ([this]() {
+	nano::thread_role::set (nano::thread_role::name::store_flush);
+	run ();
+})
+{
+}
+
+nano::group_commit::~group_commit ()
+{
+	stop ();
+}
+
+void nano::group_commit::committed ()
+{
+	uint64_t sequence (0);
+	{
+		nano::lock_guard<std::mutex> lock (mutex);
+		sequence = ++commits;
+	}
+	if (config.mode == nano::durability_mode::group)
+	{
+		if (deferred.depth > 0)
+		{
+			if (deferred.group != nullptr && deferred.group != this)
+			{
+				deferred.group->wait (deferred.sequence);
+			}
+			deferred.group = this;
+			deferred.sequence = sequence;
+		}
+		else
+		{
+			wait (sequence);
+		}
+	}
+}
+
+void nano::group_commit::stop ()
+{
+	nano::unique_lock<std::mutex> lock (mutex);
+	if (!stopped)
+	{
+		stopped = true;
+		condition.notify_all ();
+		lock.unlock ();
+		thread.join ();
+		lock.lock ();
+		if (flushed < commits)
+		{
+			flush ();
+			flushed = commits;
+			++flushes;
+		}
+	}
+}
+
+void nano::group_commit::defer_begin ()
+{
+	++deferred.depth;
+}
+
+void nano::group_commit::defer_end ()
+{
+	assert (deferred.depth > 0);
+	if (--deferred.depth == 0 && deferred.group != nullptr)
+	{
+		auto group (deferred.group);
+		deferred.group = nullptr;
+		group->wait (deferred.sequence);
+	}
+}
+
+void nano::group_commit::run ()
+{
+	nano::unique_lock<std::mutex> lock (mutex);
+	while (!stopped)
+	{
+		condition.wait_for (lock, config.sync_interval, [this]() { return stopped || waiting > 0; });
+		if (!stopped && flushed < commits)
+		{
+			// Commits made during the flush are covered by the next one
+			auto target (commits);
+			lock.unlock ();
+			flush ();
+			lock.lock ();
+			flushed = target;
+			++flushes;
+			condition.notify_all ();
+		}
+	}
+}
+
+void nano::group_commit::wait (uint64_t sequence_a)
+{
+	nano::unique_lock<std::mutex> lock (mutex);
+	++waiting;
+	condition.notify_all ();
+	condition.wait (lock, [this, sequence_a]() { return stopped || !(flushed < sequence_a); });
+	--waiting;
+}
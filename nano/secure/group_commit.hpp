@@ -0,0 +1,48 @@
+#pragma once
+
+#include <nano/lib/durabilityconfig.hpp>
+#include <nano/lib/locks.hpp>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace nano
+{
+/**
+ * Flushes a store which does not sync on commit from a background thread, so that concurrent commits share a single flush.
+ * In group mode committers wait until a flush started after their commit is done, commits made while a flush is running are all
+ * covered by the next one. In async mode committers never wait and the store is flushed every sync_interval, which bounds the
+ * commits lost on a system crash.
+ * A thread holding a write_database_queue guard only waits for its commits once the guard is released, so queued writers do not
+ * hold the queue while their commits are flushed
+ */
+class group_commit final
+{
+public:
+	group_commit (nano::durability_config const &, std::function<void()> const & flush_a);
+	~group_commit ();
+	/** Called after every commit, blocks until the commit is flushed in group mode */
+	void committed ();
+	/** Flushes outstanding commits and stops the background thread */
+	void stop ();
+	/** Defers waiting for commits made by the calling thread until the matching defer_end */
+	static void defer_begin ();
+	static void defer_end ();
+	std::atomic<uint64_t> flushes{ 0 };
+
+private:
+	void run ();
+	void wait (uint64_t sequence_a);
+	nano::durability_config const config;
+	std::function<void()> flush;
+	std::mutex mutex;
+	nano::condition_variable condition;
+	uint64_t commits{ 0 };
+	uint64_t flushed{ 0 };
+	unsigned waiting{ 0 };
+	bool stopped{ false };
+	std::thread thread;
+};
+}
@@ -693,11 +693,15 @@ check_bootstrap_weights (true)
 		auto transaction = store.tx_begin_read ();
 		if (cache_reps_a)
 		{
+			auto now (nano::seconds_since_epoch ());
 			for (auto i (store.latest_begin (transaction)), n (store.latest_end ()); i != n; ++i)
 			{
 				nano::account_info const & info (i->second);
 				rep_weights.representation_add (info.representative, info.balance.number ());
+				age_index.update (i->first, info.modified);
 			}
+			// Every account was visited, the index is complete for its whole window
+			age_index.complete (now - std::min (now, age_index.window));
 		}
 
 		if (cache_cemented_count_a)
@@ -713,6 +717,24 @@ check_bootstrap_weights (true)
 	}
 }
 
+void nano::ledger::cache_reload (nano::transaction const & transaction_a)
+{
+	std::unordered_map<nano::account, nano::uint128_t> rep_amounts;
+	for (auto i (store.latest_begin (transaction_a)), n (store.latest_end ()); i != n; ++i)
+	{
+		nano::account_info const & info (i->second);
+		rep_amounts[info.representative] += info.balance.number ();
+	}
+	rep_weights.replace (std::move (rep_amounts));
+	uint64_t cemented_count_l (0);
+	for (auto i (store.confirmation_height_begin (transaction_a)), n (store.confirmation_height_end ()); i != n; ++i)
+	{
+		cemented_count_l += i->second;
+	}
+	cemented_count = cemented_count_l;
+	block_count_cache = store.block_count (transaction_a).sum ();
+}
+
 // Balance for account containing hash
 nano::uint128_t nano::ledger::balance (nano::transaction const & transaction_a, nano::block_hash const & hash_a) const
 {
@@ -735,11 +757,10 @@ nano::uint128_t nano::ledger::account_balance (nano::transaction const & transac
 nano::uint128_t nano::ledger::account_pending (nano::transaction const & transaction_a, nano::account const & account_a)
 {
 	nano::uint128_t result (0);
-	nano::account end (account_a.number () + 1);
-	for (auto i (store.pending_begin (transaction_a, nano::pending_key (account_a, 0))), n (store.pending_begin (transaction_a, nano::pending_key (end, 0))); i != n; ++i)
+	nano::pending_summary summary;
+	if (!store.pending_summary_get (transaction_a, account_a, summary))
 	{
-		nano::pending_info const & info (i->second);
-		result += info.amount.number ();
+		result = summary.total.number ();
 	}
 	return result;
 }
@@ -1046,11 +1067,13 @@ void nano::ledger::change_latest (nano::write_transaction const & transaction_a,
 			store.account_del (transaction_a, account_a);
 		}
 		store.account_put (transaction_a, account_a, new_a);
+		age_index.update (account_a, new_a.modified);
 	}
 	else
 	{
 		store.confirmation_height_del (transaction_a, account_a);
 		store.account_del (transaction_a, account_a);
+		age_index.erase (account_a);
 	}
 }
 
@@ -1140,6 +1163,7 @@ std::unique_ptr<seq_con_info_component> collect_seq_con_info (ledger & ledger, c
 	auto sizeof_element = sizeof (decltype (ledger.bootstrap_weights)::value_type);
 	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "bootstrap_weights", count, sizeof_element }));
 	composite->add_component (collect_seq_con_info (ledger.rep_weights, "rep_weights"));
+	composite->add_component (collect_seq_con_info (ledger.age_index, "age_index"));
 	return composite;
 }
 }
@@ -2,6 +2,7 @@
 
 #include <nano/lib/config.hpp>
 #include <nano/lib/rep_weights.hpp>
+#include <nano/secure/account_age_index.hpp>
 #include <nano/secure/common.hpp>
 
 namespace nano
@@ -45,12 +46,16 @@ public:
 	bool is_epoch_link (nano::link const &);
 	nano::account const & epoch_signer (nano::link const &) const;
 	nano::link const & epoch_link (nano::epoch) const;
+	/** Recomputes the representative weights, cemented count and block count from the store, used by read replicas which do not see the ledger writes */
+	void cache_reload (nano::transaction const &);
 	static nano::uint128_t const unit;
 	nano::network_params network_params;
 	nano::block_store & store;
 	std::atomic<uint64_t> cemented_count{ 0 };
 	std::atomic<uint64_t> block_count_cache{ 0 };
 	nano::rep_weights rep_weights;
+	/** Accounts modified within the last day, ordered by modification time */
+	nano::account_age_index age_index{ 24 * 60 * 60 };
 	nano::stat & stats;
 	std::unordered_map<nano::account, nano::uint128_t> bootstrap_weights;
 	std::atomic<size_t> bootstrap_weights_size{ 0 };
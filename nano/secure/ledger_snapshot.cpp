@@ -0,0 +1,287 @@
+#include <nano/crypto/blake2/blake2.h>
+#include <nano/secure/ledger_snapshot.hpp>
+
+#include <boost/endian/conversion.hpp>
+#include <boost/format.hpp>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+std::vector<nano::tables> const nano::ledger_snapshot::tables{ nano::tables::accounts, nano::tables::change_blocks, nano::tables::confirmation_height, nano::tables::frontiers, nano::tables::open_blocks, nano::tables::pending, nano::tables::pending_amounts, nano::tables::pending_summary, nano::tables::receive_blocks, nano::tables::send_blocks, nano::tables::state_blocks };
+std::array<char, 8> const nano::ledger_snapshot::magic{ { 'n', 'a', 'n', 'o', 's', 'n', 'a', 'p' } };
+uint8_t constexpr nano::ledger_snapshot::format_version;
+size_t constexpr nano::ledger_snapshot::chunk_entries;
+uint8_t constexpr nano::ledger_snapshot::trailer_tag;
+uint32_t constexpr nano::ledger_snapshot::max_chunk_size;
+
+namespace
+{
+template <typename T>
+void write_int (std::vector<uint8_t> & buffer_a, T value_a)
+{
+	auto value_l (boost::endian::native_to_little (value_a));
+	auto bytes (reinterpret_cast<uint8_t const *> (&value_l));
+	buffer_a.insert (buffer_a.end (), bytes, bytes + sizeof (value_l));
+}
+
+template <typename T>
+bool read_int (std::istream & stream_a, T & value_a)
+{
+	stream_a.read (reinterpret_cast<char *> (&value_a), sizeof (value_a));
+	boost::endian::little_to_native_inplace (value_a);
+	return !stream_a;
+}
+
+template <typename T>
+T get_int (uint8_t const * data_a)
+{
+	T result;
+	std::memcpy (&result, data_a, sizeof (result));
+	return boost::endian::little_to_native (result);
+}
+
+using checksum = std::array<uint8_t, 8>;
+
+checksum chunk_checksum (std::vector<uint8_t> const & header_a, std::vector<uint8_t> const & payload_a)
+{
+	checksum result;
+	blake2b_state state;
+	blake2b_init (&state, result.size ());
+	blake2b_update (&state, header_a.data (), header_a.size ());
+	blake2b_update (&state, payload_a.data (), payload_a.size ());
+	blake2b_final (&state, result.data (), result.size ());
+	return result;
+}
+
+/** Chunk layout: table tag, entry count, payload size, payload, checksum of everything before it */
+void write_chunk (std::ostream & stream_a, uint8_t tag_a, uint32_t count_a, std::vector<uint8_t> const & payload_a)
+{
+	std::vector<uint8_t> header;
+	header.push_back (tag_a);
+	write_int (header, count_a);
+	write_int (header, static_cast<uint32_t> (payload_a.size ()));
+	auto checksum_l (chunk_checksum (header, payload_a));
+	stream_a.write (reinterpret_cast<char const *> (header.data ()), header.size ());
+	stream_a.write (reinterpret_cast<char const *> (payload_a.data ()), payload_a.size ());
+	stream_a.write (reinterpret_cast<char const *> (checksum_l.data ()), checksum_l.size ());
+}
+}
+
+bool nano::ledger_snapshot::write (nano::block_store & store_a, std::ostream & stream_a)
+{
+	auto transaction (store_a.tx_begin_read ());
+	std::vector<uint8_t> header (magic.begin (), magic.end ());
+	header.push_back (format_version);
+	write_int (header, static_cast<uint32_t> (store_a.version_get (transaction)));
+	stream_a.write (reinterpret_cast<char const *> (header.data ()), header.size ());
+	std::vector<uint8_t> trailer;
+	for (uint8_t tag (0); tag < tables.size () && stream_a; ++tag)
+	{
+		uint64_t total (0);
+		uint32_t count (0);
+		std::vector<uint8_t> payload;
+		store_a.raw_for_each (transaction, tables[tag], [&](uint8_t const * key_a, size_t key_size_a, uint8_t const * value_a, size_t value_size_a) {
+			write_int (payload, static_cast<uint16_t> (key_size_a));
+			write_int (payload, static_cast<uint32_t> (value_size_a));
+			payload.insert (payload.end (), key_a, key_a + key_size_a);
+			payload.insert (payload.end (), value_a, value_a + value_size_a);
+			++total;
+			if (++count == chunk_entries)
+			{
+				write_chunk (stream_a, tag, count, payload);
+				payload.clear ();
+				count = 0;
+			}
+		});
+		if (count != 0)
+		{
+			write_chunk (stream_a, tag, count, payload);
+		}
+		write_int (trailer, total);
+	}
+	write_chunk (stream_a, trailer_tag, static_cast<uint32_t> (tables.size ()), trailer);
+	stream_a.flush ();
+	return !stream_a;
+}
+
+bool nano::ledger_snapshot::read (nano::block_store & store_a, std::istream & stream_a, std::string & error_a)
+{
+	auto start (stream_a.tellg ());
+	auto error (start == std::istream::pos_type (-1));
+	if (error)
+	{
+		error_a = "Snapshot stream is not seekable";
+	}
+	// The whole image is checked before the ledger tables are cleared, a truncated or corrupted image leaves the ledger untouched
+	if (!error)
+	{
+		error = read_image (store_a, stream_a, nullptr, error_a);
+	}
+	if (!error)
+	{
+		stream_a.clear ();
+		stream_a.seekg (start);
+		auto tables_l (tables);
+		tables_l.push_back (nano::tables::cached_counts);
+		auto transaction (store_a.tx_begin_write (tables_l));
+		for (auto table : tables)
+		{
+			store_a.raw_clear (transaction, table);
+		}
+		error = read_image (store_a, stream_a, &transaction, error_a);
+	}
+	if (!error)
+	{
+		error = verify (store_a, error_a);
+	}
+	return error;
+}
+
+bool nano::ledger_snapshot::read_image (nano::block_store & store_a, std::istream & stream_a, nano::write_transaction * transaction_a, std::string & error_a)
+{
+	std::array<char, 8> magic_l;
+	uint8_t format_version_l (0);
+	uint32_t store_version (0);
+	stream_a.read (magic_l.data (), magic_l.size ());
+	auto error (!stream_a || magic_l != magic || read_int (stream_a, format_version_l) || format_version_l != format_version || read_int (stream_a, store_version));
+	if (error)
+	{
+		error_a = "Not a ledger snapshot or unsupported format version";
+	}
+	else
+	{
+		auto version (transaction_a != nullptr ? store_a.version_get (*transaction_a) : store_a.version_get (store_a.tx_begin_read ()));
+		if (store_version != static_cast<uint32_t> (version))
+		{
+			error = true;
+			error_a = boost::str (boost::format ("Snapshot store version %1% does not match the database version %2%") % store_version % version);
+		}
+	}
+	std::vector<uint64_t> totals (tables.size (), 0);
+	uint8_t last_tag (0);
+	auto finished (false);
+	while (!error && !finished)
+	{
+		std::vector<uint8_t> header (1 + sizeof (uint32_t) * 2);
+		stream_a.read (reinterpret_cast<char *> (header.data ()), header.size ());
+		uint8_t tag (header[0]);
+		auto count (get_int<uint32_t> (header.data () + 1));
+		auto payload_size (get_int<uint32_t> (header.data () + 1 + sizeof (uint32_t)));
+		std::vector<uint8_t> payload;
+		checksum checksum_l;
+		if (stream_a && payload_size <= max_chunk_size)
+		{
+			payload.resize (payload_size);
+			stream_a.read (reinterpret_cast<char *> (payload.data ()), payload.size ());
+			stream_a.read (reinterpret_cast<char *> (checksum_l.data ()), checksum_l.size ());
+		}
+		if (!stream_a || payload.size () != payload_size || checksum_l != chunk_checksum (header, payload))
+		{
+			error = true;
+			error_a = "Snapshot is truncated or corrupted";
+		}
+		else if (tag == trailer_tag)
+		{
+			finished = true;
+			error = count != tables.size () || payload.size () != tables.size () * sizeof (uint64_t);
+			for (size_t i (0); !error && i < tables.size (); ++i)
+			{
+				error = get_int<uint64_t> (payload.data () + i * sizeof (uint64_t)) != totals[i];
+			}
+			if (error)
+			{
+				error_a = "Snapshot entry counts do not match its trailer";
+			}
+		}
+		// Tables are written in order, a table can only continue in the next chunk
+		else if (tag >= tables.size () || tag < last_tag)
+		{
+			error = true;
+			error_a = "Snapshot tables are out of order";
+		}
+		else
+		{
+			last_tag = tag;
+			size_t offset (0);
+			for (uint32_t i (0); !error && i < count; ++i)
+			{
+				auto entry_header (sizeof (uint16_t) + sizeof (uint32_t));
+				error = offset + entry_header > payload.size ();
+				if (!error)
+				{
+					auto key_size (get_int<uint16_t> (payload.data () + offset));
+					auto value_size (get_int<uint32_t> (payload.data () + offset + sizeof (uint16_t)));
+					offset += entry_header;
+					error = offset + key_size + value_size > payload.size ();
+					if (!error && transaction_a != nullptr)
+					{
+						error = store_a.raw_put (*transaction_a, tables[tag], payload.data () + offset, key_size, payload.data () + offset + key_size, value_size, true);
+					}
+					offset += key_size + value_size;
+				}
+			}
+			error = error || offset != payload.size ();
+			if (error)
+			{
+				error_a = "Invalid snapshot entries";
+			}
+			else
+			{
+				totals[tag] += count;
+			}
+			if (transaction_a != nullptr && !error)
+			{
+				// Keep write transactions bounded
+				transaction_a->commit ();
+				transaction_a->renew ();
+			}
+		}
+	}
+	return error;
+}
+
+bool nano::ledger_snapshot::verify (nano::block_store & store_a, std::string & error_a)
+{
+	bool error (false);
+	auto transaction (store_a.tx_begin_read ());
+	uint64_t account_blocks (0);
+	for (auto i (store_a.latest_begin (transaction)), n (store_a.latest_end ()); i != n && !error; ++i)
+	{
+		nano::account const & account (i->first);
+		nano::account_info const & info (i->second);
+		uint64_t confirmation_height (0);
+		error = !store_a.block_exists (transaction, info.head) || !store_a.block_exists (transaction, info.open_block) || store_a.confirmation_height_get (transaction, account, confirmation_height) || confirmation_height > info.block_count;
+		if (error)
+		{
+			error_a = boost::str (boost::format ("Account %1% does not match the imported blocks") % account.to_account ());
+		}
+		account_blocks += info.block_count;
+	}
+	// Legacy frontiers must be the head of their account
+	store_a.raw_for_each (transaction, nano::tables::frontiers, [&](uint8_t const * key_a, size_t key_size_a, uint8_t const * value_a, size_t value_size_a) {
+		if (!error)
+		{
+			nano::block_hash hash (0);
+			nano::account account (0);
+			nano::account_info info;
+			error = key_size_a != sizeof (hash) || value_size_a != sizeof (account);
+			if (!error)
+			{
+				std::memcpy (hash.bytes.data (), key_a, sizeof (hash));
+				std::memcpy (account.bytes.data (), value_a, sizeof (account));
+				error = store_a.account_get (transaction, account, info) || info.head != hash;
+			}
+			if (error)
+			{
+				error_a = boost::str (boost::format ("Frontier %1% does not match its account") % hash.to_string ());
+			}
+		}
+	});
+	if (!error && account_blocks != store_a.block_count (transaction).sum ())
+	{
+		error = true;
+		error_a = "Block count does not match the account chains";
+	}
+	return error;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <nano/secure/blockstore.hpp>
+
+#include <array>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Streaming image of the ledger tables, used to bring up a node without bootstrapping.
+ * The image starts with a header holding the store version, followed by the tables in a fixed order.
+ * Every table is written in key order as chunks of raw entries, each chunk carries a blake2b checksum.
+ * A trailer holds the entry count of every table.
+ * Entries are loaded with append-mode inserts. The loaded accounts are then checked against the imported blocks, confirmation
+ * heights and frontiers
+ */
+class ledger_snapshot final
+{
+public:
+	/** Writes the ledger tables of \p store_a as seen by a single read transaction. Returns true on error */
+	static bool write (nano::block_store & store_a, std::ostream & stream_a);
+	/**
+	 * Replaces the ledger tables of \p store_a with the image read from \p stream_a, which must be seekable. The store must be at the same
+	 * version as the image. The image is fully checked before the ledger tables are cleared, so a truncated or corrupted image leaves them
+	 * untouched. Returns true on error and describes it in \p error_a. The ledger tables are only left in an undefined state if the store
+	 * fails while they are written, or if the imported accounts do not match their blocks
+	 */
+	static bool read (nano::block_store & store_a, std::istream & stream_a, std::string & error_a);
+	/** Ledger tables included in the image, in the order they are written */
+	static std::vector<nano::tables> const tables;
+	static std::array<char, 8> const magic;
+	static uint8_t constexpr format_version{ 1 };
+	static size_t constexpr chunk_entries{ 64 * 1024 };
+	static uint8_t constexpr trailer_tag{ 0xff };
+	/** Upper bound of a chunk payload, larger sizes are rejected as corrupted */
+	static uint32_t constexpr max_chunk_size{ 256 * 1024 * 1024 };
+
+private:
+	/** Reads and checks the image, its entries are stored when \p transaction_a is set. Returns true on error */
+	static bool read_image (nano::block_store & store_a, std::istream & stream_a, nano::write_transaction * transaction_a, std::string & error_a);
+	static bool verify (nano::block_store & store_a, std::string & error_a);
+};
+}
@@ -0,0 +1,65 @@
+#include <nano/crypto/blake2/blake2.h>
+#include <nano/crypto_lib/random_pool.hpp>
+#include <nano/lib/locks.hpp>
+#include <nano/secure/network_filter.hpp>
+
+nano::network_filter::network_filter (size_t size_a) :
+items (size_a, nano::uint128_t{ 0 })
+{
+	assert (size_a > 0);
+	nano::random_pool::generate_block (key.bytes.data (), key.bytes.size ());
+}
+
+bool nano::network_filter::apply (uint8_t const * bytes_a, size_t count_a, nano::uint128_t * digest_a)
+{
+	// Get hash before locking
+	auto digest (hash (bytes_a, count_a));
+
+	nano::lock_guard<std::mutex> lock (mutex);
+	auto & element (get_element (digest));
+	bool existed (element == digest);
+	if (!existed)
+	{
+		// Replace likely old element with a new one
+		element = digest;
+	}
+	if (digest_a)
+	{
+		*digest_a = digest;
+	}
+	return existed;
+}
+
+void nano::network_filter::clear (nano::uint128_t const & digest_a)
+{
+	nano::lock_guard<std::mutex> lock (mutex);
+	auto & element (get_element (digest_a));
+	if (element == digest_a)
+	{
+		element = nano::uint128_t{ 0 };
+	}
+}
+
+void nano::network_filter::clear ()
+{
+	nano::lock_guard<std::mutex> lock (mutex);
+	items.assign (items.size (), nano::uint128_t{ 0 });
+}
+
+nano::uint128_t & nano::network_filter::get_element (nano::uint128_t const & digest_a)
+{
+	assert (!mutex.try_lock ());
+	assert (items.size () > 0);
+	size_t index (digest_a % items.size ());
+	return items[index];
+}
+
+nano::uint128_t nano::network_filter::hash (uint8_t const * bytes_a, size_t count_a) const
+{
+	nano::uint128_union digest;
+	blake2b_state state;
+	blake2b_init_key (&state, sizeof (digest.bytes), key.bytes.data (), key.bytes.size ());
+	blake2b_update (&state, bytes_a, count_a);
+	blake2b_final (&state, digest.bytes.data (), sizeof (digest.bytes));
+	return digest.number ();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+
+#include <mutex>
+
+namespace nano
+{
+/**
+ * A probabilistic duplicate filter based on directed map caches, using a keyed blake2b 128-bit digest.
+ * Digests are stored in a fixed-size array, indexed by the digest itself. Inserting a digest into an occupied
+ * slot replaces the previous one, so old entries are continuously rotated out of the filter as new ones arrive.
+ * False positives only happen on a full 128-bit collision, false negatives happen when an entry was evicted.
+ * The random key makes the slot positions unpredictable to peers.
+ * All public methods are thread-safe
+ */
+class network_filter final
+{
+public:
+	network_filter () = delete;
+	explicit network_filter (size_t size_a);
+	/**
+	 * Reads \p count_a bytes starting from \p bytes_a and inserts the resulting digest in the filter.
+	 * @param \p digest_a if given, will be set to the resulting digest
+	 * @return a boolean representing the previous existence of the digest in the filter
+	 */
+	bool apply (uint8_t const * bytes_a, size_t count_a, nano::uint128_t * digest_a = nullptr);
+	/** Sets the corresponding element in the filter to zero, if it matches \p digest_a exactly */
+	void clear (nano::uint128_t const & digest_a);
+	/** Sets every element in the filter to zero, keeping its size and capacity */
+	void clear ();
+	/** Reads \p count_a bytes starting from \p bytes_a and digests the contents */
+	nano::uint128_t hash (uint8_t const * bytes_a, size_t count_a) const;
+
+private:
+	/** Get element from digest */
+	nano::uint128_t & get_element (nano::uint128_t const & digest_a);
+	std::vector<nano::uint128_t> items;
+	nano::uint128_union key;
+	std::mutex mutex;
+};
+}
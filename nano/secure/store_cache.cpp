@@ -0,0 +1,271 @@
+#include <nano/lib/locks.hpp>
+#include <nano/secure/store_cache.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+size_t constexpr nano::store_cache::default_capacity;
+size_t constexpr nano::store_cache::shard_count;
+
+template <typename Key, typename Value>
+nano::store_cache::table<Key, Value>::table (size_t capacity_a) :
+shard_capacity (std::max<size_t> (capacity_a / shard_count, 1))
+{
+}
+
+template <typename Key, typename Value>
+typename nano::store_cache::table<Key, Value>::shard & nano::store_cache::table<Key, Value>::shard_get (Key const & key_a)
+{
+	return shards[key_a.bytes[0] % shard_count];
+}
+
+nano::store_cache::store_cache (size_t capacity_a) :
+blocks (capacity_a),
+accounts (capacity_a),
+confirmation_heights (capacity_a)
+{
+}
+
+bool nano::store_cache::block_get (nano::transaction const & transaction_a, nano::block_hash const & hash_a, std::shared_ptr<nano::block> & block_a, nano::block_sideband * sideband_a)
+{
+	cached_block cached;
+	auto result (get (blocks, transaction_a, hash_a, cached));
+	if (!result)
+	{
+		block_a = cached.block;
+		if (sideband_a != nullptr)
+		{
+			*sideband_a = cached.sideband;
+		}
+	}
+	return result;
+}
+
+void nano::store_cache::block_put (nano::transaction const & transaction_a, nano::block_hash const & hash_a, std::shared_ptr<nano::block> const & block_a, nano::block_sideband const & sideband_a)
+{
+	put (blocks, transaction_a, hash_a, cached_block{ block_a, sideband_a });
+}
+
+bool nano::store_cache::account_get (nano::transaction const & transaction_a, nano::account const & account_a, nano::account_info & info_a)
+{
+	return get (accounts, transaction_a, account_a, info_a);
+}
+
+void nano::store_cache::account_put (nano::transaction const & transaction_a, nano::account const & account_a, nano::account_info const & info_a)
+{
+	put (accounts, transaction_a, account_a, info_a);
+}
+
+bool nano::store_cache::confirmation_height_get (nano::transaction const & transaction_a, nano::account const & account_a, uint64_t & confirmation_height_a)
+{
+	return get (confirmation_heights, transaction_a, account_a, confirmation_height_a);
+}
+
+void nano::store_cache::confirmation_height_put (nano::transaction const & transaction_a, nano::account const & account_a, uint64_t confirmation_height_a)
+{
+	put (confirmation_heights, transaction_a, account_a, confirmation_height_a);
+}
+
+void nano::store_cache::block_modified (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a)
+{
+	nano::lock_guard<std::mutex> lock (pending_mutex);
+	changes_get (transaction_a).blocks.push_back (hash_a);
+}
+
+void nano::store_cache::account_modified (nano::write_transaction const & transaction_a, nano::account const & account_a)
+{
+	nano::lock_guard<std::mutex> lock (pending_mutex);
+	changes_get (transaction_a).accounts.push_back (account_a);
+}
+
+void nano::store_cache::confirmation_height_modified (nano::write_transaction const & transaction_a, nano::account const & account_a)
+{
+	nano::lock_guard<std::mutex> lock (pending_mutex);
+	changes_get (transaction_a).confirmation_heights.push_back (account_a);
+}
+
+void nano::store_cache::all_modified (nano::write_transaction const & transaction_a)
+{
+	nano::lock_guard<std::mutex> lock (pending_mutex);
+	auto & changes_l (changes_get (transaction_a));
+	changes_l.all = true;
+	changes_l.blocks.clear ();
+	changes_l.accounts.clear ();
+	changes_l.confirmation_heights.clear ();
+}
+
+bool nano::store_cache::commit_begin (nano::write_transaction const & transaction_a)
+{
+	changes changes_l;
+	auto result (false);
+	{
+		nano::lock_guard<std::mutex> lock (pending_mutex);
+		auto existing (pending.find (transaction_a.get_handle ()));
+		if (existing != pending.end ())
+		{
+			changes_l = std::move (existing->second);
+			pending.erase (existing);
+			result = true;
+		}
+	}
+	if (result)
+	{
+		// Blocks insertions until commit_end, readers may still have snapshots without this commit
+		++committing;
+		if (changes_l.all)
+		{
+			clear ();
+		}
+		for (auto const & hash : changes_l.blocks)
+		{
+			erase (blocks, hash);
+		}
+		for (auto const & account : changes_l.accounts)
+		{
+			erase (accounts, account);
+		}
+		for (auto const & account : changes_l.confirmation_heights)
+		{
+			erase (confirmation_heights, account);
+		}
+	}
+	return result;
+}
+
+void nano::store_cache::commit_end ()
+{
+	++generation;
+	--committing;
+}
+
+void nano::store_cache::clear ()
+{
+	clear (blocks);
+	clear (accounts);
+	clear (confirmation_heights);
+}
+
+void nano::store_cache::serialize_json (boost::property_tree::ptree & json_a)
+{
+	auto serialize_table ([&json_a](std::string const & name_a, size_t entries_a, uint64_t hits_a, uint64_t misses_a) {
+		boost::property_tree::ptree table_l;
+		table_l.put ("entries", entries_a);
+		table_l.put ("hits", hits_a);
+		table_l.put ("misses", misses_a);
+		json_a.add_child (name_a, table_l);
+	});
+	serialize_table ("blocks", size (blocks), blocks.hits, blocks.misses);
+	serialize_table ("accounts", size (accounts), accounts.hits, accounts.misses);
+	serialize_table ("confirmation_heights", size (confirmation_heights), confirmation_heights.hits, confirmation_heights.misses);
+}
+
+template <typename Key, typename Value>
+bool nano::store_cache::get (table<Key, Value> & table_a, nano::transaction const & transaction_a, Key const & key_a, Value & value_a)
+{
+	auto result (true);
+	auto generation_l (transaction_a.cache_generation ());
+	if (generation_l != 0)
+	{
+		auto & shard (table_a.shard_get (key_a));
+		{
+			nano::lock_guard<std::mutex> lock (shard.mutex);
+			auto existing (shard.l1.find (key_a));
+			if (existing == shard.l1.end ())
+			{
+				auto existing_l2 (shard.l2.find (key_a));
+				if (existing_l2 != shard.l2.end ())
+				{
+					// Keep hot entries in the newest generation
+					existing = shard.l1.insert (*existing_l2).first;
+				}
+			}
+			// Entries read after the transaction started may be newer than its snapshot
+			if (existing != shard.l1.end () && !(generation_l < existing->second.generation))
+			{
+				value_a = existing->second.value;
+				result = false;
+			}
+			if (shard.l1.size () > table_a.shard_capacity)
+			{
+				shard.l2.swap (shard.l1);
+				shard.l1.clear ();
+			}
+		}
+		if (result)
+		{
+			++table_a.misses;
+		}
+		else
+		{
+			++table_a.hits;
+		}
+	}
+	return result;
+}
+
+template <typename Key, typename Value>
+void nano::store_cache::put (table<Key, Value> & table_a, nano::transaction const & transaction_a, Key const & key_a, Value const & value_a)
+{
+	auto generation_l (transaction_a.cache_generation ());
+	if (generation_l != 0)
+	{
+		auto & shard (table_a.shard_get (key_a));
+		nano::lock_guard<std::mutex> lock (shard.mutex);
+		// Values read from a snapshot without the latest commit may be stale
+		if (committing == 0 && generation == generation_l)
+		{
+			shard.l1[key_a] = { value_a, generation_l };
+			if (shard.l1.size () > table_a.shard_capacity)
+			{
+				shard.l2.swap (shard.l1);
+				shard.l1.clear ();
+			}
+		}
+	}
+}
+
+template <typename Key, typename Value>
+void nano::store_cache::erase (table<Key, Value> & table_a, Key const & key_a)
+{
+	auto & shard (table_a.shard_get (key_a));
+	nano::lock_guard<std::mutex> lock (shard.mutex);
+	shard.l1.erase (key_a);
+	shard.l2.erase (key_a);
+}
+
+template <typename Key, typename Value>
+void nano::store_cache::clear (table<Key, Value> & table_a)
+{
+	for (auto & shard : table_a.shards)
+	{
+		nano::lock_guard<std::mutex> lock (shard.mutex);
+		shard.l1.clear ();
+		shard.l2.clear ();
+	}
+}
+
+template <typename Key, typename Value>
+size_t nano::store_cache::size (table<Key, Value> & table_a)
+{
+	size_t result (0);
+	for (auto & shard : table_a.shards)
+	{
+		nano::lock_guard<std::mutex> lock (shard.mutex);
+		result += shard.l1.size () + shard.l2.size ();
+	}
+	return result;
+}
+
+nano::store_cache::changes & nano::store_cache::changes_get (nano::write_transaction const & transaction_a)
+{
+	assert (!pending_mutex.try_lock ());
+	return pending[transaction_a.get_handle ()];
+}
+
+std::unique_ptr<nano::seq_con_info_component> nano::collect_seq_con_info (nano::store_cache & cache, const std::string & name)
+{
+	auto composite = std::make_unique<seq_con_info_composite> (name);
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "blocks", cache.size (cache.blocks), sizeof (decltype (cache.blocks.shards[0].l1)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "accounts", cache.size (cache.accounts), sizeof (decltype (cache.accounts.shards[0].l1)::value_type) }));
+	composite->add_component (std::make_unique<seq_con_info_leaf> (seq_con_info{ "confirmation_heights", cache.size (cache.confirmation_heights), sizeof (decltype (cache.confirmation_heights.shards[0].l1)::value_type) }));
+	return composite;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <nano/lib/numbers.hpp>
+#include <nano/lib/utility.hpp>
+#include <nano/secure/blockstore.hpp>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nano
+{
+/**
+ * Size-bounded cache of hot store objects: blocks with their sideband, account information and confirmation heights.
+ * Objects are split in shards by key, each shard keeps two generations of entries which are swapped when the newest one is full.
+ *
+ * Entries are tagged with the commit generation they were read at and are only returned to read transactions whose snapshot
+ * includes that generation, write transactions always read the store. Objects modified by a write transaction are dropped
+ * when it commits, and no entry is inserted while a commit is in progress or from a snapshot older than the last commit.
+ * All public methods are thread-safe
+ */
+class store_cache final
+{
+public:
+	explicit store_cache (size_t capacity_a = default_capacity);
+	/** Returns true if \p hash_a is not cached for \p transaction_a */
+	bool block_get (nano::transaction const & transaction_a, nano::block_hash const & hash_a, std::shared_ptr<nano::block> & block_a, nano::block_sideband * sideband_a);
+	void block_put (nano::transaction const & transaction_a, nano::block_hash const & hash_a, std::shared_ptr<nano::block> const & block_a, nano::block_sideband const & sideband_a);
+	bool account_get (nano::transaction const & transaction_a, nano::account const & account_a, nano::account_info & info_a);
+	void account_put (nano::transaction const & transaction_a, nano::account const & account_a, nano::account_info const & info_a);
+	bool confirmation_height_get (nano::transaction const & transaction_a, nano::account const & account_a, uint64_t & confirmation_height_a);
+	void confirmation_height_put (nano::transaction const & transaction_a, nano::account const & account_a, uint64_t confirmation_height_a);
+	/** Records objects modified by \p transaction_a, they are dropped from the cache when it commits */
+	void block_modified (nano::write_transaction const & transaction_a, nano::block_hash const & hash_a);
+	void account_modified (nano::write_transaction const & transaction_a, nano::account const & account_a);
+	void confirmation_height_modified (nano::write_transaction const & transaction_a, nano::account const & account_a);
+	/** Drops every cached object when \p transaction_a commits, used for bulk table changes */
+	void all_modified (nano::write_transaction const & transaction_a);
+	/** Called before \p transaction_a commits, returns true if commit_end must be called once the commit is done */
+	bool commit_begin (nano::write_transaction const & transaction_a);
+	void commit_end ();
+	void clear ();
+	void serialize_json (boost::property_tree::ptree & json_a);
+
+	/** Number of commits which modified cached objects, read transactions record it before taking their snapshot */
+	std::atomic<uint64_t> generation{ 1 };
+	static size_t constexpr default_capacity{ 16 * 1024 };
+	static size_t constexpr shard_count{ 16 };
+
+private:
+	class cached_block final
+	{
+	public:
+		std::shared_ptr<nano::block> block;
+		nano::block_sideband sideband;
+	};
+	template <typename Key, typename Value>
+	class table final
+	{
+	public:
+		class entry final
+		{
+		public:
+			Value value;
+			uint64_t generation;
+		};
+		class shard final
+		{
+		public:
+			std::mutex mutex;
+			std::unordered_map<Key, entry> l1;
+			std::unordered_map<Key, entry> l2;
+		};
+		explicit table (size_t capacity_a);
+		shard & shard_get (Key const & key_a);
+		std::array<shard, shard_count> shards;
+		size_t const shard_capacity;
+		std::atomic<uint64_t> hits{ 0 };
+		std::atomic<uint64_t> misses{ 0 };
+	};
+	/** Changes made by a write transaction which is not committed yet */
+	class changes final
+	{
+	public:
+		std::vector<nano::block_hash> blocks;
+		std::vector<nano::account> accounts;
+		std::vector<nano::account> confirmation_heights;
+		bool all{ false };
+	};
+
+	template <typename Key, typename Value>
+	bool get (table<Key, Value> &, nano::transaction const &, Key const &, Value &);
+	template <typename Key, typename Value>
+	void put (table<Key, Value> &, nano::transaction const &, Key const &, Value const &);
+	template <typename Key, typename Value>
+	void erase (table<Key, Value> &, Key const &);
+	template <typename Key, typename Value>
+	void clear (table<Key, Value> &);
+	template <typename Key, typename Value>
+	size_t size (table<Key, Value> &);
+	changes & changes_get (nano::write_transaction const &);
+
+	table<nano::block_hash, cached_block> blocks;
+	table<nano::account, nano::account_info> accounts;
+	table<nano::account, uint64_t> confirmation_heights;
+	std::atomic<unsigned> committing{ 0 };
+	std::unordered_map<void *, changes> pending;
+	std::mutex pending_mutex;
+
+	friend std::unique_ptr<seq_con_info_component> collect_seq_con_info (store_cache &, const std::string &);
+};
+std::unique_ptr<seq_con_info_component> collect_seq_con_info (store_cache &, const std::string &);
+}